@@ -39,6 +39,7 @@
 #include "PatternList.h"
 #include "Collection.h"
 #include "Categories.h"
+#include "MelderThread.h"
 
 static void bookkeeping (FFNet me);
 
@@ -412,6 +413,259 @@ void FFNet_computeDerivative (FFNet me) {
 				my dwi [k] = - my error [i] * my activity [node];
 }
 
+/*
+	Mini-batch version of steps (1) to (4).
+	The weights of layer ilayer form a contiguous numberOfUnits x (numberOfUnitsInPreviousLayer + 1) row-major matrix
+	in my w (the last column holds the biases), so that for a block of patterns (one pattern per row)
+		activity [ilayer] = f (activity [ilayer - 1] . W' + bias)
+		error [ilayer - 1] = (error [ilayer] . W) * deriv [ilayer - 1]
+		dw [ilayer] = - error [ilayer]' . activity [ilayer - 1]
+	are matrix products.
+	The patterns are divided into at most FFNet_MAXIMUM_NUMBER_OF_CHUNKS chunks, independently of the number of threads;
+	each chunk has its own sums, which are added in chunk order, so that the result does not depend on the number of threads.
+*/
+constexpr integer FFNet_PATTERN_BLOCK_SIZE = 256;
+constexpr integer FFNet_MAXIMUM_NUMBER_OF_CHUNKS = 16;
+
+static constMATVU FFNet_getLayerWeights (FFNet me, integer ilayer) {
+	integer firstWeight = 1, numberOfUnitsInPreviousLayer = my numberOfInputs;
+	for (integer jlayer = 1; jlayer < ilayer; jlayer ++) {
+		firstWeight += my numberOfUnitsInLayer [jlayer] * (numberOfUnitsInPreviousLayer + 1);
+		numberOfUnitsInPreviousLayer = my numberOfUnitsInLayer [jlayer];
+	}
+	const integer numberOfWeights = my numberOfUnitsInLayer [ilayer] * (numberOfUnitsInPreviousLayer + 1);
+	Melder_assert (firstWeight + numberOfWeights - 1 <= my numberOfWeights);
+	return constMATVU (& my w [firstWeight], my numberOfUnitsInLayer [ilayer], numberOfUnitsInPreviousLayer + 1,
+			numberOfUnitsInPreviousLayer + 1, 1);
+}
+
+Thing_define (FFNetBatchWorkspace, Thing) {
+	autoMAT activity [4], deriv [4], error [4];   // per layer: numberOfPatternsInBlock x numberOfUnits
+	autoMAT activity_transposed [4], error_transposed [4];
+	autoMAT weightDerivatives [4];
+};
+Thing_implement (FFNetBatchWorkspace, Thing, 0);
+
+static autoFFNetBatchWorkspace FFNetBatchWorkspace_create (FFNet me, integer numberOfPatternsInBlock) {
+	autoFFNetBatchWorkspace thee = Thing_new (FFNetBatchWorkspace);
+	Melder_assert (my numberOfLayers <= 3);
+	integer numberOfUnitsInPreviousLayer = my numberOfInputs;
+	thy activity_transposed [0] = raw_MAT (my numberOfInputs, numberOfPatternsInBlock);
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		const integer numberOfUnits = my numberOfUnitsInLayer [ilayer];
+		thy activity [ilayer] = raw_MAT (numberOfPatternsInBlock, numberOfUnits);
+		thy deriv [ilayer] = raw_MAT (numberOfPatternsInBlock, numberOfUnits);
+		thy error [ilayer] = raw_MAT (numberOfPatternsInBlock, numberOfUnits);
+		thy activity_transposed [ilayer] = raw_MAT (numberOfUnits, numberOfPatternsInBlock);
+		thy error_transposed [ilayer] = raw_MAT (numberOfUnits, numberOfPatternsInBlock);
+		thy weightDerivatives [ilayer] = raw_MAT (numberOfUnits, numberOfUnitsInPreviousLayer);
+		numberOfUnitsInPreviousLayer = numberOfUnits;
+	}
+	return thee;
+}
+
+/*
+	Adds the costs and (if dw is not empty) the derivatives of one block of patterns; does not allocate.
+*/
+static double FFNet_addBlockCostsAndDerivatives (FFNet me, FFNetBatchWorkspace ws, constMATVU const& input, constMATVU const& target,
+	constMATVU const *weights, constMAT const *weights_transposed, VEC const& dw)
+{
+	const integer numberOfPatterns = input.nrow;
+	/*
+		Step (1): forward.
+	*/
+	constMATVU previousActivity = input;
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		const integer numberOfUnitsInPreviousLayer = weights [ilayer].ncol - 1;
+		const bool isLinear = ( ilayer == my numberOfLayers && my outputsAreLinear );
+		MATVU const activity = ws -> activity [ilayer].horizontalBand (1, numberOfPatterns);
+		MATVU const deriv = ws -> deriv [ilayer].horizontalBand (1, numberOfPatterns);
+		mul_MAT_out (activity, previousActivity, weights [ilayer].verticalBand (1, numberOfUnitsInPreviousLayer).transpose());
+		for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++)
+			for (integer iunit = 1; iunit <= activity.ncol; iunit ++) {
+				const double act = activity [ipattern] [iunit] + weights [ilayer] [iunit] [numberOfUnitsInPreviousLayer + 1];
+				if (isLinear) {
+					activity [ipattern] [iunit] = act;
+					deriv [ipattern] [iunit] = 1.0;
+				} else {
+					activity [ipattern] [iunit] = my nonLinearity (me, act, & deriv [ipattern] [iunit]);
+				}
+			}
+		previousActivity = activity;
+	}
+	/*
+		Step (2): the costs and the errors at the output layer.
+	*/
+	MATVU const output = ws -> activity [my numberOfLayers].horizontalBand (1, numberOfPatterns);
+	MATVU const outputError = ws -> error [my numberOfLayers].horizontalBand (1, numberOfPatterns);
+	longdouble cost = 0.0;
+	for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++)
+		for (integer iunit = 1; iunit <= my numberOfOutputs; iunit ++) {
+			const double t = target [ipattern] [iunit], o = output [ipattern] [iunit];
+			if (my costFunctionType == 2) {
+				cost -= t * log (o) + (1.0 - t) * log (1.0 - o);
+				outputError [ipattern] [iunit] = - (1.0 - t) / (1.0 - o) + t / o;
+			} else {
+				const double e = t - o;
+				cost += 0.5 * e * e;
+				outputError [ipattern] [iunit] = e;
+			}
+		}
+	if (dw.size == 0)
+		return (double) cost;
+	/*
+		Step (3): backpropagation.
+	*/
+	for (integer ilayer = my numberOfLayers; ilayer >= 1; ilayer --) {
+		MATVU const error = ws -> error [ilayer].horizontalBand (1, numberOfPatterns);
+		error  *=  ws -> deriv [ilayer].horizontalBand (1, numberOfPatterns);
+		if (ilayer > 1)
+			mul_MAT_out (ws -> error [ilayer - 1].horizontalBand (1, numberOfPatterns), error, weights_transposed [ilayer].transpose());
+	}
+	/*
+		Step (4): dw = - error' . [previousActivity 1].
+	*/
+	integer firstWeight = 1;
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		const integer numberOfUnits = weights [ilayer].nrow, numberOfUnitsInPreviousLayer = weights [ilayer].ncol - 1;
+		MATVU const error_transposed = ws -> error_transposed [ilayer].verticalBand (1, numberOfPatterns);
+		error_transposed  <<=  ws -> error [ilayer].horizontalBand (1, numberOfPatterns).transpose();
+		MATVU const previousActivity_transposed = ws -> activity_transposed [ilayer - 1].verticalBand (1, numberOfPatterns);
+		previousActivity_transposed  <<=  ( ilayer == 1 ? input : constMATVU (ws -> activity [ilayer - 1].horizontalBand (1, numberOfPatterns)) ).transpose();
+		MAT const weightDerivatives = ws -> weightDerivatives [ilayer].get();
+		mul_MAT_out (weightDerivatives, error_transposed, previousActivity_transposed.transpose());
+		MATVU const layerDw (& dw [firstWeight], numberOfUnits, numberOfUnitsInPreviousLayer + 1, numberOfUnitsInPreviousLayer + 1, 1);
+		for (integer iunit = 1; iunit <= numberOfUnits; iunit ++) {
+			layerDw [iunit]. part (1, numberOfUnitsInPreviousLayer)  -=  weightDerivatives [iunit];
+			layerDw [iunit] [numberOfUnitsInPreviousLayer + 1] -= NUMsum (error_transposed [iunit]);
+		}
+		firstWeight += numberOfUnits * (numberOfUnitsInPreviousLayer + 1);
+	}
+	return (double) cost;
+}
+
+double FFNet_computeCostsAndDerivative (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& out_dw) {
+	Melder_assert (input.nrow == target.nrow);
+	Melder_assert (input.ncol == my numberOfInputs && target.ncol == my numberOfOutputs);
+	Melder_assert (out_dw.size == 0 || out_dw.size == my numberOfWeights);
+	const integer numberOfPatterns = input.nrow;
+	if (out_dw.size > 0)
+		out_dw  <<=  0.0;
+	if (numberOfPatterns == 0)
+		return 0.0;
+	/*
+		The weights per layer, and their transposes for the backpropagation.
+	*/
+	constMATVU weights [4];
+	autoMAT weights_transposed [4];
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++) {
+		weights [ilayer] = FFNet_getLayerWeights (me, ilayer);
+		weights_transposed [ilayer] = transpose_MAT (weights [ilayer].verticalBand (1, weights [ilayer].ncol - 1));
+	}
+	constMAT weights_transposed_views [4];
+	for (integer ilayer = 1; ilayer <= my numberOfLayers; ilayer ++)
+		weights_transposed_views [ilayer] = weights_transposed [ilayer].get();
+
+	const integer numberOfBlocks = (numberOfPatterns - 1) / FFNet_PATTERN_BLOCK_SIZE + 1;
+	const integer numberOfChunks = std::min (numberOfBlocks, FFNet_MAXIMUM_NUMBER_OF_CHUNKS);
+	const integer numberOfBlocksPerChunk = (numberOfBlocks - 1) / numberOfChunks + 1;
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfChunks);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+
+	const integer numberOfPatternsInBlock = std::min (numberOfPatterns, FFNet_PATTERN_BLOCK_SIZE);
+	OrderedOf <structFFNetBatchWorkspace> workspaces;
+	for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+		workspaces. addItem_move (FFNetBatchWorkspace_create (me, numberOfPatternsInBlock));
+	autoMAT chunkDw = zero_MAT (numberOfChunks, ( out_dw.size > 0 ? my numberOfWeights : 0 ));
+	autoVEC chunkCosts = zero_VEC (numberOfChunks);
+
+	auto doChunks = [&] (integer ithread) {
+		const FFNetBatchWorkspace ws = workspaces.at [ithread];
+		for (integer ichunk = ithread; ichunk <= numberOfChunks; ichunk += numberOfThreads) {
+			const integer firstBlock = (ichunk - 1) * numberOfBlocksPerChunk + 1;
+			const integer lastBlock = std::min (ichunk * numberOfBlocksPerChunk, numberOfBlocks);
+			VEC const dw = ( out_dw.size > 0 ? chunkDw.row (ichunk) : VEC () );
+			longdouble cost = 0.0;
+			for (integer iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+				const integer firstPattern = (iblock - 1) * FFNet_PATTERN_BLOCK_SIZE + 1;
+				const integer lastPattern = std::min (iblock * FFNet_PATTERN_BLOCK_SIZE, numberOfPatterns);
+				cost += FFNet_addBlockCostsAndDerivatives (me, ws, input.part (firstPattern, lastPattern, 1, input.ncol),
+						target.part (firstPattern, lastPattern, 1, target.ncol), weights, weights_transposed_views, dw);
+			}
+			chunkCosts [ichunk] = (double) cost;
+		}
+	};
+	MelderThread_run (numberOfThreads, doChunks);
+	longdouble cost = 0.0;
+	for (integer ichunk = 1; ichunk <= numberOfChunks; ichunk ++) {
+		cost += chunkCosts [ichunk];
+		if (out_dw.size > 0)
+			out_dw  +=  chunkDw.row (ichunk);
+	}
+	return (double) cost;
+}
+
+/*
+	Compares the blocked and threaded costs and derivatives with the sum of the per-pattern steps (1) to (4),
+	and the derivatives with central differences of the costs,
+	for more patterns than one block or one chunk can hold.
+*/
+static void FFNet_checkCostsAndDerivative (FFNet me, constMAT const& input, constMAT const& target) {
+	const integer numberOfPatterns = input.nrow;
+	autoVEC dw = raw_VEC (my numberOfWeights);
+	const double cost = FFNet_computeCostsAndDerivative (me, input, target, dw.get());
+
+	autoVEC dw_perPattern = zero_VEC (my numberOfWeights);
+	longdouble cost_perPattern = 0.0;
+	for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+		FFNet_propagate (me, input.row (ipattern), nullptr);
+		cost_perPattern += FFNet_computeError (me, target.row (ipattern));
+		FFNet_computeDerivative (me);
+		dw_perPattern.get()  +=  my dwi.get();
+	}
+	Melder_require (fabs (cost - (double) cost_perPattern) <= 1e-10 * (double) cost_perPattern,
+		U"Costs: blocked ", cost, U", per pattern ", (double) cost_perPattern, U".");
+	const double maximumDerivative = NUMextremum_e (dw_perPattern.get());
+	for (integer iweight = 1; iweight <= my numberOfWeights; iweight ++)
+		Melder_require (fabs (dw [iweight] - dw_perPattern [iweight]) <= 1e-10 * maximumDerivative,
+			U"Derivative of weight ", iweight, U": blocked ", dw [iweight], U", per pattern ", dw_perPattern [iweight], U".");
+
+	for (integer iweight = 1; iweight <= my numberOfWeights; iweight ++) {
+		const double w = my w [iweight], h = 1e-5 * std::max (1.0, fabs (w));
+		my w [iweight] = w + h;
+		const double costPlus = FFNet_computeCostsAndDerivative (me, input, target, VEC ());
+		my w [iweight] = w - h;
+		const double costMinus = FFNet_computeCostsAndDerivative (me, input, target, VEC ());
+		my w [iweight] = w;
+		const double dw_finiteDifference = (costPlus - costMinus) / (2.0 * h);
+		Melder_require (fabs (dw [iweight] - dw_finiteDifference) <= 1e-5 * maximumDerivative,
+			U"Derivative of weight ", iweight, U": blocked ", dw [iweight], U", finite difference ", dw_finiteDifference, U".");
+	}
+}
+
+void test_FFNet_computeCostsAndDerivative () {
+	try {
+		const integer numberOfPatterns = 2 * FFNet_MAXIMUM_NUMBER_OF_CHUNKS * FFNet_PATTERN_BLOCK_SIZE + 37;   // several blocks per chunk, and a partial last block
+		const integer numberOfInputs = 4, numberOfOutputs = 3;
+		autoMAT input = randomUniform_MAT (numberOfPatterns, numberOfInputs, -1.0, 1.0);
+		autoMAT target = randomUniform_MAT (numberOfPatterns, numberOfOutputs, 0.05, 0.95);
+		for (integer numberOfHiddenLayers = 0; numberOfHiddenLayers <= 2; numberOfHiddenLayers ++) {
+			for (int costFunctionType = 1; costFunctionType <= 2; costFunctionType ++) {
+				for (int outputsAreLinear = 0; outputsAreLinear <= ( costFunctionType == 1 ); outputsAreLinear ++) {
+					autoFFNet me = FFNet_create (numberOfInputs, ( numberOfHiddenLayers > 0 ? 5 : 0 ),
+							( numberOfHiddenLayers > 1 ? 4 : 0 ), numberOfOutputs, outputsAreLinear);
+					FFNet_setCostFunction (me.get(), costFunctionType);
+					FFNet_reset (me.get(), 1.0);
+					FFNet_checkCostsAndDerivative (me.get(), input.get(), target.get());
+				}
+			}
+		}
+		MelderInfo_writeLine (U"test_FFNet_computeCostsAndDerivative: OK");
+	} catch (MelderError) {
+		Melder_throw (U"FFNet costs and derivative test failed.");
+	}
+}
+
 /******* end operation ******************************************************/
 
 integer FFNet_getWinningUnit (FFNet me, integer labeling) {
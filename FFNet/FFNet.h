@@ -174,6 +174,13 @@ void FFNet_computeDerivative (FFNet me);
 /* step (4) compute derivative in my dwi */
 /* Precondition: step (3) */
 
+double FFNet_computeCostsAndDerivative (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& out_dw);
+/* steps (1) to (4) for all patterns (the rows of input and target) at once, in blocks and threads; */
+/* returns the total cost and, if out_dw is not empty, puts the sum of the per-pattern derivatives into out_dw */
+/* my activity, error and dwi are not changed */
+
+void test_FFNet_computeCostsAndDerivative ();
+
 integer FFNet_getWinningUnit (FFNet me, integer labeling);
 /* labeling = 1 : winner-takes-all */
 /* labeling = 2 : stochastic */
@@ -177,4 +177,82 @@ autoMAT newMATpseudoInverse (constMATVU const& mat, double tolerance) {
 	return result;
 }
 
+/*
+	Makes the rows of m orthonormal by classical Gram-Schmidt, applied twice ("twice is enough").
+	Rows that are numerically dependent on the previous ones become zero.
+*/
+static void MAT_orthonormalizeRows_inplace (MAT const& m) {
+	for (integer irow = 1; irow <= m.nrow; irow ++) {
+		VEC const row = m.row (irow);
+		const double originalNorm = NUMnorm (row, 2.0);
+		for (integer pass = 1; pass <= 2; pass ++)
+			for (integer jrow = 1; jrow < irow; jrow ++)
+				row  -=  NUMinner (row, m.row (jrow)) * m.row (jrow);
+		const double norm = NUMnorm (row, 2.0);
+		if (norm > 1e-12 * originalNorm && norm > 0.0)
+			row  *=  1.0 / norm;
+		else
+			row  <<=  0.0;
+	}
+}
+
+void MAT_getTruncatedSingularValueDecomposition (constMATVU const& a, constVECVU const& columnOffsets,
+	integer numberOfSingularValues, integer oversampling, integer numberOfPowerIterations,
+	autoMAT *out_left, autoVEC *out_singularValues, autoMAT *out_right)
+{
+	Melder_assert (columnOffsets.size == 0 || columnOffsets.size == a.ncol);
+	Melder_require (numberOfSingularValues > 0 && numberOfSingularValues <= std::min (a.nrow, a.ncol),
+		U"The number of singular values should be in the range [1, ", std::min (a.nrow, a.ncol), U"].");
+	Melder_require (oversampling >= 0 && numberOfPowerIterations >= 0,
+		U"The oversampling and the number of power iterations should not be negative.");
+	const integer subspaceDimension = std::min (numberOfSingularValues + oversampling, std::min (a.nrow, a.ncol));
+	const bool centre = ( columnOffsets.size > 0 );
+	/*
+		The bases of the column space (qt) and the row space (zt) of A are stored row-wise,
+		so that each basis vector is contiguous in memory.
+		We compute qt = orth (omegat . A'), and then the power iterations
+		zt = orth (qt . A), qt = orth (zt . A').
+		With centring, A = a - 1 c', so that
+			x . A' = x . a' - (x . c) 1'   and   qt . A = qt . a - (qt . 1) c'.
+	*/
+	autoMAT zt = randomGauss_MAT (subspaceDimension, a.ncol, 0.0, 1.0);
+	autoMAT qt = raw_MAT (subspaceDimension, a.nrow);
+	auto multiplyByTransposed = [&] () {   // qt := zt . A'
+		mul_fast_MAT_out (qt.get(), zt.get(), a.transpose());
+		if (centre)
+			for (integer irow = 1; irow <= subspaceDimension; irow ++)
+				qt.row (irow)  -=  NUMinner (zt.row (irow), columnOffsets);
+		MAT_orthonormalizeRows_inplace (qt.get());
+	};
+	auto multiply = [&] () {   // zt := qt . A
+		mul_fast_MAT_out (zt.get(), qt.get(), a);
+		if (centre)
+			for (integer irow = 1; irow <= subspaceDimension; irow ++)
+				zt.row (irow)  -=  NUMsum (qt.row (irow)) * columnOffsets;
+	};
+	multiplyByTransposed ();
+	for (integer iteration = 1; iteration <= numberOfPowerIterations; iteration ++) {
+		multiply ();
+		MAT_orthonormalizeRows_inplace (zt.get());
+		multiplyByTransposed ();
+	}
+	/*
+		A ~ Q Q' A = Q B, with the small subspaceDimension x a.ncol matrix B = zt = qt . A.
+		If B = Ub D Vb', then A ~ (Q Ub) D Vb'.
+	*/
+	multiply ();
+	autoSVD svd = SVD_createFromGeneralMatrix (zt.get());
+	MAT const leftOfB = ( svd -> isTransposed ? svd -> v.get() : svd -> u.get() );
+	MAT const rightOfB = ( svd -> isTransposed ? svd -> u.get() : svd -> v.get() );
+	if (out_left) {
+		autoMAT left = raw_MAT (a.nrow, numberOfSingularValues);
+		mul_fast_MAT_out (left.get(), qt.transpose(), leftOfB.verticalBand (1, numberOfSingularValues));
+		*out_left = left.move();
+	}
+	if (out_singularValues)
+		*out_singularValues = copy_VEC (svd -> d.part (1, numberOfSingularValues));
+	if (out_right)
+		*out_right = copy_MAT (rightOfB.verticalBand (1, numberOfSingularValues));
+}
+
 /* End of file MAT_numerics.cpp */
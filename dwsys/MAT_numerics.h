@@ -70,4 +70,19 @@ autoMAT newMATpseudoInverse (constMATVU const& mat, double tolerance);
 	Returns a [1..ncol] [1..nrow] matrix
 */
 
+void MAT_getTruncatedSingularValueDecomposition (constMATVU const& a, constVECVU const& columnOffsets,
+	integer numberOfSingularValues, integer oversampling, integer numberOfPowerIterations,
+	autoMAT *out_left, autoVEC *out_singularValues, autoMAT *out_right);
+/*
+	The largest singular values of the a.nrow x a.ncol matrix A - 1 c' (c = columnOffsets, or zero if columnOffsets is empty),
+	computed with a randomised range finder with subspace (power) iterations (Halko, Martinsson & Tropp 2011).
+	The subspace has dimension numberOfSingularValues + oversampling; each power iteration needs two extra passes
+	over the data and improves the accuracy when the singular values decay slowly.
+	Only O((a.nrow + a.ncol) * (numberOfSingularValues + oversampling)) extra memory is used; A is never copied.
+	Output:
+		if (out_left) the left singular vectors, as the columns of an a.nrow x numberOfSingularValues matrix
+		if (out_singularValues) the singular values, sorted descending
+		if (out_right) the right singular vectors, as the columns of an a.ncol x numberOfSingularValues matrix
+*/
+
 /* End of file MAT_numerics.h */
@@ -21,6 +21,7 @@
 #include "NUMmachar.h"
 #include "NUM2.h"
 #include "SVD.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "NMF_def.h"
@@ -201,31 +202,73 @@ static double getMaximumChange (constMATVU const& m, MATVU const& m0, const doub
 	return dmat;
 }
 
+/*
+	The weights are updated in blocks of columns, so that the intermediate matrices have only
+	numberOfColumnsPerBlock columns instead of as many columns as the data.
+	The block size does not change the factorization, so the public functions choose it themselves (0 = the default).
+	The large products within a block are divided over threads by _mul_blocked_threaded_MAT_out.
+*/
+constexpr integer NMF_DEFAULT_NUMBER_OF_COLUMNS_PER_BLOCK = 8192;
+
+static integer NMF_getNumberOfColumnsPerBlock (NMF me, integer numberOfColumnsPerBlock) {
+	if (numberOfColumnsPerBlock <= 0)
+		numberOfColumnsPerBlock = NMF_DEFAULT_NUMBER_OF_COLUMNS_PER_BLOCK;
+	return std::min (numberOfColumnsPerBlock, my numberOfColumns);
+}
+
+/*
+	For the element-wise passes over the whole data matrix; below some 100000 cells threading does not pay.
+*/
+static integer NMF_getNumberOfThreads (integer numberOfParts, double numberOfCells) {
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), Melder_ifloor (numberOfCells / 1e5) + 1);
+	Melder_clip (1_integer, & numberOfThreads, std::min (numberOfParts, 16_integer));
+	return numberOfThreads;
+}
+
+/*
+	Divides the range 1..size over the threads; every part is handled in the same way whatever the number of threads.
+*/
+template <typename PartFunction>
+static void NMF_doInParallel (integer numberOfThreads, integer size, PartFunction const& doPart) {
+	const integer partSize = (size - 1) / numberOfThreads + 1;
+	auto doThreadPart = [&] (integer ithread) {
+		const integer from = (ithread - 1) * partSize + 1, to = std::min (ithread * partSize, size);
+		if (from <= to)
+			doPart (from, to);
+	};
+	MelderThread_run (numberOfThreads, doThreadPart);
+}
+
 /*
 	Calculating elementwise matrix multiplication, division and addition m = m0 .* (numerm ./(denom + eps))
 	Set elements < zero_threshold to zero
 */
 
+/*
+	The value 1e-9 is OK for matrices with values that are larger than 1.
+	For matrices with very small values we have to scale the divByZeroAvoidance value
+	otherwise the precision would suffer.
+	A scaling with the maximum value seems reasonable.
+*/
+static double getDivByZeroAvoidance (double maximum) {
+	return 1e-09 * ( maximum < 1.0 ? maximum : 1.0 );
+}
+
+static inline double updatedValue (double m0, double numer, double denom, double zeroThreshold, double divByZeroAvoidance) {
+	if (m0 == 0.0 || numer == 0.0)
+		return 0.0;
+	const double update = m0 * (numer / (denom + divByZeroAvoidance));
+	return ( update < zeroThreshold ? 0.0 : update );
+}
+
 static const void update (MATVU const& m, constMATVU const& m0, constMATVU const& numer, constMATVU const& denom, double zeroThreshold, double maximum) {
 	Melder_assert (m.nrow == m0.nrow && m.ncol == m0.ncol);
 	Melder_assert (m.nrow == numer.nrow && m.ncol == numer.ncol);
 	Melder_assert (m.nrow == denom.nrow && m.ncol == denom.ncol);
-	/*
-		The value 1e-9 is OK for matrices with values that are larger than 1.
-		For matrices with very small values we have to scale the divByZeroAvoidance value
-		otherwise the precision would suffer. 
-		A scaling with the maximum value seems reasonable.
-	*/
-	const double divByZeroAvoidance = 1e-09 * ( maximum < 1.0 ? maximum : 1.0 );
+	const double divByZeroAvoidance = getDivByZeroAvoidance (maximum);
 	for (integer irow = 1; irow <= m.nrow; irow ++) 
-		for (integer icol = 1; icol <= m.ncol; icol++) {
-			if (m0 [irow] [icol] == 0.0 || numer [irow] [icol]  == 0.0) {
-				m [irow] [icol] = 0.0;
-			} else {
-				double update = m0 [irow] [icol] * (numer [irow] [icol] / (denom [irow] [icol] + divByZeroAvoidance));
-				m [irow] [icol] = ( update < zeroThreshold ? 0.0 : update );
-			}
-		}
+		for (integer icol = 1; icol <= m.ncol; icol++)
+			m [irow] [icol] = updatedValue (m0 [irow] [icol], numer [irow] [icol], denom [irow] [icol], zeroThreshold, divByZeroAvoidance);
 }
 
 /*
@@ -236,16 +279,16 @@ static const void update (MATVU const& m, constMATVU const& m0, constMATVU const
 		Computing and informatics% #30: 205--224.
 
 */
-void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, bool info) {
+static void NMF_improveFactorization_mu_ (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, integer numberOfColumnsPerBlock, bool info) {
 	try {
 		Melder_require (my numberOfColumns == data.ncol,
 			U"The number of columns should be equal.");
 		Melder_require (my numberOfRows == data.nrow,
 			U"The number of rows should be equal.");
+		const integer blockSize = NMF_getNumberOfColumnsPerBlock (me, numberOfColumnsPerBlock);
 		
-		autoMAT productFtD = zero_MAT (my numberOfFeatures, my numberOfColumns); // calculations of F'D
-		autoMAT productFtFW = zero_MAT (my numberOfFeatures, my numberOfColumns); // calculations of F'F W
-		autoMAT weights0 = zero_MAT (my numberOfFeatures, my numberOfColumns);
+		autoMAT productFtD = zero_MAT (my numberOfFeatures, blockSize); // calculations of F'D, per block
+		autoMAT productFtFW = zero_MAT (my numberOfFeatures, blockSize); // calculations of F'F W, per block
 		
 		autoMAT productDWt = zero_MAT (my numberOfRows, my numberOfFeatures); // calculations of DW'
 		autoMAT productFWWt = zero_MAT (my numberOfRows, my numberOfFeatures); // calculations of FWW'
@@ -255,8 +298,6 @@ void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximu
 		autoMAT productFtF = zero_MAT (my numberOfFeatures, my numberOfFeatures); // calculations of F'F
 		
 		const double traceDtD = NUMtrace2 (data.transpose(), data); // for distance calculation
-		features0.all()  <<=  my features.all();
-		weights0.all()  <<=  my weights.all();
 		
 		if (! NUMfpp)
 			NUMmachar ();
@@ -264,6 +305,7 @@ void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximu
 		const double eps = NUMfpp -> eps;
 		const double sqrteps = sqrt (eps);
 		const double maximum = NUMmax_e (data);
+		const double divByZeroAvoidance = getDivByZeroAvoidance (maximum);
 		double dnorm0 = 0.0;
 		integer iter = 1;
 		bool convergence = false;	
@@ -277,18 +319,42 @@ void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximu
 				endwhile
 			*/
 			
-			// 1. Update W matrix
+			/*
+				1. Update W matrix, one block of columns at a time.
+				The element-wise update follows the products of the block directly,
+				and D*W' and W*W' for step 2 and trace (W'(F'D)) for step 3 are accumulated on the way,
+				so that the full F'D and F'FW are never needed.
+			*/
 			features0.all()  <<=  my features.all();
-			weights0.all()  <<=  my weights.all();
-			mul_MAT_out (productFtD.get(), features0.transpose(), data);
 			mul_MAT_out (productFtF.get(), features0.transpose(), features0.get());
-			mul_MAT_out (productFtFW.get(), productFtF.get(), weights0.get());
-			update (my weights.get(), weights0.get(), productFtD.get(), productFtFW.get(), eps, maximum);
+			productDWt.all()  <<=  0.0;
+			productWWt.all()  <<=  0.0;
+			longdouble traceWtFtD = 0.0;
+			double maximumWeight = 0.0, maximumWeightChange = 0.0;
+			for (integer firstColumn = 1; firstColumn <= my numberOfColumns; firstColumn += blockSize) {
+				const integer lastColumn = std::min (firstColumn + blockSize - 1, my numberOfColumns);
+				const integer numberOfColumnsInBlock = lastColumn - firstColumn + 1;
+				constMATVU const dataBlock = data.verticalBand (firstColumn, lastColumn);
+				MATVU const weights = my weights.verticalBand (firstColumn, lastColumn);
+				MATVU const ftd = productFtD.verticalBand (1, numberOfColumnsInBlock);
+				MATVU const ftfw = productFtFW.verticalBand (1, numberOfColumnsInBlock);
+				_mul_blocked_threaded_MAT_out (ftd, features0.transpose(), dataBlock, 1.0, 0.0, 0);
+				_mul_blocked_threaded_MAT_out (ftfw, productFtF.get(), weights, 1.0, 0.0, 0);
+				for (integer irow = 1; irow <= weights.nrow; irow ++)
+					for (integer icol = 1; icol <= weights.ncol; icol ++) {
+						const double weight0 = weights [irow] [icol];
+						const double weight = updatedValue (weight0, ftd [irow] [icol], ftfw [irow] [icol], eps, divByZeroAvoidance);
+						weights [irow] [icol] = weight;
+						traceWtFtD += weight * ftd [irow] [icol];
+						maximumWeight = std::max (maximumWeight, fabs (weight0));
+						maximumWeightChange = std::max (maximumWeightChange, fabs (weight0 - weight));
+					}
+				_mul_blocked_threaded_MAT_out (productDWt.get(), dataBlock, weights.transpose(), 1.0, 1.0, 0); // productDWt += data*weights'
+				_mul_blocked_threaded_MAT_out (productWWt.get(), weights, weights.transpose(), 1.0, 1.0, 0); // productWWt += weights*weights'
+			}
 
 			// 2. Update F matrix
-			mul_MAT_out (productDWt.get(), data, my weights.transpose()); // productDWt = data*weights'
-			mul_MAT_out (productWWt.get(), my weights.get(), my weights.transpose()); // work1 = weights*weights'
-			mul_MAT_out (productFWWt.get(), features0.get(), productWWt.get()); // productFWWt = features0 * work1
+			mul_MAT_out (productFWWt.get(), features0.get(), productWWt.get()); // productFWWt = features0 * productWWt
 			update (my features.get(), features0.get(), productDWt.get(), productFWWt.get(), eps, maximum);
 			
 			/* 3. Convergence test:
@@ -299,12 +365,11 @@ void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximu
 				the needed matrix multiplications in the update step.
 			*/
 			
-			const double traceWtFtD  = NUMtrace2 (my weights.transpose(), productFtD.get());
 			const double traceWtFtFW = NUMtrace2 (productFtF.get(), productWWt.get());
-			const double distance = sqrt (std::max (traceDtD - 2.0 * traceWtFtD + traceWtFtFW, 0.0)); // just in case
+			const double distance = sqrt (std::max (traceDtD - 2.0 * double (traceWtFtD) + traceWtFtFW, 0.0)); // just in case
 			const double dnorm = distance / (my numberOfRows * my numberOfColumns);
 			const double df = getMaximumChange (my features.get(), features0.get(), sqrteps);
-			const double dw = getMaximumChange (my weights.get(), weights0.get(), sqrteps);
+			const double dw = maximumWeightChange / (sqrteps + maximumWeight);
 			const double delta = std::max (df, dw);
 			convergence = ( iter > 1 && (delta < changeTolerance || dnorm < dnorm0 * approximationTolerance) );
 			if (info)
@@ -320,15 +385,20 @@ void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximu
 	}
 }
 
-void NMF_improveFactorization_als (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, bool info) {
+void NMF_improveFactorization_mu (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, bool info) {
+	NMF_improveFactorization_mu_ (me, data, maximumNumberOfIterations, changeTolerance, approximationTolerance, 0, info);
+}
+
+static void NMF_improveFactorization_als_ (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, integer numberOfColumnsPerBlock, bool info) {
 	try {
 		Melder_require (my numberOfColumns == data.ncol, U"The number of columns should be equal.");
 		Melder_require (my numberOfRows == data.nrow, U"The number of rows should be equal.");
+		const integer blockSize = NMF_getNumberOfColumnsPerBlock (me, numberOfColumnsPerBlock);
 		
-		autoMAT productFtD = zero_MAT (my numberOfFeatures, my numberOfColumns); // calculations of F'D
+		autoMAT productFtD = zero_MAT (my numberOfFeatures, blockSize); // calculations of F'D, per block
+		autoMAT weights0 = zero_MAT (my numberOfFeatures, blockSize); // previous weights, per block
 		autoMAT productWDt = zero_MAT (my numberOfFeatures, my numberOfRows); // calculations of WD'
 		
-		autoMAT weights0 = zero_MAT (my numberOfFeatures, my numberOfColumns);
 		autoMAT features0 = zero_MAT (my numberOfRows, my numberOfFeatures);
 
 		autoMAT productFtF = zero_MAT (my numberOfFeatures, my numberOfFeatures); // calculations of F'F
@@ -359,24 +429,41 @@ void NMF_improveFactorization_als (NMF me, constMATVU const& data, integer maxim
 			*/
 			
 			/*
-				1. Solve equations for new W:  F´*F*W = F'*D
+				1. Solve equations for new W:  F´*F*W = F'*D, one block of columns at a time.
+				W*D' and W*W' for step 2 and trace (W'(F'D)) for step 3 are accumulated on the way.
 			*/
-			weights0.all()  <<=  my weights.all();   // save previous weights for convergence test
-			mul_MAT_out (productFtD.get(), my features.transpose(), data);
 			mul_MAT_out (productFtF.get(), my features.transpose(), my features.get());
-
 			svd_FtF -> u.all()  <<=  productFtF.all();
 			SVD_compute (svd_FtF.get());
-			SVD_solve_preallocated (svd_FtF.get(), productFtD.get(), my weights.get());
-			MATmakeElementsNonNegative (my weights.get(), 0);
+			productWDt.all()  <<=  0.0;
+			productWWt.all()  <<=  0.0;
+			longdouble traceWtFtD = 0.0;
+			double maximumWeight = 0.0, maximumWeightChange = 0.0;
+			for (integer firstColumn = 1; firstColumn <= my numberOfColumns; firstColumn += blockSize) {
+				const integer lastColumn = std::min (firstColumn + blockSize - 1, my numberOfColumns);
+				const integer numberOfColumnsInBlock = lastColumn - firstColumn + 1;
+				constMATVU const dataBlock = data.verticalBand (firstColumn, lastColumn);
+				MATVU const weights = my weights.verticalBand (firstColumn, lastColumn);
+				MATVU const ftd = productFtD.verticalBand (1, numberOfColumnsInBlock);
+				MATVU const previousWeights = weights0.verticalBand (1, numberOfColumnsInBlock);
+				previousWeights  <<=  weights;   // save previous weights for convergence test
+				_mul_blocked_threaded_MAT_out (ftd, my features.transpose(), dataBlock, 1.0, 0.0, 0);
+				SVD_solve_preallocated (svd_FtF.get(), ftd, weights);
+				MATmakeElementsNonNegative (weights, 0);
+				for (integer irow = 1; irow <= weights.nrow; irow ++)
+					for (integer icol = 1; icol <= weights.ncol; icol ++) {
+						traceWtFtD += weights [irow] [icol] * ftd [irow] [icol];
+						maximumWeight = std::max (maximumWeight, fabs (previousWeights [irow] [icol]));
+						maximumWeightChange = std::max (maximumWeightChange, fabs (previousWeights [irow] [icol] - weights [irow] [icol]));
+					}
+				_mul_blocked_threaded_MAT_out (productWDt.get(), weights, dataBlock.transpose(), 1.0, 1.0, 0); // productWDt += weights*data'
+				_mul_blocked_threaded_MAT_out (productWWt.get(), weights, weights.transpose(), 1.0, 1.0, 0); // productWWt += weights*weights'
+			}
 			
 			/*
 				2. Solve equations for new F:  W*W'*F' = W*D'
 			*/
 			features0.all()  <<=  my features.all();   // save previous features for convergence test
-			mul_MAT_out  (productWDt.get(), my weights.get(), data.transpose());
-			mul_MAT_out (productWWt.get(), my weights.get(), my weights.transpose());
-
 			svd_WWt -> u.all()  <<=  productWWt.all();
 			SVD_compute (svd_WWt.get());
 			SVD_solve_preallocated (svd_WWt.get(), productWDt.get(), my features.transpose());
@@ -384,12 +471,11 @@ void NMF_improveFactorization_als (NMF me, constMATVU const& data, integer maxim
 			/*
 				3. Convergence test.
 			*/
-			const double traceWtFtD  = NUMtrace2 (my weights.transpose(), productFtD.get());
 			const double traceWtFtFW = NUMtrace2 (productFtF.get(), productWWt.get());
-			const double distance = sqrt (std::max (traceDtD - 2.0 * traceWtFtD + traceWtFtFW, 0.0));   // just in case
+			const double distance = sqrt (std::max (traceDtD - 2.0 * double (traceWtFtD) + traceWtFtFW, 0.0));   // just in case
 			const double dnorm = distance / (my numberOfRows * my numberOfColumns);
 			const double df = getMaximumChange (my features.get(), features0.get(), sqrteps);
-			const double dw = getMaximumChange (my weights.get(), weights0.get(), sqrteps);
+			const double dw = maximumWeightChange / (sqrteps + maximumWeight);
 			const double delta = std::max (df, dw);
 			
 			convergence = ( iter > 1 && (delta < changeTolerance || dnorm < dnorm0 * approximationTolerance) );
@@ -405,12 +491,44 @@ void NMF_improveFactorization_als (NMF me, constMATVU const& data, integer maxim
 	}
 }
 
+void NMF_improveFactorization_als (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, bool info) {
+	NMF_improveFactorization_als_ (me, data, maximumNumberOfIterations, changeTolerance, approximationTolerance, 0, info);
+}
+
 static void VECinvertAndScale (VECVU const& target, constVECVU const& source, double scaleFactor) {
 	Melder_assert (target.size == source.size);
 	for (integer i = 1; i <= target.size; i ++)
 		target [i] = scaleFactor / source [i];
 }
 
+/*
+	As MATgetDivergence_ItakuraSaito, with the rows divided over threads;
+	the sums of the rows are added in order, so the result does not depend on the number of threads.
+*/
+static double getDivergence_ItakuraSaito (constMATVU const& ref, constMATVU const& x, VEC const& rowDivergences, integer numberOfThreads) {
+	NMF_doInParallel (numberOfThreads, ref.nrow, [&] (integer fromRow, integer toRow) {
+		for (integer irow = fromRow; irow <= toRow; irow ++) {
+			double divergence = 0.0;
+			for (integer icol = 1; icol <= ref.ncol; icol ++) {
+				const double refval = ref [irow] [icol];
+				if (refval == 0.0) {
+					divergence = undefined;
+					break;
+				}
+				divergence += x [irow] [icol] / refval - log (x [irow] [icol] / refval) - 1.0;
+			}
+			rowDivergences [irow] = divergence;
+		}
+	});
+	double divergence = 0.0;
+	for (integer irow = 1; irow <= ref.nrow; irow ++) {
+		if (isundef (rowDivergences [irow]))
+			return undefined;
+		divergence += rowDivergences [irow];
+	}
+	return divergence;
+}
+
 void NMF_improveFactorization_is (NMF me, constMATVU const& data, integer maximumNumberOfIterations, double changeTolerance, double approximationTolerance, bool info) {
 	try {
 		Melder_require (my numberOfColumns == data.ncol, U"The number of columns should be equal.");
@@ -419,11 +537,19 @@ void NMF_improveFactorization_is (NMF me, constMATVU const& data, integer maximu
 			U"The data matrix should not have cells that are zero.");
 		autoMAT vk = raw_MAT (data.nrow, data.ncol);
 		autoMAT fw = raw_MAT (data.nrow, data.ncol);
-		autoMAT fcol_x_wrow = raw_MAT (data.nrow, data.ncol);
 		autoVEC fcolumn_inv = raw_VEC (data.nrow); // feature column
 		autoVEC wrow_inv = raw_VEC (data.ncol); // weight row
-		mul_MAT_out (fw.get(), my features.get(), my weights.get());
-		double divergence = MATgetDivergence_ItakuraSaito (data, fw.get());
+		autoVEC fcolumn0 = raw_VEC (data.nrow), wrow0 = raw_VEC (data.ncol); // previous feature column and weight row
+		autoVEC rowDivergences = raw_VEC (data.nrow);
+		/*
+			The element-wise passes over the data are divided over threads, by rows or by columns,
+			in such a way that every element is computed in the same order whatever the number of threads.
+		*/
+		const double numberOfCells = double (data.nrow) * double (data.ncol);
+		const integer numberOfRowThreads = NMF_getNumberOfThreads (data.nrow, numberOfCells);
+		const integer numberOfColumnThreads = NMF_getNumberOfThreads (data.ncol, numberOfCells);
+		_mul_blocked_threaded_MAT_out (fw.get(), my features.get(), my weights.get(), 1.0, 0.0, 0);
+		double divergence = getDivergence_ItakuraSaito (data, fw.get(), rowDivergences.get(), numberOfRowThreads);
 		const double divergence0 = divergence;
 		if (info)
 			MelderInfo_writeLine (U"Iteration: 0", U" divergence: ", divergence, U" delta: ", divergence);
@@ -444,33 +570,54 @@ void NMF_improveFactorization_is (NMF me, constMATVU const& data, integer maximu
 						F.H - old(fcol(k) x wrow (k)) + new(fcol(k) x wrow (k))    (6)
 					}
 				}
-				There is no need to calculate G(k) explicitly as in (1).
-				We can calculate the elements of G(k) while we are doing (2).
+				There is no need to calculate G(k) explicitly as in (1), nor the outer product fcol(k) x wrow (k).
+				We can calculate their elements while we are doing (2) and (6).
 			*/
 			for (integer kf = 1; kf <= my numberOfFeatures; kf ++) {
+				VEC const fcolumn = fcolumn0.get(), wrow = wrow0.get();
+				fcolumn  <<=  my features.column (kf);
+				wrow  <<=  my weights.row (kf);
 				// (1) and (2)
-				outer_MAT_out (fcol_x_wrow.get(), my features.column (kf), my weights.row (kf));
-				for (integer irow = 1; irow <= data.nrow; irow ++)
-					for (integer icol = 1; icol <= data.ncol; icol ++) {
-						double gk = fcol_x_wrow [irow] [icol] / fw [irow] [icol];
-						vk [irow] [icol] = gk * gk * data [irow] [icol] + (1.0 - gk) * fcol_x_wrow [irow] [icol];
-					}
+				NMF_doInParallel (numberOfRowThreads, data.nrow, [&] (integer fromRow, integer toRow) {
+					for (integer irow = fromRow; irow <= toRow; irow ++)
+						for (integer icol = 1; icol <= data.ncol; icol ++) {
+							const double fcol_x_wrow = fcolumn [irow] * wrow [icol];
+							const double gk = fcol_x_wrow / fw [irow] [icol];
+							vk [irow] [icol] = gk * gk * data [irow] [icol] + (1.0 - gk) * fcol_x_wrow;
+						}
+				});
 				// (3)
-				VECinvertAndScale (fcolumn_inv.get(), my features.column (kf), 1.0 / my numberOfRows);	
-				mul_VEC_out (my weights.row (kf), fcolumn_inv.get(), vk.get());
+				VECinvertAndScale (fcolumn_inv.get(), fcolumn, 1.0 / my numberOfRows);
+				VECVU const newWrow = my weights.row (kf);
+				NMF_doInParallel (numberOfColumnThreads, data.ncol, [&] (integer fromColumn, integer toColumn) {
+					VECVU const part = newWrow.part (fromColumn, toColumn);
+					part  <<=  0.0;
+					for (integer irow = 1; irow <= data.nrow; irow ++) {
+						const double factor = fcolumn_inv [irow];
+						const double *const vkrow = & vk [irow] [fromColumn];
+						for (integer icol = 1; icol <= part.size; icol ++)
+							part [icol] += factor * vkrow [icol - 1];
+					}
+				});
 				// (4)
-				VECinvertAndScale (wrow_inv.get(), my weights.row (kf), 1.0 / my numberOfColumns);
-				mul_VEC_out (my features.column (kf), vk.get(), wrow_inv.get());
+				VECinvertAndScale (wrow_inv.get(), newWrow, 1.0 / my numberOfColumns);
+				VECVU const newFcolumn = my features.column (kf);
+				NMF_doInParallel (numberOfRowThreads, data.nrow, [&] (integer fromRow, integer toRow) {
+					for (integer irow = fromRow; irow <= toRow; irow ++)
+						newFcolumn [irow] = NUMinner (vk.row (irow), wrow_inv.get());
+				});
 				// (5)
-				double fcolumn_norm = NUMnorm (my features.column (kf), 2.0);
-				my features.column (kf)  /=  fcolumn_norm;
-				my weights.row (kf)  *=  fcolumn_norm;
+				double fcolumn_norm = NUMnorm (newFcolumn, 2.0);
+				newFcolumn  /=  fcolumn_norm;
+				newWrow  *=  fcolumn_norm;
 				// (6)
-				fw.get()  -=  fcol_x_wrow.get();
-				outer_MAT_out (fcol_x_wrow.get(), my features.column (kf), my weights.row (kf));
-				fw.get()  +=  fcol_x_wrow.get();
+				NMF_doInParallel (numberOfRowThreads, data.nrow, [&] (integer fromRow, integer toRow) {
+					for (integer irow = fromRow; irow <= toRow; irow ++)
+						for (integer icol = 1; icol <= data.ncol; icol ++)
+							fw [irow] [icol] = (fw [irow] [icol] - fcolumn [irow] * wrow [icol]) + newFcolumn [irow] * newWrow [icol];
+				});
 			}
-			const double divergence_update = MATgetDivergence_ItakuraSaito (data, fw.get());
+			const double divergence_update = getDivergence_ItakuraSaito (data, fw.get(), rowDivergences.get(), numberOfRowThreads);
 			const double delta = divergence - divergence_update;
 			convergence = ( iter > 1 && (fabs (delta) < changeTolerance || divergence_update < divergence0 * approximationTolerance) );
 			if (info)
@@ -488,11 +635,46 @@ void NMF_improveFactorization_is (NMF me, constMATVU const& data, integer maximu
 
 autoMAT NMF_synthesize (NMF me) {
 	try {
-		autoMAT result = mul_MAT (my features.get(), my weights.get());
+		autoMAT result = raw_MAT (my numberOfRows, my numberOfColumns);
+		_mul_blocked_threaded_MAT_out (result.get(), my features.get(), my weights.get(), 1.0, 0.0, 0);
 		return result;
 	} catch (MelderError) {
 		Melder_throw (me, U": No matrix created.");
 	}
 }
 
+/*
+	More columns than fit in one block: the blocked updates should give the same factorization as a single block.
+*/
+void test_NMF_blockedUpdates () {
+	try {
+		const integer numberOfRows = 20, numberOfColumns = 20000, numberOfFeatures = 3;
+		autoMAT data = randomUniform_MAT (numberOfRows, numberOfColumns, 1.0, 10.0);
+		autoNMF start = NMF_create (numberOfRows, numberOfColumns, numberOfFeatures);
+		NMF_initializeFactorization (start.get(), data.get(), kNMF_Initialization::RANDOM_UNIFORM);
+		autoNMF single = Data_copy (start.get());
+		NMF_improveFactorization_mu_ (single.get(), data.get(), 10, 1e-9, 1e-9, numberOfColumns, false);
+		NMF_improveFactorization_als_ (single.get(), data.get(), 10, 1e-9, 1e-9, numberOfColumns, false);
+		const double singleDistance = NMF_getEuclideanDistance (single.get(), data.get());
+		for (const integer numberOfColumnsPerBlock : { 1000, 7777 }) {
+			autoNMF blocked = Data_copy (start.get());
+			NMF_improveFactorization_mu_ (blocked.get(), data.get(), 10, 1e-9, 1e-9, numberOfColumnsPerBlock, false);
+			NMF_improveFactorization_als_ (blocked.get(), data.get(), 10, 1e-9, 1e-9, numberOfColumnsPerBlock, false);
+			const double blockedDistance = NMF_getEuclideanDistance (blocked.get(), data.get());
+			Melder_require (fabs (blockedDistance - singleDistance) <= 1e-9 * singleDistance,
+				U"Blocks of ", numberOfColumnsPerBlock, U" columns: the distance is ", blockedDistance, U" instead of ", singleDistance, U".");
+			autoMAT singleProduct = mul_MAT (single -> features.get(), single -> weights.get());
+			autoMAT blockedProduct = mul_MAT (blocked -> features.get(), blocked -> weights.get());
+			const double scale = NUMmax_e (singleProduct.get());
+			blockedProduct.all()  -=  singleProduct.all();
+			const double maximumDifference = std::max (fabs (NUMmin_e (blockedProduct.get())), fabs (NUMmax_e (blockedProduct.get())));
+			Melder_require (maximumDifference <= 1e-9 * scale,
+				U"Blocks of ", numberOfColumnsPerBlock, U" columns: the product differs by ", maximumDifference, U".");
+		}
+		MelderInfo_writeLine (U"test_NMF_blockedUpdates: OK");
+	} catch (MelderError) {
+		Melder_throw (U"NMF blocked updates test failed.");
+	}
+}
+
 /* End of file NMF.cpp */
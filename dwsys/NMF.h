@@ -79,4 +79,6 @@ double NMF_getEuclideanDistance (NMF me, constMATVU const& data); // sqrt (||dat
 
 double NMF_getItakuraSaitoDivergence (NMF me, constMATVU const& data);
 
+void test_NMF_blockedUpdates ();
+
 #endif /* _NMF_h_ */
@@ -64,6 +64,7 @@
 #include "NUMlapack.h"
 #include "NUM2.h"
 #include "NUMmachar.h"
+#include "MelderThread.h"
 #include "melder.h"
 
 #include "gsl_randist.h"
@@ -203,6 +204,93 @@ void MATmtm_weighRows (MATVU const& result, constMATVU const& data, constVECVU c
 	}
 }
 
+void MATdistancesBetweenRows_preallocated (MAT const& result, constMAT const& x, constMAT const& y, double metric) {
+	Melder_assert (result.nrow == x.nrow && result.ncol == y.nrow);
+	Melder_assert (x.ncol == y.ncol);
+	Melder_assert (metric > 0.0);
+	const integer dimension = x.ncol;
+	const bool euclidean = ( metric == 2.0 );
+	autoVEC xSquaredNorms, ySquaredNorms;
+	if (euclidean) {
+		xSquaredNorms = raw_VEC (x.nrow);
+		for (integer irow = 1; irow <= x.nrow; irow ++)
+			xSquaredNorms [irow] = NUMsum2 (x.row (irow));
+		ySquaredNorms = raw_VEC (y.nrow);
+		for (integer irow = 1; irow <= y.nrow; irow ++)
+			ySquaredNorms [irow] = NUMsum2 (y.row (irow));
+	}
+	auto getDistance = [&] (const double *xrow, const double *yrow) {
+		if (metric == 1.0) {
+			double sum = 0.0;
+			for (integer k = 0; k < dimension; k ++)
+				sum += fabs (xrow [k] - yrow [k]);
+			return sum;
+		}
+		if (euclidean) {
+			double sum = 0.0;
+			for (integer k = 0; k < dimension; k ++) {
+				const double d = xrow [k] - yrow [k];
+				sum += d * d;
+			}
+			return sqrt (sum);
+		}
+		/*
+			First divide by the maximum, to prevent overflow when the metric is large.
+		*/
+		double dmax = 0.0, sum = 0.0;
+		for (integer k = 0; k < dimension; k ++)
+			dmax = std::max (dmax, fabs (xrow [k] - yrow [k]));
+		if (dmax == 0.0)
+			return 0.0;
+		const double scale = 1.0 / dmax;
+		for (integer k = 0; k < dimension; k ++)
+			sum += pow (fabs (xrow [k] - yrow [k]) * scale, metric);
+		return dmax * pow (sum, 1.0 / metric);
+	};
+	auto distancesOfRows = [&] (integer fromRow, integer toRow) {
+		if (euclidean) {
+			/*
+				||x - y||² = ||x||² + ||y||² - 2 x.y, where the inner products are already in the result.
+				The rounding error of this difference is some multiple of the machine precision times the sum of the squared norms,
+				so where the squared distance is below 1e-8 of that sum, cancellation would leave fewer than about seven
+				correct digits; there we compute the distance directly.
+			*/
+			for (integer irow = fromRow; irow <= toRow; irow ++) {
+				for (integer icol = 1; icol <= y.nrow; icol ++) {
+					const double sumOfNorms = xSquaredNorms [irow] + ySquaredNorms [icol];
+					const double squaredDistance = sumOfNorms - 2.0 * result [irow] [icol];
+					result [irow] [icol] = ( squaredDistance > 1e-8 * sumOfNorms ? sqrt (squaredDistance) :
+							getDistance (& x [irow] [1], & y [icol] [1]) );
+				}
+			}
+		} else {
+			for (integer irow = fromRow; irow <= toRow; irow ++)
+				for (integer icol = 1; icol <= y.nrow; icol ++)
+					result [irow] [icol] = getDistance (& x [irow] [1], & y [icol] [1]);
+		}
+	};
+	if (dimension == 0) {
+		result  <<=  0.0;
+		return;
+	}
+	if (euclidean)
+		mul_fast_threaded_MAT_out (result, x, y.transpose());   // the inner products
+	/*
+		Threads get contiguous blocks of rows; below a million or so operations threading does not pay.
+	*/
+	const double numberOfOperations = double (x.nrow) * double (y.nrow) * double (dimension);
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), Melder_ifloor (numberOfOperations / 1e6));
+	Melder_clip (1_integer, & numberOfThreads, std::min (x.nrow, 16_integer));
+	const integer numberOfRowsPerThread = (x.nrow - 1) / numberOfThreads + 1;
+	numberOfThreads = (x.nrow - 1) / numberOfRowsPerThread + 1;
+	auto distancesOfThread = [&] (integer ithread) {
+		const integer fromRow = (ithread - 1) * numberOfRowsPerThread + 1;
+		const integer toRow = std::min (ithread * numberOfRowsPerThread, x.nrow);
+		distancesOfRows (fromRow, toRow);
+	};
+	MelderThread_run (numberOfThreads, distancesOfThread);
+}
+
 inline void MATmultiplyRows_inplace (MATVU const& x, constVECVU const& v) {
 	Melder_assert (x.nrow == v.size);
 	for (integer irow = 1; irow <= x.nrow; irow ++)
@@ -249,6 +249,14 @@ autoMAT MATcovarianceFromColumnCentredMatrix (constMATVU const& x, integer ndf);
 
 void MATmtm_weighRows (MATVU const& result, constMATVU const& data, constVECVU const& rowWeights);
 
+void MATdistancesBetweenRows_preallocated (MAT const& result, constMAT const& x, constMAT const& y, double metric);
+/*
+	result [i] [j] := (sum (k, |x [i] [k] - y [j] [k]|^metric))^(1/metric).
+	For metric = 2 the squared distances are computed as ||x [i]||^2 + ||y [j]||^2 - 2 x [i].y [j],
+	with the inner products from a matrix product.
+	Blocks of rows of result are computed in separate threads.
+*/
+
 inline autoMAT newMATmtm_weighRows (constMATVU const& data, constVECVU const& rowWeights) {
 	autoMAT result = raw_MAT (data.ncol, data.ncol);
 	MATmtm_weighRows (result.get(), data, rowWeights);
@@ -1016,6 +1024,65 @@ void VECsmooth_gaussian (VECVU const& out, constVECVU const& in, double sigma, N
 	For a given fftTable we require that fftTable->n >= n.
 */
 
+/********************** gammatone filterbank ******************************************/
+
+struct structNUMgammatoneFilterbank
+{
+	integer numberOfFilters, gamma;
+	double samplingPeriod;
+	integer numberOfSamplesDone;
+	autoINTVEC delay;   // in samples
+	autoVEC poleRe, poleIm, gainRe, gainIm;
+	autoMAT numeratorRe, numeratorIm;   // gamma x numberOfFilters
+	autoMAT stateRe, stateIm;   // gamma x numberOfFilters
+	autoVEC inputRe, inputIm;   // numberOfFilters
+};
+
+typedef struct structNUMgammatoneFilterbank *NUMgammatoneFilterbank;
+
+struct autoNUMgammatoneFilterbank : public structNUMgammatoneFilterbank {
+	autoNUMgammatoneFilterbank () throw () {
+		numberOfFilters = 0;
+	}
+	~autoNUMgammatoneFilterbank () { }
+};
+
+void NUMgammatoneFilterbank_init (NUMgammatoneFilterbank me, integer numberOfFilters, integer gamma, double samplingPeriod);
+/*
+	Allocates a bank of `numberOfFilters` gammatone filters of order `gamma`;
+	the filters still have to be specified with NUMgammatoneFilterbank_setFilter.
+*/
+
+void NUMgammatoneFilterbank_setFilter (NUMgammatoneFilterbank me, integer ifilter,
+	double frequency, double bandwidth, double latency, double amplitude);
+/*
+	Filter `ifilter` gets the impulse response
+		h (t) = amplitude * tau^(gamma-1) * exp (-2 pi bandwidth tau) * cos (2 pi frequency tau),   tau = t - latency > 0
+	sampled at t = (i - 0.5) * samplingPeriod, i = 1, 2, ...
+	This is the same impulse response as that of Sound_createGammaTone,
+	so that filtering gives the same result as Sounds_convolve with such a Sound (scaling "sum"),
+	except that the impulse response is not truncated,
+	and that a frequency above the Nyquist frequency aliases (where Sound_createGammaTone gives zeroes).
+	The filter is implemented recursively, as a cascade of gamma complex one-pole sections
+	(preceded by a complex FIR section of order gamma - 1 that accounts for the polynomial factor
+	and for the half-sample offset), so that the cost per sample is independent of the bandwidth.
+*/
+
+void NUMgammatoneFilterbank_reset (NUMgammatoneFilterbank me);
+
+void NUMgammatoneFilterbank_filter (NUMgammatoneFilterbank me, constVEC const& input, MATVU const& out_block);
+/*
+	Computes the next out_block.ncol output samples of all filters,
+	continuing where the previous call (or the last reset) left off;
+	out_block [ifilter] [i] is output sample (numberOfSamplesDone + i) of filter `ifilter`,
+	where output sample n is the sum over j >= 1 of h [j] * input [n + 1 - j],
+	input samples outside [1, input.size] being zero.
+	Hence the complete input must be supplied in every call, but the output can be computed in blocks
+	of any size, so that the memory needed for the output can be bounded.
+	Precondition: out_block.nrow == my numberOfFilters.
+	The inner loops run over the filters, which the compiler can vectorize.
+*/
+
 integer NUMgetIndexFromProbability (constVEC probs, double p); //TODO HMM zero start matrices
 integer NUMgetIndexFromProbability (double *probs, integer nprobs, double p);
 
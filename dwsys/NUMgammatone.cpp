@@ -0,0 +1,151 @@
+/* NUMgammatone.cpp
+ *
+ * Copyright (C) 2026 the Praat contributors
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NUM2.h"
+
+/*
+	The sampled gammatone impulse response at lag l = j - 1 (sample j at t = (j - 0.5) * dx) is zero for l < l0,
+	where l0 is the first lag with (l0 + 0.5) * dx > latency. For l = l0 + k (k >= 0) we have
+		tau = (k + delta) * dx,   delta = (l0 + 0.5) - latency / dx,   0 < delta <= 1,
+	and
+		h = amplitude * tau^(gamma-1) * exp (-beta tau) * cos (omega tau)
+		  = Re (G * q (k) * p^k),
+	with
+		beta = 2 pi bandwidth, omega = 2 pi frequency,
+		p = exp ((- beta + i omega) * dx)   (the pole),
+		q (k) = (k + delta)^(gamma-1),
+		G = amplitude * dx^(gamma-1) * exp ((- beta + i omega) * delta * dx).
+	Because q is a polynomial of degree gamma-1 in k, the z-transform of q (k) p^k is
+		N (z) / (1 - p z^-1)^gamma,
+	where the numerator N has the gamma coefficients
+		N [k] = p^k * sum (j = 0..k, (-1)^j binomial (gamma, j) q (k - j)),   k = 0..gamma-1
+	(the coefficients for k >= gamma are gamma-th differences of q, which vanish).
+	Filtering a real signal with the complex filter and taking the real part of the result
+	therefore gives exactly the convolution with h.
+	In contrast to the real 8th-order direct form (Slaney 1993), the cascade of complex one-pole sections
+	is numerically stable for all frequencies and bandwidths.
+*/
+
+void NUMgammatoneFilterbank_init (NUMgammatoneFilterbank me, integer numberOfFilters, integer gamma, double samplingPeriod) {
+	Melder_assert (numberOfFilters > 0);
+	Melder_assert (gamma > 0);
+	Melder_assert (samplingPeriod > 0.0);
+	my numberOfFilters = numberOfFilters;
+	my gamma = gamma;
+	my samplingPeriod = samplingPeriod;
+	my delay = zero_INTVEC (numberOfFilters);
+	my poleRe = zero_VEC (numberOfFilters);
+	my poleIm = zero_VEC (numberOfFilters);
+	my gainRe = zero_VEC (numberOfFilters);
+	my gainIm = zero_VEC (numberOfFilters);
+	my numeratorRe = zero_MAT (gamma, numberOfFilters);
+	my numeratorIm = zero_MAT (gamma, numberOfFilters);
+	my stateRe = zero_MAT (gamma, numberOfFilters);
+	my stateIm = zero_MAT (gamma, numberOfFilters);
+	my inputRe = zero_VEC (numberOfFilters);
+	my inputIm = zero_VEC (numberOfFilters);
+	my numberOfSamplesDone = 0;
+}
+
+void NUMgammatoneFilterbank_setFilter (NUMgammatoneFilterbank me, integer ifilter,
+	double frequency, double bandwidth, double latency, double amplitude)
+{
+	Melder_assert (ifilter >= 1 && ifilter <= my numberOfFilters);
+	Melder_assert (bandwidth > 0.0);
+	const double dx = my samplingPeriod;
+	integer firstLag = 0;
+	if (latency > 0.0) {
+		firstLag = Melder_ifloor (latency / dx - 0.5) + 1;
+		while (firstLag > 0 && (firstLag - 0.5) * dx > latency)
+			firstLag --;
+		while ((firstLag + 0.5) * dx <= latency)
+			firstLag ++;
+	}
+	const double delta = (firstLag + 0.5) - latency / dx;
+	const double beta = NUM2pi * bandwidth, omega = NUM2pi * frequency;
+	const dcomplex pole = std::polar (exp (- beta * dx), omega * dx);
+	const dcomplex gain = amplitude * pow (dx, my gamma - 1) * std::polar (exp (- beta * delta * dx), omega * delta * dx);
+	my delay [ifilter] = firstLag;
+	my poleRe [ifilter] = pole.real();
+	my poleIm [ifilter] = pole.imag();
+	my gainRe [ifilter] = gain.real();
+	my gainIm [ifilter] = gain.imag();
+	dcomplex poleToTheK = 1.0;
+	for (integer k = 0; k < my gamma; k ++) {
+		double sum = 0.0, binomial = 1.0;   // binomial (gamma, j)
+		for (integer j = 0; j <= k; j ++) {
+			const double q = pow (k - j + delta, my gamma - 1);
+			sum += ( j % 2 == 0 ? binomial : - binomial ) * q;
+			binomial *= double (my gamma - j) / (j + 1);
+		}
+		const dcomplex numerator = poleToTheK * sum;
+		my numeratorRe [k + 1] [ifilter] = numerator.real();
+		my numeratorIm [k + 1] [ifilter] = numerator.imag();
+		poleToTheK *= pole;
+	}
+	my stateRe.column (ifilter)  <<=  0.0;
+	my stateIm.column (ifilter)  <<=  0.0;
+}
+
+void NUMgammatoneFilterbank_reset (NUMgammatoneFilterbank me) {
+	my stateRe.all()  <<=  0.0;
+	my stateIm.all()  <<=  0.0;
+	my numberOfSamplesDone = 0;
+}
+
+void NUMgammatoneFilterbank_filter (NUMgammatoneFilterbank me, constVEC const& input, MATVU const& out_block) {
+	Melder_assert (out_block.nrow == my numberOfFilters);
+	const integer numberOfFilters = my numberOfFilters;
+	double *const inputRe = & my inputRe [1], *const inputIm = & my inputIm [1];
+	const double *const poleRe = & my poleRe [1], *const poleIm = & my poleIm [1];
+	for (integer i = 1; i <= out_block.ncol; i ++) {
+		const integer isample = my numberOfSamplesDone + i;
+		/*
+			FIR part: the complex numerator applied to the delayed input.
+		*/
+		for (integer ifilter = 0; ifilter < numberOfFilters; ifilter ++)
+			inputRe [ifilter] = inputIm [ifilter] = 0.0;
+		for (integer k = 0; k < my gamma; k ++) {
+			const double *const numeratorRe = & my numeratorRe [k + 1] [1], *const numeratorIm = & my numeratorIm [k + 1] [1];
+			for (integer ifilter = 0; ifilter < numberOfFilters; ifilter ++) {
+				const integer index = isample - my delay [ifilter + 1] - k;
+				if (index >= 1 && index <= input.size) {
+					inputRe [ifilter] += numeratorRe [ifilter] * input [index];
+					inputIm [ifilter] += numeratorIm [ifilter] * input [index];
+				}
+			}
+		}
+		/*
+			IIR part: gamma cascaded complex one-pole sections, s := w + p * s.
+		*/
+		for (integer stage = 1; stage <= my gamma; stage ++) {
+			double *const stateRe = & my stateRe [stage] [1], *const stateIm = & my stateIm [stage] [1];
+			for (integer ifilter = 0; ifilter < numberOfFilters; ifilter ++) {
+				const double re = inputRe [ifilter] + poleRe [ifilter] * stateRe [ifilter] - poleIm [ifilter] * stateIm [ifilter];
+				const double im = inputIm [ifilter] + poleRe [ifilter] * stateIm [ifilter] + poleIm [ifilter] * stateRe [ifilter];
+				stateRe [ifilter] = inputRe [ifilter] = re;
+				stateIm [ifilter] = inputIm [ifilter] = im;
+			}
+		}
+		for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++)
+			out_block [ifilter] [i] = my gainRe [ifilter] * inputRe [ifilter - 1] - my gainIm [ifilter] * inputIm [ifilter - 1];
+	}
+	my numberOfSamplesDone += out_block.ncol;
+}
+
+/* End of file NUMgammatone.cpp */
@@ -25,6 +25,7 @@
  */
 
 #include "CCs_to_DTW.h"
+#include "NUM2.h"
 
 static void regression (const VEC r, const CC me, const integer frameNumber, const integer numberOfCoefficients) {
 
@@ -62,6 +63,46 @@ static void regression (const VEC r, const CC me, const integer frameNumber, con
 	}
 }
 
+/*
+	The frames as rows of weighted features, such that the Euclidean distance between two rows is
+	the distance between the corresponding frames.
+	Frames for which the regression window does not fit get the regression coefficients of the nearest frame for which it does.
+*/
+static autoMAT CC_to_MAT_weightedFeatures (const CC me, const double coefficientWeight, const double logEnergyWeight,
+	const double coefficientRegressionWeight, const double logEnergyRegressionWeight, const integer numberOfRegressionCoefficients)
+{
+	const integer numberOfCoefficients = my maximumNumberOfCoefficients;
+	const double sumOfWeights = coefficientWeight + logEnergyWeight + coefficientRegressionWeight + logEnergyRegressionWeight;
+	const bool wantRegression = ( coefficientRegressionWeight != 0.0 || logEnergyRegressionWeight != 0.0 );
+	const double coefficientFactor = sqrt (coefficientWeight / sumOfWeights);
+	const double logEnergyFactor = sqrt (logEnergyWeight / sumOfWeights);
+	const double coefficientRegressionFactor = sqrt (coefficientRegressionWeight / sumOfWeights);
+	const double logEnergyRegressionFactor = sqrt (logEnergyRegressionWeight / sumOfWeights);
+	/*
+		Columns: c [1..n], c0, regression of c [1..n], regression of c0.
+	*/
+	autoMAT features = zero_MAT (my nx, 2 * numberOfCoefficients + 2);
+	autoVEC r = zero_VEC (numberOfCoefficients + 1);
+	const integer halfWindow = numberOfRegressionCoefficients / 2;
+	const integer firstRegressionFrame = halfWindow + 1, lastRegressionFrame = my nx - halfWindow - 1;
+	for (integer iframe = 1; iframe <= my nx; iframe ++) {
+		const CC_Frame frame = & my frame [iframe];
+		const VEC row = features.row (iframe);
+		for (integer k = 1; k <= frame -> numberOfCoefficients; k ++)
+			row [k] = coefficientFactor * frame -> c [k];
+		row [numberOfCoefficients + 1] = logEnergyFactor * frame -> c0;
+		if (wantRegression && firstRegressionFrame <= lastRegressionFrame) {
+			const integer regressionFrame = Melder_clipped (firstRegressionFrame, iframe, lastRegressionFrame);
+			if (regressionFrame == iframe || iframe == 1)
+				regression (r.get(), me, regressionFrame, numberOfRegressionCoefficients);
+			for (integer k = 1; k <= numberOfCoefficients; k ++)
+				row [numberOfCoefficients + 1 + k] = coefficientRegressionFactor * r [k + 1];
+			row [2 * numberOfCoefficients + 2] = logEnergyRegressionFactor * r [1];
+		}
+	}
+	return features;
+}
+
 autoDTW CCs_to_DTW (const CC me, const CC thee,
 	const double coefficientWeight, const double logEnergyWeight,
 	const double coefficientRegressionWeight, const double logEnergyRegressionWeight,
@@ -79,69 +120,16 @@ autoDTW CCs_to_DTW (const CC me, const CC thee,
 			numberOfCoefficients ++;
 
 		Melder_assert (numberOfCoefficients > 1 || (coefficientRegressionWeight == 0.0 && logEnergyRegressionWeight == 0.0));
-//TRACE
-trace(1, U" regression window length ", regressionWindowLength, U" dx ", my dx, U" #coeff ", numberOfCoefficients);
 		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
-trace(2);
-		autoVEC ri = raw_VEC (my maximumNumberOfCoefficients + 1);
-trace(3);
-		autoVEC rj = raw_VEC (my maximumNumberOfCoefficients + 1);
-trace(4);
 
 		/*
-			Calculate distance matrix.
+			Calculate distance matrix (prototype along y-direction).
 		*/
-		autoMelderProgress progress (U"CCs_to_DTW");
-		for (integer iframe = 1; iframe <= my nx; iframe ++) {
-			trace (U"iframe ", iframe, U"/", my nx);
-			const CC_Frame fi = & my frame [iframe];
-trace(5);
-			if (coefficientRegressionWeight != 0.0 || logEnergyRegressionWeight != 0.0)
-				regression (ri.get(), me, iframe, numberOfCoefficients);
-
-trace(6);
-			for (integer jframe = 1; jframe <= thy nx; jframe ++) {
-				//trace (U"jframe ", jframe, U"/", thy nx);
-				const CC_Frame fj = & thy frame [jframe];
-				longdouble dist = 0.0;
-
-				if (coefficientWeight != 0.0) {
-					for (integer k = 1; k <= fj -> numberOfCoefficients; k ++) {
-						const double d = fi -> c [k] - fj -> c [k];
-						dist += d * d;
-					}
-					dist *= coefficientWeight;
-				}
-
-				if (logEnergyWeight != 0.0) {
-					const double d = fi -> c0 - fj -> c0;
-					dist += logEnergyWeight * d * d;
-				}
-
-				if (coefficientRegressionWeight != 0.0) {
-					longdouble distr = 0.0;
-					regression (rj.get(), thee, jframe, numberOfCoefficients);
-					for (integer k = 2; k <= fj -> numberOfCoefficients + 1; k ++) {
-						const double d = ri [k] - rj [k];
-						distr += d * d;
-					}
-					dist += coefficientRegressionWeight * distr;
-				}
-
-				if (logEnergyRegressionWeight != 0.0) {
-					if (coefficientRegressionWeight == 0.0)
-						regression (rj.get(), thee, jframe, numberOfCoefficients);
-					const double d = ri [1] - rj [1];
-					dist += logEnergyRegressionWeight * d * d;
-				}
-
-				dist /= coefficientWeight + logEnergyWeight + coefficientRegressionWeight + logEnergyRegressionWeight;
-				his z [iframe] [jframe] = sqrt ((double) dist);   // prototype along y-direction
-			}
-
-			if (iframe % 10 == 1)
-				Melder_progress (0.999 * iframe / my nx, U"Calculate distances: frame ", iframe, U" from ", my nx, U".");
-		}
+		autoMAT myFeatures = CC_to_MAT_weightedFeatures (me, coefficientWeight, logEnergyWeight,
+				coefficientRegressionWeight, logEnergyRegressionWeight, numberOfCoefficients);
+		autoMAT thyFeatures = CC_to_MAT_weightedFeatures (thee, coefficientWeight, logEnergyWeight,
+				coefficientRegressionWeight, logEnergyRegressionWeight, numberOfCoefficients);
+		MATdistancesBetweenRows_preallocated (his z.get(), myFeatures.get(), thyFeatures.get(), 2.0);
 		return him;
 	} catch (MelderError) {
 		Melder_throw (U"DTW not created from CCs.");
@@ -41,6 +41,8 @@
 #include "Sound_extensions.h"
 #include "NUM2.h"
 #include "NUMmachar.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #include "oo_DESTROY.h"
 #include "DTW_def.h"
@@ -173,119 +175,129 @@ void DTW_Path_Query_init (DTW_Path_Query me, integer ny, integer nx) {
 	my yfromx = Thing_new (RealTier);
 }
 
+/*
+	Recode the path from a chain of cells to the vertices (xwarp [i], ywarp [i]) of a piecewise linear path.
+	Returns the number of vertices; xwarp and ywarp should have at least nx + ny + 2 elements.
+*/
+static integer DTW_Path_getPiecewiseLinearWarp (constvector <structDTW_Path> const& path,
+	double xmin, double xmax, double dx, double x1, double ymin, double ymax, double dy, double y1,
+	VEC const& xwarp, VEC const& ywarp)
+{
+	integer nxy;		// current number of elements in recoded path
+	integer nsc_x = 1;	// current number of successive horizontal cells in the cells chain
+	integer nsc_y = 1;	// current number of successive vertical cells in the cells chain
+	integer nd = 0;	// current number of successive diagonal cells in the cells chain
+	bool yDirection = false;	// previous segment in the original path was vertical
+	bool xDirection = false;	// previous segment in the original path was horizontal
+	integer ixp = 0, iyp = 0; // previous cell
+
+	// 1. Starting point always at origin
+	
+	xwarp [1] = xmin;
+	ywarp [1] = ymin;
+	
+	// 2. next point lower left of first cell
+	
+	nsc_x = path [1]. x;
+	ixp = nsc_x - 1;
+	xwarp [2] = x1 + (nsc_x - 1 - 0.5) * dx;
+	nsc_y = path [1]. y;
+	iyp = nsc_y - 1;
+	ywarp [2] = y1 + (nsc_y - 1 - 0.5) * dy;
+	
+	// 3. follow all cells. implicit: x1 - 0.5 * dx > xmin && y1 - 0.5 * dy > ymin */
+	
+	nxy = 2;
+	for (integer j = 1; j <= path.size; j ++) {
+		const integer ix = path [j]. x, iy = path [j]. y;
+		const double xright = x1 + (ix - 1 + 0.5) * dx;
+		const double ytop = y1 + (iy - 1 + 0.5) * dy;
+		double x, y, f;
+		integer index; // where are we in the new path?
+
+		if (iy == iyp) { // horizontal path?
+			xDirection = true;
+			if (yDirection) {
+				// We came from a vertical direction so this is the second horizontal cell in a row.
+				// The statement after this "if" updates nsc_x to 2.
+				nsc_x = 1;
+				yDirection = false;
+			}
+			nsc_x ++;
+
+			if (nsc_y > 1 || nd > 1) {
+				// Previous segment was diagonal or vertical: modify intersection
+				// The vh intersection (x,y) = (nsc_x*dx, dy) * (nsc_y-1)/(nsc_x*nsc_y-1)
+				// A diagonal segment has nsc_y = 1.
+				f = (nsc_y - 1.0) / (nsc_x * nsc_y - 1);
+				x = xright - nsc_x * dx + nsc_x * dx * f;
+				y = ytop - dy + dy * f;
+				index = nxy - 1;
+				if (nsc_x == 2)
+					index = nxy ++;
+
+				xwarp [index] = x;
+				ywarp [index] = y;
+			}
+			nd = 0;
+		} else if (ix == ixp) { // vertical
+			yDirection = true;
+			if (xDirection) {
+				nsc_y = 1;
+				xDirection = false;
+			}
+			nsc_y ++;
+
+			if (nsc_x > 1 || nd > 1) {
+				// The hv intersection (x,y) = (dx, dy*nsc_y ) * (nsc_x-1)/(nsc_x*nsc_y-1)
+				f = (nsc_x - 1.0) / (nsc_x * nsc_y - 1);
+				x = xright - dx + dx * f;
+				y = ytop - nsc_y * dy + nsc_y * dy * f;
+				index = nxy - 1;
+				if (nsc_y == 2)
+					index = nxy ++;
+				xwarp [index] = x;
+				ywarp [index] = y;
+			}
+			nd = 0;
+		} else if (ix == ixp + 1 && iy == iyp + 1) {   // diagonal
+			nd ++;
+			if (nd == 1)
+				nxy ++;
+			nsc_x = nsc_y = 1;
+		} else {
+			Melder_throw (U"The path goes back in time.");
+		}
+		// update
+		xwarp [nxy] = xright;
+		ywarp [nxy] = ytop;
+		ixp = ix;
+		iyp = iy;
+	}
+
+	if (xmax > xwarp [nxy] || ymax > ywarp [nxy]) {
+		xwarp [++ nxy] = xmax;
+		ywarp [nxy] = ymax;
+	}
+	return nxy;
+}
+
 /* Recode the path from a chain of cells to a piecewise linear path. */
 void DTW_Path_recode (DTW me) {
 	try {
 		DTW_Path_Query thee = & my pathQuery;
-		integer nxy;		// current number of elements in recoded path
-		integer nsc_x = 1;	// current number of successive horizontal cells in the cells chain
-		integer nsc_y = 1;	// current number of successive vertical cells in the cells chain
-		integer nd = 0;	// current number of successive diagonal cells in the cells chain
-		bool yDirection = false;	// previous segment in the original path was vertical
-		bool xDirection = false;	// previous segment in the original path was horizontal
-		integer ixp = 0, iyp = 0; // previous cell
-		struct structPoint {
-			double x,y;
-		};
-
-		// 1. Starting point always at origin
-		
 		const integer nxymax = thy nx + thy ny + 2;
-		autovector <structPoint> xytimes = newvectorzero <structPoint> (nxymax);
-		xytimes [1]. x = my xmin;
-		xytimes [1]. y = my ymin;
-		
-		// 2. next point lower left of first cell
-		
-		nsc_x = my path [1]. x;
-		ixp = nsc_x - 1;
-		xytimes [2]. x = my x1 + (nsc_x - 1 - 0.5) * my dx;
-		nsc_y = my path [1]. y;
-		iyp = nsc_y - 1;
-		xytimes [2]. y = my y1 + (nsc_y - 1 - 0.5) * my dy;
-		
-		// 3. follow all cells. implicit: my x1 - 0.5 * my dx > my xmin && my y1 - 0.5 * my dy > my ymin */
-		
-		nxy = 2;
-		for (integer j = 1; j <= my pathLength; j ++) {
-			const integer ix = my path [j]. x, iy = my path [j]. y;
-			const double xright = my x1 + (ix - 1 + 0.5) * my dx;
-			const double ytop = my y1 + (iy - 1 + 0.5) * my dy;
-			double x, y, f;
-			integer index; // where are we in the new path?
-
-			if (iy == iyp) { // horizontal path?
-				xDirection = true;
-				if (yDirection) {
-					// We came from a vertical direction so this is the second horizontal cell in a row.
-					// The statement after this "if" updates nsc_x to 2.
-					nsc_x = 1;
-					yDirection = false;
-				}
-				nsc_x ++;
-
-				if (nsc_y > 1 || nd > 1) {
-					// Previous segment was diagonal or vertical: modify intersection
-					// The vh intersection (x,y) = (nsc_x*dx, dy) * (nsc_y-1)/(nsc_x*nsc_y-1)
-					// A diagonal segment has nsc_y = 1.
-					f = (nsc_y - 1.0) / (nsc_x * nsc_y - 1);
-					x = xright - nsc_x * my dx + nsc_x * my dx * f;
-					y = ytop - my dy + my dy * f;
-					index = nxy - 1;
-					if (nsc_x == 2)
-						index = nxy ++;
-
-					xytimes [index]. x = x;
-					xytimes [index]. y = y;
-				}
-				nd = 0;
-			} else if (ix == ixp) { // vertical
-				yDirection = true;
-				if (xDirection) {
-					nsc_y = 1;
-					xDirection = false;
-				}
-				nsc_y ++;
-
-				if (nsc_x > 1 || nd > 1) {
-					// The hv intersection (x,y) = (dx, dy*nsc_y ) * (nsc_x-1)/(nsc_x*nsc_y-1)
-					f = (nsc_x - 1.0) / (nsc_x * nsc_y - 1);
-					x = xright - my dx + my dx * f;
-					y = ytop - nsc_y * my dy + nsc_y * my dy * f;
-					index = nxy - 1;
-					if (nsc_y == 2)
-						index = nxy ++;
-					xytimes [index]. x = x;
-					xytimes [index]. y = y;
-				}
-				nd = 0;
-			} else if (ix == ixp + 1 && iy == iyp + 1) {   // diagonal
-				nd ++;
-				if (nd == 1)
-					nxy ++;
-				nsc_x = nsc_y = 1;
-			} else {
-				Melder_throw (U"The path goes back in time.");
-			}
-			// update
-			xytimes [nxy]. x = xright;
-			xytimes [nxy]. y = ytop;
-			ixp = ix;
-			iyp = iy;
-		}
-
-		if (my xmax > xytimes [nxy].x || my ymax > xytimes [nxy].y) {
-			xytimes [++ nxy]. x = my xmax;
-			xytimes [nxy]. y = my ymax;
-		}
+		autoVEC xwarp = zero_VEC (nxymax), ywarp = zero_VEC (nxymax);
+		const integer nxy = DTW_Path_getPiecewiseLinearWarp (my path.part (1, my pathLength), my xmin, my xmax, my dx, my x1,
+				my ymin, my ymax, my dy, my y1, xwarp.get(), ywarp.get());
 		Melder_assert (nxy <= 2 * std::max (my ny, my nx) + 2);
 		
 		thy nxy = nxy;
 		thy yfromx = RealTier_create (my xmin, my xmax);
 		thy xfromy = RealTier_create (my ymin, my ymax);
 		for (integer i = 1; i <= nxy; i ++) {
-			RealTier_addPoint (thy yfromx.get(), xytimes [i]. x, xytimes [i]. y);
-			RealTier_addPoint (thy xfromy.get(), xytimes [i]. y, xytimes [i]. x);
+			RealTier_addPoint (thy yfromx.get(), xwarp [i], ywarp [i]);
+			RealTier_addPoint (thy xfromy.get(), ywarp [i], xwarp [i]);
 		}
 	} catch (MelderError) {
 		Melder_throw (me, U": not recoded.");
@@ -791,35 +803,16 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 	try {
 		Melder_require (thy ny == my ny,
 			U"Column sizes should be equal.");
+		Melder_require (metric > 0.0,
+			U"The distance metric should be positive.");
 
 		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
-		autoMelderProgress progess (U"Calculate distances");
-		for (integer i = 1; i <= my nx; i ++) {
-			for (integer j = 1; j <= thy nx; j ++) {
-				/*
-					First divide distance by maximum to prevent overflow when metric
-					is a large number.
-					d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
-				*/
-				double dmax = 0.0, d = 0.0;
-				for (integer k = 1; k <= my ny; k ++) {
-					const double dtmp = fabs (my z [k] [i] - thy z [k] [j]);
-					if (dtmp > dmax)
-						dmax = dtmp;
-				}
-				if (dmax > 0) {
-					for (integer k = 1; k <= my ny; k ++) {
-						const double dtmp = fabs (my z [k] [i] - thy z [k] [j]) / dmax;
-						d +=  pow (dtmp, metric);
-					}
-				}
-				d = dmax * pow (d, 1.0 / metric);
-				his z [i] [j] = d / my ny; // == d * dy / ymax
-			}
-			if ((i % 10) == 1) {
-				Melder_progress (0.999 * i / my nx, U"Calculate distances: column ", i, U" from ", my nx, U".");
-			}
-		}
+		/*
+			The frames are the columns; as rows they are contiguous.
+		*/
+		autoMAT myFrames = transpose_MAT (my z.get()), thyFrames = transpose_MAT (thy z.get());
+		MATdistancesBetweenRows_preallocated (his z.get(), myFrames.get(), thyFrames.get(), metric);
+		his z.all()  *=  1.0 / my ny;   // == d * dy / ymax
 		DTW_findPath (him.get(), matchStart, matchEnd, slope);
 		return him;
 	} catch (MelderError) {
@@ -955,8 +948,37 @@ autoDTW Pitches_to_DTW (Pitch me, Pitch thee, double vuv_costs, double time_weig
 	}
 }
 
-autoDurationTier DTW_to_DurationTier (DTW /* me */) {
-	return autoDurationTier();
+/*
+	The relative duration along each segment of the piecewise linear warp is its slope dy/dx.
+	Two points per segment keep the tier piecewise constant; vertical segments cannot be represented and are skipped.
+*/
+static autoDurationTier DurationTier_createFromWarp (double xmin, double xmax, constVEC const& xwarp, constVEC const& ywarp) {
+	autoDurationTier me = DurationTier_create (xmin, xmax);
+	for (integer i = 1; i < xwarp.size; i ++) {
+		const double segmentDuration = xwarp [i + 1] - xwarp [i];
+		if (segmentDuration <= 0.0)
+			continue;
+		const double relativeDuration = (ywarp [i + 1] - ywarp [i]) / segmentDuration;
+		const double margin = 0.001 * segmentDuration;
+		RealTier_addPoint (me.get(), xwarp [i] + margin, relativeDuration);
+		RealTier_addPoint (me.get(), xwarp [i + 1] - margin, relativeDuration);
+	}
+	return me;
+}
+
+autoDurationTier DTW_to_DurationTier (DTW me) {
+	try {
+		Melder_require (my pathLength > 0,
+			U"There is no path.");
+		const integer nxymax = my nx + my ny + 2;
+		autoVEC xwarp = zero_VEC (nxymax), ywarp = zero_VEC (nxymax);
+		const integer nxy = DTW_Path_getPiecewiseLinearWarp (my path.part (1, my pathLength), my xmin, my xmax, my dx, my x1,
+				my ymin, my ymax, my dy, my y1, xwarp.get(), ywarp.get());
+		autoDurationTier thee = DurationTier_createFromWarp (my xmin, my xmax, xwarp.part (1, nxy), ywarp.part (1, nxy));
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": no DurationTier created.");
+	}
 }
 
 void DTW_Matrix_replace (DTW me, Matrix thee) {
@@ -1217,214 +1239,232 @@ void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, a
     }
 }
 
-void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
-	try {
-		const double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
-		// if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
-		integer delta_xy = std::min (my nx, my ny) / 10; // if localSlope == 1 start within 10% of
-
-		Melder_require (localSlope > 0 && localSlope < 5,
-			U"Local slope parameter ", localSlope, U" not supported.");
-
-		autoMAT delta = copy_MAT (my z.get());
-		autoINTMAT psi = zero_INTMAT (my ny, my nx);
-		/*
-			Start by making the outside unreachable.
-		*/
+/*
+	The path search of DTW_Polygon_findPathInside, in the memory provided by the caller:
+	delta (cumulative distances) and psi (directions) are ny x nx.
+	Does not allocate, and does not report progress unless showProgress is true, so that it can run in a separate thread;
+	the path still has to be recoded.
+*/
+static void DTW_Polygon_findPathInside_preallocated (DTW me, Polygon thee, int localSlope, MAT const& delta, INTMAT const& psi, bool showProgress) {
+	const double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+	// if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
+	integer delta_xy = std::min (my nx, my ny) / 10; // if localSlope == 1 start within 10% of
+
+	Melder_assert (localSlope > 0 && localSlope < 5);
+	Melder_assert (delta.nrow == my ny && delta.ncol == my nx && psi.nrow == my ny && psi.ncol == my nx);
+	delta  <<=  my z.get();
+	for (integer i = 1; i <= my ny; i ++)
 		for (integer j = 1; j <= my nx; j ++)
-			psi [1] [j] = DTW_UNREACHABLE;
-		for (integer i = 1; i <= my ny; i ++)
-			psi [i] [1] = DTW_UNREACHABLE;
+			psi [i] [j] = 0;
+	/*
+		Start by making the outside unreachable.
+	*/
+	for (integer j = 1; j <= my nx; j ++)
+		psi [1] [j] = DTW_UNREACHABLE;
+	for (integer i = 1; i <= my ny; i ++)
+		psi [i] [1] = DTW_UNREACHABLE;
 
-		/*
-			Make begin part of first column reachable.
-		*/
-		const integer rowto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
-		for (integer iy = 2; iy <= rowto; iy ++) {
-			if (localSlope != 1) {
-				delta [iy] [1] = delta [iy - 1] [1] + my z [iy] [1];
-				psi [iy] [1] = DTW_Y;
-			} else {
-				psi [iy] [1] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
-			}
+	/*
+		Make begin part of first column reachable.
+	*/
+	const integer rowto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
+	for (integer iy = 2; iy <= rowto; iy ++) {
+		if (localSlope != 1) {
+			delta [iy] [1] = delta [iy - 1] [1] + my z [iy] [1];
+			psi [iy] [1] = DTW_Y;
+		} else {
+			psi [iy] [1] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
 		}
-		/*
-			Make begin part of first row reachable.
-		*/
-		const integer colto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
-		for (integer ix = 2; ix <= colto; ix ++) {
-			if (localSlope != 1) {
-				delta [1] [ix] = delta [1] [ix -1] + my z [1] [ix];
-				psi [1] [ix] = DTW_X;
-			} else {
-				psi [1] [ix] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
-			}
+	}
+	/*
+		Make begin part of first row reachable.
+	*/
+	const integer colto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
+	for (integer ix = 2; ix <= colto; ix ++) {
+		if (localSlope != 1) {
+			delta [1] [ix] = delta [1] [ix -1] + my z [1] [ix];
+			psi [1] [ix] = DTW_X;
+		} else {
+			psi [1] [ix] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
 		}
+	}
 
-		/*
-			Now we can set the unreachable parts from the Polygon.
-		*/
-		DTW_Polygon_setUnreachableParts (me, thee, psi.get());
+	/*
+		Now we can set the unreachable parts from the Polygon.
+	*/
+	DTW_Polygon_setUnreachableParts (me, thee, psi);
 
-		/*
-			Forward pass.
-		*/
-		integer numberOfIsolatedPoints = 0;
-		autoMelderProgress progress (U"Find path");
-		for (integer j = 2; j <= my nx; j ++) {
-			for (integer i = 2; i <= my ny; i ++) {
-				if (! DTW_ISREACHABLE (i, j))
-					continue;
-				double g, gmin = DTW_BIG;
-				integer direction = 0;
-				if (DTW_ISREACHABLE (i - 1, j - 1)) {
-					gmin = delta [i - 1] [j - 1] + 2.0 * my z [i] [j];
-					direction = DTW_XANDY;
-				} else if (DTW_ISREACHABLE (i, j - 1)) {
-					gmin = delta [i] [j - 1] + my z [i] [j];
+	/*
+		Forward pass.
+	*/
+	integer numberOfIsolatedPoints = 0;
+	for (integer j = 2; j <= my nx; j ++) {
+		for (integer i = 2; i <= my ny; i ++) {
+			if (! DTW_ISREACHABLE (i, j))
+				continue;
+			double g, gmin = DTW_BIG;
+			integer direction = 0;
+			if (DTW_ISREACHABLE (i - 1, j - 1)) {
+				gmin = delta [i - 1] [j - 1] + 2.0 * my z [i] [j];
+				direction = DTW_XANDY;
+			} else if (DTW_ISREACHABLE (i, j - 1)) {
+				gmin = delta [i] [j - 1] + my z [i] [j];
+				direction = DTW_X;
+			} else if (DTW_ISREACHABLE (i - 1, j)) {
+				gmin = delta [i - 1] [j] + my z [i] [j];
+				direction = DTW_Y;
+			} else {
+				numberOfIsolatedPoints ++;
+				continue;
+			}
+
+			switch (localSlope) {
+			case 1:  {   // no restriction
+				if (DTW_ISREACHABLE (i, j - 1) && ((g = delta [i] [j - 1] + my z [i] [j]) < gmin)) {
+					gmin = g;
 					direction = DTW_X;
-				} else if (DTW_ISREACHABLE (i - 1, j)) {
-					gmin = delta [i - 1] [j] + my z [i] [j];
+				}
+				if (DTW_ISREACHABLE (i - 1, j) && ((g = delta [i - 1] [j] + my z [i] [j]) < gmin)) {
+					gmin = g;
 					direction = DTW_Y;
-				} else {
-					numberOfIsolatedPoints ++;
-					continue;
 				}
-
-				switch (localSlope) {
-				case 1:  {   // no restriction
-					if (DTW_ISREACHABLE (i, j - 1) && ((g = delta [i] [j - 1] + my z [i] [j]) < gmin)) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (DTW_ISREACHABLE (i - 1, j) && ((g = delta [i - 1] [j] + my z [i] [j]) < gmin)) {
-						gmin = g;
-						direction = DTW_Y;
-					}
+			}
+			break;
+
+			/*
+				Sakoe & Chiba (1978) define the slope constraint measure as P = n / m, 
+					where n is the number of steps in the diagonal and 
+					m the number of steps in one of the other directions.
+					
+				P = 1/2
+			*/
+			case 2: {   // P = 1/2
+				if (j >= 4 && DTW_ISREACHABLE (i - 1, j - 3) && psi [i] [j - 1] == DTW_X && psi [i] [j - 2] == DTW_XANDY &&
+					(g = delta [i-1] [j-3] + 2.0 * my z [i] [j-2] + my z [i] [j-1] + my z [i] [j]) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
+					(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
-
-				/*
-					Sakoe & Chiba (1978) define the slope constraint measure as P = n / m, 
-						where n is the number of steps in the diagonal and 
-						m the number of steps in one of the other directions.
-						
-					P = 1/2
-				*/
-				case 2: {   // P = 1/2
-					if (j >= 4 && DTW_ISREACHABLE (i - 1, j - 3) && psi [i] [j - 1] == DTW_X && psi [i] [j - 2] == DTW_XANDY &&
-						(g = delta [i-1] [j-3] + 2.0 * my z [i] [j-2] + my z [i] [j-1] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-						(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-						(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_Y;
-					}
-					if (i >= 4 && DTW_ISREACHABLE (i - 3, j - 1) && psi [i - 1] [j] == DTW_Y && psi [i - 2] [j] == DTW_XANDY &&
-						(g = delta [i-3] [j-1] + 2.0 * my z [i-2] [j] + my z [i-1] [j] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_Y;
-					}
+				if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
+					(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
 				}
-				break;
-
-				// P = 1
-
-				case 3: {
-					if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-							(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-							(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_Y;
-					}
+				if (i >= 4 && DTW_ISREACHABLE (i - 3, j - 1) && psi [i - 1] [j] == DTW_Y && psi [i - 2] [j] == DTW_XANDY &&
+					(g = delta [i-3] [j-1] + 2.0 * my z [i-2] [j] + my z [i-1] [j] + my z [i] [j]) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
 				}
-				break;
+			}
+			break;
+
+			// P = 1
+
+			case 3: {
+				if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
+						(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin)
+				{
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
+						(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin)
+				{
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
 
                 // P = 2
 
-				case 4: {
-					if (i >= 3 && j >= 4 && DTW_ISREACHABLE (i - 2, j - 3) && psi [i] [j - 1] == DTW_XANDY && psi [i - 1] [j - 2] == DTW_XANDY &&
-							(g = delta [i-2] [j-3] + 2.0 * my z [i-1] [j-2] + 2.0 * my z [i] [j-1] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 4 && j >= 3 && DTW_ISREACHABLE (i - 3, j - 2) && psi [i - 1] [j] == DTW_XANDY && psi [i - 2] [j - 1] == DTW_XANDY &&
-							(g = delta [i-3] [j-2] + 2.0 * my z [i-2] [j-1] + 2.0 * my z [i-1] [j] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_Y;
-					}
+			case 4: {
+				if (i >= 3 && j >= 4 && DTW_ISREACHABLE (i - 2, j - 3) && psi [i] [j - 1] == DTW_XANDY && psi [i - 1] [j - 2] == DTW_XANDY &&
+						(g = delta [i-2] [j-3] + 2.0 * my z [i-1] [j-2] + 2.0 * my z [i] [j-1] + my z [i] [j]) < gmin)
+				{
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
-				default:
-				break;
+				if (i >= 4 && j >= 3 && DTW_ISREACHABLE (i - 3, j - 2) && psi [i - 1] [j] == DTW_XANDY && psi [i - 2] [j - 1] == DTW_XANDY &&
+						(g = delta [i-3] [j-2] + 2.0 * my z [i-2] [j-1] + 2.0 * my z [i-1] [j] + my z [i] [j]) < gmin)
+				{
+					gmin = g;
+					direction = DTW_Y;
 				}
-				Melder_assert (direction != 0);
-				psi [i] [j] = direction;
-				delta [i] [j] = gmin;
 			}
-			if (j % 10 == 2)
-				Melder_progress (0.999 * j / my nx, U"Calculate time warp: frame ", j, U" from ", my nx, U".");
+			break;
+			default:
+			break;
+			}
+			Melder_assert (direction != 0);
+			psi [i] [j] = direction;
+			delta [i] [j] = gmin;
 		}
+		if (showProgress && j % 10 == 2)
+			Melder_progress (0.999 * j / my nx, U"Calculate time warp: frame ", j, U" from ", my nx, U".");
+	}
 
-		/*
-			Find minimum at end of path and trace back.
-		*/
-		integer iy = my ny;
-		double minimum = delta [iy] [my nx];
-		for (integer i = my ny - 1; i > 0; i --) {
-			if (! DTW_ISREACHABLE (i, my nx)) {
-				break;   // we're in unreachable places
-			} else if (delta [i] [my nx] < minimum) {
-				minimum = delta [iy = i] [my nx];
-			}
+	/*
+		Find minimum at end of path and trace back.
+	*/
+	integer iy = my ny;
+	double minimum = delta [iy] [my nx];
+	for (integer i = my ny - 1; i > 0; i --) {
+		if (! DTW_ISREACHABLE (i, my nx)) {
+			break;   // we're in unreachable places
+		} else if (delta [i] [my nx] < minimum) {
+			minimum = delta [iy = i] [my nx];
 		}
+	}
 
-		integer pathIndex = my nx + my ny - 1;   // maximum path length
-		my weightedDistance = minimum / (my nx + my ny);
-		my path [pathIndex]. y = iy;
-		integer ix = my path [pathIndex]. x = my nx;
+	integer pathIndex = my nx + my ny - 1;   // maximum path length
+	my weightedDistance = minimum / (my nx + my ny);
+	my path [pathIndex]. y = iy;
+	integer ix = my path [pathIndex]. x = my nx;
 
-		/*
-			Fill path backwards.
-		*/
-		while (ix > 1) {
-			if (psi [iy] [ix] == DTW_XANDY) {
-				ix --;
-				iy --;
-			} else if (psi [iy] [ix] == DTW_X) {
-				ix --;
-			} else if (psi [iy] [ix] == DTW_Y) {
-				iy --;
-			} else if (psi [iy] [ix] == DTW_START) {
-				break;
-			}
-			if (pathIndex < 2 || iy < 1)
-				break;
-			//Melder_assert (pathIndex > 1 && iy > 0);
-			my path [-- pathIndex]. x = ix;
-			my path [pathIndex]. y = iy;
+	/*
+		Fill path backwards.
+	*/
+	while (ix > 1) {
+		if (psi [iy] [ix] == DTW_XANDY) {
+			ix --;
+			iy --;
+		} else if (psi [iy] [ix] == DTW_X) {
+			ix --;
+		} else if (psi [iy] [ix] == DTW_Y) {
+			iy --;
+		} else if (psi [iy] [ix] == DTW_START) {
+			break;
 		}
+		if (pathIndex < 2 || iy < 1)
+			break;
+		//Melder_assert (pathIndex > 1 && iy > 0);
+		my path [-- pathIndex]. x = ix;
+		my path [pathIndex]. y = iy;
+	}
 
-		my pathLength = my nx + my ny - 1 - pathIndex + 1;
-		if (pathIndex > 1)
-			for (integer j = 1; j <= my pathLength; j ++)
-				my path [j] = my path [pathIndex ++];
-		my path.resize (my pathLength);   // maintain invariant
+	my pathLength = my nx + my ny - 1 - pathIndex + 1;
+	if (pathIndex > 1)
+		for (integer j = 1; j <= my pathLength; j ++)
+			my path [j] = my path [pathIndex ++];
+	my path.resize (my pathLength);   // maintain invariant
+}
+
+void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
+	try {
+		Melder_require (localSlope > 0 && localSlope < 5,
+			U"Local slope parameter ", localSlope, U" not supported.");
+		autoMAT delta = raw_MAT (my ny, my nx);
+		autoINTMAT psi = raw_INTMAT (my ny, my nx);
+		my path.resize (my nx + my ny - 1);
+		{// scope
+			autoMelderProgress progress (U"Find path");
+			DTW_Polygon_findPathInside_preallocated (me, thee, localSlope, delta.get(), psi.get(), true);
+		}
 		DTW_Path_recode (me);
 		if (cumulativeDists) {
 			autoMatrix him = Matrix_create (my xmin, my xmax, my nx, my dx, my x1,
@@ -1437,4 +1477,338 @@ void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatri
 	}
 }
 
+void DTWList_findPath_bandAndSlope (DTWList me, double sakoeChibaBand, int localSlope) {
+	try {
+		Melder_require (localSlope > 0 && localSlope < 5,
+			U"Local slope parameter ", localSlope, U" not supported.");
+		if (my size == 0)
+			return;
+		/*
+			Everything that can fail or allocate is done here, in the main thread.
+		*/
+		OrderedOf <structPolygon> polygons;
+		integer maximumNumberOfCells = 0;
+		for (integer idtw = 1; idtw <= my size; idtw ++) {
+			DTW dtw = my at [idtw];
+			autoPolygon polygon = DTW_to_Polygon (dtw, sakoeChibaBand, localSlope);
+			double xmin, xmax, ymin, ymax;
+			Polygon_getExtrema (polygon.get(), & xmin, & xmax, & ymin, & ymax);
+			Melder_require (! (xmax <= dtw -> xmin || xmin >= dtw -> xmax || ymax <= dtw -> ymin || ymin >= dtw -> ymax),
+				dtw, U": DTW and Polygon don't overlap.");   // otherwise DTW_Polygon_setUnreachableParts would throw in a thread
+			polygons. addItem_move (polygon.move());
+			dtw -> path.resize (dtw -> nx + dtw -> ny - 1);   // the path search starts at the maximum path length
+			maximumNumberOfCells = std::max (maximumNumberOfCells, dtw -> nx * dtw -> ny);
+		}
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), my size);
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		autoMAT deltas = raw_MAT (numberOfThreads, maximumNumberOfCells);
+		autoINTMAT psis = raw_INTMAT (numberOfThreads, maximumNumberOfCells);
+		std::atomic <integer> nextDTW (1);
+		auto findPaths = [&] (integer ithread) {
+			for (integer idtw = nextDTW ++; idtw <= my size; idtw = nextDTW ++) {
+				DTW dtw = my at [idtw];
+				const integer numberOfCells = dtw -> nx * dtw -> ny;
+				DTW_Polygon_findPathInside_preallocated (dtw, polygons.at [idtw], localSlope,
+					deltas.row (ithread).part (1, numberOfCells).asmatrix (dtw -> ny, dtw -> nx),
+					psis.row (ithread).part (1, numberOfCells).asmatrix (dtw -> ny, dtw -> nx), false
+				);
+			}
+		};
+		MelderThread_run (numberOfThreads, findPaths);
+		for (integer idtw = 1; idtw <= my size; idtw ++)
+			DTW_Path_recode (my at [idtw]);
+	} catch (MelderError) {
+		Melder_throw (U"Cannot find the paths.");
+	}
+}
+
+/*
+	Linear-memory path search inside a corridor.
+	For column ix only the rows rowFrom [ix] .. rowTo [ix] are evaluated. The corridor has to be monotone and connected:
+	rowFrom [1] = 1, rowTo [nx] = ny, and for ix > 1, rowFrom [ix - 1] <= rowFrom [ix] <= rowTo [ix - 1] + 1 and rowTo [ix - 1] <= rowTo [ix].
+	Only two columns of cumulative distances are kept; the back-pointers take one byte per corridor cell.
+	The local constraints are those of the unrestricted slope in DTW_Polygon_findPathInside
+	(diagonal steps weigh 2, horizontal and vertical steps weigh 1), but the path always runs from (1,1) to (nx,ny).
+	The distance of cell (iy, ix) is only asked for once, so it may be computed on the fly.
+	Returns the cumulative distance along the path.
+*/
+template <typename DistanceFunction>
+static double DTW_findPathInsideCorridor (integer nx, integer ny, constINTVEC const& rowFrom, constINTVEC const& rowTo,
+	DistanceFunction const& distance, autovector <structDTW_Path> *out_path)
+{
+	Melder_assert (rowFrom [1] == 1 && rowTo [nx] == ny);
+	autoINTVEC offset = raw_INTVEC (nx + 1);
+	offset [1] = 0;
+	for (integer ix = 1; ix <= nx; ix ++) {
+		Melder_assert (rowFrom [ix] >= 1 && rowFrom [ix] <= rowTo [ix] && rowTo [ix] <= ny);
+		Melder_assert (ix == 1 || (rowFrom [ix] >= rowFrom [ix - 1] && rowFrom [ix] <= rowTo [ix - 1] + 1 && rowTo [ix] >= rowTo [ix - 1]));
+		offset [ix + 1] = offset [ix] + rowTo [ix] - rowFrom [ix] + 1;
+	}
+	autoBYTEVEC psi = raw_BYTEVEC (offset [nx + 1]);
+	autoVEC columnA = raw_VEC (ny), columnB = raw_VEC (ny);
+	VEC previous = columnA.get(), current = columnB.get();
+	for (integer ix = 1; ix <= nx; ix ++) {
+		const integer iyfrom = rowFrom [ix], iyto = rowTo [ix];
+		const integer previousFrom = ( ix > 1 ? rowFrom [ix - 1] : 1 ), previousTo = ( ix > 1 ? rowTo [ix - 1] : 0 );
+		for (integer iy = iyfrom; iy <= iyto; iy ++) {
+			const double d = distance (iy, ix);
+			double g, gmin = DTW_BIG;
+			int direction = 0;
+			if (ix == 1 && iy == 1) {
+				gmin = d;
+				direction = DTW_START;
+			} else {
+				if (iy - 1 >= previousFrom && iy - 1 <= previousTo) {
+					gmin = previous [iy - 1] + 2.0 * d;
+					direction = DTW_XANDY;
+				}
+				if (iy >= previousFrom && iy <= previousTo && (g = previous [iy] + d) < gmin) {
+					gmin = g;
+					direction = DTW_X;
+				}
+				if (iy > iyfrom && (g = current [iy - 1] + d) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			Melder_assert (direction != 0);
+			current [iy] = gmin;
+			psi [offset [ix] + iy - iyfrom + 1] = (byte) direction;
+		}
+		std::swap (previous, current);
+	}
+	const double minimum = previous [ny];
+	/*
+		Trace back from (nx,ny) to (1,1).
+	*/
+	const integer maximumPathLength = nx + ny - 1;
+	autovector <structDTW_Path> path = newvectorzero <structDTW_Path> (maximumPathLength);
+	integer pathIndex = maximumPathLength, ix = nx, iy = ny;
+	for (;;) {
+		path [pathIndex]. x = ix;
+		path [pathIndex]. y = iy;
+		const int direction = psi [offset [ix] + iy - rowFrom [ix] + 1];
+		if (direction == DTW_START)
+			break;
+		if (direction == DTW_XANDY) {
+			ix --;
+			iy --;
+		} else if (direction == DTW_X) {
+			ix --;
+		} else {
+			iy --;
+		}
+		pathIndex --;
+		Melder_assert (pathIndex >= 1);
+	}
+	const integer pathLength = maximumPathLength - pathIndex + 1;
+	for (integer j = 1; j <= pathLength; j ++)
+		path [j] = path [pathIndex ++];
+	path.resize (pathLength);
+	*out_path = path.move();
+	return minimum;
+}
+
+/*
+	The rows within halfWidth from the straight line from (1,1) to (nx,ny).
+	The band is widened where necessary to keep it connected.
+*/
+static void getSakoeChibaCorridor (integer nx, integer ny, double halfWidth, INTVEC const& rowFrom, INTVEC const& rowTo) {
+	const double slope = ( nx > 1 ? (ny - 1.0) / (nx - 1.0) : 0.0 );
+	halfWidth = std::max (halfWidth, 0.5 * ceil (slope));
+	for (integer ix = 1; ix <= nx; ix ++) {
+		const double iy = ( ix < nx ? 1.0 + (ix - 1) * slope : double (ny) );
+		rowFrom [ix] = std::max (1_integer, Melder_ifloor (iy - halfWidth));
+		rowTo [ix] = std::min (ny, Melder_iceiling (iy + halfWidth));
+	}
+	rowFrom [1] = 1;
+	rowTo [nx] = ny;
+}
+
+static void getFullCorridor (integer ny, INTVEC const& rowFrom, INTVEC const& rowTo) {
+	for (integer ix = 1; ix <= rowFrom.size; ix ++) {
+		rowFrom [ix] = 1;
+		rowTo [ix] = ny;
+	}
+}
+
+void DTW_findPath_sakoeChibaBand (DTW me, double sakoeChibaBand) {
+	try {
+		autoINTVEC rowFrom = raw_INTVEC (my nx), rowTo = raw_INTVEC (my nx);
+		if (sakoeChibaBand > 0.0)
+			getSakoeChibaCorridor (my nx, my ny, sakoeChibaBand / my dy, rowFrom.get(), rowTo.get());
+		else
+			getFullCorridor (my ny, rowFrom.get(), rowTo.get());
+		const double minimum = DTW_findPathInsideCorridor (my nx, my ny, rowFrom.get(), rowTo.get(),
+			[&] (integer iy, integer ix) {
+				return my z [iy] [ix];
+			}, & my path);
+		my pathLength = my path.size;
+		my weightedDistance = minimum / (my nx + my ny);
+		DTW_Path_recode (me);
+	} catch (MelderError) {
+		Melder_throw (me, U": cannot find path inside the band.");
+	}
+}
+
+/*
+	Distance between two frames as in Matrices_to_DTW.
+*/
+static double getFrameDistance (constVEC const& x, constVEC const& y, double metric) {
+	double dmax = 0.0, d = 0.0;
+	for (integer k = 1; k <= x.size; k ++) {
+		const double dtmp = fabs (x [k] - y [k]);
+		if (dtmp > dmax)
+			dmax = dtmp;
+	}
+	if (dmax > 0.0) {
+		for (integer k = 1; k <= x.size; k ++) {
+			const double dtmp = fabs (x [k] - y [k]) / dmax;
+			d += pow (dtmp, metric);
+		}
+	}
+	d = dmax * pow (d, 1.0 / metric);
+	return d / x.size;
+}
+
+/*
+	Averages pairs of consecutive frames (rows); an odd last frame is copied.
+*/
+static autoMAT halveFrames (constMAT const& frames) {
+	const integer numberOfFrames = (frames.nrow + 1) / 2;
+	autoMAT result = raw_MAT (numberOfFrames, frames.ncol);
+	for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
+		result.row (iframe)  <<=  frames.row (2 * iframe - 1);
+		if (2 * iframe <= frames.nrow) {
+			result.row (iframe)  +=  frames.row (2 * iframe);
+			result.row (iframe)  *=  0.5;
+		}
+	}
+	return result;
+}
+
+/*
+	Multiscale DTW (Salvador & Chan 2007): the path is first found between the sequences at half the
+	resolution; the cells that this coarse path covers at full resolution, widened by radius cells,
+	form the corridor at full resolution. The recursion stops when a sequence has no more than radius + 2 frames.
+	Frames are the rows of x and y.
+*/
+static double Matrices_findPath_multiscale (constMAT const& x, constMAT const& y, integer radius, double metric,
+	autovector <structDTW_Path> *out_path)
+{
+	const integer nx = x.nrow, ny = y.nrow;
+	autoINTVEC rowFrom = raw_INTVEC (nx), rowTo = raw_INTVEC (nx);
+	if (nx <= radius + 2 || ny <= radius + 2) {
+		getFullCorridor (ny, rowFrom.get(), rowTo.get());
+	} else {
+		autoMAT xcoarse = halveFrames (x), ycoarse = halveFrames (y);
+		autovector <structDTW_Path> coarsePath;
+		Matrices_findPath_multiscale (xcoarse.get(), ycoarse.get(), radius, metric, & coarsePath);
+		for (integer ix = 1; ix <= nx; ix ++) {
+			rowFrom [ix] = ny;
+			rowTo [ix] = 1;
+		}
+		for (integer j = 1; j <= coarsePath.size; j ++) {
+			const integer iyfrom = 2 * coarsePath [j]. y - 1, iyto = std::min (2 * coarsePath [j]. y, ny);
+			for (integer ix = 2 * coarsePath [j]. x - 1; ix <= std::min (2 * coarsePath [j]. x, nx); ix ++) {
+				rowFrom [ix] = std::min (rowFrom [ix], iyfrom);
+				rowTo [ix] = std::max (rowTo [ix], iyto);
+			}
+		}
+		/*
+			Widen by radius; rowFrom and rowTo are non-decreasing, so the extremes within the window are at its ends.
+		*/
+		for (integer ix = nx; ix >= 1; ix --)
+			rowFrom [ix] = std::max (1_integer, rowFrom [std::max (1_integer, ix - radius)] - radius);
+		for (integer ix = 1; ix <= nx; ix ++)
+			rowTo [ix] = std::min (ny, rowTo [std::min (nx, ix + radius)] + radius);
+	}
+	return DTW_findPathInsideCorridor (nx, ny, rowFrom.get(), rowTo.get(),
+		[&] (integer iy, integer ix) {
+			return getFrameDistance (x.row (ix), y.row (iy), metric);
+		}, out_path);
+}
+
+void test_DTW_findPath_corridors () {
+	try {
+		const integer sizes [] [2] = { { 300, 230 }, { 230, 300 }, { 97, 97 } };
+		for (const auto& size : sizes) {
+			const integer nx = size [0], ny = size [1];
+			autoMAT x = randomGauss_MAT (nx, 3, 0.0, 0.3), y = randomGauss_MAT (ny, 3, 0.0, 0.3);
+			for (integer ix = 1; ix <= nx; ix ++)
+				for (integer k = 1; k <= 3; k ++)
+					x [ix] [k] += sin (ix / 15.0 + k);
+			for (integer iy = 1; iy <= ny; iy ++)
+				for (integer k = 1; k <= 3; k ++)
+					y [iy] [k] += sin (iy * (double (nx) / ny) / 15.0 + k);
+			const double metric = 2.0;
+			auto distance = [&] (integer iy, integer ix) {
+				return getFrameDistance (x.row (ix), y.row (iy), metric);
+			};
+			autoINTVEC rowFrom = raw_INTVEC (nx), rowTo = raw_INTVEC (nx);
+			autovector <structDTW_Path> path;
+			getFullCorridor (ny, rowFrom.get(), rowTo.get());
+			const double distance_full = DTW_findPathInsideCorridor (nx, ny, rowFrom.get(), rowTo.get(), distance, & path);
+			const double bands [] = { 0.5, 2.0, 5.0, 20.0, double (nx + ny) };
+			for (const double halfWidth : bands) {
+				getSakoeChibaCorridor (nx, ny, halfWidth, rowFrom.get(), rowTo.get());
+				const double distance_band = DTW_findPathInsideCorridor (nx, ny, rowFrom.get(), rowTo.get(), distance, & path);
+				Melder_require (distance_band >= distance_full,
+					nx, U" x ", ny, U", band ", halfWidth, U": the distance ", distance_band, U" is less than the full distance ", distance_full, U".");
+				if (halfWidth >= nx + ny)
+					Melder_require (distance_band == distance_full,
+						nx, U" x ", ny, U", band ", halfWidth, U": the distance ", distance_band, U" differs from the full distance ", distance_full, U".");
+			}
+			const integer radii [] = { 1, 2, 5, 10, std::max (nx, ny) };
+			for (const integer radius : radii) {
+				const double distance_multiscale = Matrices_findPath_multiscale (x.get(), y.get(), radius, metric, & path);
+				Melder_require (distance_multiscale >= distance_full,
+					nx, U" x ", ny, U", radius ", radius, U": the distance ", distance_multiscale, U" is less than the full distance ", distance_full, U".");
+				if (radius >= std::max (nx, ny))
+					Melder_require (distance_multiscale == distance_full,
+						nx, U" x ", ny, U", radius ", radius, U": the distance ", distance_multiscale, U" differs from the full distance ", distance_full, U".");
+			}
+		}
+		MelderInfo_writeLine (U"test_DTW_findPath_corridors: OK");
+	} catch (MelderError) {
+		Melder_throw (U"DTW corridor test failed.");
+	}
+}
+
+autoDurationTier Matrices_to_DurationTier_dtw (Matrix me, Matrix thee, double sakoeChibaBand, integer multiscaleRadius, double metric) {
+	try {
+		Melder_require (thy ny == my ny,
+			U"Column sizes should be equal.");
+		Melder_require (metric > 0.0,
+			U"The distance metric should be positive.");
+		/*
+			As in Matrices_to_DTW, the frames of me are on the y-axis and those of thee on the x-axis.
+			Copying the frames to rows makes them contiguous.
+		*/
+		autoMAT x = transpose_MAT (thy z.get()), y = transpose_MAT (my z.get());
+		autovector <structDTW_Path> path;
+		if (multiscaleRadius > 0) {
+			Matrices_findPath_multiscale (x.get(), y.get(), multiscaleRadius, metric, & path);
+		} else {
+			autoINTVEC rowFrom = raw_INTVEC (thy nx), rowTo = raw_INTVEC (thy nx);
+			if (sakoeChibaBand > 0.0)
+				getSakoeChibaCorridor (thy nx, my nx, sakoeChibaBand / my dx, rowFrom.get(), rowTo.get());
+			else
+				getFullCorridor (my nx, rowFrom.get(), rowTo.get());
+			DTW_findPathInsideCorridor (thy nx, my nx, rowFrom.get(), rowTo.get(),
+				[&] (integer iy, integer ix) {
+					return getFrameDistance (x.row (ix), y.row (iy), metric);
+				}, & path);
+		}
+		const integer nxymax = thy nx + my nx + 2;
+		autoVEC xwarp = zero_VEC (nxymax), ywarp = zero_VEC (nxymax);
+		const integer nxy = DTW_Path_getPiecewiseLinearWarp (path.get(), thy xmin, thy xmax, thy dx, thy x1,
+				my xmin, my xmax, my dx, my x1, xwarp.get(), ywarp.get());
+		autoDurationTier him = DurationTier_createFromWarp (thy xmin, thy xmax, xwarp.part (1, nxy), ywarp.part (1, nxy));
+		return him;
+	} catch (MelderError) {
+		Melder_throw (U"DurationTier not created from matrices.");
+	}
+}
+
 /* End of file DTW.cpp */
@@ -31,6 +31,9 @@
 
 #include "DTW_def.h"
 
+Collection_define (DTWList, OrderedOf, DTW) {
+};
+
 #define DTW_SAKOECHIBA 1
 #define DTW_SLOPES 2
 
@@ -53,6 +56,19 @@ autoDTW DTW_swapAxes (DTW me);
 
 void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, autoMatrix *cumulativeDists);
 
+void DTWList_findPath_bandAndSlope (DTWList me, double sakoeChibaBand, int localSlope);
+/*
+	As DTW_findPath_bandAndSlope for each DTW, with the path searches distributed over threads;
+	each thread reuses its own cumulative-distance and direction matrices.
+*/
+
+void DTW_findPath_sakoeChibaBand (DTW me, double sakoeChibaBand);
+/*
+	Finds the path from the first to the last cell among the cells that lie within sakoeChibaBand seconds (on the y-axis)
+	from the diagonal; a band of zero means no restriction.
+	Memory use is linear: only two columns of cumulative distances and a byte per band cell for the back-pointers are kept.
+*/
+
 void DTW_findPath (DTW me, bool matchStart, bool matchEnd, int slope); // deprecated
 /* Obsolete
 	Function:
@@ -120,7 +136,25 @@ autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart,
 autoDTW Pitches_to_DTW (Pitch me, Pitch thee, double vuv_costs, double time_weight, bool matchStart, bool matchEnd, int slope);
 
 autoDurationTier DTW_to_DurationTier (DTW me);
+/*
+	The relative durations dy/dx along the (recoded) path, as a function of the x-time.
+*/
+
+autoDurationTier Matrices_to_DurationTier_dtw (Matrix me, Matrix thee, double sakoeChibaBand, integer multiscaleRadius, double metric);
+/*
+	Finds the DTW path between the frames (columns) of thee (x-axis) and me (y-axis) without a distance matrix:
+	the distances are computed only for the cells inside the corridor, and only the path is kept.
+	multiscaleRadius > 0: the corridor is derived from the path at half the resolution, widened by multiscaleRadius frames
+		(recursively, as in FastDTW); sakoeChibaBand is not used.
+	multiscaleRadius <= 0: the corridor is the Sakoe-Chiba band (s); a band of zero means the full matrix.
+*/
 
 void DTW_Matrix_replace (DTW me, Matrix thee);
 
+void test_DTW_findPath_corridors ();
+/*
+	Checks that the banded and multiscale path searches never find a smaller distance than the search in the full matrix,
+	and the same distance when the corridor covers the full matrix.
+*/
+
 #endif /* _DTW_h_ */
@@ -23,6 +23,7 @@
 
 #include "Distance.h"
 #include "TableOfReal_extensions.h"
+#include "MelderThread.h"
 
 Thing_implement (Distance, Proximity, 0);
 
@@ -42,26 +43,43 @@ autoDistance Configuration_to_Distance (Configuration me) {
 	try {
 		autoDistance thee = Distance_create (my numberOfRows);
 		TableOfReal_copyLabels (me, thee.get(), 1, -1);
-		autoVEC dist = raw_VEC (my numberOfColumns);
-		for (integer i = 1; i <= thy numberOfRows - 1; i ++) {
-			for (integer j = i + 1; j <= thy numberOfColumns; j ++) {
-				dist.all()  <<=  my data.row (i)  -  my data.row (j);
-				abs_VEC_inout (dist.get());
-				const double dmax = NUMmax_e (dist.get());
+		Configuration_into_Distance (me, thee.get(), 0);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": no Distance created.");
+	}
+}
+
+void Configuration_into_Distance (Configuration me, Distance thee, integer numberOfThreads) {
+	Melder_assert (thy numberOfRows == my numberOfRows && thy numberOfColumns == my numberOfRows);
+	const integer numberOfPoints = my numberOfRows;
+	if (numberOfThreads <= 0)
+		numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfPoints / 250 + 1);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	autoMAT differences = raw_MAT (numberOfThreads, my numberOfColumns);   // one row per thread
+	/*
+		Thread k handles the rows k, k + numberOfThreads, ..., so that the work of the triangle is evenly divided.
+	*/
+	auto getDistances = [&] (integer ithread) {
+		VEC const dist = differences.row (ithread);
+		for (integer i = ithread; i <= numberOfPoints; i += numberOfThreads) {
+			thy data [i] [i] = 0.0;
+			for (integer j = i + 1; j <= numberOfPoints; j ++) {
+				dist  <<=  my data.row (i)  -  my data.row (j);
+				abs_VEC_inout (dist);
+				const double dmax = NUMmax_e (dist);
 				double d = 0.0;
 				if (dmax > 0.0) {
-					dist.all()  /=  dmax;   // prevent overflow
-					power_VEC_inout (dist.get(), my metric);
-					d = NUMinner (my w.all(), dist.get());
+					dist  /=  dmax;   // prevent overflow
+					power_VEC_inout (dist, my metric);
+					d = NUMinner (my w.all(), dist);
 					d = dmax * pow (d, 1.0 / my metric);   // scale back
 				}
 				thy data [i] [j] = thy data [j] [i] = d;
 			}
 		}
-		return thee;
-	} catch (MelderError) {
-		Melder_throw (me, U": no Distance created.");
-	}
+	};
+	MelderThread_run (numberOfThreads, getDistances);
 }
 
 void Distance_drawDendrogram (Distance me, Graphics g, int method) {
@@ -29,6 +29,12 @@ autoDistance Distance_create (integer numberOfPoints);
 
 autoDistance Configuration_to_Distance (Configuration me);
 
+void Configuration_into_Distance (Configuration me, Distance thee, integer numberOfThreads);
+/*
+	Computes the distances between the points of the Configuration into the existing Distance.
+	The rows are divided over numberOfThreads threads (0: as many as useful); the result does not depend on this.
+*/
+
 void Distance_drawDendrogram (Distance me, Graphics g, int method);
 
 Collection_define (DistanceList, OrderedOf, Distance) {
@@ -24,6 +24,7 @@
 #include "NUMmachar.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "GaussianMixture_def.h"
@@ -51,6 +52,34 @@
 
 Thing_implement (GaussianMixture, Daata, 0);
 
+/*
+	The E-step and the M-step handle the data in blocks of rows, which are divided over threads.
+	Each thread has its own part of the work space and its own partial sums, which are added in a fixed order.
+*/
+constexpr integer GaussianMixture_ROW_BLOCK_SIZE = 256;
+
+static integer GaussianMixture_getNumberOfThreads (integer numberOfRows) {
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfRows / (4 * GaussianMixture_ROW_BLOCK_SIZE) + 1);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	return numberOfThreads;
+}
+
+/*
+	Calls doRows (ithread, fromRow, toRow) for consecutive parts of the rows 1..numberOfRows,
+	one part per thread (see MelderThread_run).
+*/
+template <typename RowsFunction>
+static void GaussianMixture_doRowsInParallel (integer numberOfThreads, integer numberOfRows, RowsFunction const& doRows) {
+	const integer numberOfRowsPerThread = (numberOfRows - 1) / numberOfThreads + 1;
+	auto doPart = [&] (integer ithread) {
+		const integer fromRow = (ithread - 1) * numberOfRowsPerThread + 1;
+		const integer toRow = std::min (ithread * numberOfRowsPerThread, numberOfRows);
+		if (fromRow <= toRow)
+			doRows (ithread, fromRow, toRow);
+	};
+	MelderThread_run (numberOfThreads, doPart);
+}
+
 void structGaussianMixture :: v1_info () {
 	structDaata :: v1_info ();
 	MelderInfo_writeLine (U"Number of components: ", our numberOfComponents);
@@ -66,40 +95,64 @@ static integer GaussianMixture_getNumberOfParametersInComponent (GaussianMixture
 	return ( thy numberOfRows == 1 ? 2 * thy numberOfColumns : thy numberOfColumns * (thy numberOfColumns + 3) / 2 );
 }
 
-static double GaussianMixture_getLikelihoodValue (GaussianMixture me, constMAT const& probabilities, kGaussianMixtureCriterion criterion) {
-	Melder_require (probabilities.ncol == my numberOfComponents,
-		U"The number of columns in the probabilities should equal the number of components.");
-	const integer numberOfData = probabilities.nrow;
+/*
+	ln (mixingProbabilities [k] * N(x|mu(k),Sigma(k))), or -INFINITY if that product is zero.
+*/
+static inline double GaussianMixture_getLogWeightedDensity (GaussianMixture me, constVECVU const& logDensities, integer component) {
+	return ( my mixingProbabilities [component] > 0.0 && logDensities [component] > -INFINITY ?
+			log (my mixingProbabilities [component]) + logDensities [component] : -INFINITY );
+}
+
+/*
+	ln (sum (k=1...K, mixingProbabilities [k] * N(x|mu(k),Sigma(k)))), computed from the log densities
+	by taking the largest term out of the sum, so that far-out points do not underflow to zero (log-sum-exp).
+	Returns -INFINITY if all the terms are zero.
+*/
+static double GaussianMixture_getLogMixtureDensity (GaussianMixture me, constVECVU const& logDensities) {
+	double maximum = -INFINITY;
+	for (integer component = 1; component <= my numberOfComponents; component ++)
+		maximum = std::max (maximum, GaussianMixture_getLogWeightedDensity (me, logDensities, component));
+	if (maximum == -INFINITY)
+		return -INFINITY;
+	longdouble sum = 0.0;
+	for (integer component = 1; component <= my numberOfComponents; component ++)
+		sum += exp (GaussianMixture_getLogWeightedDensity (me, logDensities, component) - maximum);   // exp (-INFINITY) = 0
+	return maximum + log (double (sum));
+}
+
+static double GaussianMixture_getLikelihoodValue (GaussianMixture me, constMAT const& logDensities, kGaussianMixtureCriterion criterion) {
+	Melder_require (logDensities.ncol == my numberOfComponents,
+		U"The number of columns in the log densities should equal the number of components.");
+	const integer numberOfData = logDensities.nrow;
 	Melder_require (numberOfData > my numberOfComponents,
-		U"The number of rows in the probabilities should be larger than the number of components.");
+		U"The number of rows in the log densities should be larger than the number of components.");
 	if (criterion == kGaussianMixtureCriterion::COMPLETE_DATA_ML) {
 		/*
 			Bishop eq. 9.40 (we rewrote ln(a)+ln(b) = ln (a*b)):
 			ln(p(X,Z|μ,S,π)= sum(n=1...N, sum (k=1...K, gamma [n] [k])*ln (π [k]*N(x [n]|μ [k],S [k])),
-			where gamma [n] [k] = mixingProbablities [k] * probabilities [n] [k] / 
-				sum(1...K, mixingProbablities [k] * probabilities [n] [k])
+			where gamma [n] [k] = π [k] * N(x [n]|μ [k],S [k]) / sum(1...K, π [k] * N(x [n]|μ [k],S [k]))
 		*/
 		longdouble lnpcd = 0.0;
 		for (integer irow = 1; irow <= numberOfData; irow ++) {
-			longdouble psum = 0.0, lnsum = 0.0;
+			const double lnMixture = GaussianMixture_getLogMixtureDensity (me, logDensities.row (irow));
+			if (lnMixture == -INFINITY)
+				continue;
 			for (integer icol = 1; icol <= my numberOfComponents; icol ++) {
-				const longdouble pp = my mixingProbabilities [icol] * probabilities [irow] [icol];
-				psum += pp;
-				lnsum += pp * log (pp); // scaling outside the loop
+				const double lnpp = GaussianMixture_getLogWeightedDensity (me, logDensities.row (irow), icol);
+				if (lnpp > -INFINITY)
+					lnpcd += exp (lnpp - lnMixture) * lnpp;
 			}
-			if (psum > 0)
-				lnpcd += lnsum / psum; // scaling: as responsibilities
 		}
-		return lnpcd;
+		return double (lnpcd);
 	}
 	/*
 		The common factor for the following criteria is the log(likelihood), Bishop eq. 9.28
 	*/
 	longdouble lnp = 0.0;
 	for (integer irow = 1; irow <= numberOfData; irow ++) {
-		const double psum = NUMinner (my mixingProbabilities.get(), probabilities.row (irow));
-		if (psum > 0.0)
-			lnp += (longdouble) log (psum);
+		const double lnMixture = GaussianMixture_getLogMixtureDensity (me, logDensities.row (irow));
+		if (lnMixture > -INFINITY)
+			lnp += lnMixture;
 	}
 
 	if (criterion == kGaussianMixtureCriterion::LIKELIHOOD)
@@ -138,16 +191,20 @@ static double GaussianMixture_getLikelihoodValue (GaussianMixture me, constMAT c
 	return lnp;
 }
 
-static void GaussianMixture_getResponsibilities (GaussianMixture me, constMATVU const& probabilities, integer componentToUpdate, MAT const& responsibilities) {
-	Melder_require (responsibilities.nrow == probabilities.nrow && responsibilities.ncol == probabilities.ncol,
-			U"The responsibilities and the probabilities should have the same dimensions.");
+static void GaussianMixture_getResponsibilities (GaussianMixture me, constMATVU const& logDensities, integer componentToUpdate, MAT const& responsibilities) {
+	Melder_require (responsibilities.nrow == logDensities.nrow && responsibilities.ncol == logDensities.ncol,
+			U"The responsibilities and the log densities should have the same dimensions.");
 	Melder_require (responsibilities.ncol == my numberOfComponents,
 			U"The number of columns of the responsibilities should equal the number of components.");
 	const integer fromComponent = componentToUpdate == 0 ? 1 : componentToUpdate;
 	const integer toComponent = componentToUpdate == 0 ? my numberOfComponents : componentToUpdate;
 	
-	for (integer irow = 1; irow <= probabilities.nrow; irow ++) {
-		responsibilities.row (irow).part (fromComponent, toComponent)  <<=  probabilities.row (irow).part (fromComponent, toComponent)  *  my mixingProbabilities.part (fromComponent, toComponent);
+	for (integer irow = 1; irow <= logDensities.nrow; irow ++) {
+		const double lnMixture = GaussianMixture_getLogMixtureDensity (me, logDensities.row (irow));
+		for (integer component = fromComponent; component <= toComponent; component ++) {
+			const double lnpp = GaussianMixture_getLogWeightedDensity (me, logDensities.row (irow), component);
+			responsibilities [irow] [component] = ( lnMixture > -INFINITY ? exp (lnpp - lnMixture) : 0.0 );
+		}
 	}
 	/*
 		Maintain the invariant.
@@ -167,6 +224,8 @@ static void GaussianMixture_updateComponent (GaussianMixture me, integer compone
 		U"The component number should be in the range from 1 to ", my numberOfComponents, U".");
 	
 	const Covariance thee = my covariances->at [component];
+	const integer dimension = thy numberOfColumns;
+	const bool diagonal = ( thy numberOfRows == 1 );
 	/*
 		Update the means: Bishop eq. 9.24
 	*/
@@ -177,25 +236,45 @@ static void GaussianMixture_updateComponent (GaussianMixture me, integer compone
 	const double totalComponentResponsibility = NUMsum (responsibilities.column (component));
 	thy centroid.get ()  /=  totalComponentResponsibility;
 	/*
-		update covariance with the new mean: Bishop eq. 9.25
+		Update the covariance with the new mean: Bishop eq. 9.25.
+		Each thread sums the weighted outer products of its rows, a block at a time,
+		as the matrix product of the transposed weighted deviations and the deviations.
 	*/
-	thy data.all()  <<=  0.0;
-	autoVEC dif = raw_VEC (thy numberOfColumns);
-	if (thy numberOfRows == 1) { // 1xn covariance
-		autoVEC variance = raw_VEC (thy numberOfColumns);
-		for (integer irow = 1; irow <= numberOfData; irow ++) {
-			dif.all()  <<=  data.row (irow)  -  thy centroid.get();
-			variance.all()  <<=  dif.all()  *  dif.all();
-			thy data.row (1)  +=  responsibilities [irow] [component]  *  variance.get();
-		}
-	} else { // nxn covariance
-		autoMAT covar = raw_MAT (thy numberOfColumns, thy numberOfColumns);
-		for (integer irow = 1; irow <= numberOfData; irow ++) {
-			dif.all()  <<=  data.row (irow)  -  thy centroid.get();
-			outer_MAT_out (covar.get(), dif.get(), dif.get());
-			thy data.get()  +=  responsibilities [irow] [component]  *  covar.get();
+	const integer numberOfThreads = GaussianMixture_getNumberOfThreads (numberOfData);
+	const integer blockSize = GaussianMixture_ROW_BLOCK_SIZE;
+	autoMAT deviations_transposed = raw_MAT (numberOfThreads * dimension, blockSize);
+	autoMAT weightedDeviations_transposed = raw_MAT (numberOfThreads * dimension, blockSize);
+	autoMAT blockSums = raw_MAT (numberOfThreads * thy numberOfRows, dimension);
+	autoMAT partialSums = zero_MAT (numberOfThreads * thy numberOfRows, dimension);
+	GaussianMixture_doRowsInParallel (numberOfThreads, numberOfData, [&] (integer ithread, integer fromRow, integer toRow) {
+		const integer firstWorkRow = (ithread - 1) * dimension + 1;
+		MATVU const partialSum = partialSums.horizontalBand ((ithread - 1) * thy numberOfRows + 1, ithread * thy numberOfRows);
+		MATVU const blockSum = blockSums.horizontalBand ((ithread - 1) * thy numberOfRows + 1, ithread * thy numberOfRows);
+		for (integer firstRow = fromRow; firstRow <= toRow; firstRow += blockSize) {
+			const integer numberOfRowsInBlock = std::min (blockSize, toRow - firstRow + 1);
+			MATVU const dt = deviations_transposed.part (firstWorkRow, firstWorkRow + dimension - 1, 1, numberOfRowsInBlock);
+			MATVU const wdt = weightedDeviations_transposed.part (firstWorkRow, firstWorkRow + dimension - 1, 1, numberOfRowsInBlock);
+			for (integer i = 1; i <= numberOfRowsInBlock; i ++) {
+				const integer irow = firstRow + i - 1;
+				const double responsibility = responsibilities [irow] [component];
+				for (integer j = 1; j <= dimension; j ++) {
+					const double deviation = data [irow] [j] - thy centroid [j];
+					dt [j] [i] = deviation;
+					wdt [j] [i] = responsibility * deviation;
+				}
+			}
+			if (diagonal) {
+				for (integer j = 1; j <= dimension; j ++)
+					partialSum [1] [j] += NUMinner (wdt.row (j), dt.row (j));
+			} else {
+				mul_MAT_out (blockSum, wdt, dt.transpose());
+				partialSum  +=  blockSum;
+			}
 		}
-	}
+	});
+	thy data.all()  <<=  0.0;
+	for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+		thy data.all()  +=  partialSums.horizontalBand ((ithread - 1) * thy numberOfRows + 1, ithread * thy numberOfRows);
 	thy data.get()  /=  totalComponentResponsibility;
 	thy numberOfObservations = my mixingProbabilities [component] * numberOfData;
 }
@@ -792,35 +871,81 @@ void GaussianMixture_splitComponent (GaussianMixture me, integer component) {
 	}
 }
 
-void GaussianMixture_TableOfReal_getComponentProbabilities (GaussianMixture me, TableOfReal thee, integer componentToUpdate, MAT const& probabilities) {
+void GaussianMixture_TableOfReal_getComponentLogDensities (GaussianMixture me, TableOfReal thee, integer componentToUpdate, MAT const& logDensities) {
 	try {
-		Melder_require (probabilities.nrow == thy numberOfRows,
-			U"The number of rows in the TableOfReal and the probabilities should be equal.");
-		Melder_require (probabilities.ncol == my numberOfComponents,
-			U"The number of columns in the TableOfReal and the probabilities should be equal.");
+		Melder_require (logDensities.nrow == thy numberOfRows,
+			U"The number of rows in the TableOfReal and the log densities should be equal.");
+		Melder_require (logDensities.ncol == my numberOfComponents,
+			U"The number of columns in the TableOfReal and the log densities should be equal.");
 		Melder_require (my dimension == thy numberOfColumns,
 			U"The number of columns in the TableOfReal and the dimension of the GaussianMixture should be equal.");
 		Melder_require (componentToUpdate >= 0 && componentToUpdate <= my numberOfComponents,
 			U"The component number should be in the interval from 0 to ", my numberOfComponents);
 		const double ln2pid = my dimension * log (NUM2pi);
+		const integer dimension = my dimension;
 
 		const integer fromComponent = componentToUpdate == 0 ? 1 : componentToUpdate;
 		const integer toComponent = componentToUpdate == 0 ? my numberOfComponents : componentToUpdate;
-		
+		/*
+			Cache the inverse Cholesky factors L^-1 of the covariances (with zeros above the diagonal),
+			so that the squared Mahalanobis distances of a block of rows are the row sums of squares of
+			the matrix product of the deviations and L^-T.
+		*/
+		const integer numberOfComponentsToUpdate = toComponent - fromComponent + 1;
+		autoMAT inverseFactors = zero_MAT (numberOfComponentsToUpdate * dimension, dimension);
 		for (integer component = fromComponent; component <= toComponent; component ++) {
 			const Covariance covi = my covariances->at [component];
 			SSCP_expandWithLowerCholeskyInverse (covi);
-
-			for (integer irow = 1; irow <= thy numberOfRows; irow++) {
-				const double dsq = NUMmahalanobisDistanceSquared (covi -> lowerCholeskyInverse.get(), thy data.row (irow), covi -> centroid.get());
-				probabilities [irow] [component] = std::max (1e-300, exp (- 0.5 * (ln2pid + covi -> lnd + dsq))); // prevent probabilities from being zero
-			}
+			MATVU const inverseFactor = inverseFactors.horizontalBand ((component - fromComponent) * dimension + 1,
+					(component - fromComponent + 1) * dimension);
+			if (covi -> numberOfRows == 1)
+				inverseFactor.diagonal()  <<=  covi -> lowerCholeskyInverse.row (1);
+			else
+				for (integer irow = 1; irow <= dimension; irow ++)
+					inverseFactor.row (irow).part (1, irow)  <<=  covi -> lowerCholeskyInverse.row (irow).part (1, irow);
 		}
+		const integer numberOfThreads = GaussianMixture_getNumberOfThreads (thy numberOfRows);
+		const integer blockSize = GaussianMixture_ROW_BLOCK_SIZE;
+		autoMAT deviations = raw_MAT (numberOfThreads * blockSize, dimension);
+		autoMAT standardized = raw_MAT (numberOfThreads * blockSize, dimension);
+		GaussianMixture_doRowsInParallel (numberOfThreads, thy numberOfRows, [&] (integer ithread, integer fromRow, integer toRow) {
+			const integer firstWorkRow = (ithread - 1) * blockSize + 1;
+			for (integer firstRow = fromRow; firstRow <= toRow; firstRow += blockSize) {
+				const integer numberOfRowsInBlock = std::min (blockSize, toRow - firstRow + 1);
+				MATVU const deviation = deviations.horizontalBand (firstWorkRow, firstWorkRow + numberOfRowsInBlock - 1);
+				MATVU const y = standardized.horizontalBand (firstWorkRow, firstWorkRow + numberOfRowsInBlock - 1);
+				for (integer component = fromComponent; component <= toComponent; component ++) {
+					const Covariance covi = my covariances->at [component];
+					constMATVU const inverseFactor = inverseFactors.horizontalBand ((component - fromComponent) * dimension + 1,
+							(component - fromComponent + 1) * dimension);
+					for (integer i = 1; i <= numberOfRowsInBlock; i ++)
+						deviation.row (i)  <<=  thy data.row (firstRow + i - 1)  -  covi -> centroid.all();
+					if (covi -> numberOfRows == 1)
+						for (integer i = 1; i <= numberOfRowsInBlock; i ++)
+							y.row (i)  <<=  deviation.row (i)  *  inverseFactor.diagonal();
+					else
+						mul_MAT_out (y, deviation, inverseFactor.transpose());
+					for (integer i = 1; i <= numberOfRowsInBlock; i ++) {
+						const double dsq = NUMsum2 (y.row (i));
+						logDensities [firstRow + i - 1] [component] = - 0.5 * (ln2pid + covi -> lnd + dsq);
+					}
+				}
+			}
+		});
 	} catch (MelderError) {
-		Melder_throw (me, U" & ", thee, U": no component probabilies could be calculated.");
+		Melder_throw (me, U" & ", thee, U": no component densities could be calculated.");
 	}
 }
 
+void GaussianMixture_TableOfReal_getComponentProbabilities (GaussianMixture me, TableOfReal thee, integer componentToUpdate, MAT const& probabilities) {
+	GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, componentToUpdate, probabilities);
+	const integer fromComponent = componentToUpdate == 0 ? 1 : componentToUpdate;
+	const integer toComponent = componentToUpdate == 0 ? my numberOfComponents : componentToUpdate;
+	for (integer irow = 1; irow <= probabilities.nrow; irow ++)
+		for (integer component = fromComponent; component <= toComponent; component ++)
+			probabilities [irow] [component] = std::max (1e-300, exp (probabilities [irow] [component])); // prevent probabilities from being zero
+}
+
 void GaussianMixture_TableOfReal_getResponsilities (GaussianMixture me, TableOfReal thee, MAT const& responsibilities) {
 		Melder_require (responsibilities.nrow == thy numberOfRows,
 			U"The number of rows in the TableOfReal and the responsibilities should be equal.");
@@ -828,9 +953,9 @@ void GaussianMixture_TableOfReal_getResponsilities (GaussianMixture me, TableOfR
 			U"The number of columns in the TableOfReal and the responsibilities should be equal.");
 		Melder_require (my dimension == thy numberOfColumns,
 			U"The number of columns in the TableOfReal and the dimension of the GaussianMixture should be equal.");
-		autoMAT probabilities = raw_MAT (responsibilities.nrow, responsibilities.ncol);
-		GaussianMixture_TableOfReal_getComponentProbabilities (me, thee, 0, probabilities.get());
-		GaussianMixture_getResponsibilities (me, probabilities.get(), 0, responsibilities);
+		autoMAT logDensities = raw_MAT (responsibilities.nrow, responsibilities.ncol);
+		GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, 0, logDensities.get());
+		GaussianMixture_getResponsibilities (me, logDensities.get(), 0, responsibilities);
 }
 
 autoTableOfReal GaussianMixture_TableOfReal_to_TableOfReal_probabilities (GaussianMixture me, TableOfReal thee) {
@@ -849,8 +974,13 @@ autoTableOfReal GaussianMixture_TableOfReal_to_TableOfReal_probabilities (Gaussi
 
 autoTableOfReal GaussianMixture_TableOfReal_to_TableOfReal_responsibilities (GaussianMixture me, TableOfReal thee) {
 	try {
-		autoTableOfReal him = GaussianMixture_TableOfReal_to_TableOfReal_probabilities (me, thee);
-		GaussianMixture_getResponsibilities (me, his data.get(), 0, his data.get());
+		Melder_require (my dimension == thy numberOfColumns,
+			U"The number of columns in the TableOfReal and the dimension of the GaussianMixture should be equal.");
+		autoTableOfReal him = TableOfReal_create (thy numberOfRows, my numberOfComponents);
+		his rowLabels.all()  <<=  thy rowLabels.all();
+		TableOfReal_setSequentialColumnLabels (him.get(), 1, my numberOfComponents, U"c", 1, 1);
+		GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, 0, his data.get());
+		GaussianMixture_getResponsibilities (me, his data.get(), 0, his data.get());   // in place, row by row
 		return him;
 	} catch (MelderError) {
 		Melder_throw (me, U" & ", thee, U": no responsibilities could be calculated.");
@@ -885,12 +1015,12 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 		// mixture covariances to prevent numerical instabilities.
 
 		autoCovariance covg = TableOfReal_to_Covariance (thee);
-		autoMAT probabilities = raw_MAT (thy numberOfRows, my numberOfComponents);
+		autoMAT logDensities = raw_MAT (thy numberOfRows, my numberOfComponents);
 		autoMAT responsibilities = raw_MAT (thy numberOfRows, my numberOfComponents);
 		
-		GaussianMixture_TableOfReal_getComponentProbabilities (me, thee, 0, probabilities.get());
+		GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, 0, logDensities.get());
 
-		double lnp = GaussianMixture_getLikelihoodValue (me, probabilities.get(), criterion);
+		double lnp = GaussianMixture_getLikelihoodValue (me, logDensities.get(), criterion);
 		integer iter = 0;
 		autoMelderProgress progress (U"Improve likelihood...");
 		try {
@@ -901,7 +1031,7 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 					E-step: get responsibilities (gamma) with current parameters
 					See C. Bishop (2006), Pattern reconition and machine learning, Springer, page 439...
 				*/
-				GaussianMixture_getResponsibilities (me, probabilities.get(), 0, responsibilities.get());
+				GaussianMixture_getResponsibilities (me, logDensities.get(), 0, responsibilities.get());
 
 				lnp_prev = lnp;
 				
@@ -920,9 +1050,9 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 				my mixingProbabilities.all()  <<=  totalResponsibilities.get();
 				my mixingProbabilities.all()  *=  1.0 / responsibilities.nrow;
 				
-				GaussianMixture_TableOfReal_getComponentProbabilities (me, thee, 0, probabilities.get());
+				GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, 0, logDensities.get());
 				
-				lnp = GaussianMixture_getLikelihoodValue (me, probabilities.get(), criterion);
+				lnp = GaussianMixture_getLikelihoodValue (me, logDensities.get(), criterion);
 				Melder_progress ((double) iter / (double) maxNumberOfIterations, criterionText, U": ", lnp / thy numberOfRows, U", L0: ", lnp_start);
 			} while (fabs (lnp - lnp_prev) > std::max (fabs (delta_lnp * lnp_prev), NUMeps) && iter < maxNumberOfIterations);
 		} catch (MelderError) {
@@ -943,9 +1073,9 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 
 
 double GaussianMixture_TableOfReal_getLikelihoodValue (GaussianMixture me, TableOfReal thee, kGaussianMixtureCriterion criterion) {
-	autoMAT probabilities = raw_MAT (thy numberOfRows, my numberOfComponents);
-	GaussianMixture_TableOfReal_getComponentProbabilities (me, thee, 0, probabilities.get());
-	return GaussianMixture_getLikelihoodValue (me, probabilities.get(), criterion);
+	autoMAT logDensities = raw_MAT (thy numberOfRows, my numberOfComponents);
+	GaussianMixture_TableOfReal_getComponentLogDensities (me, thee, 0, logDensities.get());
+	return GaussianMixture_getLikelihoodValue (me, logDensities.get(), criterion);
 }
 
 autoMAT newMATremoveColumn (constMAT const& m, integer columnToRemove) {
@@ -983,7 +1113,7 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 		const conststring32 criterionText = GaussianMixture_criterionText (criterion);
 		const bool deleteWeakComponents = minimumNumberOfComponents > 0;
 		autoGaussianMixture him = Data_copy (me);
-		autoMAT probabilities = zero_MAT (thy numberOfRows, his numberOfComponents);
+		autoMAT logDensities = zero_MAT (thy numberOfRows, his numberOfComponents);
 		autoMAT responsibilities = zero_MAT (thy numberOfRows, his numberOfComponents);
 
 		autoCovariance covg = TableOfReal_to_Covariance (thee);
@@ -991,12 +1121,12 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 		const double npars = GaussianMixture_getNumberOfParametersInComponent (him.get());
 		const double nparsd2 = ( deleteWeakComponents ? npars / 2.0 : 0.0 );
 
-		// Initial E-step: Update all component probabilities.
+		// Initial E-step: Update all component densities.
 
-		GaussianMixture_TableOfReal_getComponentProbabilities (him.get(), thee, 0, probabilities.get());
-		GaussianMixture_getResponsibilities (me, probabilities.get(), 0, responsibilities.get());
+		GaussianMixture_TableOfReal_getComponentLogDensities (him.get(), thee, 0, logDensities.get());
+		GaussianMixture_getResponsibilities (me, logDensities.get(), 0, responsibilities.get());
 
-		double lnew = GaussianMixture_getLikelihoodValue (him.get(), probabilities.get(), criterion);
+		double lnew = GaussianMixture_getLikelihoodValue (him.get(), logDensities.get(), criterion);
 
 		autoMelderProgress progress (U"Gaussian mixture...");
 		autoGaussianMixture best = Data_copy (me);
@@ -1012,7 +1142,7 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 				lprev = lnew;
 				for (integer icomponent = 1; icomponent <= his numberOfComponents; icomponent ++) {
 
-					GaussianMixture_getResponsibilities (him.get(), probabilities.get(), icomponent, responsibilities.get());
+					GaussianMixture_getResponsibilities (him.get(), logDensities.get(), icomponent, responsibilities.get());
 					// Now check if enough support for a component exists
 					
 					const double componentSupport = NUMsum (responsibilities.column (icomponent)) - nparsd2;
@@ -1025,18 +1155,18 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 					VECnormalize_inplace (his mixingProbabilities.get(), 1.0, 1.0); // redistribute probability mass
 
 					if (his mixingProbabilities [icomponent] > 0.0) {
-						// update probabilities for component
+						// update densities for component
 						GaussianMixture_updateComponent (him.get(), icomponent, thy data.get(), responsibilities.get());
 						//if (lambda > 0)
 						//	GaussianMixture_addCovarianceFraction (him.get(), icomponent, covg.get(), lambda);
-						GaussianMixture_TableOfReal_getComponentProbabilities (him.get(), thee, icomponent, probabilities.get());
+						GaussianMixture_TableOfReal_getComponentLogDensities (him.get(), thee, icomponent, logDensities.get());
 					} else {
 						/*
-							"Remove" the component from GaussianMixture, the probabilities and responsibilities
+							"Remove" the component from GaussianMixture, the densities and responsibilities
 						*/
 						if (numberOfNonzeroComponents > minimumNumberOfComponents) {
 							numberOfNonzeroComponents --;
-							probabilities.column (icomponent)  <<=  0.0;
+							logDensities.column (icomponent)  <<=  -INFINITY;
 							responsibilities.column (icomponent)  <<=  0.0;
 							MATnormalizeRows_inplace (responsibilities.get(), 1.0, 1.0); // Maintain invariant
 							if (info)
@@ -1048,7 +1178,7 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 				// L(theta,Y)=N/2 sum(m=1..k, log(n*mixingP [m]/12))+k/2log(n/12)+k/2(N+1)-loglikelihood reduces to:
 				// k/2 (N+1){log(n/12)+1}+N/2sum(m=1..k,mixingP [m]) - loglikelihood
 
-				lnew = GaussianMixture_getLikelihoodValue (him.get(), probabilities.get(), criterion);
+				lnew = GaussianMixture_getLikelihoodValue (him.get(), logDensities.get(), criterion);
 				if (info)
 					MelderInfo_writeLine (U"iter = ", iter, U", ML = ", lnew);
 			} while (lnew > lprev && fabs (lprev - lnew) > std::max (tolerance * fabs (lnew), NUMeps) && iter < maxNumberOfIterations);
@@ -1070,7 +1200,7 @@ autoGaussianMixture GaussianMixture_TableOfReal_to_GaussianMixture_CEMM (Gaussia
 				}
 				his mixingProbabilities [componentToDelete] = 0.0;
 				numberOfNonzeroComponents --;
-				probabilities.column (componentToDelete)  <<=  0.0;
+				logDensities.column (componentToDelete)  <<=  -INFINITY;
 				responsibilities.column (componentToDelete)  <<=  0.0;
 				MATnormalizeRows_inplace (responsibilities.get(), 1.0, 1.0); // Maintain invariant
 				if (info)
@@ -1266,4 +1396,94 @@ autoTable GaussianMixture_TableOfReal_to_Table_BHEPNormalityTests (GaussianMixtu
 	}
 }
 
+void test_GaussianMixture_blockedSteps () {
+	try {
+		const integer numberOfRows = 3000, dimension = 3, numberOfComponents = 2;
+		for (int istorage = 1; istorage <= 2; istorage ++) {
+			const kGaussianMixtureStorage storage = ( istorage == 1 ? kGaussianMixtureStorage::COMPLETE : kGaussianMixtureStorage::DIAGONALS );
+			autoTableOfReal table = TableOfReal_create (numberOfRows, dimension);
+			for (integer irow = 1; irow <= numberOfRows; irow ++)
+				for (integer j = 1; j <= dimension; j ++)
+					table -> data [irow] [j] = NUMrandomGauss (( irow % 2 == 0 ? 1.0 : -1.0 ) * j, 0.5 * j) + 0.3 * table -> data [irow] [1];
+			autoGaussianMixture gm = GaussianMixture_create (numberOfComponents, dimension, storage);
+			GaussianMixture_initialGuess (gm.get(), table.get());
+			/*
+				M-step: the blocked covariances should equal the direct sums of the weighted outer products.
+			*/
+			autoMAT responsibilities = raw_MAT (numberOfRows, numberOfComponents);
+			for (integer irow = 1; irow <= numberOfRows; irow ++) {
+				responsibilities [irow] [1] = NUMrandomUniform (0.0, 1.0);
+				responsibilities [irow] [2] = 1.0 - responsibilities [irow] [1];
+			}
+			for (integer component = 1; component <= numberOfComponents; component ++) {
+				GaussianMixture_updateComponent (gm.get(), component, table -> data.get(), responsibilities.get());
+				const Covariance cov = gm -> covariances->at [component];
+				longdouble totalResponsibility = 0.0;
+				autoVEC mean = zero_VEC (dimension);
+				for (integer irow = 1; irow <= numberOfRows; irow ++) {
+					totalResponsibility += responsibilities [irow] [component];
+					for (integer j = 1; j <= dimension; j ++)
+						mean [j] += responsibilities [irow] [component] * table -> data [irow] [j];
+				}
+				mean.get()  /=  double (totalResponsibility);
+				for (integer i = 1; i <= dimension; i ++) {
+					for (integer j = i; j <= dimension; j ++) {
+						if (cov -> numberOfRows == 1 && j != i)
+							continue;
+						longdouble sum = 0.0;
+						for (integer irow = 1; irow <= numberOfRows; irow ++)
+							sum += responsibilities [irow] [component] *
+									(table -> data [irow] [i] - mean [i]) * (table -> data [irow] [j] - mean [j]);
+						const double direct = double (sum / totalResponsibility);
+						const double blocked = ( cov -> numberOfRows == 1 ? cov -> data [1] [i] : cov -> data [i] [j] );
+						Melder_require (fabs (blocked - direct) <= 1e-12 * (1.0 + fabs (direct)),
+							U"Covariance ", i, U",", j, U" of component ", component, U" is ", blocked, U" instead of ", direct, U".");
+					}
+				}
+			}
+			/*
+				E-step: the responsibilities of points far from all centroids should not underflow.
+				They follow from the log densities ln (N) = -0.5 (d ln (2 pi) + ln |Sigma| + dsq).
+			*/
+			autoTableOfReal far = TableOfReal_create (4, dimension);
+			for (integer irow = 1; irow <= 4; irow ++)
+				for (integer j = 1; j <= dimension; j ++)
+					far -> data [irow] [j] = ( irow % 2 == 0 ? 1.0 : -1.0 ) * pow (10.0, irow) * j;
+			autoMAT farResponsibilities = raw_MAT (4, numberOfComponents);
+			GaussianMixture_TableOfReal_getResponsilities (gm.get(), far.get(), farResponsibilities.get());
+			for (integer irow = 1; irow <= 4; irow ++) {
+				double lnpp [1 + numberOfComponents], maximum = -INFINITY;
+				for (integer component = 1; component <= numberOfComponents; component ++) {
+					const Covariance cov = gm -> covariances->at [component];
+					SSCP_expandWithLowerCholeskyInverse (cov);
+					double dsq = 0.0;
+					if (cov -> numberOfRows == 1)
+						for (integer j = 1; j <= dimension; j ++)
+							dsq += sqr ((far -> data [irow] [j] - cov -> centroid [j]) / sqrt (cov -> data [1] [j]));
+					else
+						dsq = NUMmahalanobisDistanceSquared (cov -> lowerCholeskyInverse.get(), far -> data.row (irow), cov -> centroid.get());
+					lnpp [component] = log (gm -> mixingProbabilities [component]) - 0.5 * (dimension * log (NUM2pi) + cov -> lnd + dsq);
+					maximum = std::max (maximum, lnpp [component]);
+				}
+				Melder_require (exp (maximum) == 0.0 || irow < 3,
+					U"Row ", irow, U" is not far enough out to test underflow.");
+				double sum = 0.0;
+				for (integer component = 1; component <= numberOfComponents; component ++)
+					sum += exp (lnpp [component] - maximum);
+				for (integer component = 1; component <= numberOfComponents; component ++) {
+					const double expected = exp (lnpp [component] - maximum) / sum;
+					Melder_require (fabs (farResponsibilities [irow] [component] - expected) <= 1e-9,
+						U"Responsibility ", irow, U",", component, U" is ", farResponsibilities [irow] [component], U" instead of ", expected, U".");
+				}
+			}
+			const double lnp = GaussianMixture_TableOfReal_getLikelihoodValue (gm.get(), far.get(), kGaussianMixtureCriterion::LIKELIHOOD);
+			Melder_require (isdefined (lnp) && lnp < -1e6,
+				U"The likelihood of the far-out points is ", lnp, U".");
+		}
+		MelderInfo_writeLine (U"test_GaussianMixture_blockedSteps: OK");
+	} catch (MelderError) {
+		Melder_throw (U"GaussianMixture blocked steps test failed.");
+	}
+}
+
 /* End of file GaussianMixture.cpp 1555*/
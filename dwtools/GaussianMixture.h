@@ -79,6 +79,11 @@ void GaussianMixture_initialGuess (GaussianMixture me, TableOfReal thee);
 	Bishop (2007): Pattern recognition and machine learning, Springer page 25: Eq. 1.52
 */
 void GaussianMixture_TableOfReal_getComponentProbabilities (GaussianMixture me, TableOfReal thee, integer componentToUpdate, MAT const& probabilities);
+/*
+	The logarithms ln N(x|mu(k),Sigma(k)) of the component probabilities;
+	unlike the probabilities themselves, these do not underflow for points far from the centroids.
+*/
+void GaussianMixture_TableOfReal_getComponentLogDensities (GaussianMixture me, TableOfReal thee, integer componentToUpdate, MAT const& logDensities);
 autoTableOfReal GaussianMixture_TableOfReal_to_TableOfReal_probabilities (GaussianMixture me, TableOfReal thee);
 
 /*
@@ -158,4 +163,9 @@ void GaussianMixture_generateOneVector_inline (GaussianMixture me, VEC const& c,
 
 autoTableOfReal GaussianMixture_to_TableOfReal_randomSampling (GaussianMixture me, integer numberOfPoints);
 
+/*
+	Checks the blocked M-step against the direct sums, and the responsibilities of points far from all centroids.
+*/
+void test_GaussianMixture_blockedSteps ();
+
 #endif /* _GaussianMixture_h_ */
@@ -24,6 +24,7 @@
 #include "Index.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "HMM_def.h"
@@ -57,6 +58,7 @@ Thing_implement (HMMObservation, Daata, 0);
 Thing_implement (HMMObservationList, Ordered, 0);
 Thing_implement (HMMBaumWelch, Daata, 0);
 Thing_implement (HMMViterbi, Daata, 0);
+Thing_implement (HMMBeamViterbi, Daata, 0);
 Thing_implement (HMMObservationSequence, Table, 0);
 Thing_implement (HMMObservationSequenceBag, Collection, 0);
 Thing_implement (HMMStateSequence, Strings, 0);
@@ -80,6 +82,7 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 void HMMBaumWelch_getGamma (HMMBaumWelch me);
 autoHMMBaumWelch HMM_forward (HMM me, constINTVEC obs);
 void HMMBaumWelch_reInit (HMMBaumWelch me);
+void HMMBaumWelch_setModel (HMMBaumWelch me, HMM hmm);
 void HMM_HMMBaumWelch_getXi (HMM me, HMMBaumWelch thee, constINTVEC obs);
 void HMM_HMMBaumWelch_reestimate (HMM me, HMMBaumWelch thee);
 void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs);
@@ -225,17 +228,20 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 		my numberOfTimes = my capacity = capacity;
 		my numberOfStates = nstates;
 		my numberOfSymbols = nsymbols;
-		my alpha = zero_MAT (nstates, capacity);
-		my beta = zero_MAT (nstates, capacity);
+		my alpha = zero_MAT (capacity, nstates);
+		my beta = zero_MAT (capacity, nstates);
 		my scale = zero_VEC (capacity);
-		my xi = zero_TEN3 (capacity, nstates, nstates); // TEN3
+		my betaTimesEmission = zero_MAT (capacity, nstates);
+		my xiSum = zero_MAT (nstates, nstates);
+		my transitionProbs_transposed = zero_MAT (nstates, nstates);
+		my emissionProbs_transposed = zero_MAT (nsymbols, nstates);
 		my aij_num_p0 = zero_VEC (nstates + 1);
 		my aij_num = zero_MAT (nstates, nstates + 1);
 		my aij_denom_p0 = zero_VEC (nstates + 1);
 		my aij_denom =  zero_MAT (nstates, nstates + 1);
 		my bik_num = zero_MAT (nstates, nsymbols);
 		my bik_denom = zero_MAT (nstates, nsymbols);
-		my gamma = zero_MAT (nstates, capacity);
+		my gamma = zero_MAT (capacity, nstates);
 		return me;
 	} catch (MelderError) {
 		Melder_throw (U"HMMBaumWelch not created.");
@@ -244,11 +250,20 @@ autoHMMBaumWelch HMMBaumWelch_create (integer nstates, integer nsymbols, integer
 
 void HMMBaumWelch_getGamma (HMMBaumWelch me) {
 	for (integer it = 1; it <= my numberOfTimes; it ++) {
-		my gamma.column (it)  <<=  my alpha.column (it)  *  my beta.column (it);
-		my gamma.column (it)  /=  NUMsum (my gamma.column (it));
+		my gamma.row (it)  <<=  my alpha.row (it)  *  my beta.row (it);
+		my gamma.row (it)  /=  NUMsum (my gamma.row (it));
 	}
 }
 
+/*
+	To be called whenever the probabilities of the model have changed.
+*/
+void HMMBaumWelch_setModel (HMMBaumWelch me, HMM hmm) {
+	Melder_assert (my numberOfStates == hmm -> numberOfStates && my numberOfSymbols == hmm -> numberOfObservationSymbols);
+	my transitionProbs_transposed.all()  <<=  hmm -> transitionProbs.verticalBand (1, my numberOfStates).transpose();
+	my emissionProbs_transposed.all()  <<=  hmm -> emissionProbs.transpose();
+}
+
 /**************** HMMViterbi ******************************/
 
 autoHMMViterbi HMMViterbi_create (integer nstates, integer ntimes) {
@@ -265,6 +280,126 @@ autoHMMViterbi HMMViterbi_create (integer nstates, integer ntimes) {
 	}
 }
 
+autoHMMBeamViterbi HMMBeamViterbi_create (integer nstates, integer nsymbols, integer capacity, double beamWidth_log, integer maximumNumberOfActiveStates) {
+	try {
+		Melder_assert (beamWidth_log > 0.0);
+		autoHMMBeamViterbi me = Thing_new (HMMBeamViterbi);
+		my capacity = capacity;
+		my numberOfStates = nstates;
+		my numberOfSymbols = nsymbols;
+		my beamWidth_log = beamWidth_log;
+		my maximumNumberOfActiveStates = ( maximumNumberOfActiveStates > 0 ? std::min (maximumNumberOfActiveStates, nstates) : nstates );
+		my logInitialStateProbs = zero_VEC (nstates);
+		my logTransitionProbs = zero_MAT (nstates, nstates);
+		my logEmissionProbs_transposed = zero_MAT (nsymbols, nstates);
+		my previousScore = zero_VEC (nstates);
+		my score = zero_VEC (nstates);
+		my bestPredecessor = zero_INTVEC (nstates);
+		my candidates = newvectorzero <int32> (nstates);
+		my firstEntry = zero_INTVEC (capacity + 1);
+		my activeState = newvectorzero <int32> (capacity * my maximumNumberOfActiveStates);
+		my predecessorPosition = newvectorzero <int32> (capacity * my maximumNumberOfActiveStates);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"HMMBeamViterbi not created.");
+	}
+}
+
+void HMMBeamViterbi_setModel (HMMBeamViterbi me, HMM hmm) {
+	Melder_assert (my numberOfStates == hmm -> numberOfStates && my numberOfSymbols == hmm -> numberOfObservationSymbols);
+	for (integer is = 1; is <= my numberOfStates; is ++) {
+		my logInitialStateProbs [is] = log (hmm -> initialStateProbs [is]);   // p = 0 -> -INFINITY
+		for (integer js = 1; js <= my numberOfStates; js ++)
+			my logTransitionProbs [is] [js] = log (hmm -> transitionProbs [is] [js]);
+		for (integer k = 1; k <= my numberOfSymbols; k ++)
+			my logEmissionProbs_transposed [k] [is] = log (hmm -> emissionProbs [is] [k]);
+	}
+}
+
+/*
+	Keep the states whose score is within the beam of the best score (at most maximumNumberOfActiveStates of them)
+	and store them as the active states at time it.
+	Returns false if no state can be reached at all.
+*/
+static bool HMMBeamViterbi_pruneAndStore (HMMBeamViterbi me, integer it) {
+	double bestScore = -INFINITY;
+	for (integer is = 1; is <= my numberOfStates; is ++)
+		if (my score [is] > bestScore)
+			bestScore = my score [is];
+	if (bestScore == -INFINITY)
+		return false;
+	const double threshold = bestScore - my beamWidth_log;
+	integer numberOfCandidates = 0;
+	for (integer is = 1; is <= my numberOfStates; is ++)
+		if (my score [is] >= threshold)
+			my candidates [++ numberOfCandidates] = int32 (is);
+	if (numberOfCandidates > my maximumNumberOfActiveStates) {
+		int32 *const first = & my candidates [1];
+		std::nth_element (first, first + my maximumNumberOfActiveStates - 1, first + numberOfCandidates,
+			[me] (int32 state1, int32 state2) { return my score [state1] > my score [state2]; });
+		numberOfCandidates = my maximumNumberOfActiveStates;
+		std::sort (first, first + numberOfCandidates);   // in state order, so that ties are resolved as without pruning
+	}
+	const integer entry = my firstEntry [it];
+	for (integer icandidate = 1; icandidate <= numberOfCandidates; icandidate ++) {
+		const int32 state = my candidates [icandidate];
+		my activeState [entry + icandidate - 1] = state;
+		my predecessorPosition [entry + icandidate - 1] = ( it > 1 ? int32 (my bestPredecessor [state]) : 0 );
+	}
+	my firstEntry [it + 1] = entry + numberOfCandidates;
+	return true;
+}
+
+double HMMBeamViterbi_decode (HMMBeamViterbi me, constINTVEC const& obs, INTVEC const& out_path) {
+	const integer numberOfTimes = obs.size;
+	Melder_assert (numberOfTimes >= 1 && numberOfTimes <= my capacity);
+	Melder_assert (out_path.size == numberOfTimes);
+	/*
+		Work with logarithms so that long sequences do not underflow.
+		Only transitions from the active states of the previous time are explored.
+	*/
+	my firstEntry [1] = 1;
+	my score.all()  <<=  my logInitialStateProbs.all();
+	my score.all()  +=  my logEmissionProbs_transposed.row (obs [1]);
+	if (! HMMBeamViterbi_pruneAndStore (me, 1))
+		return undefined;
+	for (integer it = 2; it <= numberOfTimes; it ++) {
+		std::swap (my score, my previousScore);
+		my score.all()  <<=  -INFINITY;
+		const integer firstEntryOfPrevious = my firstEntry [it - 1];
+		for (integer entry = firstEntryOfPrevious; entry < my firstEntry [it]; entry ++) {
+			const integer state = my activeState [entry];
+			const double scoreOfPredecessor = my previousScore [state];
+			constVEC const logTransitionProbs = my logTransitionProbs.row (state);
+			for (integer is = 1; is <= my numberOfStates; is ++) {
+				const double candidateScore = scoreOfPredecessor + logTransitionProbs [is];
+				if (candidateScore > my score [is]) {
+					my score [is] = candidateScore;
+					my bestPredecessor [is] = entry - firstEntryOfPrevious + 1;
+				}
+			}
+		}
+		my score.all()  +=  my logEmissionProbs_transposed.row (obs [it]);
+		if (! HMMBeamViterbi_pruneAndStore (me, it))
+			return undefined;
+	}
+	/*
+		The path ends in the active state with the best score; trace back.
+	*/
+	integer bestEntry = my firstEntry [numberOfTimes];
+	for (integer entry = bestEntry + 1; entry < my firstEntry [numberOfTimes + 1]; entry ++)
+		if (my score [my activeState [entry]] > my score [my activeState [bestEntry]])
+			bestEntry = entry;
+	const double lnp = my score [my activeState [bestEntry]];
+	integer entry = bestEntry;
+	for (integer it = numberOfTimes; it >= 1; it --) {
+		out_path [it] = my activeState [entry];
+		if (it > 1)
+			entry = my firstEntry [it - 1] + my predecessorPosition [entry] - 1;
+	}
+	return lnp;
+}
+
 /******************* HMMObservationSequence & HMMStateSequence ***/
 
 autoHMMObservationSequence HMMObservationSequence_create (integer numberOfItems, integer dataLength) {
@@ -788,6 +923,7 @@ autoHMMObservationSequence HMM_to_HMMObservationSequence (HMM me, integer startS
 autoHMMBaumWelch HMM_forward (HMM me, constINTVEC obs) {
 	try {
 		autoHMMBaumWelch thee = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, obs.size);
+		HMMBaumWelch_setModel (thee.get(), me);
 		HMM_HMMBaumWelch_forward (me, thee.get(), obs);
 		return thee;
 	} catch (MelderError) {
@@ -812,7 +948,7 @@ void HMMBaumWelch_reInit (HMMBaumWelch me) {
 	/*
 		The _num and _denum matrices are assigned as += in the iteration loop and therefore need to be zeroed
 		at the start of each new iteration.
-		The elements of alpha, beta, scale, gamma & xi are always calculated directly and need not be
+		The elements of alpha, beta, scale, gamma & xiSum are always calculated directly and need not be
 		initialised.
 	*/
 	my aij_num_p0.all()  <<=  0.0;
@@ -923,55 +1059,113 @@ static void HMM_HMMObservationSequenceBag_learn_notHidden (HMM me, HMMObservatio
 }
 
 
-void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info) {
+static void HMMBaumWelch_addAccumulators (HMMBaumWelch me, HMMBaumWelch thee) {
+	my totalNumberOfSequences += thy totalNumberOfSequences;
+	my lnProb += thy lnProb;
+	my aij_num_p0.all()  +=  thy aij_num_p0.all();
+	my aij_num.all()  +=  thy aij_num.all();
+	my aij_denom_p0.all()  +=  thy aij_denom_p0.all();
+	my aij_denom.all()  +=  thy aij_denom.all();
+	my bik_num.all()  +=  thy bik_num.all();
+	my bik_denom.all()  +=  thy bik_denom.all();
+}
+
+static void HMM_HMMObservationSequenceBag_learn_ (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info,
+	integer maximumNumberOfThreads)
+{
 	try {
 		if (my notHidden) {
 			// For a not hidden markov model there is an analytical solution for the state transition probabilities
 			HMM_HMMObservationSequenceBag_learn_notHidden (me, thee, minProb);
 			return;
 		}
-		// act as if all observation sequences are in memory
-		const integer capacity = HMMObservationSequenceBag_getLongestSequence (thee);
-		autoHMMBaumWelch bw = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
-		bw -> minProb = minProb;
+		/*
+			Translate the observations into symbol numbers once.
+			Interpretation of unknowns: end of sequence. Every stretch of known symbols is trained as a separate sequence.
+		*/
+		OrderedOf <structStringsIndex> symbolNumbers;
+		std::vector <constINTVEC> sequences;
+		integer capacity = 0, totalLength = 0;
+		for (integer iseq = 1; iseq <= thy size; iseq ++) {
+			autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, thy at [iseq]);
+			constINTVEC const obs = si -> classIndex.get();
+			const integer nobs = si -> numberOfItems; // convenience
+			integer istart = 1;
+			while (istart <= nobs) {
+				while (istart <= nobs && obs [istart] == 0)
+					istart ++;
+				if (istart > nobs)
+					break;
+				integer iend = istart + 1;
+				while (iend <= nobs && obs [iend] != 0)
+					iend ++;
+				iend --;
+				sequences.push_back (obs.part (istart, iend));
+				capacity = std::max (capacity, iend - istart + 1);
+				totalLength += iend - istart + 1;
+				istart = iend + 1;
+			}
+			symbolNumbers.addItem_move (si.move());
+		}
+		const integer numberOfSequences = uinteger_to_integer (sequences.size());
+		Melder_require (numberOfSequences > 0,
+			U"There should be at least one known observation.");
+		/*
+			The sequences are divided over the threads in consecutive chunks of about equal total length.
+			Each thread accumulates its own statistics in its own workspace; these are added in a fixed order,
+			so that the result does not depend on the timing of the threads.
+		*/
+		integer numberOfThreads = std::min (maximumNumberOfThreads, std::min (numberOfSequences, totalLength / 1000 + 1));
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		autoINTVEC firstSequence = raw_INTVEC (numberOfThreads + 1);
+		{// scope
+			integer ithread = 1, cumulativeLength = 0;
+			firstSequence [1] = 1;
+			for (integer iseq = 1; iseq <= numberOfSequences; iseq ++) {
+				cumulativeLength += sequences [integer_to_uinteger (iseq - 1)].size;
+				if (ithread < numberOfThreads && cumulativeLength * numberOfThreads >= ithread * totalLength)
+					firstSequence [++ ithread] = iseq + 1;
+			}
+			while (ithread < numberOfThreads)
+				firstSequence [++ ithread] = numberOfSequences + 1;
+			firstSequence [numberOfThreads + 1] = numberOfSequences + 1;
+		}
+		OrderedOf <structHMMBaumWelch> workspaces;
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoHMMBaumWelch workspace = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
+			workspace -> minProb = minProb;
+			workspaces.addItem_move (workspace.move());
+		}
+		HMMBaumWelch bw = workspaces.at [1];   // receives the sum of the statistics
+		auto addEstimates = [&] (integer ithread) {
+			HMMBaumWelch workspace = workspaces.at [ithread];
+			for (integer iseq = firstSequence [ithread]; iseq < firstSequence [ithread + 1]; iseq ++) {
+				constINTVEC const obs = sequences [integer_to_uinteger (iseq - 1)];
+				workspace -> numberOfTimes = obs.size;
+				workspace -> totalNumberOfSequences ++;
+				HMM_HMMBaumWelch_forward (me, workspace, obs); // get new alphas
+				HMM_HMMBaumWelch_backward (me, workspace, obs); // get new betas
+				HMMBaumWelch_getGamma (workspace);
+				HMM_HMMBaumWelch_getXi (me, workspace, obs);
+				HMM_HMMBaumWelch_addEstimate (me, workspace, obs);
+			}
+		};
 		if (info)
 			MelderInfo_open (); 
 		integer iter = 0;
 		double lnp;
 		do {
 			lnp = bw -> lnProb;
-			HMMBaumWelch_reInit (bw.get());
-			for (integer iseq = 1; iseq <= thy size; iseq ++) {
-				const HMMObservationSequence hmm_os = thy at [iseq];
-				autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, hmm_os); // TODO outside the loop or more efficiently
-				INTVEC obs = si -> classIndex.get();
-				const integer nobs = si -> numberOfItems; // convenience
-
-				// Interpretation of unknowns: end of sequence
-
-				integer istart = 1, iend = nobs;
-				while (istart <= nobs) {
-					while (istart <= nobs && obs [istart] == 0)
-						istart ++;
-					if (istart > nobs) break;
-
-					iend = istart + 1;
-					while (iend <= nobs && obs [iend] != 0)
-						iend ++;
-					iend --;
-					bw -> numberOfTimes = iend - istart + 1;
-					bw -> totalNumberOfSequences ++;
-					HMM_HMMBaumWelch_forward (me, bw.get(), obs.part (istart, nobs)); // get new alphas
-					HMM_HMMBaumWelch_backward (me, bw.get(), obs.part (istart, nobs)); // get new betas
-					HMMBaumWelch_getGamma (bw.get());
-					HMM_HMMBaumWelch_getXi (me, bw.get(), obs.part (istart, nobs));
-					HMM_HMMBaumWelch_addEstimate (me, bw.get(), obs.part (istart, nobs));
-					istart = iend + 1;
-				}
+			for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
+				HMMBaumWelch_reInit (workspaces.at [ithread]);
+				HMMBaumWelch_setModel (workspaces.at [ithread], me);
 			}
+			MelderThread_run (numberOfThreads, addEstimates);
+			for (integer ithread = 2; ithread <= numberOfThreads; ithread ++)
+				HMMBaumWelch_addAccumulators (bw, workspaces.at [ithread]);
 			// we have processed all observation sequences, now it is time to estimate new probabilities.
 			iter ++;
-			HMM_HMMBaumWelch_reestimate (me, bw.get());
+			HMM_HMMBaumWelch_reestimate (me, bw);
 			if (info)
 				MelderInfo_writeLine (U"Iteration: ", iter, U" ln(prob): ", bw -> lnProb);
 		} while (fabs (lnp - bw -> lnProb) > std::max (fabs (delta_lnp * bw -> lnProb), NUMeps));
@@ -988,6 +1182,139 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 	}
 }
 
+void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info) {
+	HMM_HMMObservationSequenceBag_learn_ (me, thee, delta_lnp, minProb, info, MelderThread_getNumberOfProcessors ());
+}
+
+/*
+	Learning on several threads should give the same model as learning on one thread,
+	up to the rounding errors of adding the statistics of the threads in a different grouping.
+*/
+void test_HMM_HMMObservationSequenceBag_learn () {
+	try {
+		const autoMAT transitionProbs { { 0.8, 0.15, 0.05 }, { 0.1, 0.7, 0.2 }, { 0.25, 0.05, 0.7 } };
+		const autoMAT emissionProbs { { 0.6, 0.2, 0.1, 0.1 }, { 0.1, 0.5, 0.3, 0.1 }, { 0.05, 0.15, 0.2, 0.6 } };
+		autoHMM hmm = HMM_create (0, 3, 4);
+		for (integer istate = 1; istate <= 3; istate ++) {
+			HMM_setTransitionProbabilities (hmm.get(), istate, transitionProbs.row (istate));
+			HMM_setEmissionProbabilities (hmm.get(), istate, emissionProbs.row (istate));
+		}
+		const integer numberOfSequences = 12;
+		OrderedOf <structHMMObservationSequence> sequences;
+		for (integer iseq = 1; iseq <= numberOfSequences; iseq ++)
+			sequences. addItem_move (HMM_to_HMMObservationSequence (hmm.get(), 0, 500 + 100 * iseq));
+		autoHMM start = HMM_create (0, 3, 4);   // uniform transition probabilities
+		HMM_setEmissionProbabilities (start.get(), 1, emissionProbs.row (2));
+		HMM_setEmissionProbabilities (start.get(), 3, emissionProbs.row (1));
+		autoHMM learnedOnOneThread = Data_copy (start.get());
+		HMM_HMMObservationSequenceBag_learn_ (learnedOnOneThread.get(), (HMMObservationSequenceBag) & sequences, 1e-6, 1e-10, 0, 1);
+		for (integer numberOfThreads = 2; numberOfThreads <= 5; numberOfThreads ++) {
+			autoHMM learned = Data_copy (start.get());
+			HMM_HMMObservationSequenceBag_learn_ (learned.get(), (HMMObservationSequenceBag) & sequences, 1e-6, 1e-10, 0, numberOfThreads);
+			for (integer istate = 1; istate <= learned -> numberOfStates; istate ++) {
+				for (integer jstate = 1; jstate <= learned -> transitionProbs.ncol; jstate ++)
+					Melder_require (fabs (learned -> transitionProbs [istate] [jstate] - learnedOnOneThread -> transitionProbs [istate] [jstate]) <= 1e-9,
+						numberOfThreads, U" threads: transition probability [", istate, U"] [", jstate, U"] is ",
+						learned -> transitionProbs [istate] [jstate], U" instead of ", learnedOnOneThread -> transitionProbs [istate] [jstate], U".");
+				for (integer isymbol = 1; isymbol <= learned -> numberOfObservationSymbols; isymbol ++)
+					Melder_require (fabs (learned -> emissionProbs [istate] [isymbol] - learnedOnOneThread -> emissionProbs [istate] [isymbol]) <= 1e-9,
+						numberOfThreads, U" threads: emission probability [", istate, U"] [", isymbol, U"] is ",
+						learned -> emissionProbs [istate] [isymbol], U" instead of ", learnedOnOneThread -> emissionProbs [istate] [isymbol], U".");
+			}
+		}
+		MelderInfo_writeLine (U"test_HMM_HMMObservationSequenceBag_learn: OK");
+	} catch (MelderError) {
+		Melder_throw (U"HMM multi-threaded learning test failed.");
+	}
+}
+
+autoTable HMM_HMMObservationSequenceBag_decode (HMM me, HMMObservationSequenceBag thee, double beamWidth_log,
+	integer maximumNumberOfActiveStates, OrderedOf <structHMMStateSequence> *out_stateSequences)
+{
+	try {
+		Melder_require (beamWidth_log > 0.0,
+			U"The beam width should be positive.");
+		/*
+			Translate all observations into symbol numbers first; the paths of all sequences share one vector.
+		*/
+		const integer numberOfSequences = thy size;
+		OrderedOf <structStringsIndex> symbolNumbers;
+		autoINTVEC firstTime = raw_INTVEC (numberOfSequences + 1);
+		integer capacity = 0, totalLength = 0;
+		firstTime [1] = 1;
+		for (integer iseq = 1; iseq <= numberOfSequences; iseq ++) {
+			autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, thy at [iseq]);
+			const integer numberOfUnknowns = StringsIndex_countItems (si.get(), 0);
+			Melder_require (si -> numberOfItems > 0,
+				thy at [iseq], U": there are no observations.");
+			Melder_require (numberOfUnknowns == 0,
+				thy at [iseq], U": unknown observation symbol(s) (# = ", numberOfUnknowns, U").");
+			capacity = std::max (capacity, si -> numberOfItems);
+			totalLength += si -> numberOfItems;
+			firstTime [iseq + 1] = firstTime [iseq] + si -> numberOfItems;
+			symbolNumbers.addItem_move (si.move());
+		}
+		autoINTVEC paths = raw_INTVEC (totalLength);
+		autoVEC lnp = raw_VEC (numberOfSequences);
+		/*
+			As in learning, the threads get consecutive chunks of sequences of about equal total length,
+			and each thread has its own workspace.
+		*/
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (),
+				std::min (numberOfSequences, totalLength / 1000 + 1));
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		autoINTVEC firstSequence = raw_INTVEC (numberOfThreads + 1);
+		{// scope
+			integer ithread = 1;
+			firstSequence [1] = 1;
+			for (integer iseq = 1; iseq <= numberOfSequences; iseq ++)
+				if (ithread < numberOfThreads && (firstTime [iseq + 1] - 1) * numberOfThreads >= ithread * totalLength)
+					firstSequence [++ ithread] = iseq + 1;
+			while (ithread < numberOfThreads)
+				firstSequence [++ ithread] = numberOfSequences + 1;
+			firstSequence [numberOfThreads + 1] = numberOfSequences + 1;
+		}
+		OrderedOf <structHMMBeamViterbi> workspaces;
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoHMMBeamViterbi workspace = HMMBeamViterbi_create (my numberOfStates, my numberOfObservationSymbols,
+					capacity, beamWidth_log, maximumNumberOfActiveStates);
+			HMMBeamViterbi_setModel (workspace.get(), me);
+			workspaces.addItem_move (workspace.move());
+		}
+		auto decode = [&] (integer ithread) {
+			HMMBeamViterbi workspace = workspaces.at [ithread];
+			for (integer iseq = firstSequence [ithread]; iseq < firstSequence [ithread + 1]; iseq ++)
+				lnp [iseq] = HMMBeamViterbi_decode (workspace, symbolNumbers.at [iseq] -> classIndex.get(),
+						paths.part (firstTime [iseq], firstTime [iseq + 1] - 1));
+		};
+		MelderThread_run (numberOfThreads, decode);
+		/*
+			Convert the paths to state sequences.
+		*/
+		const conststring32 columnNames [] = { U"sequence", U"length", U"lnp" };
+		autoTable table = Table_createWithColumnNames (numberOfSequences, ARRAY_TO_STRVEC (columnNames));
+		for (integer iseq = 1; iseq <= numberOfSequences; iseq ++) {
+			Melder_require (isdefined (lnp [iseq]),
+				thy at [iseq], U": the observations cannot be generated by the model.");
+			const integer numberOfTimes = firstTime [iseq + 1] - firstTime [iseq];
+			autoHMMStateSequence stateSequence = HMMStateSequence_create (numberOfTimes);
+			for (integer it = 1; it <= numberOfTimes; it ++) {
+				const HMMState hmms = my states->at [paths [firstTime [iseq] + it - 1]];
+				stateSequence -> strings [it] = Melder_dup (hmms -> label.get());
+				stateSequence -> numberOfStrings ++;
+			}
+			Table_setStringValue (table.get(), iseq, 1, thy at [iseq] -> name ? thy at [iseq] -> name.get() : U"");
+			Table_setNumericValue (table.get(), iseq, 2, numberOfTimes);
+			Table_setNumericValue (table.get(), iseq, 3, lnp [iseq]);
+			if (out_stateSequences)
+				out_stateSequences -> addItem_move (stateSequence.move());
+		}
+		return table;
+	} catch (MelderError) {
+		Melder_throw (me, U" & ", thee, U": not decoded.");
+	}
+}
+
 
 // xc1 < xc2
 void HMM_HMMStateSequence_drawTrellis (HMM me, HMMStateSequence thee, Graphics g, bool connect, bool garnish) {
@@ -1193,20 +1520,30 @@ void HMM_drawForwardAndBackwardProbabilitiesIllustration (Graphics g, bool garni
 	}
 }
 
+/*
+	xi [t] [i] [j] = alpha [t] [i] a [i] [j] b [j] (o [t+1]) beta [t+1] [j] / norm [t], normalised to a sum of 1 over i and j.
+	Because sum (j, a [i] [j] b [j] (o [t+1]) beta [t+1] [j]) = scale [t] beta [t] [i], we have
+		norm [t] = scale [t] sum (i, alpha [t] [i] beta [t] [i]).
+	Only the sum over t is needed; this is a [i] [j] times element [i] [j] of the matrix product
+		sum (t, (alpha [t] / norm [t])' (beta [t+1] b (o [t+1]))).
+	Precondition: HMMBaumWelch_getGamma has been called (alpha is overwritten).
+*/
 void HMM_HMMBaumWelch_getXi (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	Melder_assert (obs.size == thy numberOfTimes);
-	for (integer it = 1; it <= thy numberOfTimes - 1; it ++) {
-		longdouble sum = 0.0;
-		MATVU xi_it = thy xi [it];
-		for (integer is = 1; is <= thy numberOfStates; is ++) {
-			for (integer js = 1; js <= thy numberOfStates; js ++) {
-				xi_it [is] [js] = thy alpha [is] [it] * thy beta [js] [it + 1] *
-					my transitionProbs [is] [js] * my emissionProbs [js] [ obs [it + 1] ];
-				sum += xi_it [is] [js];
-			}
-		}
-		xi_it  /=  double (sum);
+	const integer numberOfTimes = thy numberOfTimes;
+	if (numberOfTimes < 2) {
+		thy xiSum.all()  <<=  0.0;
+		return;
+	}
+	for (integer it = 1; it <= numberOfTimes - 1; it ++) {
+		const double norm = thy scale [it] * NUMinner (thy alpha.row (it), thy beta.row (it));
+		thy alpha.row (it)  /=  norm;
 	}
+	mul_MAT_out (thy xiSum.get(), thy alpha.horizontalBand (1, numberOfTimes - 1).transpose(),
+			thy betaTimesEmission.horizontalBand (2, numberOfTimes));
+	for (integer is = 1; is <= my numberOfStates; is ++)
+		for (integer js = 1; js <= my numberOfStates; js ++)
+			thy xiSum [is] [js] *= my transitionProbs [is] [js];
 }
 
 void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
@@ -1214,21 +1551,18 @@ void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	for (integer is = 1; is <= my numberOfStates; is ++) {
 		// only for valid start states with p > 0
 		if (my initialStateProbs [is] > 0.0) {
-			thy aij_num_p0 [is] += thy gamma [is] [1];
+			thy aij_num_p0 [is] += thy gamma [1] [is];
 			thy aij_denom_p0 [is] += 1.0;
 		}
 	}
 
 	for (integer is = 1; is <= my numberOfStates; is ++) {
-		double gammasum = NUMsum (thy gamma.row (is).part (1, thy numberOfTimes - 1));
+		double gammasum = NUMsum (thy gamma.column (is).part (1, thy numberOfTimes - 1));
 
 		for (integer js = 1; js <= my numberOfStates; js ++) {
-			longdouble xisum = 0.0;
-			for (integer it = 1; it <= thy numberOfTimes - 1; it ++)
-				xisum += thy xi [it] [is] [js];
 			// zero probs signal invalid connections, don't reestimate
 			if (my transitionProbs [is] [js] > 0.0) {
-				thy aij_num [is] [js] += double (xisum);
+				thy aij_num [is] [js] += thy xiSum [is] [js];
 				thy aij_denom [is] [js] += gammasum;
 			}
 		}
@@ -1238,25 +1572,24 @@ void HMM_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 			A not hidden model is emulated with fixed emissionProbs.
 		*/
 		if (! my notHidden) {
-			gammasum += thy gamma [is] [thy numberOfTimes];   // now sum all, add last term
-			for (integer k = 1; k <= my numberOfObservationSymbols; k ++) {
-				longdouble gammasum_k = 0.0;
-				for (integer it = 1; it <= thy numberOfTimes; it ++)
-					if (obs [it] == k)
-						gammasum_k += thy gamma [is] [it];
+			gammasum += thy gamma [thy numberOfTimes] [is];   // now sum all, add last term
+			for (integer k = 1; k <= my numberOfObservationSymbols; k ++)
 				// only reestimate probs > 0 !
-				if (my emissionProbs [is] [k] > 0.0) {
-					thy bik_num [is] [k] += double (gammasum_k);
+				if (my emissionProbs [is] [k] > 0.0)
 					thy bik_denom [is] [k] += gammasum;
-				}
-			}
 		}
 		// For a left-to-right model the final state determines the transition prob to go to the END state
 		if (my leftToRight) {
-			thy aij_num [is] [my numberOfStates + 1] += thy gamma [is] [thy numberOfTimes];
+			thy aij_num [is] [my numberOfStates + 1] += thy gamma [thy numberOfTimes] [is];
 			thy aij_denom [is] [my numberOfStates + 1] += 1.0;
 		}
 	}
+	/*
+		The numerators of the emission probabilities are only used where the emission probability is positive.
+	*/
+	if (! my notHidden)
+		for (integer it = 1; it <= thy numberOfTimes; it ++)
+			thy bik_num.column (obs [it])  +=  thy gamma.row (it);
 }
 
 void HMM_HMMBaumWelch_reestimate (HMM me, HMMBaumWelch thee) {
@@ -1301,28 +1634,26 @@ void HMM_HMMBaumWelch_reestimate (HMM me, HMMBaumWelch thee) {
 	}
 }
 
+/*
+	The recursions as matrix-vector products (Rabiner 1989, formulas 19-20 and 24-25, with scaling):
+		alpha [t] = (a' alpha [t-1]) * b (o [t]) / scale [t]
+		beta [t] = a (beta [t+1] * b (o [t+1])) / scale [t]
+	where a is the matrix of transition probabilities and * is element-wise multiplication.
+	The scaling keeps the numbers within range; ln (p) is the sum of the logarithms of the scale factors.
+	Precondition: HMMBaumWelch_setModel has been called.
+*/
 void HMM_HMMBaumWelch_forward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	// initialise at t = 1 & scale
-	for (integer js = 1; js <= my numberOfStates; js ++)
-		thy alpha [js] [1] = my initialStateProbs [js] * my emissionProbs [js] [obs [1]];
-	thy scale [1] = NUMsum (thy alpha.column (1));
-	thy alpha.column (1) /= thy scale [1];
+	thy alpha.row (1)  <<=  my initialStateProbs.all()  *  thy emissionProbs_transposed.row (obs [1]);
+	thy scale [1] = NUMsum (thy alpha.row (1));
+	thy alpha.row (1)  /=  thy scale [1];
 	// recursion
 	for (integer it = 2; it <= thy numberOfTimes; it ++) {
-		thy scale [it] = 0.0;
-		for (integer js = 1; js <= my numberOfStates; js ++) {
-			double sum = 0.0;
-			for (integer is = 1; is <= my numberOfStates; is ++) {
-				sum += thy alpha [is] [it - 1] * my transitionProbs [is] [js];
-			}
-
-			thy alpha [js] [it] = sum * my emissionProbs [js] [obs [it]];
-			thy scale [it] += thy alpha [js] [it];
-		}
-
-		for (integer js = 1; js <= my numberOfStates; js ++) {
-			thy alpha [js] [it] /= thy scale [it];
-		}
+		VEC const alpha_it = thy alpha.row (it);
+		mul_VEC_out (alpha_it, thy transitionProbs_transposed.get(), thy alpha.row (it - 1));
+		alpha_it  *=  thy emissionProbs_transposed.row (obs [it]);
+		thy scale [it] = NUMsum (alpha_it);
+		alpha_it  /=  thy scale [it];
 	}
 
 	for (integer it = 1; it <= thy numberOfTimes; it ++) {
@@ -1332,17 +1663,13 @@ void HMM_HMMBaumWelch_forward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 
 void HMM_HMMBaumWelch_backward (HMM me, HMMBaumWelch thee, constINTVEC obs) {
 	Melder_assert (obs.size == thy numberOfTimes);
-	for (integer is = 1; is <= my numberOfStates; is ++) {
-		thy beta [is] [thy numberOfTimes] = 1.0 / thy scale [thy numberOfTimes];
-	}
+	constMATVU const transitionProbs = my transitionProbs.verticalBand (1, my numberOfStates);
+	thy beta.row (thy numberOfTimes)  <<=  1.0 / thy scale [thy numberOfTimes];
 	for (integer it = thy numberOfTimes - 1; it >= 1; it --) {
-		for (integer is = 1; is <= my numberOfStates; is ++) {
-			longdouble sum = 0.0;
-			for (integer js = 1; js <= my numberOfStates; js ++) {
-				sum += thy beta [js] [it + 1] * my transitionProbs [is] [js] * my emissionProbs [js] [obs [it + 1]];
-			}
-			thy beta [is] [it] = double (sum) / thy scale [it];
-		}
+		VEC const betaTimesEmission = thy betaTimesEmission.row (it + 1);
+		betaTimesEmission  <<=  thy beta.row (it + 1)  *  thy emissionProbs_transposed.row (obs [it + 1]);
+		mul_VEC_out (thy beta.row (it), transitionProbs, betaTimesEmission);
+		thy beta.row (it)  /=  thy scale [it];
 	}
 }
 
@@ -53,11 +53,21 @@ Thing_define (HMMBaumWelch, Daata) {
 	integer numberOfSymbols;
 	double lnProb;
 	double minProb;
+	/*
+		The scaled forward and backward probabilities and the state probabilities,
+		with one row per time, so that each time step is a contiguous vector.
+	*/
 	autoMAT alpha;
 	autoMAT beta;
 	autoVEC scale;
 	autoMAT gamma;
-	autoTEN3 xi;
+	autoMAT betaTimesEmission;   // beta [t] [j] * b [j] (o [t])
+	autoMAT xiSum;   // sum over t of xi [t] [i] [j]
+	/*
+		Copies of the model's probabilities in the order in which the recursions need them.
+	*/
+	autoMAT transitionProbs_transposed;
+	autoMAT emissionProbs_transposed;
 	autoVEC aij_num_p0;
 	autoMAT aij_num;
 	autoVEC aij_denom_p0;
@@ -66,6 +76,37 @@ Thing_define (HMMBaumWelch, Daata) {
 	autoMAT bik_denom;
 };
 
+/********** class HMMBeamViterbi **********/
+
+Thing_define (HMMBeamViterbi, Daata) {
+	integer capacity;
+	integer numberOfStates;
+	integer numberOfSymbols;
+	integer maximumNumberOfActiveStates;
+	double beamWidth_log;
+	/*
+		The model's probabilities as logarithms, in the order in which the recursion needs them.
+	*/
+	autoVEC logInitialStateProbs;
+	autoMAT logTransitionProbs;
+	autoMAT logEmissionProbs_transposed;
+	/*
+		The scores of the states at the previous and the current time (only the active states have valid scores).
+	*/
+	autoVEC previousScore;
+	autoVEC score;
+	autoINTVEC bestPredecessor;
+	autovector <int32> candidates;
+	/*
+		Compact back-pointers: for each time only the active states are stored, each with the position
+		of its best predecessor in the list of active states of the previous time.
+		The entries for time t are at firstEntry [t] .. firstEntry [t + 1] - 1.
+	*/
+	autoINTVEC firstEntry;
+	autovector <int32> activeState;
+	autovector <int32> predecessorPosition;
+};
+
 Thing_define (HMMStateSequence, Strings) {
 };
 
@@ -184,6 +225,15 @@ double HMM_HMMStateSequence_getProbability (HMM me, HMMStateSequence thee);
 
 void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info);
 
+void test_HMM_HMMObservationSequenceBag_learn ();
+
+/*
+	Decodes each of the observation sequences with a beam-pruned Viterbi search, several sequences at the same time.
+	The state sequences are returned in out_stateSequences, the log probabilities of their paths in the table.
+*/
+autoTable HMM_HMMObservationSequenceBag_decode (HMM me, HMMObservationSequenceBag thee, double beamWidth_log,
+	integer maximumNumberOfActiveStates, OrderedOf <structHMMStateSequence> *out_stateSequences);
+
 void HMM_HMMStateSequence_drawTrellis (HMM me, HMMStateSequence thee, Graphics g, bool connect, bool garnish);
 
 double HMM_HMMObservationSequence_getProbability (HMM me, HMMObservationSequence thee);
@@ -36,6 +36,7 @@
 #include "Proximity_and_Distance.h"
 #include "SSCP.h"
 #include "PCA.h"
+#include "MelderThread.h"
 
 #include "enums_getText.h"
 #undef _MDS_enums_h_
@@ -1159,39 +1160,93 @@ autoDissimilarityList DistanceList_to_DissimilarityList (DistanceList me) {
 
 /*****************  Kruskal *****************************************/
 
-static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance disp, Weight weight, constMAT vplus) {
+/*
+	The Guttman transform X = V+ B(Z) Z (eq. 8.29), with B(Z) as in eq. 8.25.
+	Because the rows of B(Z) sum to zero, row i of B(Z) Z equals sum (j != i, b [i] [j] (z [j] - z [i])),
+	so that B(Z) need not be stored and the transform costs O(n^2) instead of O(n^4) operations.
+	If all the weights are equal to w, V+ equals (I - 11'/n) / (n w), and because the columns of B(Z) Z
+	sum to zero, V+ B(Z) Z equals B(Z) Z / (n w).
+	The rows are divided over the threads; each row is computed in the same order whatever the number of threads.
+*/
+static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance distZ, Distance disp, Weight weight,
+	constMAT const& vplus, double uniformWeight, MAT const& bz, integer numberOfThreads)
+{
 	const integer nPoints = cx -> numberOfRows, nDimensions = cx -> numberOfColumns;
+	const integer numberOfRowsPerThread = (nPoints - 1) / numberOfThreads + 1;
+	auto doRowsInParallel = [&] (auto const& doRows) {
+		auto doPart = [&] (integer ithread) {
+			const integer fromRow = (ithread - 1) * numberOfRowsPerThread + 1;
+			const integer toRow = std::min (ithread * numberOfRowsPerThread, nPoints);
+			if (fromRow <= toRow)
+				doRows (fromRow, toRow);
+		};
+		MelderThread_run (numberOfThreads, doPart);
+	};
+	const double scale = ( isdefined (uniformWeight) ? 1.0 / (nPoints * uniformWeight) : 1.0 );
+	MAT const bzTarget = ( isdefined (uniformWeight) ? cx -> data.get() : bz );
+	doRowsInParallel ([&] (integer fromRow, integer toRow) {
+		for (integer i = fromRow; i <= toRow; i ++) {
+			constVEC const zi = cz -> data.row (i);
+			VEC const bzi = bzTarget.row (i);
+			bzi  <<=  0.0;
+			for (integer j = 1; j <= nPoints; j ++) {
+				const double dzij = distZ -> data [i] [j];
+				if (i == j || dzij == 0.0)
+					continue;
+				const double bij = - weight -> data [i] [j] * disp -> data [i] [j] / dzij;
+				constVEC const zj = cz -> data.row (j);
+				for (integer k = 1; k <= nDimensions; k ++)
+					bzi [k] += bij * (zj [k] - zi [k]);
+			}
+			bzi  *=  scale;
+		}
+	});
+	if (isdefined (uniformWeight))
+		return;
+	doRowsInParallel ([&] (integer fromRow, integer toRow) {
+		mul_MAT_out (cx -> data.horizontalBand (fromRow, toRow), vplus.horizontalBand (fromRow, toRow), bz);
+	});
+}
 
-	autoMAT b = raw_MAT (nPoints, nPoints);
-	autoDistance distZ = Configuration_to_Distance (cz);
-	/*
-		compute B(Z) (eq. 8.25)
-	*/
-	for (integer i = 1; i <= nPoints; i ++) {
-		longdouble sum = 0.0;
-		for (integer j = 1; j <= nPoints; j ++) {
-			const double dzij = distZ -> data [i] [j];
-			if (i == j || dzij == 0.0)
-				continue;
-			b [i] [j] = - weight -> data [i] [j] * disp -> data [i] [j] / dzij;
-			sum += b [i] [j];
+/*
+	Returns the common weight if all the weights between different points are equal (and positive), else undefined.
+*/
+static double smacof_getUniformWeight (Weight weight) {
+	const integer nPoints = weight -> numberOfRows;
+	if (nPoints < 2)
+		return undefined;
+	const double w = weight -> data [1] [2];
+	if (! (w > 0.0))
+		return undefined;
+	for (integer i = 1; i <= nPoints; i ++)
+		for (integer j = 1; j <= nPoints; j ++)
+			if (i != j && weight -> data [i] [j] != w)
+				return undefined;
+	return w;
+}
+
+/*
+	The Moore-Penrose inverse of V (eq. 8.19); not needed if the weights are uniform.
+*/
+static autoMAT smacof_getPseudoInverseOfV (Weight weight) {
+	const integer nPoints = weight -> numberOfRows;
+	autoMAT v = raw_MAT (nPoints, nPoints);
+	for (integer irow = 1; irow <= nPoints; irow ++) {
+		longdouble wsum = 0.0;
+		for (integer icol = 1; icol <= nPoints; icol ++) {
+			if (irow != icol) {
+				v [irow] [icol] = -  weight -> data [irow] [icol];
+				wsum +=  weight -> data [irow] [icol];
+			}
 		}
-		b [i] [i] = - (double) sum;
+		v [irow] [irow] = (double) wsum;
 	}
 	/*
-		Guttman transform: Xu = (V+)B(Z)Z (eq. 8.29)
+		V is row and column centered and therefore: rank(V) <= nPoints-1.
+		V^-1 does not exist -> get Moore-Penrose inverse.
 	*/
-	for (integer i = 1; i <= nPoints; i ++) {
-		for (integer j = 1; j <= nDimensions; j ++) {
-			longdouble xij = 0.0;
-			for (integer k = 1;  k <= nPoints; k ++) {
-				for (integer l = 1; l <= nPoints; l ++) {
-					xij += vplus [i] [k] * b [k] [l] * cz -> data [l] [j];
-				}
-			}
-			cx -> data [i] [j] = (double) xij;
-		}
-	}
+	constexpr double tol = 1e-6;
+	return newMATpseudoInverse (v.get(), tol);
 }
 
 double Distance_Weight_stress (Distance fit, Distance conf, Weight weight, kMDS_stressMeasure stressMeasure) {
@@ -1351,6 +1406,69 @@ double Distance_Weight_congruenceCoefficient (Distance x, Distance y, Weight w)
 	return xy / (sqrt (x2) * sqrt (y2));
 }
 
+static autoConfiguration smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t,
+	constMAT const& vplus, double uniformWeight, double tolerance, integer numberOfIterations, integer numberOfThreads,
+	bool showProgress, double *out_stress)
+{
+	const integer nPoints = conf -> numberOfRows;
+	autoConfiguration z = Data_copy (conf);
+	autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+	autoMAT bz = raw_MAT (nPoints, conf -> numberOfColumns);
+	/*
+		The distances of Z are those of the configuration at the start of each iteration,
+		i.e. those computed after the Guttman transform in the previous iteration.
+	*/
+	autoDistance dist = Distance_create (nPoints), cdist = Distance_create (nPoints);
+	TableOfReal_copyLabels (conf, dist.get(), 1, -1);
+	TableOfReal_copyLabels (conf, cdist.get(), 1, -1);
+	Configuration_into_Distance (conf, dist.get(), numberOfThreads);
+
+	if (showProgress)
+		Melder_progress (0.0, U"MDS analysis");
+
+	double stressp = 1e308, stress = 0.0;
+	for (integer iter = 1; iter <= numberOfIterations; iter ++) {
+		/*
+			transform & normalization
+		*/
+		autoDistance fit = Transformator_transform (t, vec.get(), dist.get(), weight);
+		/*
+			Make conf the Guttman transform of z
+		*/
+		smacof_guttmanTransform (conf, z.get(), dist.get(), fit.get(), weight, vplus, uniformWeight, bz.get(), numberOfThreads);
+		/*
+			Compute stress
+		*/
+		Configuration_into_Distance (conf, cdist.get(), numberOfThreads);
+
+		stress = Distance_Weight_stress (fit.get(), cdist.get(), weight, kMDS_stressMeasure::NORMALIZED);
+		/*
+			Check stop criterium
+		*/
+		if (fabs (stress - stressp) / stressp < tolerance) break;
+		/*
+			Make Z = X
+		*/
+		z -> data.all()  <<=  conf -> data.all();
+		std::swap (dist, cdist);
+
+		stressp = stress;
+		if (showProgress)
+			Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stress);
+	}
+	if (showProgress)
+		Melder_progress (1.0);
+	if (out_stress)
+		*out_stress = stress;
+	return z;
+}
+
+static integer smacof_getNumberOfThreads (integer nPoints, integer numberOfProcessors) {
+	integer numberOfThreads = std::min (numberOfProcessors, nPoints / 250 + 1);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	return numberOfThreads;
+}
+
 autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t, double tolerance, integer numberOfIterations, bool showProgress, double *out_stress) {
 	try {
 		const integer nPoints = conf -> numberOfRows;
@@ -1363,67 +1481,12 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissi
 			aw = Weight_create (nPoints);
 			weight = aw.get();
 		}
-		autoMAT v = raw_MAT (nPoints, nPoints);
-		autoConfiguration z = Data_copy (conf);
-		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
-
-		if (showProgress)
-			Melder_progress (0.0, U"MDS analysis");
-
-		// Get V (eq. 8.19).
-
-		for (integer irow = 1; irow <= nPoints; irow ++) {
-			longdouble wsum = 0.0;
-			for (integer icol = 1; icol <= nPoints; icol ++) {
-				if (irow != icol) {
-					v [irow] [icol] = -  weight -> data [irow] [icol];
-					wsum +=  weight -> data [irow] [icol];
-				}
-			}
-			v [irow] [irow] = (double) wsum;
-		}
-
-		/*
-			V is row and column centered and therefore: rank(V) <= nPoints-1.
-			V^-1 does not exist -> get Moore-Penrose inverse.
-		*/
-		constexpr double tol = 1e-6;
-		autoMAT vplus = newMATpseudoInverse (v.get(), tol);
-		double stressp = 1e308, stress = 0.0;
-		for (integer iter = 1; iter <= numberOfIterations; iter ++) {
-			autoDistance dist = Configuration_to_Distance (conf);
-			/*
-				transform & normalization
-			*/
-			autoDistance fit = Transformator_transform (t, vec.get(), dist.get(), weight);
-			/*
-				Make conf the Guttman transform of z
-			*/
-			smacof_guttmanTransform (conf, z.get(), fit.get(), weight, vplus.get());
-			/*
-				Compute stress
-			*/
-			autoDistance cdist = Configuration_to_Distance (conf);
-
-			stress = Distance_Weight_stress (fit.get(), cdist.get(), weight, kMDS_stressMeasure::NORMALIZED);
-			/*
-				Check stop criterium
-			*/
-			if (fabs (stress - stressp) / stressp < tolerance) break;
-			/*
-				Make Z = X
-			*/
-			z -> data.all()  <<=  conf -> data.all();
-
-			stressp = stress;
-			if (showProgress)
-				Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stress);
-		}
-		if (showProgress)
-			Melder_progress (1.0);
-		if (out_stress)
-			*out_stress = stress;
-		return z;
+		const double uniformWeight = smacof_getUniformWeight (weight);
+		autoMAT vplus;
+		if (isundef (uniformWeight))
+			vplus = smacof_getPseudoInverseOfV (weight);
+		return smacof (me, conf, weight, t, vplus.get(), uniformWeight, tolerance, numberOfIterations,
+				smacof_getNumberOfThreads (nPoints, MelderThread_getNumberOfProcessors ()), showProgress, out_stress);
 	} catch (MelderError) {
 		if (showProgress)
 			Melder_progress (1.0);
@@ -1431,32 +1494,119 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissi
 	}
 }
 
-autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf,  Weight w, Transformator t, double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress) {
+/*
+	A new Transformator of the same kind and with the same settings, for use on another thread.
+	Unlike ISplineTransformator_create, this does not draw random numbers.
+*/
+static autoTransformator Transformator_createCopy (Transformator me) {
+	autoTransformator thee;
+	if (Thing_isa (me, classISplineTransformator)) {
+		const ISplineTransformator original = static_cast <ISplineTransformator> (me);
+		autoISplineTransformator copy = Thing_new (ISplineTransformator);
+		Transformator_init (copy.get(), my numberOfPoints);
+		copy -> numberOfInteriorKnots = original -> numberOfInteriorKnots;
+		copy -> order = original -> order;
+		copy -> numberOfParameters = original -> numberOfParameters;
+		copy -> m = zero_MAT (original -> m.nrow, original -> m.ncol);
+		copy -> b = copy_VEC (original -> b.get());
+		copy -> knot = copy_VEC (original -> knot.get());
+		thee = copy.move();
+	} else if (Thing_isa (me, classMonotoneTransformator)) {
+		autoMonotoneTransformator copy = MonotoneTransformator_create (my numberOfPoints);
+		copy -> tiesHandling = static_cast <MonotoneTransformator> (me) -> tiesHandling;
+		thee = copy.move();
+	} else if (Thing_isa (me, classRatioTransformator)) {
+		thee = RatioTransformator_create (my numberOfPoints);
+	} else {
+		thee = Transformator_create (my numberOfPoints);
+	}
+	thy normalization = my normalization;
+	return thee;
+}
+
+/*
+	The repetitions run concurrently, as many as the processors and the memory allow
+	(each repetition needs a few n x n matrices); the remaining processors are used within each repetition.
+	The random starting configurations are drawn beforehand in the same order as when the repetitions
+	would run one after another, and the best configuration is chosen in the same order,
+	so the result depends only on the random seed.
+*/
+constexpr double smacof_MAXIMUM_NUMBER_OF_CONCURRENT_MATRIX_ELEMENTS = 2.5e8;
+
+static autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof_ (Dissimilarity me, Configuration conf,  Weight w, Transformator t,
+	double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress, integer numberOfProcessors)
+{
 	bool showMulti = showProgress && numberOfRepetitions > 1;
 	try {
 		const bool showSingle = showProgress && numberOfRepetitions == 1;
-		autoConfiguration cstart = Data_copy (conf);
-		autoConfiguration  cbest = Data_copy (conf);
-
-		if (showMulti)
-			Melder_progress (0.0, U"MDS many times");
+		const integer nPoints = conf -> numberOfRows;
+		Melder_require (my numberOfRows == nPoints && t -> numberOfPoints == nPoints &&
+			(! w || w -> numberOfRows == nPoints),
+				U"Dimensions should agree.");
+		autoWeight aw;
+		if (! w) {
+			aw = Weight_create (nPoints);
+			w = aw.get();
+		}
+		const double uniformWeight = smacof_getUniformWeight (w);
+		autoMAT vplus;
+		if (isundef (uniformWeight))
+			vplus = smacof_getPseudoInverseOfV (w);
 
-		double stress, stressmax = 1e308;
+		OrderedOf <structConfiguration> starts;
+		autoConfiguration cstart = Data_copy (conf);
 		for (integer i = 1; i <= numberOfRepetitions; i ++) {
-			autoConfiguration cresult = Dissimilarity_Configuration_Weight_Transformator_smacof (me, cstart.get(), w, t, tolerance, numberOfIterations, showSingle, & stress);
-			if (stress < stressmax) {
-				stressmax = stress;
-				cbest = cresult.move();
-			}
+			starts.addItem_move (Data_copy (cstart.get()));
 			Configuration_randomize (cstart.get());
 			TableOfReal_centreColumns (cstart.get());
+		}
 
-			if (showMulti)
-				Melder_progress ((double) i / (numberOfRepetitions + 1), i, U" from ", numberOfRepetitions);
+		const double numberOfMatrixElementsPerRepetition = 6.0 * double (nPoints) * double (nPoints);
+		integer numberOfConcurrentRepetitions = std::min (numberOfRepetitions, numberOfProcessors);
+		Melder_clip (1_integer, & numberOfConcurrentRepetitions,
+			std::max (1_integer, integer (smacof_MAXIMUM_NUMBER_OF_CONCURRENT_MATRIX_ELEMENTS / numberOfMatrixElementsPerRepetition)));
+		Melder_clip (1_integer, & numberOfConcurrentRepetitions, 16_integer);
+		const integer numberOfThreadsPerRepetition = std::min (smacof_getNumberOfThreads (nPoints, numberOfProcessors),
+				std::max (1_integer, numberOfProcessors / numberOfConcurrentRepetitions));
+
+		OrderedOf <structTransformator> transformators;
+		for (integer i = 1; i <= numberOfConcurrentRepetitions; i ++)
+			transformators.addItem_move (Transformator_createCopy (t));
+
+		std::vector <autoConfiguration> results (integer_to_uinteger (numberOfRepetitions));
+		autoVEC stresses = raw_VEC (numberOfRepetitions);
+
+		if (showMulti)
+			Melder_progress (0.0, U"MDS many times");
+		for (integer firstRepetition = 1; firstRepetition <= numberOfRepetitions; firstRepetition += numberOfConcurrentRepetitions) {
+			const integer numberOfRepetitionsInRun = std::min (numberOfConcurrentRepetitions, numberOfRepetitions - firstRepetition + 1);
+			auto repeat = [&] (integer ithread) {
+				const integer repetition = firstRepetition + ithread - 1;
+				const uinteger index = integer_to_uinteger (repetition - 1);
+				try {
+					results [index] = smacof (me, starts.at [repetition], w, ( numberOfConcurrentRepetitions == 1 ? t : transformators.at [ithread] ),
+							vplus.get(), uniformWeight, tolerance, numberOfIterations, numberOfThreadsPerRepetition,
+							showSingle, & stresses [repetition]);
+				} catch (MelderError) {
+					Melder_throw (U"Repetition ", repetition, U" failed.");   // MelderThread_run passes this on to the main thread
+				}
+			};
+			MelderThread_run (numberOfRepetitionsInRun, repeat);
+			if (showMulti) {
+				const integer numberOfRepetitionsDone = firstRepetition + numberOfRepetitionsInRun - 1;
+				Melder_progress ((double) numberOfRepetitionsDone / (numberOfRepetitions + 1), numberOfRepetitionsDone, U" from ", numberOfRepetitions);
+			}
 		}
+		/*
+			The first repetition with the lowest stress wins.
+		*/
+		integer best = 1;
+		for (integer repetition = 2; repetition <= numberOfRepetitions; repetition ++)
+			if (stresses [repetition] < stresses [best])
+				best = repetition;
 		if (showMulti)
 			Melder_progress (1.0);
-		return cbest;
+		return results [integer_to_uinteger (best - 1)].move();
 	} catch (MelderError) {
 		if (showMulti)
 			Melder_progress (1.0);
@@ -1464,6 +1614,61 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (
 	}
 }
 
+autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf,  Weight w, Transformator t, double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress) {
+	return Dissimilarity_Configuration_Weight_Transformator_multiSmacof_ (me, conf, w, t, tolerance, numberOfIterations,
+			numberOfRepetitions, showProgress, MelderThread_getNumberOfProcessors ());
+}
+
+/*
+	The configurations should not depend on the number of threads, i.e. on the number of processors
+	over which the repetitions and the rows of the distances and of the Guttman transform are divided.
+*/
+void test_MDS_multiSmacof_threads () {
+	try {
+		const integer numberOfPoints = 300;
+		autoConfiguration truth = Configuration_create (numberOfPoints, 2);
+		Configuration_randomize (truth.get());
+		autoDistance distance = Configuration_to_Distance (truth.get());
+		autoDissimilarity dissimilarity = Distance_to_Dissimilarity (distance.get());
+		for (integer i = 1; i < numberOfPoints; i ++)
+			for (integer j = i + 1; j <= numberOfPoints; j ++)
+				dissimilarity -> data [i] [j] = dissimilarity -> data [j] [i] = dissimilarity -> data [i] [j] * NUMrandomUniform (0.9, 1.1);
+		autoConfiguration start = Configuration_create (numberOfPoints, 2);
+		Configuration_randomize (start.get());
+		for (int itransformator = 1; itransformator <= 2; itransformator ++) {
+			autoTransformator t;
+			if (itransformator == 1)
+				t = MonotoneTransformator_create (numberOfPoints);
+			else
+				t = RatioTransformator_create (numberOfPoints);
+			/*
+				Three repetitions: up to 3 processors run concurrent repetitions;
+				with 6 and 9 processors, each repetition also divides its rows over 2 threads.
+			*/
+			autoConfiguration onOneProcessor;
+			for (const integer numberOfProcessors : { 1, 2, 3, 6, 9 }) {
+				NUMrandom_initializeWithSeedUnsafelyButPredictably (5489);
+				autoConfiguration result = Dissimilarity_Configuration_Weight_Transformator_multiSmacof_ (dissimilarity.get(), start.get(),
+						nullptr, t.get(), 1e-5, 10, 3, false, numberOfProcessors);
+				if (numberOfProcessors == 1) {
+					onOneProcessor = result.move();
+					continue;
+				}
+				for (integer irow = 1; irow <= numberOfPoints; irow ++)
+					for (integer icol = 1; icol <= 2; icol ++)
+						Melder_require (result -> data [irow] [icol] == onOneProcessor -> data [irow] [icol],
+							numberOfProcessors, U" processors: coordinate [", irow, U"] [", icol, U"] is ",
+							result -> data [irow] [icol], U" instead of ", onOneProcessor -> data [irow] [icol], U".");
+			}
+		}
+		NUMrandom_initializeSafelyAndUnpredictably ();
+		MelderInfo_writeLine (U"test_MDS_multiSmacof_threads: OK");
+	} catch (MelderError) {
+		NUMrandom_initializeSafelyAndUnpredictably ();
+		Melder_throw (U"MDS multi-threaded repetitions test failed.");
+	}
+}
+
 autoConfiguration Dissimilarity_Configuration_Weight_absolute_mds (Dissimilarity me, Configuration cstart, Weight w, double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress) {
 	try {
 		autoTransformator t = Transformator_create (my numberOfRows);
@@ -214,6 +214,8 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissi
 autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf, Weight w, Transformator t,
 	double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress);
 
+void test_MDS_multiSmacof_threads ();
+
 autoConfiguration Dissimilarity_Configuration_Weight_absolute_mds (Dissimilarity dis, Configuration cstart, Weight w,
 	double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress);
 
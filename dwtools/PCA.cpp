@@ -36,6 +36,7 @@
 #include "Eigen_and_SSCP.h"
 #include "Eigen_and_TableOfReal.h"
 #include "Matrix_extensions.h"
+#include "MAT_numerics.h"
 #include "NUM2.h"
 #include "PCA.h"
 #include "TableOfReal_extensions.h"
@@ -192,6 +193,42 @@ autoPCA TableOfReal_to_PCA_byRows (TableOfReal me) {
 	}
 }
 
+autoPCA TableOfReal_to_PCA_byRows_truncated (TableOfReal me, integer numberOfComponents,
+	integer oversampling, integer numberOfPowerIterations)
+{
+	try {
+		constMAT const m = my data.get();
+		Melder_require (NUMdefined (m),
+			U"All matrix elements should be defined.");
+		Melder_require (m.nrow > 1,
+			U"The number of rows should be larger than 1.");
+		Melder_require (numberOfComponents > 0 && numberOfComponents <= std::min (m.nrow, m.ncol),
+			U"The number of components should be in the range [1, ", std::min (m.nrow, m.ncol), U"].");
+		autoPCA thee = Thing_new (PCA);
+		thy centroid = columnMeans_VEC (m);
+		autoVEC singularValues;
+		autoMAT rightSingularVectors;
+		MAT_getTruncatedSingularValueDecomposition (m, thy centroid.get(), numberOfComponents, oversampling,
+				numberOfPowerIterations, nullptr, & singularValues, & rightSingularVectors);
+		Melder_require (singularValues [1] > 0.0,
+			U"Not all values in your table should be equal.");
+		Eigen_init (thee.get(), numberOfComponents, m.ncol);
+		/*
+			As in MAT_to_PCA: the eigenvalues of the covariance matrix are d^2 / (N - 1).
+		*/
+		for (integer i = 1; i <= numberOfComponents; i ++) {
+			thy eigenvalues [i] = singularValues [i] * singularValues [i] / (m.nrow - 1);
+			thy eigenvectors.row (i)  <<=  rightSingularVectors.column (i);
+		}
+		thy labels = autoSTRVEC (m.ncol);
+		thy labels.all()  <<=  my columnLabels.all();
+		PCA_setNumberOfObservations (thee.get(), m.nrow);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": truncated PCA not created.");
+	}
+}
+
 autoPCA Matrix_to_PCA_byColumns (Matrix me) {
 	try {
 		autoPCA thee = MAT_to_PCA (my z.get(), true);
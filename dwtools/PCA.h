@@ -41,6 +41,14 @@ integer PCA_getNumberOfObservations (PCA me);
 
 autoPCA TableOfReal_to_PCA_byRows (TableOfReal me);
 
+autoPCA TableOfReal_to_PCA_byRows_truncated (TableOfReal me, integer numberOfComponents,
+	integer oversampling, integer numberOfPowerIterations);
+/*
+	Only the first numberOfComponents principal components, computed with a randomised truncated SVD
+	of the centred data (see MAT_getTruncatedSingularValueDecomposition).
+	The data are not copied.
+*/
+
 autoEigen PCA_to_Eigen (PCA me);
 
 /* Calculate PCA of M'M */
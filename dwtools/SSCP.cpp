@@ -430,7 +430,7 @@ autoSSCP TableOfReal_to_SSCP (TableOfReal me, integer rowb, integer rowe, intege
 		columnMeans_VEC_out (thy centroid.get(), part.get());
 		part.all()  -=  thy centroid.all();
 		SSCP_setNumberOfObservations (thee.get(), part.nrow);
-		mtm_MAT_out (thy data.get(), part.get());   // sum of squares and cross products = T'T
+		mtm_threaded_MAT_out (thy data.get(), part.get());   // sum of squares and cross products = T'T
 		for (integer j = 1; j <= part.ncol; j ++) {
 			const conststring32 label = my columnLabels [colb - 1 + j].get();
 			TableOfReal_setColumnLabel (thee.get(), j, label);
@@ -465,7 +465,7 @@ autoSSCP TableOfReal_to_SSCP_rowWeights (TableOfReal me, integer rowb, integer r
 			autoVEC rowWeights = column_VEC (my data.horizontalBand (rowb, rowe), weightColumnNumber);
 			MATmtm_weighRows (thy data.get(), part.get(), rowWeights.get());
 		} else
-			mtm_MAT_out (thy data.get(), part.get());   // sum of squares and cross products = T'T
+			mtm_threaded_MAT_out (thy data.get(), part.get());   // sum of squares and cross products = T'T
 		for (integer j = 1; j <= part.ncol; j ++) {
 			const conststring32 label = my columnLabels [colb - 1 + j].get();
 			TableOfReal_setColumnLabel (thee.get(), j, label);
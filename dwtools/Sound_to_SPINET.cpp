@@ -23,6 +23,7 @@
 
 #include "Sound_to_SPINET.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 static double fgamma (double x, integer n) {
 	const double x2p1 = 1.0 + x * x;
@@ -51,11 +52,12 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 		Sampled_shortTermAnalysis (me, windowDuration, timeStep, & numberOfFrames, & firstTime);
 		autoSPINET thee = SPINET_create (my xmin, my xmax, numberOfFrames, timeStep, firstTime, minimumFrequencyHz, maximumFrequencyHz, numberOfGammaFilters, excitationErbProportion, inhibitionErbProportion);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		autoSound frame = Sound_createSimple (1, windowDuration, samplingFrequency);
+		const integer numberOfWindowSamples = window -> nx;
 		autoVEC f = raw_VEC (numberOfGammaFilters);
 		autoVEC bw = raw_VEC (numberOfGammaFilters);
 		autoVEC aex = raw_VEC (numberOfGammaFilters);
 		autoVEC ain = raw_VEC (numberOfGammaFilters);
+		autoVEC firstFrameTime = raw_VEC (numberOfGammaFilters);
 		/*
 			Cochlear filterbank: gammatone.
 		*/
@@ -63,26 +65,107 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 			f [i] = NUMerbToHertz (thy y1 + (i - 1) * thy dy);
 			bw [i] = NUM2pi * b * (f [i] * (6.23e-6 * f [i] + 93.39e-3) + 28.52);
 		}
-
-		autoMelderProgress progress (U"SPINET analysis");
-
+		/*
+			The filters are the ones that used to be applied as FIR filters, i.e. by convolving the sound with
+			Sound_createGammaTone (0.0, 0.1, samplingFrequency, thy gamma, b, f [i], 0.0, 0.0, false),
+			which has frequency b and bandwidth f [i] (Sounds_convolve with scaling "sum").
+			The filter output of such a convolution starts at my x1 + 0.5 * my dx and
+			is 0.1 seconds longer than the sound.
+			The recursive filterbank computes the output of all filters in blocks of samples,
+			and the frame energies are accumulated block by block,
+			so that the filtered sounds never have to be stored in full.
+		*/
+		const integer numberOfGammaToneSamples = Melder_iround (0.1 * samplingFrequency);
+		const integer numberOfFilteredSamples = my nx + numberOfGammaToneSamples - 1;
+		const double filteredX1 = my x1 + 0.5 * my dx;
 		for (integer i = 1; i <= numberOfGammaFilters; i ++) {
-			const double bb = (f [i] / 1000.0) * exp (- f [i] / 1000.0); // outer & middle ear and phase locking
 			const double tgammaMax = (thy gamma - 1) / bw [i]; // the time where the gamma function envelope has its maximum
-			const double gammaMaxAmplitude = pow ((thy gamma - 1) / (NUMe * bw [i]), thy gamma - 1);
 			const double timeCorrection = tgammaMax - windowDuration / 2.0;
-
-			autoSound gammaTone = Sound_createGammaTone (0.0, 0.1, samplingFrequency, thy gamma, b, f [i], 0.0, 0.0, false);
-			autoSound filtered = Sounds_convolve (me, gammaTone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
-			/*
-				To energy measure: weigh with broad-band transfer function.
-			*/
-			for (integer j = 1; j <= numberOfFrames; j ++) {
-				Sound_into_Sound (filtered.get(), frame.get(), Sampled_indexToX (thee.get(), j) + timeCorrection);
-				Sounds_multiply (frame.get(), window.get());
-				thy y [i] [j] = Sound_power (frame.get()) * bb / gammaMaxAmplitude;
+			firstFrameTime [i] = Sampled_indexToX (thee.get(), 1) + timeCorrection;
+		}
+		auto firstSampleOfFrame = [&] (integer ifilter, integer iframe) -> integer {
+			return Melder_iround ((firstFrameTime [ifilter] + (iframe - 1) * thy dx - filteredX1) / my dx + 1.0);
+		};
+		constVEC input = my z.row (1);
+		constVEC windowShape = window -> z.row (1);
+		/*
+			thy y [i] [j] collects the sum of squares of the windowed filter output first.
+		*/
+		auto analyseFilters = [&] (NUMgammatoneFilterbank filterbank, MATVU const& block, integer fromFilter, INTVEC const& nextFrame,
+			integer fromSample, integer toSample)
+		{
+			for (integer blockStart = fromSample; blockStart <= toSample; blockStart += block.ncol) {
+				const integer blockEnd = std::min (blockStart + block.ncol - 1, toSample);
+				NUMgammatoneFilterbank_filter (filterbank, input, block.verticalBand (1, blockEnd - blockStart + 1));
+				for (integer ifilter = 1; ifilter <= filterbank -> numberOfFilters; ifilter ++) {
+					const integer i = fromFilter + ifilter - 1;
+					for (integer j = nextFrame [ifilter]; j <= numberOfFrames; j ++) {
+						const integer frameStart = firstSampleOfFrame (i, j), frameEnd = frameStart + numberOfWindowSamples - 1;
+						if (frameStart > blockEnd)
+							break;
+						const integer from = std::max (frameStart, blockStart), to = std::min (frameEnd, blockEnd);
+						longdouble sumOfSquares = 0.0;
+						for (integer isample = from; isample <= to; isample ++) {
+							const double value = block [ifilter] [isample - blockStart + 1] * windowShape [isample - frameStart + 1];
+							sumOfSquares += value * value;
+						}
+						thy y [i] [j] += (double) sumOfSquares;
+						if (frameEnd <= blockEnd && j == nextFrame [ifilter])
+							nextFrame [ifilter] ++;
+					}
+				}
 			}
-			Melder_progress ((double) i / numberOfGammaFilters, U"SPINET: filter ", i, U" from ", numberOfGammaFilters, U".");
+		};
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfGammaFilters / 4);
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		const integer numberOfFiltersPerThread = (numberOfGammaFilters - 1) / numberOfThreads + 1;
+		numberOfThreads = (numberOfGammaFilters - 1) / numberOfFiltersPerThread + 1;
+		constexpr integer numberOfSamplesPerBlock = 1024;
+		std::vector <autoNUMgammatoneFilterbank> filterbanks (integer_to_uinteger (numberOfThreads));
+		autoMAT blocks = raw_MAT (numberOfThreads * numberOfFiltersPerThread, numberOfSamplesPerBlock);
+		autoINTVEC nextFrame = raw_INTVEC (numberOfThreads * numberOfFiltersPerThread);
+		for (integer i = 1; i <= nextFrame.size; i ++)
+			nextFrame [i] = 1;
+		autoINTVEC lastSampleNeeded = zero_INTVEC (numberOfThreads);
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			const integer fromFilter = (ithread - 1) * numberOfFiltersPerThread + 1;
+			const integer toFilter = std::min (fromFilter + numberOfFiltersPerThread - 1, numberOfGammaFilters);
+			NUMgammatoneFilterbank filterbank = & filterbanks [integer_to_uinteger (ithread - 1)];
+			NUMgammatoneFilterbank_init (filterbank, toFilter - fromFilter + 1, thy gamma, my dx);
+			for (integer i = fromFilter; i <= toFilter; i ++) {
+				NUMgammatoneFilterbank_setFilter (filterbank, i - fromFilter + 1, b, f [i], 0.0, 1.0);
+				Melder_clipLeft (firstSampleOfFrame (i, numberOfFrames) + numberOfWindowSamples - 1, & lastSampleNeeded [ithread]);
+			}
+			Melder_clipRight (& lastSampleNeeded [ithread], numberOfFilteredSamples);
+		}
+		/*
+			The threads go through the samples in rounds,
+			so that the progress can be shown (and the analysis cancelled) between rounds.
+		*/
+		const integer lastSampleOfAllThreads = NUMmax_e (lastSampleNeeded.get());
+		constexpr integer numberOfSamplesPerRound = 64 * numberOfSamplesPerBlock;
+		autoMelderProgress progress (U"SPINET analysis");
+		for (integer roundStart = 1; roundStart <= lastSampleOfAllThreads; roundStart += numberOfSamplesPerRound) {
+			const integer roundEnd = std::min (roundStart + numberOfSamplesPerRound - 1, lastSampleOfAllThreads);
+			auto analyseFiltersOfThread = [&] (integer ithread) {
+				const integer fromFilter = (ithread - 1) * numberOfFiltersPerThread + 1;
+				NUMgammatoneFilterbank filterbank = & filterbanks [integer_to_uinteger (ithread - 1)];
+				analyseFilters (filterbank, blocks.horizontalBand (fromFilter, fromFilter + filterbank -> numberOfFilters - 1),
+					fromFilter, nextFrame.part (fromFilter, fromFilter + filterbank -> numberOfFilters - 1),
+					roundStart, std::min (roundEnd, lastSampleNeeded [ithread]));
+			};
+			MelderThread_run (numberOfThreads, analyseFiltersOfThread);
+			Melder_progress ((double) roundEnd / lastSampleOfAllThreads, U"SPINET: sample ", roundEnd, U" from ", lastSampleOfAllThreads, U".");
+		}
+		/*
+			To energy measure: weigh with broad-band transfer function.
+		*/
+		for (integer i = 1; i <= numberOfGammaFilters; i ++) {
+			const double bb = (f [i] / 1000.0) * exp (- f [i] / 1000.0); // outer & middle ear and phase locking
+			const double gammaMaxAmplitude = pow ((thy gamma - 1) / (NUMe * bw [i]), thy gamma - 1);
+			const double frameDuration = window -> xmax - window -> xmin;
+			for (integer j = 1; j <= numberOfFrames; j ++)
+				thy y [i] [j] = sqrt (thy y [i] [j]) * my dx / frameDuration * bb / gammaMaxAmplitude;
 		}
 		/*
 			Excitatory and inhibitory area functions.
@@ -114,4 +197,54 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 	}
 }
 
+/*
+	The energies as they used to be computed,
+	by convolving the sound with a sampled gammatone for each filter.
+*/
+static autoMAT SPINET_getEnergies_convolution (SPINET me, Sound sound, double windowDuration) {
+	const double b = 1.02, samplingFrequency = 1.0 / sound -> dx;
+	autoMAT energies = zero_MAT (my ny, my nx);
+	autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
+	autoSound frame = Sound_createSimple (1, windowDuration, samplingFrequency);
+	for (integer i = 1; i <= my ny; i ++) {
+		const double f = NUMerbToHertz (my y1 + (i - 1) * my dy);
+		const double bw = NUM2pi * b * (f * (6.23e-6 * f + 93.39e-3) + 28.52);
+		const double bb = (f / 1000.0) * exp (- f / 1000.0);
+		const double tgammaMax = (my gamma - 1) / bw;
+		const double gammaMaxAmplitude = pow ((my gamma - 1) / (NUMe * bw), my gamma - 1);
+		const double timeCorrection = tgammaMax - windowDuration / 2.0;
+		autoSound gammaTone = Sound_createGammaTone (0.0, 0.1, samplingFrequency, my gamma, b, f, 0.0, 0.0, false);
+		autoSound filtered = Sounds_convolve (sound, gammaTone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
+		for (integer j = 1; j <= my nx; j ++) {
+			Sound_into_Sound (filtered.get(), frame.get(), Sampled_indexToX (me, j) + timeCorrection);
+			Sounds_multiply (frame.get(), window.get());
+			energies [i] [j] = Sound_power (frame.get()) * bb / gammaMaxAmplitude;
+		}
+	}
+	return energies;
+}
+
+void test_Sound_to_SPINET () {
+	try {
+		for (const double samplingFrequency : { 10000.0, 22050.0 }) {
+			autoSound sound = Sound_createSimple (1, 0.3, samplingFrequency);
+			for (integer i = 1; i <= sound -> nx; i ++) {
+				const double t = Sampled_indexToX (sound.get(), i);
+				sound -> z [1] [i] = sin (NUM2pi * 200.0 * t) + 0.5 * sin (NUM2pi * 1234.0 * t) * t + ( i == 500 ? 1.0 : 0.0 );
+			}
+			const double windowDuration = 0.04;
+			autoSPINET spinet = Sound_to_SPINET (sound.get(), 0.005, windowDuration, 70.0, 5000.0, 50, 0.5, 1.0);
+			autoMAT energies = SPINET_getEnergies_convolution (spinet.get(), sound.get(), windowDuration);
+			const double maximumEnergy = NUMmax_e (energies.all());
+			for (integer i = 1; i <= spinet -> ny; i ++)
+				for (integer j = 1; j <= spinet -> nx; j ++)
+					Melder_require (fabs (spinet -> y [i] [j] - energies [i] [j]) <= 1e-9 * maximumEnergy,
+						U"Filter ", i, U", frame ", j, U": energy ", spinet -> y [i] [j], U" instead of ", energies [i] [j], U".");
+		}
+		MelderInfo_writeLine (U"test_Sound_to_SPINET: OK");
+	} catch (MelderError) {
+		Melder_throw (U"SPINET test failed.");
+	}
+}
+
 /* End of file Sound_to_SPINET.cpp */
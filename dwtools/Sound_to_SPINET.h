@@ -31,4 +31,9 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration,
 	double minimumFrequencyHz, double maximumFrequencyHz, integer numberOfGammaFilters,
 	double excitationErbProportion, double inhibitionErbProportion);
 
+void test_Sound_to_SPINET ();
+/*
+	Compares the result with that of the former convolution of the sound with sampled gammatones.
+*/
+
 #endif /* _Sound_to_SPINET_h_ */
@@ -19,6 +19,7 @@
 #include "Sound_to_MFCC.h"
 #include "Sounds_to_DTW.h"
 #include "CCs_to_DTW.h"
+#include "MelderThread.h"
 
 autoDTW Sounds_to_DTW (Sound me, Sound thee, double analysisWidth, double dt, double band, int slope) {
 	try {
@@ -43,4 +44,83 @@ trace(6);
 	}
 }
 
+autoTable SoundList_to_Table_dtw (SoundList me, int pairing, double analysisWidth, double dt, double band, int slope, autoDTWList *out_dtws) {
+	try {
+		const integer numberOfSounds = my size;
+		Melder_require (numberOfSounds > 1,
+			U"There should be at least two sounds.");
+		integer numberOfPairs = 0;
+		if (pairing == Sounds_DTW_PAIRING_HALVES) {
+			Melder_require (numberOfSounds % 2 == 0,
+				U"To pair the first half of the sounds with the second half, the number of sounds should be even.");
+			numberOfPairs = numberOfSounds / 2;
+		} else if (pairing == Sounds_DTW_PAIRING_FIRST_WITH_OTHERS) {
+			numberOfPairs = numberOfSounds - 1;
+		} else {
+			Melder_require (pairing == Sounds_DTW_PAIRING_ALL,
+				U"Unknown pairing ", pairing, U".");
+			numberOfPairs = numberOfSounds * (numberOfSounds - 1) / 2;
+		}
+		autoINTMAT pairs = raw_INTMAT (numberOfPairs, 2);
+		integer ipair = 0;
+		for (integer isound = 1; isound <= numberOfSounds; isound ++) {
+			for (integer jsound = isound + 1; jsound <= numberOfSounds; jsound ++) {
+				const bool wanted = ( pairing == Sounds_DTW_PAIRING_ALL ||
+					(pairing == Sounds_DTW_PAIRING_FIRST_WITH_OTHERS && isound == 1) ||
+					(pairing == Sounds_DTW_PAIRING_HALVES && jsound == isound + numberOfPairs) );
+				if (wanted) {
+					pairs [++ ipair] [1] = isound;
+					pairs [ipair] [2] = jsound;
+				}
+			}
+		}
+		Melder_assert (ipair == numberOfPairs);
+		/*
+			As in Sounds_to_DTW.
+		*/
+		constexpr integer numberOfCoefficients = 12;
+		constexpr double fmin_mel = 100.0, df_mel = 100.0, fmax_mel = 0.0;
+		constexpr double wc = 1.0, wle = 0.0, wr = 0.0, wer = 0.0, dtr = 0.0;
+		autoMelderProgress progress (U"DTW of sound pairs");
+		OrderedOf <structMFCC> mfccs;
+		for (integer isound = 1; isound <= numberOfSounds; isound ++) {
+			autoMFCC mfcc = Sound_to_MFCC (my at [isound], numberOfCoefficients, analysisWidth, dt, fmin_mel, fmax_mel, df_mel);
+			mfccs. addItem_move (mfcc.move());
+			Melder_progress (0.3 * isound / numberOfSounds, U"MFCC analysis of sound ", isound, U" from ", numberOfSounds, U".");
+		}
+		const conststring32 columnNames [] = { U"first", U"second", U"distance" };
+		autoTable thee = Table_createWithColumnNames (numberOfPairs, ARRAY_TO_STRVEC (columnNames));
+		autoDTWList dtws = DTWList_create ();
+		const integer numberOfPairsPerGroup = 4 * std::max (1_integer, MelderThread_getNumberOfProcessors ());
+		for (integer firstPair = 1; firstPair <= numberOfPairs; firstPair += numberOfPairsPerGroup) {
+			const integer lastPair = std::min (firstPair + numberOfPairsPerGroup - 1, numberOfPairs);
+			autoDTWList group = DTWList_create ();
+			for (ipair = firstPair; ipair <= lastPair; ipair ++) {
+				autoDTW dtw = CCs_to_DTW (mfccs.at [pairs [ipair] [1]], mfccs.at [pairs [ipair] [2]], wc, wle, wr, wer, dtr);
+				group -> addItem_move (dtw.move());
+			}
+			DTWList_findPath_bandAndSlope (group.get(), band, slope);
+			for (ipair = firstPair; ipair <= lastPair; ipair ++) {
+				const Sound first = my at [pairs [ipair] [1]], second = my at [pairs [ipair] [2]];
+				Table_setStringValue (thee.get(), ipair, 1, first -> name.get());
+				Table_setStringValue (thee.get(), ipair, 2, second -> name.get());
+				Table_setNumericValue (thee.get(), ipair, 3, group -> at [ipair - firstPair + 1] -> weightedDistance);
+			}
+			if (out_dtws) {
+				for (ipair = firstPair; ipair <= lastPair; ipair ++) {
+					autoDTW dtw = group -> subtractItem_move (1);
+					Thing_setName (dtw.get(), Melder_cat (my at [pairs [ipair] [1]] -> name.get(), U"_", my at [pairs [ipair] [2]] -> name.get()));
+					dtws -> addItem_move (dtw.move());
+				}
+			}
+			Melder_progress (0.3 + 0.7 * lastPair / numberOfPairs, U"Aligned ", lastPair, U" from ", numberOfPairs, U" pairs.");
+		}
+		if (out_dtws)
+			*out_dtws = dtws.move();
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"No DTWs for the sound pairs created.");
+	}
+}
+
 /* End of file Sounds_to_DTW.cpp */
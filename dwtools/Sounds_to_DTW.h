@@ -24,8 +24,25 @@
 
 #include "DTW.h"
 #include "Sound.h"
+#include "Table.h"
 
 
 autoDTW Sounds_to_DTW (Sound me, Sound thee, double analysisWidth, double dt, double band, int slope);
 
+#define Sounds_DTW_PAIRING_HALVES 1
+#define Sounds_DTW_PAIRING_FIRST_WITH_OTHERS 2
+#define Sounds_DTW_PAIRING_ALL 3
+
+autoTable SoundList_to_Table_dtw (SoundList me, int pairing, double analysisWidth, double dt, double band, int slope, autoDTWList *out_dtws);
+/*
+	Sounds_to_DTW for many pairs, with the weighted distances in a Table with the columns "first", "second" and "distance".
+	pairing:
+		Sounds_DTW_PAIRING_HALVES: sound i of the first half with sound i of the second half;
+		Sounds_DTW_PAIRING_FIRST_WITH_OTHERS: the first sound with each of the others;
+		Sounds_DTW_PAIRING_ALL: each sound with each of the sounds after it.
+	The first sound of a pair is on the y-axis of the DTW.
+	The MFCCs of each sound are computed only once; the pairs are aligned in groups, with the paths of a group
+	searched concurrently. If out_dtws is null, only the DTWs of the current group are kept in memory.
+*/
+
 #endif /* _Sounds_to_DTW_h_ */
@@ -23,6 +23,8 @@
 */
 
 #include "TableOfReal_and_SVD.h"
+#include "TableOfReal_extensions.h"
+#include "MAT_numerics.h"
 
 autoTableOfReal SVD_to_TableOfReal (SVD me, integer from, integer to) {
 	try {
@@ -44,6 +46,37 @@ autoSVD TableOfReal_to_SVD (TableOfReal me) {
 	}
 }
 
+void TableOfReal_to_TablesOfReal_truncatedSVD (TableOfReal me, integer numberOfSingularValues,
+	integer oversampling, integer numberOfPowerIterations, autoTableOfReal *out_leftSingularVectors,
+	autoTableOfReal *out_singularValues, autoTableOfReal *out_rightSingularVectors)
+{
+	try {
+		autoMAT left, right;
+		autoVEC singularValues;
+		MAT_getTruncatedSingularValueDecomposition (my data.get(), constVECVU (), numberOfSingularValues, oversampling,
+				numberOfPowerIterations, & left, & singularValues, & right);
+		if (out_leftSingularVectors) {
+			autoTableOfReal leftSingularVectors = TableOfReal_create (my numberOfRows, numberOfSingularValues);
+			leftSingularVectors -> data.all()  <<=  left.all();
+			TableOfReal_copyLabels (me, leftSingularVectors.get(), 1, 0);
+			*out_leftSingularVectors = leftSingularVectors.move();
+		}
+		if (out_singularValues) {
+			autoTableOfReal theSingularValues = TableOfReal_create (1, numberOfSingularValues);
+			theSingularValues -> data.row (1)  <<=  singularValues.all();
+			*out_singularValues = theSingularValues.move();
+		}
+		if (out_rightSingularVectors) {
+			autoTableOfReal rightSingularVectors = TableOfReal_create (my numberOfColumns, numberOfSingularValues);
+			rightSingularVectors -> data.all()  <<=  right.all();
+			TableOfReal_copyLabels (me, rightSingularVectors.get(), -1, 0);
+			*out_rightSingularVectors = rightSingularVectors.move();
+		}
+	} catch (MelderError) {
+		Melder_throw (me, U": no truncated singular value decomposition computed.");
+	}
+}
+
 autoTableOfReal SVD_extractLeftSingularVectors (SVD me) {
 	try {
 		autoTableOfReal thee = TableOfReal_create (my numberOfRows, my numberOfColumns);
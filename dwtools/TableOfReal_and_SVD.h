@@ -28,6 +28,16 @@
 
 autoSVD TableOfReal_to_SVD (TableOfReal me);
 
+void TableOfReal_to_TablesOfReal_truncatedSVD (TableOfReal me, integer numberOfSingularValues,
+	integer oversampling, integer numberOfPowerIterations, autoTableOfReal *out_leftSingularVectors,
+	autoTableOfReal *out_singularValues, autoTableOfReal *out_rightSingularVectors);
+/*
+	Only the largest numberOfSingularValues singular values and vectors, computed with a randomised algorithm
+	(see MAT_getTruncatedSingularValueDecomposition). The left and right singular vectors are the columns of
+	an nrow x numberOfSingularValues and an ncol x numberOfSingularValues table; the singular values are in one row.
+	An SVD object would need room for all the singular vectors.
+*/
+
 autoGSVD TablesOfReal_to_GSVD (TableOfReal me, TableOfReal thee);
 
 autoTableOfReal SVD_to_TableOfReal (SVD me, integer from, integer to);
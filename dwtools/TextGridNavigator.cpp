@@ -1,6 +1,6 @@
 /* TextGridNavigator.cpp
  *
- * Copyright (C) 2020-2022 David Weenink
+ * Copyright (C) 2020-2022,2026 David Weenink
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -421,114 +421,86 @@ bool TextGridNavigator_isMatch (TextGridNavigator me, integer topicIndex, intege
 	for (integer inum = 2; inum <= my tierNavigators.size; inum ++) {
 		const TextGridTierNavigator tni = my tierNavigators.at [inum];
 		const integer referenceIndex = tni -> v_timeToIndex (midTime);
-		const integer tierSize = tni -> v_getSize ();
-		integer beforeIndex_sub, afterIndex_sub;
-		double startTime_sub, endTime_sub;
-		
+		/*
+			Instead of testing every interval of the subordinate tier, we walk through its cached matches,
+			starting from the last match at or before the reference index (found by binary search).
+		*/
+		TextGridTierNavigator_cacheMatches (tni);
+		constINTVEC matchIndices = tni -> matchIndices.get();
+		constVEC matchStartTimes = tni -> matchStartTimes.get(), matchEndTimes = tni -> matchEndTimes.get();
+		const integer numberOfMatches = matchIndices.size;
+		const integer lastMatchUpToReference = TextGridTierNavigator_getNumberOfMatchesUpTo (tni, referenceIndex);
+		const integer firstMatchFromReference = ( lastMatchUpToReference > 0 &&
+				matchIndices [lastMatchUpToReference] == referenceIndex ? lastMatchUpToReference : lastMatchUpToReference + 1 );
+		const bool referenceIsMatch = ( firstMatchFromReference == lastMatchUpToReference );
+
 		tni -> currentTopicIndex = 0;
-		const integer startIndex = 1;
-		const integer endIndex =  tierSize;
 		const kMatchDomainAlignment matchDomainAlignment = tni -> matchDomainAlignment;
-		const kMatchDomain matchDomain = tni -> matchDomain;
 		if (matchDomainAlignment == kMatchDomainAlignment::IS_ANYWHERE) {
-			for (integer index = startIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					tni -> currentTopicIndex = index;
-					break;
-				}
-			}
+			if (numberOfMatches > 0)
+				tni -> currentTopicIndex = matchIndices [1];
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_BEFORE) {
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
-					if (endTime_sub <= startTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
+			for (integer imatch = lastMatchUpToReference; imatch >= 1; imatch --) {
+				if (matchEndTimes [imatch] <= startTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
 				}
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::TOUCHES_BEFORE) {
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
-					if (endTime_sub == startTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (endTime_sub < startTime)
-						break;
-				}
+			for (integer imatch = lastMatchUpToReference; imatch >= 1; imatch --) {
+				if (matchEndTimes [imatch] == startTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
+				} else if (matchEndTimes [imatch] < startTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_BEFORE) {
 			// OVERLAPS_BEFORE	tmin2 < tmin && tmax2 <= tmax
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (startTime_sub < startTime && endTime_sub <= endTime ) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (endTime_sub < startTime)
-						break;
-				}
+			for (integer imatch = lastMatchUpToReference; imatch >= 1; imatch --) {
+				if (matchStartTimes [imatch] < startTime && matchEndTimes [imatch] <= endTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
+				} else if (matchEndTimes [imatch] < startTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_INSIDE) { // TODO checken of tmid correct is
-			if (TextGridTierNavigator_isMatch (tni, referenceIndex, & beforeIndex_sub, & afterIndex_sub)) {
-				TextGridTierNavigator_getMatchDomain (tni, matchDomain, referenceIndex, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-				if (startTime_sub >= startTime && endTime_sub <= endTime)
-					tni -> currentTopicIndex = referenceIndex;
-			}
+			if (referenceIsMatch && matchStartTimes [lastMatchUpToReference] >= startTime && matchEndTimes [lastMatchUpToReference] <= endTime)
+				tni -> currentTopicIndex = referenceIndex;
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_AFTER) {
 			// OVERLAPS_AFTER	tmin2 >= tmin && tmax2 > tmax
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (startTime_sub >= startTime && endTime_sub > endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (startTime_sub >= endTime)
-						break;
-				}
+			for (integer imatch = firstMatchFromReference; imatch <= numberOfMatches; imatch ++) {
+				if (matchStartTimes [imatch] >= startTime && matchEndTimes [imatch] > endTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
+				} else if (matchStartTimes [imatch] >= endTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::TOUCHES_AFTER) {
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
-					if (startTime_sub == endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (startTime_sub > endTime)
-						break;
-				}
+			for (integer imatch = firstMatchFromReference; imatch <= numberOfMatches; imatch ++) {
+				if (matchStartTimes [imatch] == endTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
+				} else if (matchStartTimes [imatch] > endTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_AFTER) {
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
-					if (startTime_sub >= endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
+			for (integer imatch = firstMatchFromReference; imatch <= numberOfMatches; imatch ++) {
+				if (matchStartTimes [imatch] >= endTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
 				}
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_BEFORE_AND_AFTER) {
-			if (TextGridTierNavigator_isMatch (tni, referenceIndex, & beforeIndex_sub, & afterIndex_sub)) {
-				TextGridTierNavigator_getMatchDomain (tni, matchDomain, referenceIndex, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-				if (startTime_sub <= startTime && endTime_sub >= endTime)
-					tni -> currentTopicIndex = referenceIndex;
-			}
+			if (referenceIsMatch && matchStartTimes [lastMatchUpToReference] <= startTime && matchEndTimes [lastMatchUpToReference] >= endTime)
+				tni -> currentTopicIndex = referenceIndex;
 		} else if (matchDomainAlignment == kMatchDomainAlignment::TOUCHES_BEFORE_AND_AFTER) {
-			if (TextGridTierNavigator_isMatch (tni, referenceIndex, & beforeIndex_sub, & afterIndex_sub)) {
-				TextGridTierNavigator_getMatchDomain (tni, matchDomain, referenceIndex, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-				if (startTime_sub == startTime && endTime_sub == endTime)
-					tni -> currentTopicIndex = referenceIndex;
-			}
+			if (referenceIsMatch && matchStartTimes [lastMatchUpToReference] == startTime && matchEndTimes [lastMatchUpToReference] == endTime)
+				tni -> currentTopicIndex = referenceIndex;
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_OUTSIDE) {
-			for (integer index = startIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (endTime_sub <= startTime || startTime_sub >= endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
+			for (integer imatch = 1; imatch <= numberOfMatches; imatch ++) {
+				if (matchEndTimes [imatch] <= startTime || matchStartTimes [imatch] >= endTime) {
+					tni -> currentTopicIndex = matchIndices [imatch];
+					break;
 				}
 			}
 		}
@@ -1,6 +1,6 @@
 /* TextGridTierNavigator.cpp
  *
- * Copyright (C) 2021-2022 David Weenink
+ * Copyright (C) 2021-2022,2026 David Weenink
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -176,6 +176,7 @@ void TextGridTierNavigator_modifyMatchDomain (TextGridTierNavigator me, kMatchDo
 	try {
 		NavigationContext_checkMatchDomain (my navigationContext.get(), matchDomain);
 		my matchDomain = matchDomain;
+		my matchesAreCached = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": match domain not changed.");
 	}
@@ -234,7 +235,8 @@ void TextGridTierNavigator_replaceNavigationContext (TextGridTierNavigator me, N
 		my navigationContext -> afterCriterion = thy afterCriterion;
 		my navigationContext -> afterMatchBoolean = thy afterMatchBoolean;
 		my navigationContext -> combinationCriterion = thy combinationCriterion;
-		my navigationContext -> excludeTopicMatch = thy excludeTopicMatch;		
+		my navigationContext -> excludeTopicMatch = thy excludeTopicMatch;
+		my matchesAreCached = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": could not replace navigation context.");
 	}
@@ -269,6 +271,7 @@ void TextGridTierNavigator_replaceTier (TextGridTierNavigator me, TextGrid thee,
 		my xmin = thy xmin;
 		my xmax = thy xmax;
 		my currentTopicIndex = 0; // offLeft
+		my matchesAreCached = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": cannot replace the tier.");
 	}
@@ -279,6 +282,7 @@ void TextGridTierNavigator_modifyBeforeRange (TextGridTierNavigator me, integer
 		U"Both numbers in the Before range should be positive.");
 	my beforeRange.first = std::min (from, to);
 	my beforeRange.last = std::max (from, to);
+	my matchesAreCached = false;
 }
 
 void TextGridTierNavigator_modifyAfterRange (TextGridTierNavigator me, integer from, integer to) {
@@ -286,22 +290,27 @@ void TextGridTierNavigator_modifyAfterRange (TextGridTierNavigator me, integer f
 		U"Both numbers in the after range should be positive.");
 	my afterRange.first = std::min (from, to);
 	my afterRange.last = std::max (from, to);
+	my matchesAreCached = false;
 }
 
 void TextGridTierNavigator_modifyTopicCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyTopicCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreCached = false;
 }
 
 void TextGridTierNavigator_modifyBeforeCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyBeforeCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreCached = false;
 }
 
 void TextGridTierNavigator_modifyAfterCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyAfterCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreCached = false;
 }
 
 void TextGridTierNavigator_modifyUseCriterion (TextGridTierNavigator me, kContext_combination newUse, bool excludeTopicMatch) {
 	NavigationContext_modifyUseCriterion (my navigationContext.get(), newUse, excludeTopicMatch);
+	my matchesAreCached = false;
 }
 
 static bool TextGridTierNavigator_isTopicMatch (TextGridTierNavigator me, integer index) {
@@ -410,11 +419,8 @@ bool TextGridTierNavigator_isMatch (TextGridTierNavigator me, integer topicIndex
 }
 
 integer TextGridTierNavigator_getNumberOfMatches (TextGridTierNavigator me) {
-	integer numberOfMatches = 0;
-	for (integer index = 1; index <= my v_getSize (); index ++)
-		if (TextGridTierNavigator_isMatch (me, index, nullptr, nullptr))
-			numberOfMatches ++;
-	return numberOfMatches;
+	TextGridTierNavigator_cacheMatches (me);
+	return my matchIndices.size;
 }
 
 integer TextGridTierNavigator_getNumberOfTopicMatches (TextGridTierNavigator me) {
@@ -486,6 +492,34 @@ void TextGridTierNavigator_getMatchDomain (TextGridTierNavigator me, kMatchDomai
 		*out_endTime = endTime ;
 }
 
+void TextGridTierNavigator_cacheMatches (TextGridTierNavigator me) {
+	if (my matchesAreCached)
+		return;
+	const integer size = my v_getSize ();
+	my matchIndices = raw_INTVEC (size);
+	my matchStartTimes = raw_VEC (size);
+	my matchEndTimes = raw_VEC (size);
+	integer numberOfMatches = 0;
+	for (integer index = 1; index <= size; index ++) {
+		integer beforeIndex, afterIndex;
+		if (TextGridTierNavigator_isMatch (me, index, & beforeIndex, & afterIndex)) {
+			numberOfMatches ++;
+			my matchIndices [numberOfMatches] = index;
+			TextGridTierNavigator_getMatchDomain (me, my matchDomain, index, beforeIndex, afterIndex,
+				& my matchStartTimes [numberOfMatches], & my matchEndTimes [numberOfMatches]);
+		}
+	}
+	my matchIndices.resize (numberOfMatches);
+	my matchStartTimes.resize (numberOfMatches);
+	my matchEndTimes.resize (numberOfMatches);
+	my matchesAreCached = true;
+}
+
+integer TextGridTierNavigator_getNumberOfMatchesUpTo (TextGridTierNavigator me, integer index) {
+	TextGridTierNavigator_cacheMatches (me);
+	return std::upper_bound (my matchIndices.begin (), my matchIndices.end (), index) - my matchIndices.begin ();
+}
+
 static integer TextGridTierNavigator_setCurrentAtTime (TextGridTierNavigator me, double time) {
 	my currentTopicIndex = my v_timeToIndex (time);
 	return my currentTopicIndex;
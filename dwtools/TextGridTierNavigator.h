@@ -60,6 +60,16 @@ void TextGridTierNavigator_modifyMatchingRange (TextGridTierNavigator me, intege
 bool TextGridTierNavigator_isMatch (TextGridTierNavigator me, integer topicIndex, integer *out_beforeIndex, integer *out_afterIndex);
 
 integer TextGridTierNavigator_getNumberOfMatches (TextGridTierNavigator me);
+
+/*
+	Fills my matchIndices, matchStartTimes and matchEndTimes, unless they are still valid.
+*/
+void TextGridTierNavigator_cacheMatches (TextGridTierNavigator me);
+/*
+	The number of matches whose index is not greater than `index`;
+	hence the position in my matchIndices of the last such match (binary search).
+*/
+integer TextGridTierNavigator_getNumberOfMatchesUpTo (TextGridTierNavigator me, integer index);
 integer TextGridTierNavigator_getNumberOfTopicMatches (TextGridTierNavigator me);
 integer TextGridTierNavigator_getNumberOfBeforeMatches (TextGridTierNavigator me);
 integer TextGridTierNavigator_getNumberOfAfterMatches (TextGridTierNavigator me);
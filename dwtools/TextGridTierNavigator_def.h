@@ -54,6 +54,17 @@ oo_DEFINE_CLASS (TextGridTierNavigator, Function)
 		virtual conststring32 v_getLabel (integer index);
 	#endif
 
+	#if oo_DECLARING
+		/*
+			All matches on the tier in increasing order, with their match domains.
+			Filled on demand by TextGridTierNavigator_cacheMatches; forgotten whenever
+			the tier, the navigation context, the Before/After ranges or the match domain change.
+		*/
+		bool matchesAreCached;
+		autoINTVEC matchIndices;
+		autoVEC matchStartTimes, matchEndTimes;
+	#endif
+
 oo_END_CLASS (TextGridTierNavigator)
 #undef ooSTRUCT
 
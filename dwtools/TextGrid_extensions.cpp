@@ -1,6 +1,6 @@
 /* TextGrid_extensions.cpp
  *
- * Copyright (C) 1993-2019,2023 David Weenink, 2015-2022,2024 Paul Boersma
+ * Copyright (C) 1993-2019,2023 David Weenink, 2015-2022,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -542,9 +542,10 @@ double TextGrid_getTotalDurationOfIntervalsWhere (TextGrid me, integer tierNumbe
 	try {
 		longdouble totalDuration = 0.0;
 		const IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, true);
 		for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			const TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, true))
+			if (intervalMatches [iinterval])
 				totalDuration += interval -> xmax - interval -> xmin;
 		}
 		return double (totalDuration);
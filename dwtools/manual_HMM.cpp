@@ -419,6 +419,24 @@ ENTRY (U"Algorithm")
 NORMAL (U"The Baum-Welch @@expectation-maximization@ procedure. It uses the forward and backward procedures to (re)estimate the parameters until convergence is reached.")
 MAN_END
 
+MAN_BEGIN (U"HMM & HMMObservationSequences: To HMMStateSequences (beam)...", U"Praat contributors", 20261018)
+INTRO (U"Finds for each of the selected @@HMMObservationSequence@s the most probable sequence of states of the selected @HMM.")
+NORMAL (U"For each observation sequence an @HMMStateSequence is created, together with one @Table that lists "
+	"for each sequence its length and the natural logarithm of the probability of the observations along the found path.")
+ENTRY (U"Settings")
+TERM (U"##Beam width (ln p)")
+DEFINITION (U"at each time only the states whose log probability is within this distance from the best state "
+	"are kept as starting points for the next time.")
+TERM (U"##Maximum number of active states")
+DEFINITION (U"at each time at most this number of the best states are kept. The value 0 means that there is no maximum.")
+ENTRY (U"Algorithm")
+NORMAL (U"A Viterbi search in log probabilities, in which only the transitions from the active states are explored "
+	"and only the active states are remembered for the trace back. "
+	"With a wide beam and no maximum the result is the same as with @@HMM & HMMObservationSequence: To HMMStateSequence@; "
+	"narrower beams are faster but may miss the most probable path. "
+	"The sequences are divided over the available processors.")
+MAN_END
+
 MAN_BEGIN (U"Bishop (2006)", U"djmw", 20101026)
 NORMAL (U"C.M. Bishop (2006): %%Pattern recognition and machine learning%. Springer.")
 MAN_END
@@ -1934,6 +1934,18 @@ DEFINITION (U"determines the maximum and minimum local slopes in the optimal pat
 NORMAL (U"For more information see the article of @@Sakoe & Chiba (1978)@.")
 MAN_END
 
+MAN_BEGIN (U"DTW: Find path (Sakoe-Chiba band)...", U"Praat contributors", 20261018)
+INTRO (U"Finds the optimal path from the first to the last cell of the selected @DTW, where the path is restricted to a band around the diagonal.")
+ENTRY (U"Settings")
+TERM (U"##Sakoe-Chiba band (s)#,")
+DEFINITION (U"the maximum distance, in seconds along the y-axis, between the path and the diagonal. "
+	"A value of zero means that the path is not restricted.")
+ENTRY (U"Algorithm")
+NORMAL (U"Only the cells inside the band are visited. Instead of a matrix with all cumulative distances, "
+	"only two columns and one byte per cell inside the band are kept. This makes the search feasible for very long sequences. "
+	"The local constraints are those of the \"no restriction\" slope constraint in @@DTW: Find path (band & slope)...@.")
+MAN_END
+
 MAN_BEGIN (U"DTW: Get maximum consecutive steps...", U"djmw", 20050307)
 INTRO (U"Get the maximum number of consecutive steps in the chosen direction along the optimal path from the selected @DTW.")
 MAN_END
@@ -2005,6 +2017,46 @@ ENTRY (U"Behaviour")
 NORMAL (U"The behaviour is like @@DTW: Get y time from x time...@")
 MAN_END
 
+MAN_BEGIN (U"Matrix: To DurationTier (DTW)...", U"Praat contributors", 20261018)
+INTRO (U"Finds the dynamic time warp between the columns of two selected @Matrix objects and returns it as a @DurationTier. "
+	"No @DTW object with its distance matrix is created, so this command can align very long sequences.")
+NORMAL (U"The first Matrix is on the y-axis and the second on the x-axis, as in ##Matrices: To DTW...#. "
+	"The DurationTier has the time domain of the second matrix; its values are the local slopes of the path.")
+NORMAL (U"The path is piecewise linear, so its slope is piecewise constant, "
+	"but a DurationTier interpolates linearly between its points and cannot have two points at the same time. "
+	"Each straight segment of the path therefore gets two points with the slope of that segment, "
+	"0.1 percent of the segment's duration after its start and before its end; "
+	"around the boundary between two segments the value therefore changes linearly from one slope to the next. "
+	"Vertical segments, where the second matrix stands still, have no slope and get no points.")
+ENTRY (U"Settings")
+TERM (U"##Distance metric#")
+DEFINITION (U"the power of the distance between two columns.")
+TERM (U"##Sakoe-Chiba band (s)#")
+DEFINITION (U"restricts the path to the band around the diagonal (see @@DTW: Find path (Sakoe-Chiba band)...@). "
+	"Zero means no restriction.")
+TERM (U"##Multiscale radius (frames)#")
+DEFINITION (U"if positive, the path is first determined at half the resolution (recursively) and then refined within "
+	"this number of frames from the projection of the coarse path (@@Salvador & Chan (2007)@). "
+	"The band is not used then. Zero means that the path is searched at full resolution only.")
+MAN_END
+
+MAN_BEGIN (U"Sounds: To Table (DTW)...", U"Praat contributors", 20261018)
+INTRO (U"Aligns many pairs of the selected @Sound objects at once and returns the distances of the pairs in a @Table.")
+NORMAL (U"For each pair the result is the same as that of ##Sounds: To DTW...#; the Table has the names of the two sounds "
+	"in the columns \"first\" and \"second\" and the weighted distance of the path in the column \"distance\". "
+	"The MFCC analysis is performed only once for each sound and the paths of several pairs are searched concurrently.")
+ENTRY (U"Settings")
+TERM (U"##Pairing#")
+DEFINITION (U"determines which sounds are aligned. With ##first half with second half# the number of selected sounds should be even "
+	"and the first sound is aligned with the sound just after the middle, the second with the next one, and so on. "
+	"With ##first with each of the others# the first sound serves as the reference for all other sounds. "
+	"With ##each with each# all pairs are aligned.")
+TERM (U"##Keep DTWs#")
+DEFINITION (U"if on, the @DTW of each pair is also created. Leave this off for large numbers of sounds, "
+	"because each DTW contains a distance matrix.")
+NORMAL (U"The other settings are as in ##Sounds: To DTW...#.")
+MAN_END
+
 MAN_BEGIN (U"DTW: Swap axes", U"djmw", 20050306)
 INTRO (U"Swap the x and y-axes of the selected @DTW.")
 MAN_END
@@ -5705,6 +5757,49 @@ INTRO (U"A command that creates a @PCA object from every selected "
 NORMAL (U"In @@Principal component analysis|the tutorial on PCA@ you will find more info on principal component analysis.")
 MAN_END
 
+MAN_BEGIN (U"TableOfReal: To PCA (truncated)...", U"Praat contributors", 20261018)
+INTRO (U"A command that creates a @PCA object with only the first few principal components from every selected "
+	"@TableOfReal object, where the TableOfReal object is interpreted as row-oriented, as in @@TableOfReal: To PCA@.")
+NORMAL (U"For large tables this is much faster than computing all the components, and it needs little extra memory.")
+ENTRY (U"Settings")
+TERM (U"##Number of components")
+DEFINITION (U"the number of principal components in the PCA.")
+TERM (U"##Oversampling")
+DEFINITION (U"the number of extra random directions used in the search; more oversampling gives more accurate components.")
+TERM (U"##Number of power iterations")
+DEFINITION (U"each iteration needs two extra passes through the data and makes the components more accurate, "
+	"especially if the eigenvalues decrease only slowly.")
+ENTRY (U"Algorithm")
+NORMAL (U"The principal components follow from the singular value decomposition of the centred data. "
+	"A random subspace with dimension %%numberOfComponents% + %oversampling is multiplied by the data, "
+	"alternately transposed, 2 \\.c %%numberOfPowerIterations% + 1 times, and orthonormalized after each multiplication. "
+	"The singular value decomposition of the data projected on this subspace then gives the components "
+	"(@@Halko, Martinsson & Tropp (2011)@). The results differ slightly between runs.")
+MAN_END
+
+MAN_BEGIN (U"TableOfReal: To TablesOfReal (truncated SVD)...", U"Praat contributors", 20261018)
+INTRO (U"A command that computes only the largest singular values and the corresponding singular vectors "
+	"of every selected @TableOfReal object, without computing a complete @SVD.")
+NORMAL (U"For every selected table with %m rows and %n columns, three new TableOfReal objects appear: "
+	"the left singular vectors as the columns of an %m \\xx %k table, the singular values in a 1 \\xx %k table, "
+	"and the right singular vectors as the columns of an %n \\xx %k table, where %k is the number of singular values. "
+	"These are the same as the first %k columns of the tables that you get with "
+	"##Extract left singular vectors#, ##Extract singular values# and ##Extract right singular vectors# from the SVD, "
+	"apart from the signs of the vectors.")
+NORMAL (U"For large tables this is much faster than computing all the singular values, and it needs only little extra memory.")
+ENTRY (U"Settings")
+TERM (U"##Number of singular values")
+DEFINITION (U"the number %k of singular values and vectors; it cannot be larger than the number of rows or columns.")
+TERM (U"##Oversampling")
+DEFINITION (U"the number of extra random directions used in the search; more oversampling gives more accurate results.")
+TERM (U"##Number of power iterations")
+DEFINITION (U"each iteration needs two extra passes through the data and makes the results more accurate, "
+	"especially if the singular values decrease only slowly.")
+ENTRY (U"Algorithm")
+NORMAL (U"As in @@TableOfReal: To PCA (truncated)...@, but without centring the columns "
+	"(@@Halko, Martinsson & Tropp (2011)@). The results differ slightly between runs.")
+MAN_END
+
 MAN_BEGIN (U"TableOfReal: To SSCP...", U"djmw", 19990218)
 INTRO (U"Calculates Sums of Squares and Cross Products (@SSCP) from the selected @TableOfReal.")
 ENTRY (U"Algorithm")
@@ -6363,6 +6458,13 @@ John S. Garofolo, Lori F. Lamel, William M. Fisher, Jonathan G. Fiscus, David S.
 
 G. Greiner & K. Hormann (1998): “Efficient clipping of arbitrary polygons”, %%ACM Transactions on Graphics% #17: 71\--83.
 
+################################################################################
+"Halko, Martinsson & Tropp (2011)"
+© David Weenink 2026-10-18
+
+N. Halko, P.G. Martinsson & J.A. Tropp (2011): “Finding structure with randomness: probabilistic algorithms
+for constructing approximate matrix decompositions”, %%SIAM Review% #53: 217\--288.
+
 ################################################################################
 "Heath et al. (1986)"
 © David Weenink 1998-10-07
@@ -6556,6 +6658,11 @@ NORMAL (U"H. Sakoe & S. Chiba (1978): \"Dynamic programming algorithm optimizati
 	"%%Transactions on ASSP% #26: 43\\--49.")
 MAN_END
 
+MAN_BEGIN (U"Salvador & Chan (2007)", U"Praat contributors", 20261018)
+NORMAL (U"S. Salvador & P. Chan (2007): \"FastDTW: Toward accurate dynamic time warping in linear time and space.\" "
+	"%%Intelligent Data Analysis% #11: 561\\--580.")
+MAN_END
+
 MAN_BEGIN (U"Sandwell (1987)", U"djmw", 20170915)
 NORMAL (U"D.T. Sandwell (1987): \"Biharmonic spline interpolation of GEOS-3 and SEASAT altimeter data.\", "
 		"%%Geophysica Research Letters% #14: 139\\--142.")
@@ -65,6 +65,7 @@
 
 #include "NUMcomplex.h"
 #include "NUMmachar.h"
+#include "cblas.h"
 
 #include "ActivationList.h"
 #include "AmplitudeTier.h"
@@ -1963,6 +1964,21 @@ DO
 	MODIFY_EACH_END
 }
 
+FORM (MODIFY_DTW_findPath_sakoeChibaBand, U"DTW: Find path (Sakoe-Chiba band)", U"DTW: Find path (Sakoe-Chiba band)...") {
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
+	OK
+DO
+	MODIFY_EACH (DTW)
+		DTW_findPath_sakoeChibaBand (me, sakoeChibaBand);
+	MODIFY_EACH_END
+}
+
+DIRECT (CONVERT_EACH_TO_ONE__DTW_to_DurationTier) {
+	CONVERT_EACH_TO_ONE (DTW)
+		autoDurationTier result = DTW_to_DurationTier (me);
+	CONVERT_EACH_TO_ONE_END (my name.get())
+}
+
 FORM (CONVERT_EACH_TO_ONE__DTW_to_Matrix_cumulativeDistances, U"DTW: To Matrix", nullptr) {
     REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
     CHOICE (slopeConstraint, U"Slope constraint", 1)
@@ -3794,6 +3810,17 @@ DO
 	CONVERT_TWO_TO_ONE_END (my name.get(), U"_", your name.get())
 }
 
+FORM (CONVERT_TWO_TO_ONE__Matrices_to_DurationTier_dtw, U"Matrices: To DurationTier (DTW)", U"Matrix: To DurationTier (DTW)...") {
+	REAL (distanceMetric, U"Distance metric", U"2.0")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.0 (= no band)")
+	INTEGER (multiscaleRadius, U"Multiscale radius (frames)", U"0 (= single scale)")
+	OK
+DO
+	CONVERT_TWO_TO_ONE (Matrix)
+		autoDurationTier result = Matrices_to_DurationTier_dtw (me, you, sakoeChibaBand, multiscaleRadius, distanceMetric);
+	CONVERT_TWO_TO_ONE_END (my name.get(), U"_", your name.get())
+}
+
 FORM (CONVERT_EACH_TO_ONE__Matrix_to_PatternList, U"Matrix: To PatternList", nullptr) {
 	NATURAL (join, U"Join", U"1")
 	OK
@@ -5363,6 +5390,18 @@ DO
 	PREFS_END
 }
 
+FORM (SETTINGS__LinearAlgebraSettings, U"Linear algebra settings", nullptr) {
+	COMMENT (U"Large matrix products, triangular solves and rank updates")
+	COMMENT (U"can be computed in blocks (fast)")
+	COMMENT (U"or with the reference algorithms (slow).")
+	BOOLEAN (useBlockedAlgorithms, U"Use blocked algorithms", true)
+	OK
+	SET_BOOLEAN (useBlockedAlgorithms, blas_getBlockedLevel3 ())
+DO
+	PREFS
+		blas_setBlockedLevel3 (useBlockedAlgorithms);
+	PREFS_END
+}
 
 DIRECT (INFO_NONE__Praat_ReportFloatingPointProperties) {
 	INFO_NONE
@@ -5661,6 +5700,34 @@ DO
 	CONVERT_TWO_TO_ONE_END (my name.get(), U"_", your name.get())
 }
 
+FORM (CONVERT_ALL_TO_MULTIPLE__Sounds_to_Table_dtw, U"Sounds: To Table (DTW)", U"Sounds: To Table (DTW)...") {
+	CHOICE (pairing, U"Pairing", 1)
+		OPTION (U"first half with second half")
+		OPTION (U"first with each of the others")
+		OPTION (U"each with each")
+	POSITIVE (windowLength, U"Window length (s)", U"0.015")
+	POSITIVE (timeStep, U"Time step (s)", U"0.005")
+	COMMENT (U"")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	CHOICE (slopeConstraint, U"Slope constraint", 1)
+		OPTION (U"no restriction")
+		OPTION (U"1/3 < slope < 3")
+		OPTION (U"1/2 < slope < 2")
+		OPTION (U"2/3 < slope < 3/2")
+	BOOLEAN (keepDTWs, U"Keep DTWs", false)
+	OK
+DO
+	CONVERT_ALL_LISTED_TO_MULTIPLE (Sound, SoundList)
+		autoDTWList dtws;
+		autoTable result = SoundList_to_Table_dtw (list.get(), pairing, windowLength, timeStep, sakoeChibaBand,
+				slopeConstraint, ( keepDTWs ? & dtws : nullptr ));
+		praat_new (result.move(), U"dtw");
+		if (keepDTWs)
+			while (dtws -> size > 0)
+				praat_new (dtws -> subtractItem_move (1));
+	CONVERT_ALL_LISTED_TO_MULTIPLE_END
+}
+
 FORM (CONVERT_EACH_TO_ONE__Sound_to_TextGrid_detectSilences, U"Sound: To TextGrid (silences)", U"Sound: To TextGrid (silences)...") {
 	COMMENT (U"Parameters for the intensity analysis")
 	POSITIVE (pitchFloor, U"Pitch floor (Hz)", U"100")
@@ -7932,6 +7999,22 @@ DIRECT (CONVERT_EACH_TO_ONE__TableOfReal_to_PCA_byRows) {
 	CONVERT_EACH_TO_ONE_END (my name.get())
 }
 
+FORM (CONVERT_EACH_TO_ONE__TableOfReal_to_PCA_byRows_truncated, U"TableOfReal: To PCA (truncated)",
+	U"TableOfReal: To PCA (truncated)...")
+{
+	NATURAL (numberOfComponents, U"Number of components", U"10")
+	NATURAL (oversampling, U"Oversampling", U"10")
+	INTEGER (numberOfPowerIterations, U"Number of power iterations", U"2")
+	OK
+DO
+	Melder_require (numberOfPowerIterations >= 0,
+		U"The number of power iterations should not be negative.");
+	CONVERT_EACH_TO_ONE (TableOfReal)
+		autoPCA result = TableOfReal_to_PCA_byRows_truncated (me, numberOfComponents, oversampling,
+				numberOfPowerIterations);
+	CONVERT_EACH_TO_ONE_END (my name.get())
+}
+
 FORM (CONVERT_EACH_TO_ONE__TableOfReal_to_SSCP, U"TableOfReal: To SSCP", U"TableOfReal: To SSCP...") {
 	INTEGER (fromRow, U"Begin row", U"0")
 	INTEGER (toRow, U"End row", U"0")
@@ -7988,6 +8071,26 @@ DIRECT (CONVERT_EACH_TO_ONE__TableOfReal_to_SVD) {
 	CONVERT_EACH_TO_ONE_END (my name.get())
 }
 
+FORM (CONVERT_EACH_TO_MULTIPLE__TableOfReal_to_TablesOfReal_truncatedSVD, U"TableOfReal: To TablesOfReal (truncated SVD)",
+	U"TableOfReal: To TablesOfReal (truncated SVD)...")
+{
+	NATURAL (numberOfSingularValues, U"Number of singular values", U"10")
+	NATURAL (oversampling, U"Oversampling", U"10")
+	INTEGER (numberOfPowerIterations, U"Number of power iterations", U"2")
+	OK
+DO
+	Melder_require (numberOfPowerIterations >= 0,
+		U"The number of power iterations should not be negative.");
+	CONVERT_EACH_TO_MULTIPLE (TableOfReal)
+		autoTableOfReal leftSingularVectors, singularValues, rightSingularVectors;
+		TableOfReal_to_TablesOfReal_truncatedSVD (me, numberOfSingularValues, oversampling, numberOfPowerIterations,
+				& leftSingularVectors, & singularValues, & rightSingularVectors);
+		praat_new (leftSingularVectors.move(), my name.get(), U"_left");
+		praat_new (singularValues.move(), my name.get(), U"_singularValues");
+		praat_new (rightSingularVectors.move(), my name.get(), U"_right");
+	CONVERT_EACH_TO_MULTIPLE_END
+}
+
 DIRECT (CONVERT_TWO_TO_ONE__TablesOfReal_to_Eigen_gsvd) {
 	CONVERT_TWO_TO_ONE (TableOfReal)
 		autoEigen result = TablesOfReal_to_Eigen_gsvd (me, you);
@@ -9012,6 +9115,8 @@ void praat_David_init () {
 	
 	praat_addMenuCommand (U"Objects", U"Settings", U"Sampled data analysis settings...", nullptr, 0,
 			SETTINGS__SampledDataAnalysisSettings);
+	praat_addMenuCommand (U"Objects", U"Settings", U"Linear algebra settings...", U"Sampled data analysis settings...", 0,
+			SETTINGS__LinearAlgebraSettings);
 
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report floating point properties", U"Report integer properties", 0,
 			INFO_NONE__Praat_ReportFloatingPointProperties);
@@ -9538,12 +9643,16 @@ void praat_David_init () {
 			MODIFY_DTW_findPath);
     praat_addAction1 (classDTW, 0, U"Find path (band & slope)...", nullptr, 0,
 			MODIFY_DTW_findPath_bandAndSlope);
+    praat_addAction1 (classDTW, 0, U"Find path (Sakoe-Chiba band)...", nullptr, 0,
+			MODIFY_DTW_findPath_sakoeChibaBand);
     praat_addAction1 (classDTW, 0, U"To Polygon...", nullptr, 1,
 			CONVERT_EACH_TO_ONE__DTW_to_Polygon);
 	praat_addAction1 (classDTW, 0, U"To Matrix (distances)", nullptr, 0,
 			CONVERT_EACH_TO_ONE__DTW_to_Matrix_distances);
     praat_addAction1 (classDTW, 0, U"To Matrix (cum. distances)...", nullptr, 0,
 			CONVERT_EACH_TO_ONE__DTW_to_Matrix_cumulativeDistances);
+	praat_addAction1 (classDTW, 0, U"To DurationTier", nullptr, 0,
+			CONVERT_EACH_TO_ONE__DTW_to_DurationTier);
 	praat_addAction1 (classDTW, 0, U"Swap axes", nullptr, 0,
 			CONVERT_EACH_TO_ONE__DTW_swapAxes);
 
@@ -9834,6 +9943,8 @@ void praat_David_init () {
 			CONVERT_EACH_TO_MULTIPLE_Matrix_eigen_complex);
 	praat_addAction1 (classMatrix, 2, U"To DTW...", U"To ParamCurve", 1,
 			CONVERT_TWO_TO_ONE__Matrices_to_DTW);
+	praat_addAction1 (classMatrix, 2, U"To DurationTier (DTW)...", U"To DTW...", 1,
+			CONVERT_TWO_TO_ONE__Matrices_to_DurationTier_dtw);
 
 	praat_addAction2 (classMatrix, 1, classCategories, 1, U"To TableOfReal", nullptr, 0,
 			CONVERT_ONE_AND_ONE_TO_ONE__Matrix_Categories_to_TableOfReal);
@@ -10226,6 +10337,8 @@ void praat_David_init () {
 			CONVERT_TWO_TO_ONE__Sounds_to_Polygon_enclosed);
     praat_addAction1 (classSound, 2, U"To DTW...", U"Cross-correlate...", GuiMenu_DEPTH_1,
 			CONVERT_TWO_TO_ONE__Sounds_to_DTW);
+	praat_addAction1 (classSound, 0, U"To Table (DTW)...", U"To DTW...", GuiMenu_DEPTH_1,
+			CONVERT_ALL_TO_MULTIPLE__Sounds_to_Table_dtw);
 
 	praat_addAction1 (classSound, 1, U"Filter (gammatone)...", U"Filter (de-emphasis)...", 1,
 			CONVERT_EACH_TO_ONE__Sound_filterByGammaToneFilter4);
@@ -10501,6 +10614,8 @@ void praat_David_init () {
 			CONVERT_EACH_TO_ONE__TableOfReal_to_Discriminant);
 	praat_addAction1 (classTableOfReal, 0, U"To PCA", nullptr, 1,
 			CONVERT_EACH_TO_ONE__TableOfReal_to_PCA_byRows);
+	praat_addAction1 (classTableOfReal, 0, U"To PCA (truncated)...", U"To PCA", 1,
+			CONVERT_EACH_TO_ONE__TableOfReal_to_PCA_byRows_truncated);
 	praat_addAction1 (classTableOfReal, 0, U"To SSCP...", nullptr, 1, 
 			CONVERT_EACH_TO_ONE__TableOfReal_to_SSCP);
 	praat_addAction1 (classTableOfReal, 0, U"To SSCP (row weights)...", nullptr, 1, 
@@ -10535,6 +10650,8 @@ void praat_David_init () {
 
 	praat_addAction1 (classTableOfReal, 1, U"To SVD", nullptr, GuiMenu_HIDDEN,
 			CONVERT_EACH_TO_ONE__TableOfReal_to_SVD);
+	praat_addAction1 (classTableOfReal, 0, U"To TablesOfReal (truncated SVD)...", U"To SVD", GuiMenu_HIDDEN,
+			CONVERT_EACH_TO_MULTIPLE__TableOfReal_to_TablesOfReal_truncatedSVD);
 	praat_addAction1 (classTableOfReal, 2, U"To GSVD", nullptr, GuiMenu_HIDDEN,
 			CONVERT_TWO_TO_ONE__TablesOfReal_to_GSVD);
 	praat_addAction1 (classTableOfReal, 2, U"To Eigen (gsvd)", nullptr, GuiMenu_HIDDEN,
@@ -470,6 +470,24 @@ DIRECT (CONVERT_ONE_AND_ONE_TO_ONE__HMM_HMMObservationSequence_to_HMMStateSequen
 	CONVERT_ONE_AND_ONE_TO_ONE_END (my name.get(), U"_", your name.get(), U"_states")
 }
 
+FORM (CONVERT_ONE_AND_ALL_TO_MULTIPLE__HMM_HMMObservationSequences_decode, U"HMM & HMMObservationSequences: To HMMStateSequences (beam)", U"HMM & HMMObservationSequences: To HMMStateSequences (beam)...") {
+	POSITIVE (beamWidth_log, U"Beam width (ln p)", U"20.0")
+	INTEGER (maximumNumberOfActiveStates, U"Maximum number of active states", U"0")
+	COMMENT (U"(0 = no maximum)")
+	OK
+DO
+	Melder_require (maximumNumberOfActiveStates >= 0,
+		U"The maximum number of active states should not be negative.");
+	CONVERT_ONE_AND_ALL_TO_MULTIPLE (HMM, HMMObservationSequence)
+		OrderedOf <structHMMStateSequence> stateSequences;
+		autoTable table = HMM_HMMObservationSequenceBag_decode (me, (HMMObservationSequenceBag) & list,
+				beamWidth_log, maximumNumberOfActiveStates, & stateSequences);
+		for (integer iseq = 1; iseq <= list.size; iseq ++)
+			praat_new (stateSequences.subtractItem_move (1), list.at [iseq] -> name.get(), U"_states");
+		praat_new (table.move(), my name.get(), U"_lnp");
+	CONVERT_ONE_AND_ALL_TO_MULTIPLE_END
+}
+
 FORM (MODIFY_FIRST_OF_ONE_AND_ALL__HMM_HMMObservationSequence_learn, U"HMM & HMMObservationSequence: Learn", U"HMM & HMMObservationSequences: Learn...") {
 	POSITIVE (relativePrecision_log, U"Relative precision in log(p)", U"0.001")
 	REAL (minimumProbability, U"Minimum probability", U"0.00000000001")
@@ -822,6 +840,8 @@ void praat_HMM_init () {
 
 	praat_addAction2 (classHMM, 1, classHMMObservationSequence, 1, U"To HMMStateSequence", nullptr, 0,
 			CONVERT_ONE_AND_ONE_TO_ONE__HMM_HMMObservationSequence_to_HMMStateSequence);
+	praat_addAction2 (classHMM, 1, classHMMObservationSequence, 0, U"To HMMStateSequences (beam)...", nullptr, 0,
+			CONVERT_ONE_AND_ALL_TO_MULTIPLE__HMM_HMMObservationSequences_decode);
 	praat_addAction2 (classHMM, 2, classHMMObservationSequence, 1, U"Get cross-entropy", nullptr, 0,
 			QUERY_TWO_AND_ONE_FOR_REAL__HMM_HMM_HMMObservationSequence_getCrossEntropy);
 	praat_addAction2 (classHMM, 1, classHMMObservationSequence, 1, U"To TableOfReal (bigrams)...", nullptr, 0,
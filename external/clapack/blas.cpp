@@ -963,6 +963,18 @@ L60:
 	return 0;
     }
 
+/*     Large products: the blocked multiplication in melder/MAT.cpp. */
+/*     The matrices are column-major, so in views a row has stride 1 and a column has stride lda. */
+
+    if (blas_getBlockedLevel3 () && (double) (*m) * (double) (*n) * (double) (*k) >= 1e5) {
+	constMATVU const opa = ( nota ? constMATVU (& a [a_offset], *m, *k, 1, a_dim1) :
+		constMATVU (& a [a_offset], *m, *k, a_dim1, 1) );
+	constMATVU const opb = ( notb ? constMATVU (& b [b_offset], *k, *n, 1, b_dim1) :
+		constMATVU (& b [b_offset], *k, *n, b_dim1, 1) );
+	_mul_blocked_MAT_out (MATVU (& c__ [c_offset], *m, *n, 1, c_dim1), opa, opb, *alpha, *beta);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (notb) {
@@ -5441,6 +5453,13 @@ L40:
 	return 0;
     }
 
+/*     Large problems: blocked (blas_blocked.cpp). */
+
+    if (blas_getBlockedLevel3 () && (double) (*n) * (double) (*n) * (double) (*k) >= 1e5) {
+	dsyrk_blocked (upper, ! lsame_(trans, "N"), *n, *k, *alpha, & a [a_offset], a_dim1, *beta, & c__ [c_offset], c_dim1);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lsame_(trans, "N")) {
@@ -7289,6 +7308,13 @@ L40:
 	return 0;
     }
 
+/*     Large problems: blocked (blas_blocked.cpp). */
+
+    if (blas_getBlockedLevel3 () && nrowa > blas_BLOCK_SIZE) {
+	dtrmm_blocked (side, uplo, transa, diag, *m, *n, *alpha, & a [a_offset], a_dim1, & b [b_offset], b_dim1);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lside) {
@@ -8062,6 +8088,13 @@ L40:
 	return 0;
     }
 
+/*     Large problems: blocked (blas_blocked.cpp). */
+
+    if (blas_getBlockedLevel3 () && nrowa > blas_BLOCK_SIZE) {
+	dtrsm_blocked (side, uplo, transa, diag, *m, *n, *alpha, & a [a_offset], a_dim1, & b [b_offset], b_dim1);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lside) {
@@ -0,0 +1,160 @@
+/* blas_blocked.cpp
+ *
+ * Copyright (C) 2026 the Praat contributors
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+	Blocked versions of the level-3 BLAS routines dsyrk, dtrmm and dtrsm.
+	The matrices are divided into blocks of blas_BLOCK_SIZE rows or columns;
+	the triangular diagonal blocks are handled by the reference routines,
+	and all the rest by _mul_blocked_MAT_out, which is fast and runs on the calling thread
+	(LAPACK is also used from within worker threads).
+	The reference routines in blas.cpp call these functions for large problems (and dgemm_ calls
+	_mul_blocked_MAT_out directly), unless blas_setBlockedLevel3 (false) has been called.
+
+	The matrices are column-major (Fortran) matrices: element (i, j) of a is at a [(i - 1) + (j - 1) * lda].
+	As a view, such a matrix has a row stride of 1 and a column stride of lda; its transpose has the strides swapped.
+*/
+
+#include "cblas.h"
+#include "f2cP.h"
+
+static bool useBlockedLevel3 = true;
+
+void blas_setBlockedLevel3 (bool useBlocked) {
+	useBlockedLevel3 = useBlocked;
+}
+
+bool blas_getBlockedLevel3 () {
+	return useBlockedLevel3;
+}
+
+static constMATVU columnMajor (const double *a, integer nrow, integer ncol, integer lda, bool transposed) {
+	return transposed ? constMATVU (a, nrow, ncol, lda, 1) : constMATVU (a, nrow, ncol, 1, lda);
+}
+
+void dsyrk_blocked (bool upper, bool transposed, integer n, integer k, double alpha, const double *a, integer lda,
+	double beta, double *c, integer ldc)
+{
+	/*
+		C := alpha * opA . opA' + beta * C, where opA is n x k.
+		Only the upper or lower triangle of C is referenced.
+		For each block of columns of C, the part outside the diagonal block is a single product,
+		the diagonal block is computed in full in a scratch matrix, of which only one triangle is used.
+	*/
+	constMATVU const opA = columnMajor (a, n, k, lda, transposed);
+	MATVU const cc (c, n, n, 1, ldc);
+	const integer maximumBlockSize = std::min (n, blas_BLOCK_SIZE);
+	autoMAT diagonalBlock = raw_MAT (maximumBlockSize, maximumBlockSize);
+	for (integer first = 1; first <= n; first += blas_BLOCK_SIZE) {
+		const integer last = std::min (first + blas_BLOCK_SIZE - 1, n), blockSize = last - first + 1;
+		constMATVU const opAblock = opA.part (first, last, 1, k);
+		MATVU const product = diagonalBlock.part (1, blockSize, 1, blockSize);
+		_mul_blocked_MAT_out (product, opAblock, opAblock.transpose(), alpha, 0.0);
+		for (integer jcol = 1; jcol <= blockSize; jcol ++) {
+			const integer fromRow = ( upper ? 1 : jcol ), toRow = ( upper ? jcol : blockSize );
+			for (integer irow = fromRow; irow <= toRow; irow ++) {
+				double& cell = cc [first - 1 + irow] [first - 1 + jcol];
+				cell = ( beta == 0.0 ? product [irow] [jcol] : product [irow] [jcol] + beta * cell );
+			}
+		}
+		if (upper && first > 1)
+			_mul_blocked_MAT_out (cc.part (1, first - 1, first, last), opA.part (1, first - 1, 1, k),
+					opAblock.transpose(), alpha, beta);
+		else if (! upper && last < n)
+			_mul_blocked_MAT_out (cc.part (last + 1, n, first, last), opA.part (last + 1, n, 1, k),
+					opAblock.transpose(), alpha, beta);
+	}
+}
+
+/*
+	For dtrmm and dtrsm: the contribution of the off-diagonal part of opA to block first..last of B,
+	i.e. B [block] := alpha * (opA [block, rest] . B [rest] or B [rest] . opA [rest, block]) + beta * B [block],
+	where "rest" is the part after the block if opA is upper triangular and B is on the right (side "L"),
+	or if opA is lower triangular and B is on the left (side "R"), and the part before the block otherwise.
+*/
+static void multiplyByRest (bool leftSide, bool opUpper, constMATVU const& opA, MATVU const& bb,
+	integer first, integer last, double alpha, double beta)
+{
+	const integer order = opA.nrow;
+	const bool restIsAfter = ( leftSide == opUpper );
+	const integer restFirst = ( restIsAfter ? last + 1 : 1 ), restLast = ( restIsAfter ? order : first - 1 );
+	if (restFirst > restLast) {
+		if (beta != 1.0) {
+			MATVU const block = ( leftSide ? bb.part (first, last, 1, bb.ncol) : bb.part (1, bb.nrow, first, last) );
+			block  *=  beta;
+		}
+		return;
+	}
+	if (leftSide)
+		_mul_blocked_MAT_out (bb.part (first, last, 1, bb.ncol), opA.part (first, last, restFirst, restLast),
+				bb.part (restFirst, restLast, 1, bb.ncol), alpha, beta);
+	else
+		_mul_blocked_MAT_out (bb.part (1, bb.nrow, first, last), bb.part (1, bb.nrow, restFirst, restLast),
+				opA.part (restFirst, restLast, first, last), alpha, beta);
+}
+
+void dtrmm_blocked (const char *side, const char *uplo, const char *transa, const char *diag,
+	integer m, integer n, double alpha, double *a, integer lda, double *b, integer ldb)
+{
+	/*
+		B := alpha * opA . B (side "L") or B := alpha * B . opA (side "R"), with opA triangular.
+		A block of B depends on itself and on the rest, so the blocks are visited in an order
+		in which the rest has not yet been overwritten.
+	*/
+	const bool leftSide = lsame_ (side, "L"), transposed = ! lsame_ (transa, "N");
+	const bool opUpper = ( lsame_ (uplo, "U") != transposed );
+	const integer order = ( leftSide ? m : n );
+	constMATVU const opA = columnMajor (a, order, order, lda, transposed);
+	MATVU const bb (b, m, n, 1, ldb);
+	const integer numberOfBlocks = (order - 1) / blas_BLOCK_SIZE + 1;
+	const bool forward = ( leftSide == opUpper );
+	for (integer iblock = 1; iblock <= numberOfBlocks; iblock ++) {
+		const integer jblock = ( forward ? iblock : numberOfBlocks + 1 - iblock );
+		const integer first = (jblock - 1) * blas_BLOCK_SIZE + 1, last = std::min (jblock * blas_BLOCK_SIZE, order);
+		integer blockSize = last - first + 1, numberOfRows = ( leftSide ? blockSize : m ), numberOfColumns = ( leftSide ? n : blockSize );
+		double *const bblock = ( leftSide ? b + (first - 1) : b + (first - 1) * ldb );
+		dtrmm_ (side, uplo, transa, diag, & numberOfRows, & numberOfColumns, & alpha, a + (first - 1) * (1 + lda), & lda, bblock, & ldb);
+		multiplyByRest (leftSide, opUpper, opA, bb, first, last, alpha, 1.0);
+	}
+}
+
+void dtrsm_blocked (const char *side, const char *uplo, const char *transa, const char *diag,
+	integer m, integer n, double alpha, double *a, integer lda, double *b, integer ldb)
+{
+	/*
+		Solves opA . X = alpha * B (side "L") or X . opA = alpha * B (side "R") for X, with opA triangular;
+		X overwrites B. A block of X follows from the same block of B and the blocks of X that are already known.
+	*/
+	const bool leftSide = lsame_ (side, "L"), transposed = ! lsame_ (transa, "N");
+	const bool opUpper = ( lsame_ (uplo, "U") != transposed );
+	const integer order = ( leftSide ? m : n );
+	constMATVU const opA = columnMajor (a, order, order, lda, transposed);
+	MATVU const bb (b, m, n, 1, ldb);
+	const integer numberOfBlocks = (order - 1) / blas_BLOCK_SIZE + 1;
+	const bool forward = ( leftSide != opUpper );
+	double one = 1.0;
+	for (integer iblock = 1; iblock <= numberOfBlocks; iblock ++) {
+		const integer jblock = ( forward ? iblock : numberOfBlocks + 1 - iblock );
+		const integer first = (jblock - 1) * blas_BLOCK_SIZE + 1, last = std::min (jblock * blas_BLOCK_SIZE, order);
+		multiplyByRest (leftSide, opUpper, opA, bb, first, last, -1.0, alpha);
+		integer blockSize = last - first + 1, numberOfRows = ( leftSide ? blockSize : m ), numberOfColumns = ( leftSide ? n : blockSize );
+		double *const bblock = ( leftSide ? b + (first - 1) : b + (first - 1) * ldb );
+		dtrsm_ (side, uplo, transa, diag, & numberOfRows, & numberOfColumns, & one, a + (first - 1) * (1 + lda), & lda, bblock, & ldb);
+	}
+}
+
+/* End of file blas_blocked.cpp */
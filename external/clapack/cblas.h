@@ -137,4 +137,23 @@ int dtrsv_ (const char *uplo, const char *trans, const char *diag, integer *n,
 
 integer idamax_ (integer *n, double *dx, integer *incx);
 
+/*
+	Blocked implementations of the level-3 routines (blas_blocked.cpp), built on _mul_blocked_MAT_out.
+	dgemm_, dsyrk_, dtrmm_ and dtrsm_ use them for large problems,
+	unless the reference implementations have been chosen with blas_setBlockedLevel3 (false).
+*/
+constexpr integer blas_BLOCK_SIZE = 128;
+
+void blas_setBlockedLevel3 (bool useBlocked);
+bool blas_getBlockedLevel3 ();
+
+void dsyrk_blocked (bool upper, bool transposed, integer n, integer k, double alpha, const double *a, integer lda,
+	double beta, double *c, integer ldc);
+
+void dtrmm_blocked (const char *side, const char *uplo, const char *transa, const char *diag,
+	integer m, integer n, double alpha, double *a, integer lda, double *b, integer ldb);
+
+void dtrsm_blocked (const char *side, const char *uplo, const char *transa, const char *diag,
+	integer m, integer n, double alpha, double *a, integer lda, double *b, integer ldb);
+
 #endif /* _cblas_h_  */
@@ -1,6 +1,6 @@
 /* LongSound.cpp
  *
- * Copyright (C) 1992-2008,2010-2019,2021-2025 Paul Boersma, 2007 Erez Volk (for FLAC and MP3)
+ * Copyright (C) 1992-2008,2010-2019,2021-2026 Paul Boersma, 2007 Erez Volk (for FLAC and MP3)
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -706,26 +706,28 @@ void LongSound_concatenate (SoundAndLongSoundList me, MelderFile file, const int
 				Melder_throw (U"Cannot mix stereo and mono.");
 		}
 		/*
-			Create output file and write header.
+			Create the output file. The samples are converted and written by a background thread,
+			while the next (Long)Sound is being read.
 		*/
-		autoMelderFile mfile = MelderFile_create (file);
-		if (file -> filePointer)
-			MelderFile_writeAudioFileHeader (file, audioFileType, sampleRate, n, numberOfChannels, numberOfBitsPerSamplePoint);
+		autoMelderAudioFileWriter writer (file, audioFileType, sampleRate, n, numberOfChannels, numberOfBitsPerSamplePoint);
 		for (integer i = 1; i <= my size; i ++) {
 			data = my at [i];
 			if (data -> classInfo == classSound) {
 				Sound sound = (Sound) data;
-				if (file -> filePointer) {
-					MelderFile_writeFloatToAudio (file, sound -> z.get(),
-							Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint), true);
-				}
+				writer.write (sound -> z.get());
 			} else {
 				LongSound longSound = (LongSound) data;
-				writePartToOpenFile (longSound, audioFileType, 1, longSound -> nx, file, 0, numberOfBitsPerSamplePoint);
+				autoMAT block;
+				for (integer firstSample = 1; firstSample <= longSound -> nx; firstSample += longSound -> nmax) {
+					const integer numberOfSamplesToCopy = std::min (longSound -> nmax, longSound -> nx - firstSample + 1);
+					if (block.ncol != numberOfSamplesToCopy)
+						block = raw_MAT (numberOfChannels, numberOfSamplesToCopy);
+					LongSound_readAudioToFloat (longSound, block.get(), firstSample);
+					writer.write (block.get());
+				}
 			}
 		}
-		MelderFile_writeAudioFileTrailer (file, audioFileType, sampleRate, n, numberOfChannels, numberOfBitsPerSamplePoint);
-		mfile.close ();
+		writer.close ();
 	} catch (MelderError) {
 		Melder_throw (U"Sounds not concatenated and not saved to ", file, U".");
 	}
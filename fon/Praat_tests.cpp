@@ -30,6 +30,14 @@
 #include "praat.h"
 #include "NUM2.h"
 #include "Sound.h"
+#include "Sound_to_Cochleagram.h"
+#include "Sound_to_SPINET.h"
+#include "HMM.h"
+#include "DTW.h"
+#include "FFNet.h"
+#include "GaussianMixture.h"
+#include "MDS.h"
+#include "NMF.h"
 
 #include "enums_getText.h"
 #include "Praat_tests_enums.h"
@@ -62,6 +70,239 @@ static autoMAT constantHH (integer nrow, integer ncol, double value) {
 	return result;
 }
 
+/*
+	The bulk binary readers and writers in abcio and melder_tensorio
+	should produce the same bytes and the same values as the one-value versions,
+	also for NaN, -0, infinities and denormals, and around the block size of 4096 values.
+*/
+static autoBYTEVEC fileBytes (FILE *f) {
+	fflush (f);
+	const integer numberOfBytes = ftell (f);
+	autoBYTEVEC result = raw_BYTEVEC (numberOfBytes);
+	rewind (f);
+	if (numberOfBytes > 0)
+		Melder_require ((integer) fread (result.cells, 1, (size_t) numberOfBytes, f) == numberOfBytes,
+			U"Cannot read back ", numberOfBytes, U" bytes.");
+	rewind (f);
+	return result;
+}
+
+static void checkSameBytes (FILE *f, constBYTEVEC const& expected, conststring32 what) {
+	autoBYTEVEC bytes = fileBytes (f);
+	Melder_require (bytes.size == expected.size && (bytes.size == 0 || memcmp (bytes.cells, expected.cells, (size_t) bytes.size) == 0),
+		what, U": written bytes differ from those of the one-value version.");
+}
+
+static void checkSameValues (const double *values, const double *expected, integer n, conststring32 what) {
+	for (integer i = 0; i < n; i ++)
+		Melder_require (isundef (values [i]) ? isundef (expected [i]) : values [i] == expected [i] && signbit (values [i]) == signbit (expected [i]),
+			what, U": value ", i + 1, U" is ", values [i], U" instead of ", expected [i], U".");
+}
+
+static void checkBulkBinaryIO () {
+	const double specialValues [] = {
+		NAN, - NAN, INFINITY, - INFINITY, 0.0, -0.0,
+		4.9406564584124654e-324, -2.2250738585072014e-308 / 3.0,   // denormal as doubles
+		1e-40, -1.4e-45, 1e-50,   // denormal as floats, or too small
+		1e39, -3.4028235677973366e38, 1.0, -3.14159265358979, 1e300
+	};
+	const integer numberOfSpecialValues = sizeof specialValues / sizeof specialValues [0];
+	const integer shapes [] [2] = { { 1, 1 }, { 1, 4095 }, { 64, 64 }, { 17, 241 }, { 2, 2049 }, { 3, 4099 } };
+	for (integer ishape = 0; ishape < (integer) (sizeof shapes / sizeof shapes [0]); ishape ++) {
+		const integer nrow = shapes [ishape] [0], ncol = shapes [ishape] [1], n = nrow * ncol;
+		autoMAT mat = randomGauss_MAT (nrow, ncol, 0.0, 1.0);
+		double *values = mat.cells;
+		for (integer i = 0; i < n; i ++) {
+			if (i % 7 < 2)
+				values [i] = specialValues [(i / 7 * 2 + i % 7) % numberOfSpecialValues];
+			else
+				values [i] *= pow (10.0, NUMrandomInteger (-320, 300));
+		}
+		autoVEC readValues = raw_VEC (2 * n), expectedValues = raw_VEC (2 * n);
+		FILE *f = tmpfile ();
+		Melder_require (f, U"Cannot create a temporary file.");
+		try {
+			/*
+				64 bits.
+			*/
+			for (integer i = 0; i < n; i ++)
+				binputr64 (values [i], f);
+			autoBYTEVEC expectedBytes = fileBytes (f);
+			for (integer i = 0; i < n; i ++)
+				expectedValues [i + 1] = bingetr64 (f);
+			rewind (f);
+			bingetr64 (f, & readValues [1], n);
+			checkSameValues (& readValues [1], & expectedValues [1], n, U"bingetr64");
+			for (integer i = 0; i < n; i ++)
+				Melder_require (isdefined (values [i]) ? readValues [i + 1] == values [i] : isundef (readValues [i + 1]),
+					U"r64 value ", i + 1, U" did not survive the round trip.");
+			rewind (f);
+			binputr64 (values, n, f);
+			checkSameBytes (f, expectedBytes.get(), U"binputr64");
+			rewind (f);
+			vector_writeBinary_r64 (constVEC (values, n), f);
+			checkSameBytes (f, expectedBytes.get(), U"vector_writeBinary_r64");
+			autoVEC vec = vector_readBinary_r64 (n, f);
+			checkSameValues (vec.cells, & expectedValues [1], n, U"vector_readBinary_r64");
+			rewind (f);
+			matrix_writeBinary_r64 (mat.get(), f);
+			checkSameBytes (f, expectedBytes.get(), U"matrix_writeBinary_r64");
+			autoMAT readMat = matrix_readBinary_r64 (nrow, ncol, f);
+			checkSameValues (readMat.cells, & expectedValues [1], n, U"matrix_readBinary_r64");
+			rewind (f);
+			tensor3_writeBinary_r64 (consttensor3 <double> (values, 1, nrow, ncol, n, ncol, 1), f);
+			checkSameBytes (f, expectedBytes.get(), U"tensor3_writeBinary_r64");
+			autotensor3 <double> readTen3 = tensor3_readBinary_r64 (1, nrow, ncol, f);
+			checkSameValues (readTen3.cells, & expectedValues [1], n, U"tensor3_readBinary_r64");
+			/*
+				32 bits.
+			*/
+			rewind (f);
+			for (integer i = 0; i < n; i ++)
+				binputr32 (values [i], f);
+			expectedBytes = fileBytes (f);
+			for (integer i = 0; i < n; i ++)
+				expectedValues [i + 1] = bingetr32 (f);
+			rewind (f);
+			bingetr32 (f, & readValues [1], n);
+			checkSameValues (& readValues [1], & expectedValues [1], n, U"bingetr32");
+			rewind (f);
+			binputr32 (values, n, f);
+			checkSameBytes (f, expectedBytes.get(), U"binputr32");
+			rewind (f);
+			matrix_writeBinary_r32 (mat.get(), f);
+			checkSameBytes (f, expectedBytes.get(), U"matrix_writeBinary_r32");
+			readMat = matrix_readBinary_r32 (nrow, ncol, f);
+			checkSameValues (readMat.cells, & expectedValues [1], n, U"matrix_readBinary_r32");
+			/*
+				Complex, with the values as alternating real and imaginary parts.
+			*/
+			const integer numberOfComplexValues = n / 2;
+			const dcomplex *complexValues = reinterpret_cast <const dcomplex *> (values);
+			rewind (f);
+			for (integer i = 0; i < numberOfComplexValues; i ++)
+				binputc128 (complexValues [i], f);
+			expectedBytes = fileBytes (f);
+			for (integer i = 0; i < numberOfComplexValues; i ++) {
+				const dcomplex z = bingetc128 (f);
+				expectedValues [2 * i + 1] = z.real();
+				expectedValues [2 * i + 2] = z.imag();
+			}
+			rewind (f);
+			bingetc128 (f, reinterpret_cast <dcomplex *> (& readValues [1]), numberOfComplexValues);
+			checkSameValues (& readValues [1], & expectedValues [1], 2 * numberOfComplexValues, U"bingetc128");
+			rewind (f);
+			binputc128 (complexValues, numberOfComplexValues, f);
+			checkSameBytes (f, expectedBytes.get(), U"binputc128");
+			rewind (f);
+			vector_writeBinary_c128 (constCOMPVEC (complexValues, numberOfComplexValues), f);
+			checkSameBytes (f, expectedBytes.get(), U"vector_writeBinary_c128");
+			autoCOMPVEC complexVec = vector_readBinary_c128 (numberOfComplexValues, f);
+			checkSameValues (reinterpret_cast <const double *> (complexVec.cells), & expectedValues [1], 2 * numberOfComplexValues,
+					U"vector_readBinary_c128");
+			fclose (f);
+		} catch (MelderError) {
+			if (f)
+				fclose (f);
+			Melder_throw (U"Bulk binary I/O of ", nrow, U" x ", ncol, U" values failed.");
+		}
+	}
+	MelderInfo_writeLine (U"checkBulkBinaryIO: OK");
+}
+
+/*
+	8-bit signed and unsigned, mu-law and A-law sound files, written byte by byte
+	and checked against the G.711 formulas rather than against the decoding tables in melder_audiofiles.
+	A truncated file, cut off in the middle of a frame, should read as zero from the first missing byte on.
+*/
+static double decodeG711mulaw (uint8 byte) {
+	const integer u = (byte ^ 0xFF);
+	const integer magnitude = ((((u & 0x0F) << 3) + 0x84) << ((u >> 4) & 7)) - 0x84;
+	return ( u & 0x80 ? - magnitude : magnitude ) / 32768.0;
+}
+
+static double decodeG711alaw (uint8 byte) {
+	const integer a = (byte ^ 0x55);
+	const integer exponent = (a >> 4) & 7, mantissa = a & 0x0F;
+	const integer magnitude = ( exponent == 0 ? (mantissa << 4) + 8 : ((mantissa << 4) + 0x108) << (exponent - 1) );
+	return ( a & 0x80 ? magnitude : - magnitude ) / 32768.0;
+}
+
+static void checkSoundFileDecoding (conststring32 fileNameStem, integer numberOfFrames, integer numberOfMissingBytes) {
+	const integer numberOfChannels = 2, numberOfBytes = numberOfChannels * numberOfFrames;
+	const integer numberOfBytesWritten = numberOfBytes - numberOfMissingBytes;
+	autoBYTEVEC bytes = raw_BYTEVEC (numberOfBytes);
+	for (integer ibyte = 1; ibyte <= numberOfBytes; ibyte ++)
+		bytes [ibyte] = (byte) NUMrandomInteger (0, 255);
+	for (integer ibyte = 1; ibyte <= 256; ibyte ++)
+		bytes [ibyte] = (byte) (ibyte - 1);   // every byte value at least once
+	const struct { conststring32 name, extension; integer sunEncoding; double (*decode) (uint8); } formats [] = {
+		{ U"8-bit signed", U"au", 2, [] (uint8 byte) { return (int8) byte / 128.0; } },
+		{ U"8-bit unsigned", U"wav", 0, [] (uint8 byte) { return byte / 128.0 - 1.0; } },
+		{ U"μ-law", U"au", 1, decodeG711mulaw },
+		{ U"A-law", U"au", 27, decodeG711alaw }
+	};
+	for (const auto& format : formats) {
+		structMelderFile file { };
+		Melder_relativePathToFile (Melder_cat (fileNameStem, U".", format.extension), & file);
+		try {
+			autofile f = Melder_fopen (& file, "wb");
+			if (format.sunEncoding != 0) {
+				fwrite (".snd", 1, 4, f);
+				binputi32 (24, f);
+				binputi32 ((int32) numberOfBytes, f);
+				binputi32 ((int32) format.sunEncoding, f);
+				binputi32 (8000, f);
+				binputi32 ((int32) numberOfChannels, f);
+			} else {
+				fwrite ("RIFF", 1, 4, f);
+				binputi32LE ((int32) (36 + numberOfBytes), f);
+				fwrite ("WAVEfmt ", 1, 8, f);
+				binputi32LE (16, f);
+				binputi16LE (1, f);   // PCM
+				binputi16LE ((int16) numberOfChannels, f);
+				binputi32LE (8000, f);
+				binputi32LE ((int32) (8000 * numberOfChannels), f);
+				binputi16LE ((int16) numberOfChannels, f);
+				binputi16LE (8, f);
+				fwrite ("data", 1, 4, f);
+				binputi32LE ((int32) numberOfBytes, f);
+			}
+			fwrite (& bytes [1], 1, (size_t) numberOfBytesWritten, f);
+			f.close (& file);
+			autoSound sound;
+			double t;
+			{// scope
+				autoMelderWarningOff nowarn;
+				Melder_stopwatch ();
+				sound = Sound_readFromSoundFile (& file);
+				t = Melder_stopwatch ();
+			}
+			MelderFile_delete (& file);
+			Melder_require (sound -> ny == numberOfChannels && sound -> nx == numberOfFrames,
+				U"The sound has ", sound -> ny, U" channels and ", sound -> nx, U" samples instead of ", numberOfChannels, U" and ", numberOfFrames, U".");
+			for (integer ibyte = 1; ibyte <= numberOfBytes; ibyte ++) {
+				const integer ichan = 1 + (ibyte - 1) % numberOfChannels, isamp = 1 + (ibyte - 1) / numberOfChannels;
+				const double expected = ( ibyte <= numberOfBytesWritten ? format.decode (bytes [ibyte]) : 0.0 );
+				Melder_require (sound -> z [ichan] [isamp] == expected,
+					U"Sample ", isamp, U" of channel ", ichan, U" is ", sound -> z [ichan] [isamp], U" instead of ", expected, U".");
+			}
+			if (numberOfMissingBytes == 0)
+				MelderInfo_writeLine (format.name, U": ", Melder_fixed (t, 3), U" seconds");
+		} catch (MelderError) {
+			MelderFile_delete (& file);
+			Melder_throw (format.name, U" sound file of ", numberOfFrames, U" frames",
+				numberOfMissingBytes > 0 ? U" with missing bytes" : U"", U" not read correctly.");
+		}
+	}
+}
+
+static void checkSoundFileDecoding (conststring32 fileNameStem) {
+	checkSoundFileDecoding (fileNameStem, 5'000'003, 0);
+	checkSoundFileDecoding (fileNameStem, 100'003, 2 * 1000 + 1);   // truncated in the middle of a frame
+	MelderInfo_writeLine (U"checkSoundFileDecoding: OK");
+}
+
 int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, conststring32 arg3, conststring32 arg4) {
 	int64 n = Melder_atoi (arg1);
 	double t = 0.0;
@@ -492,6 +733,25 @@ int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, cons
 			MelderInfo_writeLine (sum, U" should be ", size1 * size2 * size3 * 30.0);
 			//Melder_require (NUMequal (result.get(), constantHH (size, size, size * 30.0).get()), U"...");
 		} break;
+		case kPraatTests::TIME_MATMUL_FAST: {
+			const integer size1 = Melder_atoi (arg2);
+			integer size2 = Melder_atoi (arg3);
+			integer size3 = Melder_atoi (arg4);
+			if (size2 == 0 || size3 == 0) size3 = size2 = size1;
+			autoMAT x = constantHH (size1, size2, 10.0);
+			autoMAT y = constantHH (size2, size3, 3.0);
+			autoMAT const result = raw_MAT (size1, size3);
+			MATVU const result_all = result.all();
+			constMATVU const x_all = x.all();
+			constMATVU const y_all = y.all();
+			Melder_stopwatch ();
+			for (integer iteration = 1; iteration <= n; iteration ++)
+				_mul_fast_MAT_out (result_all, x_all, y_all);
+			const integer numberOfComputations = size1 * size2 * size3 * 2;
+			t = Melder_stopwatch () / numberOfComputations;
+			const double sum = NUMsum (result.get());
+			MelderInfo_writeLine (sum, U" should be ", size1 * size2 * size3 * 30.0);
+		} break;
 		case kPraatTests::THING_AUTO: {
 			integer numberOfThingsBefore = theTotalNumberOfThings;
 			{
@@ -669,6 +929,34 @@ int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, cons
 			timeMultiThreading (durationOfSound);
 			//  Gflops is --undefined--
 		} break;
+		case kPraatTests::GAMMATONE_FILTERBANKS: {
+			test_Sound_to_SPINET ();
+			test_Sound_to_Cochleagram_edb ();
+		} break;
+		case kPraatTests::FFNET_COSTS_AND_DERIVATIVE: {
+			test_FFNet_computeCostsAndDerivative ();
+		} break;
+		case kPraatTests::BULK_BINARY_IO: {
+			checkBulkBinaryIO ();
+		} break;
+		case kPraatTests::HMM_LEARN_THREADS: {
+			test_HMM_HMMObservationSequenceBag_learn ();
+		} break;
+		case kPraatTests::DTW_CORRIDORS: {
+			test_DTW_findPath_corridors ();
+		} break;
+		case kPraatTests::SOUND_FILE_DECODING: {
+			checkSoundFileDecoding (arg1);
+		} break;
+		case kPraatTests::GAUSSIAN_MIXTURE_STEPS: {
+			test_GaussianMixture_blockedSteps ();
+		} break;
+		case kPraatTests::MDS_THREADS: {
+			test_MDS_multiSmacof_threads ();
+		} break;
+		case kPraatTests::NMF_BLOCKS: {
+			test_NMF_blockedUpdates ();
+		} break;
 		
 	}
 	MelderInfo_writeLine (Melder_single (n / t * 1e-9), U" Gflop/s");
@@ -63,6 +63,16 @@ enums_begin (kPraatTests, 0)
 	enums_add (kPraatTests, 43, THING_AUTO, U"ThingAuto")
 	enums_add (kPraatTests, 44, FILEINMEMORY_IO, U"FileInMemory_io")
 	enums_add (kPraatTests, 45, TIME_MULTI_THREADING, U"TimeMultiThreading")
-enums_end (kPraatTests, 45, CHECK_RANDOM_1009_2009)
+	enums_add (kPraatTests, 46, TIME_MATMUL_FAST, U"TimeMatMulFast")
+	enums_add (kPraatTests, 47, GAMMATONE_FILTERBANKS, U"GammatoneFilterbanks")
+	enums_add (kPraatTests, 48, FFNET_COSTS_AND_DERIVATIVE, U"FFNetCostsAndDerivative")
+	enums_add (kPraatTests, 49, BULK_BINARY_IO, U"BulkBinaryIO")
+	enums_add (kPraatTests, 50, HMM_LEARN_THREADS, U"HMMLearnThreads")
+	enums_add (kPraatTests, 51, DTW_CORRIDORS, U"DTWCorridors")
+	enums_add (kPraatTests, 52, SOUND_FILE_DECODING, U"SoundFileDecoding")
+	enums_add (kPraatTests, 53, GAUSSIAN_MIXTURE_STEPS, U"GaussianMixtureSteps")
+	enums_add (kPraatTests, 54, MDS_THREADS, U"MDSThreads")
+	enums_add (kPraatTests, 55, NMF_BLOCKS, U"NMFBlocks")
+enums_end (kPraatTests, 55, CHECK_RANDOM_1009_2009)
 
 /* End of file Praat_tests_enums.h */
@@ -25,6 +25,7 @@
 #include "Sound.h"
 #include "Sound_extensions.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #include "enums_getText.h"
 #include "Sound_enums.h"
@@ -542,6 +543,118 @@ autoSound Sounds_concatenate (SoundList list, double overlapTime) {
 	}
 }
 
+/*
+	result [1..signal.size + kernel.size - 1] := signal * kernel (linear convolution),
+	computed by overlap-add with FFTs of size fftTable -> n:
+	the signal is cut into blocks of fftTable -> n - kernel.size + 1 samples,
+	each block is convolved with the kernel spectrum, and the tails of consecutive blocks are added.
+	If fftTable -> n is at least signal.size + kernel.size - 1, there is only one block,
+	and this is the classic single-FFT convolution.
+	If `reverseKernel` is true, the kernel is time-reversed first (this is for cross-correlation).
+	The result is normalized, i.e. it does not contain the factor fftTable -> n of the inverse FFT.
+	`kernelSpectrum` and `block` are scratch vectors of size fftTable -> n.
+*/
+static void VECconvolve_overlapAdd (VEC const& result, constVEC const& signal, constVEC const& kernel, const bool reverseKernel,
+	NUMfft_Table fftTable, VEC const& kernelSpectrum, VEC const& block)
+{
+	const integer nfft = fftTable -> n, kernelSize = kernel.size, blockSize = nfft - kernelSize + 1;
+	Melder_assert (blockSize >= 1);
+	Melder_assert (result.size == signal.size + kernelSize - 1);
+	Melder_assert (kernelSpectrum.size == nfft && block.size == nfft);
+	for (integer i = 1; i <= kernelSize; i ++)
+		kernelSpectrum [i] = kernel [reverseKernel ? kernelSize + 1 - i : i];
+	kernelSpectrum.part (kernelSize + 1, nfft)  <<=  0.0;
+	NUMfft_forward (fftTable, kernelSpectrum);
+	result  <<=  0.0;
+	const double scale = 1.0 / nfft;
+	for (integer offset = 0; offset < signal.size; offset += blockSize) {
+		const integer numberOfSignalSamples = std::min (blockSize, signal.size - offset);
+		block.part (1, numberOfSignalSamples)  <<=  signal.part (offset + 1, offset + numberOfSignalSamples);
+		block.part (numberOfSignalSamples + 1, nfft)  <<=  0.0;
+		NUMfft_forward (fftTable, block);
+		/*
+			Complex multiplication in the half-complex layout of NUMfft_forward:
+			block [1] is the DC component, block [nfft] the Nyquist component (both real),
+			and (block [2*k], block [2*k+1]) are the real and imaginary parts of component k.
+		*/
+		block [1] *= kernelSpectrum [1];
+		if (nfft > 1) {
+			for (integer i = 2; i < nfft; i += 2) {
+				const double re = block [i] * kernelSpectrum [i] - block [i + 1] * kernelSpectrum [i + 1];
+				block [i + 1] = block [i] * kernelSpectrum [i + 1] + block [i + 1] * kernelSpectrum [i];
+				block [i] = re;
+			}
+			block [nfft] *= kernelSpectrum [nfft];
+		}
+		NUMfft_backward (fftTable, block);
+		const integer numberOfResultSamples = std::min (numberOfSignalSamples + kernelSize - 1, result.size - offset);
+		for (integer i = 1; i <= numberOfResultSamples; i ++)
+			result [offset + i] += block [i] * scale;
+	}
+}
+
+/*
+	The FFT size for convolving a signal of length `longSize` with a kernel of length `shortSize`.
+	If the kernel is much shorter than the signal, a single FFT over the whole signal
+	(of size roughly longSize + shortSize) would need two huge buffers and would be slower
+	than overlap-add with blocks of a few times the kernel length,
+	which costs about 2 * (longSize / blockSize) FFTs of size nfft.
+*/
+static integer getConvolutionFftSize (integer longSize, integer shortSize, bool *out_isPartitioned) {
+	const integer fullSize = Melder_iroundUpToPowerOfTwo (longSize + shortSize - 1);
+	const integer partitionedSize = Melder_iroundUpToPowerOfTwo (std::max (4 * shortSize, 1024_integer));
+	const bool isPartitioned = ( 4 * partitionedSize <= fullSize );
+	if (out_isPartitioned)
+		*out_isPartitioned = isPartitioned;
+	return isPartitioned ? partitionedSize : fullSize;
+}
+
+/*
+	result [channel] := x [channel] * y [channel] for all channels (with one-channel inputs applying to all channels),
+	or, if `crossCorrelate` is true, the cross-correlation of x and y, with lag zero at sample x.ncol.
+	Cross-correlation is convolution with a time-reversed x; if x is the longer signal,
+	we use that the convolution of reversed x with y is the reversed convolution of x with reversed y,
+	so that it is always the shorter input that is reversed (and transformed once per channel).
+	For partitioned (overlap-add) convolution the memory use is bounded by a few times the length
+	of the shorter input per channel, so that channels can be handled in parallel.
+*/
+static void MATconvolveChannels (MAT const& result, constMAT const& x, constMAT const& y, const bool crossCorrelate) {
+	const integer numberOfChannels = result.nrow, n1 = x.ncol, n2 = y.ncol;
+	Melder_assert (result.ncol == n1 + n2 - 1);
+	const bool xIsTheSignal = ( n1 >= n2 );
+	const integer longSize = std::max (n1, n2), shortSize = std::min (n1, n2);
+	bool isPartitioned;
+	const integer nfft = getConvolutionFftSize (longSize, shortSize, & isPartitioned);
+	integer numberOfThreads = 1;
+	if (isPartitioned) {
+		numberOfThreads = std::min (numberOfChannels, MelderThread_getNumberOfProcessors ());
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	}
+	/*
+		The transforms use the table's trigcache as a work array, so every thread needs its own table.
+	*/
+	std::vector <autoNUMfft_Table> fftTables (integer_to_uinteger (numberOfThreads));
+	for (autoNUMfft_Table& fftTable : fftTables)
+		NUMfft_Table_init (& fftTable, nfft);
+	autoMAT kernelSpectra = raw_MAT (numberOfThreads, nfft);
+	autoMAT blocks = raw_MAT (numberOfThreads, nfft);
+	auto convolveChannels = [&] (integer ithread) {
+		for (integer channel = ithread; channel <= numberOfChannels; channel += numberOfThreads) {
+			constVEC xChannel = x.row (x.nrow == 1 ? 1 : channel);
+			constVEC yChannel = y.row (y.nrow == 1 ? 1 : channel);
+			const VEC resultChannel = result.row (channel);
+			const bool reverseResult = ( crossCorrelate && xIsTheSignal );
+			const bool reverseKernel = ( crossCorrelate );
+			VECconvolve_overlapAdd (resultChannel, xIsTheSignal ? xChannel : yChannel, xIsTheSignal ? yChannel : xChannel,
+				reverseKernel, & fftTables [integer_to_uinteger (ithread - 1)], kernelSpectra.row (ithread), blocks.row (ithread));
+			if (reverseResult)
+				for (integer i = 1, j = resultChannel.size; i < j; i ++, j --)
+					std::swap (resultChannel [i], resultChannel [j]);
+		}
+	};
+	MelderThread_run (numberOfThreads, convolveChannels);
+}
+
 autoSound Sounds_convolve (constSound me, constSound thee, kSounds_convolve_scaling scaling, kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain) {
 	try {
 		if (my ny > 1 && thy ny > 1 && my ny != thy ny)
@@ -550,36 +663,9 @@ autoSound Sounds_convolve (constSound me, constSound thee, kSounds_convolve_scal
 			Melder_throw (U"The sampling frequencies of the two sounds have to be equal.");
 		const integer n1 = my nx, n2 = thy nx;
 		const integer n3 = n1 + n2 - 1;
-		const integer nfft = Melder_iroundUpToPowerOfTwo (n3);
-		autoVEC data1 = raw_VEC (nfft);
-		autoVEC data2 = raw_VEC (nfft);
 		integer numberOfChannels = std::max (my ny, thy ny);
 		autoSound him = Sound_create (numberOfChannels, my xmin + thy xmin, my xmax + thy xmax, n3, my dx, my x1 + thy x1);
-		for (integer channel = 1; channel <= numberOfChannels; channel ++) {
-			VEC a = my z.row (my ny == 1 ? 1 : channel);
-			for (integer i = n1; i > 0; i --)
-				data1 [i] = a [i];
-			for (integer i = n1 + 1; i <= nfft; i ++)
-				data1 [i] = 0.0;
-			a = thy z.row (thy ny == 1 ? 1 : channel);
-			for (integer i = n2; i > 0; i --)
-				data2 [i] = a [i];
-			for (integer i = n2 + 1; i <= nfft; i ++)
-				data2 [i] = 0.0;
-			NUMrealft (data1.get(), 1);
-			NUMrealft (data2.get(), 1);
-			data2 [1] *= data1 [1];
-			data2 [2] *= data1 [2];
-			for (integer i = 3; i <= nfft; i += 2) {
-				const double temp = data1 [i] * data2 [i] - data1 [i + 1] * data2 [i + 1];
-				data2 [i + 1] = data1 [i] * data2 [i + 1] + data1 [i + 1] * data2 [i];
-				data2 [i] = temp;
-			}
-			NUMrealft (data2.get(), -1);
-			a = his z.row (channel);
-			for (integer i = 1; i <= n3; i ++)
-				a [i] = data2 [i];
-		}
+		MATconvolveChannels (his z.get(), my z.get(), thy z.get(), false);
 		switch (signalOutsideTimeDomain) {
 			case kSounds_convolve_signalOutsideTimeDomain::ZERO: {
 				// do nothing
@@ -602,15 +688,15 @@ autoSound Sounds_convolve (constSound me, constSound thee, kSounds_convolve_scal
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling::INTEGRAL: {
-				Vector_multiplyByScalar (him.get(), my dx / nfft);
+				Vector_multiplyByScalar (him.get(), my dx);
 			} break;
 			case kSounds_convolve_scaling::SUM: {
-				Vector_multiplyByScalar (him.get(), 1.0 / nfft);
+				// do nothing: MATconvolveChannels has already normalized the FFTs
 			} break;
 			case kSounds_convolve_scaling::NORMALIZE: {
 				double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (thee);
 				if (normalizationFactor != 0.0)
-					Vector_multiplyByScalar (him.get(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (him.get(), 1.0 / normalizationFactor);
 			} break;
 			case kSounds_convolve_scaling::PEAK_099: {
 				Vector_scale (him.get(), 0.99);
@@ -631,38 +717,9 @@ autoSound Sounds_crossCorrelate (constSound me, constSound thee, kSounds_convolv
 			U"The sampling frequencies of the two sounds have to be equal.");
 		const integer numberOfChannels = std::max (my ny, thy ny);
 		const integer n1 = my nx, n2 = thy nx, n3 = n1 + n2 - 1;
-		const integer nfft = Melder_iroundUpToPowerOfTwo (n3);
-		autoVEC data1 = raw_VEC (nfft);
-		autoVEC data2 = raw_VEC (nfft);
 		const double my_xlast = my x1 + (n1 - 1) * my dx;
 		autoSound him = Sound_create (numberOfChannels, thy xmin - my xmax, thy xmax - my xmin, n3, my dx, thy x1 - my_xlast);
-		for (integer channel = 1; channel <= numberOfChannels; channel ++) {
-			VEC a = my z.row (my ny == 1 ? 1 : channel);
-			for (integer i = n1; i > 0; i --)
-				data1 [i] = a [i];
-			for (integer i = n1 + 1; i <= nfft; i ++)
-				data1 [i] = 0.0;
-			a = thy z.row (thy ny == 1 ? 1 : channel);
-			for (integer i = n2; i > 0; i --)
-				data2 [i] = a [i];
-			for (integer i = n2 + 1; i <= nfft; i ++)
-				data2 [i] = 0.0;
-			NUMrealft (data1.get(), 1);
-			NUMrealft (data2.get(), 1);
-			data2 [1] *= data1 [1];
-			data2 [2] *= data1 [2];
-			for (integer i = 3; i <= nfft; i += 2) {
-				const double temp = data1 [i] * data2 [i] + data1 [i + 1] * data2 [i + 1];   // reverse me by taking the conjugate of data1
-				data2 [i + 1] = data1 [i] * data2 [i + 1] - data1 [i + 1] * data2 [i];   // reverse me by taking the conjugate of data1
-				data2 [i] = temp;
-			}
-			NUMrealft (data2.get(), -1);
-			a = his z.row (channel);
-			for (integer i = 1; i < n1; i ++)
-				a [i] = data2 [i + (nfft - (n1 - 1))];   // data for the first part ("negative lags") is at the end of data2
-			for (integer i = 1; i <= n2; i ++)
-				a [i + (n1 - 1)] = data2 [i];   // data for the second part ("positive lags") is at the beginning of data2
-		}
+		MATconvolveChannels (his z.get(), my z.get(), thy z.get(), true);
 		switch (signalOutsideTimeDomain) {
 			case kSounds_convolve_signalOutsideTimeDomain::ZERO: {
 				// do nothing
@@ -685,15 +742,15 @@ autoSound Sounds_crossCorrelate (constSound me, constSound thee, kSounds_convolv
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling::INTEGRAL: {
-				Vector_multiplyByScalar (him.get(), my dx / nfft);
+				Vector_multiplyByScalar (him.get(), my dx);
 			} break;
 			case kSounds_convolve_scaling::SUM: {
-				Vector_multiplyByScalar (him.get(), 1.0 / nfft);
+				// do nothing: MATconvolveChannels has already normalized the FFTs
 			} break;
 			case kSounds_convolve_scaling::NORMALIZE: {
 				const double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (thee);
 				if (normalizationFactor != 0.0)
-					Vector_multiplyByScalar (him.get(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (him.get(), 1.0 / normalizationFactor);
 			} break;
 			case kSounds_convolve_scaling::PEAK_099: {
 				Vector_scale (him.get(), 0.99);
@@ -1,6 +1,6 @@
 /* SoundSet.cpp
  *
- * Copyright (C) 2019-2021,2023 Paul Boersma
+ * Copyright (C) 2019-2021,2023,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,6 +17,8 @@
  */
 
 #include "SoundSet.h"
+#include "MelderThread.h"
+#include <atomic>
 
 Thing_implement (SoundSet, Ordered, 0);
 
@@ -86,4 +88,88 @@ void SoundSet_Table_getRandomizedPatterns (SoundSet me, Table thee, conststring3
 	}
 }
 
+static conststring32 oneLine (mutablestring32 message) {
+	integer length = Melder_length (message);
+	while (length > 0 && message [length - 1] == U'\n')
+		message [-- length] = U'\0';
+	for (char32 *p = message; *p != U'\0'; p ++)
+		if (*p == U'\n')
+			*p = U' ';   // one line per file
+	return message;
+}
+
+autoSoundSet SoundSet_readFromSoundFiles (MelderFolder folder, constSTRVEC const& fileNames, autoTable *out_report) {
+	try {
+		const integer numberOfFiles = fileNames.size;
+		/*
+			Everything that can fail or allocate, apart from the reading itself, is done here, in the main thread.
+		*/
+		autovector <structMelderFile> files = newvectorzero <structMelderFile> (numberOfFiles);
+		for (integer ifile = 1; ifile <= numberOfFiles; ifile ++) {
+			if (folder)
+				MelderFolder_relativePathToFile (folder, fileNames [ifile], & files [ifile]);   // absolute paths stay as they are
+			else
+				Melder_relativePathToFile (fileNames [ifile], & files [ifile]);
+		}
+		const conststring32 columnNames [] = { U"file", U"numberOfChannels", U"duration", U"status" };
+		autoTable report = Table_createWithColumnNames (numberOfFiles, ARRAY_TO_STRVEC (columnNames));
+		std::vector <autoSound> sounds (integer_to_uinteger (numberOfFiles));   // filled in by the threads
+		autoSTRVEC errors (numberOfFiles), warnings (numberOfFiles);
+
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfFiles);
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		std::atomic <integer> nextFile (1);
+		auto readFiles = [&] (integer /* ithread */) {
+			for (integer ifile = nextFile ++; ifile <= numberOfFiles; ifile = nextFile ++) {
+				try {
+					autoMelderString fileWarnings;
+					autoSound sound;
+					{// scope
+						autoMelderWarningCollector collector (& fileWarnings);   // warnings have to stay off the screen in a worker thread
+						sound = Sound_readFromSoundFile (& files [ifile]);
+					}
+					if (fileWarnings.length > 0)
+						warnings [ifile] = Melder_dup (fileWarnings.string);
+					autostring32 name = Melder_dup (MelderFile_name (& files [ifile]));
+					char32 *lastPeriod = str32rchr (name.get(), U'.');
+					if (lastPeriod)
+						*lastPeriod = U'\0';
+					Thing_setName (sound.get(), name.get());
+					sounds [integer_to_uinteger (ifile - 1)] = sound.move();
+				} catch (MelderError) {
+					errors [ifile] = Melder_dup (Melder_getError ());
+					Melder_clearError ();
+				}
+			}
+		};
+		MelderThread_run (numberOfThreads, readFiles);
+
+		autoSoundSet result = SoundSet_create ();
+		for (integer ifile = 1; ifile <= numberOfFiles; ifile ++) {
+			Table_setStringValue (report.get(), ifile, 1, fileNames [ifile]);
+			Sound sound = sounds [integer_to_uinteger (ifile - 1)].get();
+			if (sound) {
+				Table_setNumericValue (report.get(), ifile, 2, sound -> ny);
+				Table_setNumericValue (report.get(), ifile, 3, sound -> xmax - sound -> xmin);
+				if (warnings [ifile])
+					Table_setStringValue (report.get(), ifile, 4, Melder_cat (U"Warning: ", oneLine (warnings [ifile].get())));   // e.g. a truncated file
+				else
+					Table_setStringValue (report.get(), ifile, 4, U"OK");
+			} else {
+				Table_setNumericValue (report.get(), ifile, 2, 0);
+				Table_setNumericValue (report.get(), ifile, 3, 0.0);
+				Table_setStringValue (report.get(), ifile, 4, oneLine (errors [ifile].get()));
+			}
+		}
+		for (autoSound& sound : sounds)
+			if (sound)
+				result -> addItem_move (sound.move());
+		if (out_report)
+			*out_report = report.move();
+		return result;
+	} catch (MelderError) {
+		Melder_throw (U"Sound files not read.");
+	}
+}
+
 /* End of file SoundSet.cpp */
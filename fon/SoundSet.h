@@ -2,7 +2,7 @@
 #define _SoundSet_h_
 /* SoundSet.h
  *
- * Copyright (C) 2019,2024 Paul Boersma
+ * Copyright (C) 2019,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -33,5 +33,15 @@ autoMAT SoundSet_getRandomizedPatterns (SoundSet me, integer numberOfPatterns, i
 void SoundSet_Table_getRandomizedPatterns (SoundSet me, Table thee, conststring32 columnName, integer numberOfPatterns, integer inputSize, integer outputSize,
 	autoPatternList *out_inputs, autoPatternList *out_outputs);
 
+/*
+	Reads the sound files concurrently, at most one file per thread at a time.
+	Relative file names are relative to `folder`, or to the default folder if `folder` is null;
+	absolute file names are used as they are.
+	A file that cannot be read does not stop the others: it is left out of the SoundSet.
+	The report has one row per file, in the given order; its "status" column is "OK" or the error message.
+	Warnings (e.g. about truncated files) are suppressed.
+*/
+autoSoundSet SoundSet_readFromSoundFiles (MelderFolder folder, constSTRVEC const& fileNames, autoTable *out_report);
+
 /* End of file SoundSet.h */
 #endif
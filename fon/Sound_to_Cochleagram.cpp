@@ -31,6 +31,8 @@
 #include "Sound_to_Cochleagram.h"
 #include "Sound_and_Spectrum.h"
 #include "Spectrum_to_Excitation.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_window, double forwardMaskingTime) {
 	try {
@@ -83,25 +85,120 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 	}
 }
 
-static autoSound createGammatone (double midFrequency_Hertz, double samplingFrequency) {
-	double lengthOfGammatone_seconds = 50.0 / midFrequency_Hertz;   // 50 periods
-	integer lengthOfGammatone_samples;
+/*
+	EdB's gammatone for a given mid frequency is
+		x^3 * exp (- x) * cos (omega * (t - latency)),   x = (t - latency) / decayTime,   t > latency,
+	of which the first 50 periods used to be convolved with the sound.
+	This is the gammatone of NUMgammatoneFilterbank_setFilter with gamma = 4,
+	bandwidth = 1 / (2 pi decayTime) and amplitude = 1 / decayTime^3,
+	which we apply recursively rather than by convolution.
+*/
+static void setGammatone (NUMgammatoneFilterbank filterbank, double midFrequency_Hertz) {
 	/* EdB's alfa1: */
 	double latency = 1.95e-3 * pow (midFrequency_Hertz / 1000, -0.725) + 0.6e-3;
 	/* EdB's beta: */
 	double decayTime = 1e-3 * pow (midFrequency_Hertz / 1000, -0.663);
-	/* EdB's omega: */
-	double midFrequency_radPerSecond = 2 * NUMpi * midFrequency_Hertz;
-	autoSound gammatone = Sound_createSimple (1, lengthOfGammatone_seconds, samplingFrequency);
-	lengthOfGammatone_samples = gammatone -> nx;
-	for (integer itime = 1; itime <= lengthOfGammatone_samples; itime ++) {
-		double time_seconds = (itime - 0.5) / samplingFrequency;
-		double timeAfterLatency = time_seconds - latency;
-		double x = timeAfterLatency / decayTime;
-		if (time_seconds > latency) gammatone -> z [1] [itime] =
-			x * x * x * exp (- x) * cos (midFrequency_radPerSecond * timeAfterLatency);
+	NUMgammatoneFilterbank_setFilter (filterbank, 1, midFrequency_Hertz, 1.0 / (2.0 * NUMpi * decayTime),
+			latency, 1.0 / (decayTime * decayTime * decayTime));
+	NUMgammatoneFilterbank_reset (filterbank);
+}
+
+static void Sound_into_Cochleagram_edb_row (Sound me, Cochleagram thee, integer ifreq, double dtime,
+	int hasSynapse, double replenishmentRate, double lossRate, double returnRate, double reprocessingRate,
+	NUMgammatoneFilterbank filterbank, VEC const& basilBuffer)
+{
+	double *response = & thy z [ifreq] [0];
+	integer ntime = thy nx;
+
+	/* Stage 3: basilar membrane filtering by gammatones. */
+	/* From oval window to basilar membrane response. */
+
+	double midFrequency_Bark = (ifreq - 0.5) * thy dy;
+	double midFrequency_Hertz = NUMbarkToHertz (midFrequency_Bark);
+	double lengthOfGammatone_seconds = 50.0 / midFrequency_Hertz;   // 50 periods
+	integer lengthOfGammatone_samples = (integer) round (lengthOfGammatone_seconds * (1.0 / my dx));
+	/*
+		The basilar membrane response has the time sampling of the convolution of the sound with the gammatone.
+	*/
+	integer basil_nx = my nx + lengthOfGammatone_samples - 1;
+	double basil_x1 = my x1 + 0.5 * my dx;
+	Melder_assert (basil_nx <= basilBuffer.size);
+	VEC basil = basilBuffer.part (1, basil_nx);
+	setGammatone (filterbank, midFrequency_Hertz);
+	NUMgammatoneFilterbank_filter (filterbank, my z.row (1), basil.asmatrix (1, basil_nx));
+
+	/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
+	/* From basilar membrane response to firing rate. */
+
+	if (hasSynapse) {
+		double dt = my dx;
+		double M = 1.0;   // maximum free transmitter
+		double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
+		double y = replenishmentRate;            // Meddis: 5.05
+		double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
+		double x = reprocessingRate;             // Meddis: 66.31
+		double h = 50000;   // convert cleft contents to firing rate
+		double gdt = 1.0 - exp (- g * dt);
+		double ydt = 1.0 - exp (- y * dt);
+		double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
+		double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
+		double xdt = 1.0 - exp (- x * dt);
+		double kt = g * A / (A + B);   // membrane permeability
+		double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
+		double q = c * (l + r) / kt;   // free transmitter
+		double w = c * r / x;   // reprocessing store
+		for (integer itime = 1; itime <= basil_nx; itime ++) {
+			double splusA = basil [itime] * 10.0 + A;
+			double replenish = ( M > q ? ydt * (M - q) : 0.0 );
+			kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
+			double eject = kt * q;
+			double loss = ldt * c;
+			double reuptake = rdt * c;
+			double reprocess = xdt * w;
+			q = q + replenish - eject + reprocess;
+			c = c + eject - loss - reuptake;
+			w = w + reuptake - reprocess;
+			basil [itime] = h * c;
+		}
+	}
+
+	if (dtime == my dx) {
+		for (integer itime = 1; itime <= ntime; itime ++)
+			response [itime] = basil [itime];
+	} else {
+		double d = dtime / my dx / 2.0;
+		double factor = -6 / d / d;
+		double area = d * sqrt (NUMpi / 6);
+		double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+		for (integer itime = 1; itime <= ntime; itime ++) {
+			double t1 = (itime - 1) * dtime;
+			double t2 = t1 + dtime;
+			double mean = 0.0;
+			/*
+				The samples of the basilar membrane response between t1 and t2 (cf. Matrix_getWindowSamplesX).
+			*/
+			integer i1 = 1 + Melder_iceiling ((t1 - basil_x1) / my dx);
+			integer i2 = 1 + Melder_ifloor ((t2 - basil_x1) / my dx);
+			Melder_clipLeft (1_integer, & i1);
+			Melder_clipRight (& i2, basil_nx);
+			integer n = std::max (i2 - i1 + 1, 0_integer);
+			Melder_assert (n >= 1);
+			if (n <= 2) {
+				for (integer isamp = i1; isamp <= i2; isamp ++)
+					mean += basil [isamp];
+				mean /= n;
+			} else {
+				integer muint = Melder_ifloor ((i1 + i2) / 2.0), dint = Melder_ifloor (d);
+				for (integer isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+					double y = ( isamp < 1 || isamp > basil_nx ? 0.0 : basil [isamp] );
+					mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
+						(isamp - muint)) - expmin6);
+				}
+				mean /= area;
+			}
+			response [itime] = mean;
+		}
 	}
-	return gammatone;
 }
 
 autoCochleagram Sound_to_Cochleagram_edb
@@ -120,91 +217,117 @@ autoCochleagram Sound_to_Cochleagram_edb
 		/* Stages 1 and 2: outer- and middle-ear filtering. */
 		/* From acoustic sound to oval window. */
 
-		for (integer ifreq = 1; ifreq <= nfreq; ifreq ++) {
-			double *response = & thy z [ifreq] [0];
-
-			/* Stage 3: basilar membrane filtering by gammatones. */
-			/* From oval window to basilar membrane response. */
-
-			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
-			double midFrequency_Hertz = NUMbarkToHertz (midFrequency_Bark);
-			autoSound gammatone = createGammatone (midFrequency_Hertz, 1.0 / my dx);
-			autoSound basil = Sounds_convolve (me, gammatone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
-
-			/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
-			/* From basilar membrane response to firing rate. */
-
-			if (hasSynapse) {
-				double dt = my dx;
-				double M = 1.0;   // maximum free transmitter
-				double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
-				double y = replenishmentRate;            // Meddis: 5.05
-				double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
-				double x = reprocessingRate;             // Meddis: 66.31
-				double h = 50000;   // convert cleft contents to firing rate
-				double gdt = 1.0 - exp (- g * dt);
-				double ydt = 1.0 - exp (- y * dt);
-				double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
-				double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
-				double xdt = 1.0 - exp (- x * dt);
-				double kt = g * A / (A + B);   // membrane permeability
-				double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
-				double q = c * (l + r) / kt;   // free transmitter
-				double w = c * r / x;   // reprocessing store
-				for (integer itime = 1; itime <= basil -> nx; itime ++) {
-					double splusA = basil -> z [1] [itime] * 10.0 + A;
-					double replenish = ( M > q ? ydt * (M - q) : 0.0 );
-					kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
-					double eject = kt * q;
-					double loss = ldt * c;
-					double reuptake = rdt * c;
-					double reprocess = xdt * w;
-					q = q + replenish - eject + reprocess;
-					c = c + eject - loss - reuptake;
-					w = w + reuptake - reprocess;
-					basil -> z [1] [itime] = h * c;
-				}
-			}
-			
-			if (dtime == my dx) {
-				for (integer itime = 1; itime <= ntime; itime ++)
-					response [itime] = basil -> z [1] [itime];
-			} else {
-				double d = dtime / basil -> dx / 2.0;
-				double factor = -6 / d / d;
-				double area = d * sqrt (NUMpi / 6);
-				double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
-				for (integer itime = 1; itime <= ntime; itime ++) {
-					double t1 = (itime - 1) * dtime;
-					double t2 = t1 + dtime;
-					double mean = 0.0;
-					integer i1, i2;
-					integer n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
-					Melder_assert (n >= 1);
-					if (n <= 2) {
-						for (integer isamp = i1; isamp <= i2; isamp ++)
-							mean += basil -> z [1] [isamp];
-						mean /= n;
-					} else {
-						integer muint = Melder_ifloor ((i1 + i2) / 2.0), dint = Melder_ifloor (d);
-						for (integer isamp = muint - dint; isamp <= muint + dint; isamp ++) {
-							double y = 0;
-							if (isamp < 1 || isamp > basil -> nx)
-								Melder_casual (U"isamp ", isamp);
-							else
-								y = basil -> z [1] [isamp];
-							mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
-								(isamp - muint)) - expmin6);
+		/*
+			The frequency bands are independent, so they are computed in parallel,
+			each thread with its own filter and its own buffer for the basilar membrane response;
+			the lowest band has the longest gammatone and therefore the longest response.
+		*/
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), nfreq);
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		integer maximumLengthOfGammatone_samples = (integer) round (50.0 / NUMbarkToHertz (0.5 * dfreq) * (1.0 / my dx));
+		std::vector <autoNUMgammatoneFilterbank> filterbanks (integer_to_uinteger (numberOfThreads));
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+			NUMgammatoneFilterbank_init (& filterbanks [integer_to_uinteger (ithread - 1)], 1, 4, my dx);
+		autoMAT basilBuffers = raw_MAT (numberOfThreads, my nx + maximumLengthOfGammatone_samples + 1);
+		/*
+			The threads compute one band each per round,
+			so that the progress can be shown (and the analysis cancelled) between rounds.
+		*/
+		autoMelderProgress progress (U"Cochleagram analysis");
+		for (integer firstFreq = 1; firstFreq <= nfreq; firstFreq += numberOfThreads) {
+			const integer lastFreq = std::min (firstFreq + numberOfThreads - 1, nfreq);
+			auto analyseBand = [&] (integer ithread) {
+				Sound_into_Cochleagram_edb_row (me, thee.get(), firstFreq + ithread - 1, dtime, hasSynapse, replenishmentRate, lossRate, returnRate,
+					reprocessingRate, & filterbanks [integer_to_uinteger (ithread - 1)], basilBuffers.row (ithread));
+			};
+			MelderThread_run (lastFreq - firstFreq + 1, analyseBand);
+			Melder_progress ((double) lastFreq / nfreq, U"Cochleagram: band ", lastFreq, U" from ", nfreq, U".");
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not converted to Cochleagram (edb).");
+	}
+}
+
+/*
+	The basilar membrane response (without synapse) as it used to be computed,
+	by convolving the sound with the first 50 periods of a sampled gammatone.
+	For bands above the Nyquist frequency 50 periods are too short for the tail of the gammatone to be negligible,
+	so there the gammatone is sampled until 50 decay times after the latency.
+*/
+static autoSound Sound_to_basilarMembraneResponse_convolution (Sound me, double midFrequency_Hertz) {
+	double latency = 1.95e-3 * pow (midFrequency_Hertz / 1000, -0.725) + 0.6e-3;
+	double decayTime = 1e-3 * pow (midFrequency_Hertz / 1000, -0.663);
+	double lengthOfGammatone_seconds = std::max (50.0 / midFrequency_Hertz, latency + 50.0 * decayTime);
+	double midFrequency_radPerSecond = 2 * NUMpi * midFrequency_Hertz;
+	autoSound gammatone = Sound_createSimple (1, lengthOfGammatone_seconds, 1.0 / my dx);
+	for (integer itime = 1; itime <= gammatone -> nx; itime ++) {
+		double time_seconds = (itime - 0.5) * my dx;
+		double timeAfterLatency = time_seconds - latency;
+		double x = timeAfterLatency / decayTime;
+		if (time_seconds > latency) gammatone -> z [1] [itime] =
+			x * x * x * exp (- x) * cos (midFrequency_radPerSecond * timeAfterLatency);
+	}
+	return Sounds_convolve (me, gammatone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
+}
+
+void test_Sound_to_Cochleagram_edb () {
+	try {
+		const double samplingFrequency = 10000.0;   // the upper bands lie above the Nyquist frequency and alias, as in the convolution
+		autoSound sound = Sound_createSimple (1, 0.3, samplingFrequency);
+		for (integer i = 1; i <= sound -> nx; i ++) {
+			double t = Sampled_indexToX (sound.get(), i);
+			sound -> z [1] [i] = sin (2 * NUMpi * 200.0 * t) + 0.5 * sin (2 * NUMpi * 1234.0 * t) * t + ( i == 500 ? 1.0 : 0.0 );
+		}
+		for (double dtime : { sound -> dx, 0.01 }) {
+			autoCochleagram cochleagram = Sound_to_Cochleagram_edb (sound.get(), dtime, 1.0, false, 5.05, 2500.0, 6580.0, 66.31);
+			for (integer ifreq = 1; ifreq <= cochleagram -> ny; ifreq ++) {
+				double midFrequency_Hertz = NUMbarkToHertz ((ifreq - 0.5) * cochleagram -> dy);
+				constVEC response = cochleagram -> z.row (ifreq);
+				autoSound basil = Sound_to_basilarMembraneResponse_convolution (sound.get(), midFrequency_Hertz);
+				autoVEC expected = raw_VEC (cochleagram -> nx);
+				if (dtime == sound -> dx) {
+					for (integer itime = 1; itime <= cochleagram -> nx; itime ++)
+						expected [itime] = basil -> z [1] [itime];
+				} else {
+					double d = dtime / basil -> dx / 2.0;
+					double factor = -6 / d / d;
+					double area = d * sqrt (NUMpi / 6);
+					double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+					for (integer itime = 1; itime <= cochleagram -> nx; itime ++) {
+						double t1 = (itime - 1) * dtime;
+						double t2 = t1 + dtime;
+						double mean = 0.0;
+						integer i1, i2;
+						integer n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
+						if (n <= 2) {
+							for (integer isamp = i1; isamp <= i2; isamp ++)
+								mean += basil -> z [1] [isamp];
+							mean /= n;
+						} else {
+							integer muint = Melder_ifloor ((i1 + i2) / 2.0), dint = Melder_ifloor (d);
+							for (integer isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+								double y = ( isamp < 1 || isamp > basil -> nx ? 0.0 : basil -> z [1] [isamp] );
+								mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) * (isamp - muint)) - expmin6);
+							}
+							mean /= area;
 						}
-						mean /= area;
+						expected [itime] = mean;
 					}
-					response [itime] = mean;
 				}
+				/*
+					The former gammatone was truncated after 50 periods, which for the highest bands
+					changes the basilar membrane response by up to some 1e-8 of its maximum.
+				*/
+				double tolerance = 1e-6 * NUMextremum_e (basil -> z.row (1));
+				for (integer itime = 1; itime <= cochleagram -> nx; itime ++)
+					Melder_require (fabs (response [itime] - expected [itime]) <= tolerance,
+						U"Band ", ifreq, U", time ", itime, U": response ", response [itime], U" instead of ", expected [itime], U".");
 			}
 		}
-		return thee;
+		MelderInfo_writeLine (U"test_Sound_to_Cochleagram_edb: OK");
 	} catch (MelderError) {
-		Melder_throw (me, U": not converted to Cochleagram (edb).");
+		Melder_throw (U"Cochleagram (edb) test failed.");
 	}
 }
 
@@ -25,4 +25,9 @@ autoCochleagram Sound_to_Cochleagram_edb
 	(Sound me, double dtime, double dfreq, int hasSynapse, double replenishmentRate,
 	 double lossRate, double returnRate, double reprocessingRate);
 
+void test_Sound_to_Cochleagram_edb ();
+/*
+	Compares the result (without synapse) with that of the former convolution of the sound with sampled gammatones.
+*/
+
 /* End of file Sound_to_Cochleagram.h */
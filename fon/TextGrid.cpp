@@ -1,6 +1,6 @@
 /* TextGrid.cpp
  *
- * Copyright (C) 1992-2025 Paul Boersma
+ * Copyright (C) 1992-2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -277,6 +277,13 @@ integer IntervalTier_hasBoundary (IntervalTier me, double t) {
 	return 0;   // not found
 }
 
+autoBOOLVEC IntervalTier_getIntervalsWhere (IntervalTier me, kMelder_string which, conststring32 criterion, bool caseSensitive) {
+	autoBOOLVEC result = raw_BOOLVEC (my intervals.size);
+	for (integer iinterval = 1; iinterval <= result.size; iinterval ++)
+		result [iinterval] = Melder_stringMatchesCriterion (my intervals.at [iinterval] -> text.get(), which, criterion, caseSensitive);
+	return result;
+}
+
 void structTextGrid :: v1_info () {
 	structDaata :: v1_info ();
 
@@ -436,11 +443,10 @@ integer TextGrid_countIntervalsWhere (TextGrid me, integer tierNumber, kMelder_s
 	try {
 		integer count = 0;
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
-		for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
-			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, true))
+		autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, true);
+		for (integer iinterval = 1; iinterval <= intervalMatches.size; iinterval ++)
+			if (intervalMatches [iinterval])
 				count ++;
-		}
 		return count;
 	} catch (MelderError) {
 		Melder_throw (me, U": intervals not counted.");
@@ -689,9 +695,10 @@ autoPointProcess TextGrid_getStartingPoints (TextGrid me, integer tierNumber, kM
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
+		autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, true);
 		for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, true))
+			if (intervalMatches [iinterval])
 				PointProcess_addPoint (thee.get(), interval -> xmin);
 		}
 		return thee;
@@ -704,9 +711,10 @@ autoPointProcess TextGrid_getEndPoints (TextGrid me, integer tierNumber, kMelder
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
+		autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, true);
 		for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, true))
+			if (intervalMatches [iinterval])
 				PointProcess_addPoint (thee.get(), interval -> xmax);
 		}
 		return thee;
@@ -719,9 +727,10 @@ autoPointProcess TextGrid_getCentrePoints (TextGrid me, integer tierNumber, kMel
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
+		autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, true);
 		for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, true))
+			if (intervalMatches [iinterval])
 				PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
 		}
 		return thee;
@@ -1287,11 +1296,10 @@ autoTable TextGrid_tabulateOccurrences (TextGrid me, constVEC searchTiers, kMeld
 		Function anyTier = my tiers->at [tierNumber];
 		if (anyTier -> classInfo == classIntervalTier) {
 			IntervalTier tier = static_cast <IntervalTier> (anyTier);
-			for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
-				TextInterval interval = tier -> intervals.at [iinterval];
-				if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, caseSensitive))
+			autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, caseSensitive);
+			for (integer iinterval = 1; iinterval <= intervalMatches.size; iinterval ++)
+				if (intervalMatches [iinterval])
 					numberOfRows ++;
-			}
 		} else {
 			TextTier tier = static_cast <TextTier> (anyTier);
 			for (integer ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
@@ -1312,9 +1320,10 @@ autoTable TextGrid_tabulateOccurrences (TextGrid me, constVEC searchTiers, kMeld
 		Function anyTier = my tiers->at [tierNumber];
 		if (anyTier -> classInfo == classIntervalTier) {
 			IntervalTier tier = static_cast <IntervalTier> (anyTier);
+			autoBOOLVEC intervalMatches = IntervalTier_getIntervalsWhere (tier, which, criterion, caseSensitive);
 			for (integer iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 				TextInterval interval = tier -> intervals.at [iinterval];
-				if (Melder_stringMatchesCriterion (interval -> text.get(), which, criterion, caseSensitive)) {
+				if (intervalMatches [iinterval]) {
 					++ rowNumber;
 					Melder_assert (rowNumber <= numberOfRows);
 					const double time = 0.5 * (interval -> xmin + interval -> xmax);
@@ -2,7 +2,7 @@
 #define _TextGrid_h_
 /* TextGrid.h
  *
- * Copyright (C) 1992-2012,2014-2018,2020,2021,2024,2025 Paul Boersma
+ * Copyright (C) 1992-2012,2014-2018,2020,2021,2024-2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -79,6 +79,11 @@ void IntervalTier_removeLeftBoundary (IntervalTier me, integer intervalNumber);
 void IntervalTier_moveLeftBoundary (IntervalTier me, integer interval, double newTime);
 void IntervalTier_moveRightBoundary (IntervalTier me, integer interval, double newTime);
 
+autoBOOLVEC IntervalTier_getIntervalsWhere (IntervalTier me, kMelder_string which, conststring32 criterion, bool caseSensitive);
+/*
+	For each interval, whether its text matches the criterion.
+*/
+
 void TextTier_removePoint (TextTier me, integer pointNumber);
 
 autoTextGrid TextGrid_createWithoutTiers (double tmin, double tmax);
@@ -179,6 +184,12 @@ void TextGrid_writeToChronologicalTextFile (TextGrid me, MelderFile file);
 autoTextGrid TextGrid_readFromChronologicalTextFile (MelderFile file);
 autoTextGrid TextGrid_readFromCgnSyntaxFile (MelderFile file);
 
+autoFunctionList TextGrid_readTiersFromText (MelderReadText text);
+/*
+	Reads the tiers of a TextGrid from a text file, as oo_OBJECT (FunctionList, 0, tiers) would,
+	but with the tiers of a large file read in parallel.
+*/
+
 autoIntervalTier IntervalTier_readFromTimitLabelFile (MelderFile file, bool hasPhones);
 autoTextGrid TextGrid_readFromTimitLabelFile (MelderFile file, bool hasPhones);
 /*
@@ -1,6 +1,6 @@
 /* TextGrid_def.h
  *
- * Copyright (C) 1992-2012,2014-2016,2018,2022,2023 Paul Boersma
+ * Copyright (C) 1992-2012,2014-2016,2018,2022,2023,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -77,7 +77,12 @@ oo_END_CLASS (IntervalTier)
 #define ooSTRUCT TextGrid
 oo_DEFINE_CLASS (TextGrid, Function)
 
-	oo_OBJECT (FunctionList, 0, tiers)   // TextTier and IntervalTier objects
+	#if oo_READING_TEXT
+		if (texgetex (_textSource_) == 1)
+			our tiers = TextGrid_readTiersFromText (_textSource_);   // TextTier and IntervalTier objects
+	#else
+		oo_OBJECT (FunctionList, 0, tiers)   // TextTier and IntervalTier objects
+	#endif
 
 	#if oo_DECLARING
 		void v1_info ()
@@ -1,6 +1,6 @@
 /* TextGrid_files.cpp
  *
- * Copyright (C) 1992-2025 Paul Boersma
+ * Copyright (C) 1992-2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,6 +17,8 @@
  */
 
 #include "TextGrid.h"
+#include "MelderThread.h"
+#include <atomic>
 
 static int64 Melder_readInteger (const char32 **p) {
 	char32 kar = * (*p) ++;
@@ -1050,4 +1052,105 @@ autoTextGrid TextGrid_readFromTimitLabelFile (
 	}
 }
 
+/*
+	Reading the tiers of a large TextGrid text file in parallel.
+	An index pass first finds where each tier starts, by reading the header of each tier
+	and skipping its intervals or points without converting them.
+	Each tier is then copied into its own MelderReadText and read in the usual way, on its own thread.
+	The result is used only if every tier has been read without error and has used up exactly its own part of the text;
+	otherwise (e.g. for a damaged file) the tiers are read once more in the usual way,
+	so that the error message (with its line number) is the usual one.
+	Identical labels are not shared: every interval and point owns its text (an autostring32 in TextGrid_def.h),
+	so reading a large file in parallel takes less time but not less memory.
+*/
+
+constexpr integer TextGrid_MINIMUM_TEXT_LENGTH_FOR_PARALLEL_READING = 1'000'000;   // bytes or characters
+
+struct TierInText {
+	integer startPosition, endPosition;
+	ClassInfo classInfo;
+	int formatVersion;
+};
+
+static bool indexTiers (MelderReadText text, integer numberOfTiers, std::vector <TierInText>& tiers) {
+	try {
+		for (integer itier = 1; itier <= numberOfTiers; itier ++) {
+			TierInText tier;
+			tier. startPosition = MelderReadText_tell (text);
+			autostring32 className = texgetw16 (text);
+			tier. classInfo = Thing_classFromClassName (className.get(), & tier. formatVersion);   // not thread-safe, hence here
+			const bool isIntervalTier = ( tier. classInfo == classIntervalTier );
+			if (! isIntervalTier && tier. classInfo != classTextTier)
+				return false;
+			(void) texgetw16 (text);   // name
+			(void) texgetr64 (text);   // xmin
+			(void) texgetr64 (text);   // xmax
+			const integer numberOfIntervalsOrPoints = texgetinteger (text);
+			if (numberOfIntervalsOrPoints < 0)
+				return false;
+			texskipitems (text, numberOfIntervalsOrPoints * ( isIntervalTier ? 3 : 2 ));   // xmin, xmax, text or number, mark
+			tier. endPosition = MelderReadText_tell (text);
+			tiers. push_back (tier);
+		}
+		return true;
+	} catch (MelderError) {
+		Melder_clearError ();
+		return false;
+	}
+}
+
+static autoFunctionList readTiersInParallel (MelderReadText text, std::vector <TierInText> const& tiersInText) {
+	const integer numberOfTiers = (integer) tiersInText.size ();
+	std::vector <autoFunction> tiers (integer_to_uinteger (numberOfTiers));   // filled in by the threads
+	std::atomic <bool> failed (false);
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfTiers);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	std::atomic <integer> nextTier (1);
+	auto readTiers = [&] (integer /* ithread */) {
+		for (integer itier = nextTier ++; itier <= numberOfTiers && ! failed; itier = nextTier ++) {
+			TierInText const& tierInText = tiersInText [integer_to_uinteger (itier - 1)];
+			try {
+				autoMelderReadText part = MelderReadText_createFromPart (text, tierInText. startPosition, tierInText. endPosition);
+				(void) texgetw16 (part.get());   // the class name, already known
+				autoFunction tier = Thing_newFromClass (tierInText. classInfo).static_cast_move <structFunction> ();
+				autostring32 name = texgetw16 (part.get());
+				Thing_setName (tier.get(), name.get());
+				Data_readText (tier.get(), part.get(), tierInText. formatVersion);
+				if (MelderReadText_tell (part.get()) != tierInText. endPosition - tierInText. startPosition)
+					failed = true;
+				tiers [integer_to_uinteger (itier - 1)] = tier.move();
+			} catch (MelderError) {
+				Melder_clearError ();
+				failed = true;
+			}
+		}
+	};
+	MelderThread_run (numberOfThreads, readTiers);
+	if (failed)
+		return autoFunctionList ();
+	autoFunctionList result = FunctionList_create ();
+	for (autoFunction& tier : tiers)
+		result -> addItem_move (tier.move());
+	return result;
+}
+
+autoFunctionList TextGrid_readTiersFromText (MelderReadText text) {
+	const integer startOfTiers = MelderReadText_tell (text);
+	const integer numberOfTiers = texgeti32 (text);   // as in Collection::v1_readText
+	if (numberOfTiers >= 2 && MelderReadText_getEndPosition (text) - startOfTiers >= TextGrid_MINIMUM_TEXT_LENGTH_FOR_PARALLEL_READING) {
+		std::vector <TierInText> tiersInText;
+		if (indexTiers (text, numberOfTiers, tiersInText)) {
+			autoFunctionList tiers = readTiersInParallel (text, tiersInText);
+			if (tiers) {
+				MelderReadText_seek (text, tiersInText.back (). endPosition);
+				return tiers;
+			}
+		}
+	}
+	MelderReadText_seek (text, startOfTiers);
+	autoFunctionList tiers = FunctionList_create ();
+	tiers -> v1_readText (text, 0);
+	return tiers;
+}
+
 /* End of file TextGrid_files.cpp */
@@ -1526,6 +1526,40 @@ INTRO (U"A command to read a @Strings object from a simple text file. "
 	"Each line is read as a separate string. See @Strings for an example.")
 MAN_END
 
+MAN_BEGIN (U"Read SoundSet from sound files...", U"Praat contributors", 20261018)
+INTRO (U"A command in the @@Open menu@ that reads all the sound files in a folder whose names match a pattern, "
+	"and puts the resulting Sounds into one new SoundSet object.")
+ENTRY (U"Settings")
+TERM (U"##Folder")
+DEFINITION (U"the folder that contains the sound files; a relative path is relative to the default folder.")
+TERM (U"##File name pattern# (standard value: \"*.wav\")")
+DEFINITION (U"as in @@Create Strings as file list...@.")
+ENTRY (U"Behaviour")
+NORMAL (U"The files are read concurrently, so that reading a large number of files is much faster than "
+	"with @@Read from file...@ in a script loop. The Sounds get the names of their files, without the extension.")
+NORMAL (U"A file that cannot be read does not stop the other files from being read. "
+	"Together with the SoundSet, you therefore get a @Table called \"report\" with one row per file, in the order of @@Create Strings as file list...@: "
+	"the columns are the file name, the number of channels, the duration, and the status, "
+	"which is \"OK\", or the error message (on one line) if the file could not be read, "
+	"or \"Warning:\" followed by the warnings (on one line) if the file could be read with warnings, "
+	"e.g. if the file was truncated and the missing samples were set to zero. "
+	"Files whose status is an error message are not in the SoundSet. "
+	"The warnings are not shown in a window.")
+MAN_END
+
+MAN_BEGIN (U"Strings: Read SoundSet from sound files...", U"Praat contributors", 20261018)
+INTRO (U"A command that reads the sound files whose names are in the selected @Strings object, "
+	"and puts the resulting Sounds into one new SoundSet object.")
+ENTRY (U"Settings")
+TERM (U"##Folder")
+DEFINITION (U"the folder relative to which the file names are interpreted; "
+	"a relative path is itself relative to the default folder. "
+	"File names that are absolute paths are used as they are.")
+ENTRY (U"Behaviour")
+NORMAL (U"As with @@Read SoundSet from sound files...@, the files are read concurrently, "
+	"and a @Table with one row per file, in the order of the Strings, reports which files could be read.")
+MAN_END
+
 MAN_BEGIN (U"RealTier", U"ppgb", 20210612)
 INTRO (U"One of the @@types of objects@ in Praat. "
 	"An RealTier object represents a time-stamped curve, i.e., it contains a series of (%time, %value) points. "
@@ -1,6 +1,6 @@
 /* praat_Sound.cpp
  *
- * Copyright (C) 1992-2024 Paul Boersma
+ * Copyright (C) 1992-2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -32,6 +32,7 @@
 #include "SoundRecorder.h"
 #include "SoundSet.h"
 #include "SpectrumEditor.h"
+#include "Strings_.h"
 #include "TextGrid_Sound.h"
 #include "mp3.h"
 
@@ -2105,6 +2106,38 @@ DO
 	CONVERT_ONE_AND_ONE_TO_MULTIPLE_END
 }
 
+FORM (READ_MULTIPLE__SoundSet_readFromSoundFiles, U"Read SoundSet from sound files", U"Read SoundSet from sound files...") {
+	FOLDER (folder, U"Folder", U"")
+	WORD (fileNamePattern, U"File name pattern", U"*.wav")
+	OK
+DO
+	CREATE_MULTIPLE
+		structMelderFolder soundFolder { };
+		Melder_relativePathToFolder (folder, & soundFolder);
+		structMelderFile pattern { };
+		MelderFolder_getFile (& soundFolder, fileNamePattern, & pattern);
+		autoStrings fileNames = Strings_createAsFileList (MelderFile_peekPath (& pattern));
+		autoTable report;
+		autoSoundSet result = SoundSet_readFromSoundFiles (& soundFolder, fileNames -> strings.get(), & report);
+		praat_new (result.move(), U"sounds");
+		praat_new (report.move(), U"report");
+	CREATE_MULTIPLE_END
+}
+
+FORM (CONVERT_ONE_TO_MULTIPLE__Strings_readSoundSetFromSoundFiles, U"Strings: Read SoundSet from sound files", U"Strings: Read SoundSet from sound files...") {
+	FOLDER (folder, U"Folder", U"")
+	OK
+DO
+	CONVERT_ONE_TO_MULTIPLE (Strings)
+		structMelderFolder soundFolder { };
+		Melder_relativePathToFolder (folder, & soundFolder);
+		autoTable report;
+		autoSoundSet result = SoundSet_readFromSoundFiles (& soundFolder, my strings.get(), & report);
+		praat_new (result.move(), my name.get());
+		praat_new (report.move(), my name.get());
+	CONVERT_ONE_TO_MULTIPLE_END
+}
+
 /***** STOP *****/
 
 DIRECT (PLAY__stopPlayingSound) {
@@ -2264,6 +2297,8 @@ void praat_Sound_init () {
 	praat_addMenuCommand (U"Objects", U"Open", U"Open long sound file...", nullptr, 'L', READ1_LongSound_open);
 	praat_addMenuCommand (U"Objects", U"Open", U"Read separate channels from sound file... || Read two Sounds from stereo file...", nullptr, 0,
 			READ_MULTIPLE__Sound_readSeparateChannelsFromSoundFile);   // alternative COMPATIBILITY <= 2010
+	praat_addMenuCommand (U"Objects", U"Open", U"Read SoundSet from sound files...", nullptr, 0,
+			READ_MULTIPLE__SoundSet_readFromSoundFiles);
 	praat_addMenuCommand (U"Objects", U"Open", U"Read from special sound file", nullptr, 0, nullptr);
 		praat_addMenuCommand (U"Objects", U"Open", U"Read Sound from raw Alaw file...", nullptr, GuiMenu_DEPTH_1, READ1_Sound_readFromRawAlawFile);
 
@@ -2663,6 +2698,8 @@ void praat_Sound_init () {
 			CONVERT_EACH_TO_MULTIPLE__SoundSet_extractAllSounds);
 	praat_addAction2 (classSoundSet, 1, classTable, 1, U"Get randomized patterns...", nullptr, 0,
 			CONVERT_ONE_AND_ONE_TO_MULTIPLE__SoundSet_Table_getRandomizedPatterns);
+	praat_addAction1 (classStrings, 1, U"Read SoundSet from sound files...", nullptr, 0,
+			CONVERT_ONE_TO_MULTIPLE__Strings_readSoundSetFromSoundFiles);
 }
 
 /* End of file praat_Sound.cpp */
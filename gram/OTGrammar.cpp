@@ -1,6 +1,6 @@
 /* OTGrammar.cpp
  *
- * Copyright (C) 1997-2025 Paul Boersma
+ * Copyright (C) 1997-2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -74,6 +74,7 @@
  */
 
 #include "OTGrammar.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "OTGrammar_def.h"
@@ -1158,6 +1159,32 @@ static bool honoursFixedRankings (OTGrammar me) {
 	return true;
 }
 
+/*
+	The permutations are divided into chunks of a fixed size, which are divided over threads;
+	every thread permutes the index of its own copy of the grammar and counts the winners separately,
+	so that `me` is not changed. Every chunk draws from its own random stream, whose seed is taken in advance
+	from the global random generator, so that the results do not depend on the number of threads.
+*/
+constexpr integer OTGrammar_NUMBER_OF_PERMUTATIONS_PER_CHUNK = 5000;
+
+static void OTGrammar_countWinnersOverPermutations (OTGrammar me, integer itab, const integer factorial [],
+	integer firstPermutation, integer lastPermutation, INTVEC const& counts)
+{
+	for (integer iperm = firstPermutation; iperm <= lastPermutation; iperm ++) {
+		integer permleft = iperm;
+		/* Initialize to 12345 before permuting. */
+		for (integer icons = 1; icons <= my numberOfConstraints; icons ++)
+			my index [icons] = icons;
+		for (integer icons = 1; icons < my numberOfConstraints; icons ++) {
+			const integer fac = factorial [my numberOfConstraints - icons], shift = permleft / fac;
+			std::swap (my index [icons], my index [icons + shift]);
+			permleft %= fac;
+		}
+		if (honoursFixedRankings (me))
+			counts [OTGrammar_getWinner (me, itab)] += 1;
+	}
+}
+
 autoDistributions OTGrammar_measureTypology_WEAK (OTGrammar me) {
 	try {
 		integer totalNumberOfOutputs = 0, nout = 0, nperm, factorial [1+12];
@@ -1176,6 +1203,15 @@ autoDistributions OTGrammar_measureTypology_WEAK (OTGrammar me) {
 			Create the distribution. One row for every output form.
 		*/
 		autoDistributions thee = Distributions_create (totalNumberOfOutputs, 1);
+		/*
+			Prepare the threads.
+		*/
+		const integer numberOfChunks = (nperm - 1) / OTGrammar_NUMBER_OF_PERMUTATIONS_PER_CHUNK + 1;
+		integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfChunks);
+		Melder_clip (1_integer, & numberOfThreads, 16_integer);
+		OrderedOf <structOTGrammar> copies;
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+			copies. addItem_move (Data_copy (me));
 		/*
 			Measure every input form.
 		*/
@@ -1194,21 +1230,23 @@ autoDistributions OTGrammar_measureTypology_WEAK (OTGrammar me) {
 			/*
 				Compute a number of outputs and store the results.
 			*/
-			for (integer iperm = 0; iperm < nperm; iperm ++) {
-				integer permleft = iperm, iwinner;
-				/* Initialize to 12345 before permuting. */
-				for (integer icons = 1; icons <= my numberOfConstraints; icons ++)
-					my index [icons] = icons;
-				for (integer icons = 1; icons < my numberOfConstraints; icons ++) {
-					const integer fac = factorial [my numberOfConstraints - icons], shift = permleft / fac;
-					std::swap (my index [icons], my index [icons + shift]);
-					permleft %= fac;
+			autoINTMAT counts = zero_INTMAT (numberOfThreads, tableau -> numberOfCandidates);
+			std::vector <uint64> seeds (integer_to_uinteger (numberOfChunks));   // for choosing randomly between equal candidates
+			for (uint64& seed : seeds)
+				seed = NUMrandomSeed ();
+			auto countPart = [&] (integer ithread) {
+				for (integer ichunk = ithread; ichunk <= numberOfChunks; ichunk += numberOfThreads) {
+					autoNUMrandomStream stream (seeds [integer_to_uinteger (ichunk - 1)]);
+					const integer firstPermutation = (ichunk - 1) * OTGrammar_NUMBER_OF_PERMUTATIONS_PER_CHUNK;
+					const integer lastPermutation = std::min (ichunk * OTGrammar_NUMBER_OF_PERMUTATIONS_PER_CHUNK, nperm) - 1;
+					OTGrammar_countWinnersOverPermutations (copies.at [ithread], itab, factorial,
+							firstPermutation, lastPermutation, counts.row (ithread));
 				}
-				if (honoursFixedRankings (me)) {
-					iwinner = OTGrammar_getWinner (me, itab);
-					thy data [nout + iwinner] [1] += 1;
-				}
-			}
+			};
+			MelderThread_run (numberOfThreads, countPart);
+			for (integer icand = 1; icand <= tableau -> numberOfCandidates; icand ++)
+				for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+					thy data [nout + icand] [1] += counts [ithread] [icand];
 			/*
 				Update the offset.
 			*/
@@ -1957,10 +1995,10 @@ void OTGrammar_setConstraintPlasticity (OTGrammar me, integer constraint, double
 	}
 }
 
-integer theSaveNumberOfConstraints;
-autoINTVEC theSaveIndex;
-autoVEC theSaveRankings, theSaveDisharmonies;
-autoBOOLVEC theSaveTiedToTheLeft, theSaveTiedToTheRight;
+static thread_local integer theSaveNumberOfConstraints;   // thread-local, because learners can run in parallel
+static thread_local autoINTVEC theSaveIndex;
+static thread_local autoVEC theSaveRankings, theSaveDisharmonies;
+static thread_local autoBOOLVEC theSaveTiedToTheLeft, theSaveTiedToTheRight;
 static void OTGrammar_save (OTGrammar me) {
 	if (my numberOfConstraints != theSaveNumberOfConstraints) {
 		theSaveIndex = raw_INTVEC (my numberOfConstraints);
@@ -2397,6 +2435,126 @@ double OTGrammar_Distributions_getFractionCorrect (OTGrammar me, Distributions t
 	}
 }
 
+/*
+	Replicated learning simulations.
+	Every learner starts from a copy of the grammar and draws from its own random stream,
+	whose seed is taken in advance from the global random generator,
+	so that the results do not depend on the number of threads.
+	The learners run in groups of at most one per processor; progress is reported between groups.
+	In the resulting table, every row has the final rankings and a score of one learner.
+*/
+template <typename LearnAndScore>
+static autoTable OTGrammar_simulateLearners (OTGrammar me, integer numberOfLearners, conststring32 scoreName,
+	LearnAndScore learnAndScore)
+{
+	Melder_require (numberOfLearners >= 1,
+		U"The number of learners should be at least 1.");
+	const integer numberOfConstraints = my numberOfConstraints;
+	autoTable thee = Table_createWithoutColumnNames (numberOfLearners, 1 + numberOfConstraints + 1);
+	thy columnHeaders [1]. label = Melder_dup (U"learner");
+	for (integer icons = 1; icons <= numberOfConstraints; icons ++)
+		thy columnHeaders [1 + icons]. label = Melder_dup (my constraints [icons]. name.get());
+	thy columnHeaders [1 + numberOfConstraints + 1]. label = Melder_dup (scoreName);
+
+	std::vector <uint64> seeds (integer_to_uinteger (numberOfLearners));
+	for (uint64& seed : seeds)
+		seed = NUMrandomSeed ();
+	autoMAT rankings = raw_MAT (numberOfLearners, numberOfConstraints);
+	autoVEC scores = raw_VEC (numberOfLearners);
+
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), numberOfLearners);
+	Melder_clip (1_integer, & numberOfThreads, 16_integer);
+	autoMelderProgress progress (U"Simulating learners...");
+	for (integer firstLearner = 1; firstLearner <= numberOfLearners; firstLearner += numberOfThreads) {
+		const integer numberOfLearnersInGroup = std::min (numberOfThreads, numberOfLearners - firstLearner + 1);
+		Melder_progress ((firstLearner - 0.5) / numberOfLearners,
+				U"Learners ", firstLearner, U" to ", firstLearner + numberOfLearnersInGroup - 1, U" out of ", numberOfLearners);
+		OrderedOf <structOTGrammar> learners;
+		for (integer ithread = 1; ithread <= numberOfLearnersInGroup; ithread ++)
+			learners. addItem_move (Data_copy (me));
+		auto simulate = [&] (integer ithread) {
+			const integer ilearner = firstLearner + ithread - 1;
+			OTGrammar learner = learners.at [ithread];
+			try {
+				autoNUMrandomStream stream (seeds [integer_to_uinteger (ilearner - 1)]);
+				scores [ilearner] = learnAndScore (learner);
+				for (integer icons = 1; icons <= numberOfConstraints; icons ++)
+					rankings [ilearner] [icons] = learner -> constraints [icons]. ranking;
+			} catch (MelderError) {
+				Melder_throw (U"Learner ", ilearner, U" failed.");   // MelderThread_run passes this on to the main thread
+			}
+		};
+		MelderThread_run (numberOfLearnersInGroup, simulate);
+	}
+
+	for (integer ilearner = 1; ilearner <= numberOfLearners; ilearner ++) {
+		Table_setNumericValue (thee.get(), ilearner, 1, ilearner);
+		for (integer icons = 1; icons <= numberOfConstraints; icons ++)
+			Table_setNumericValue (thee.get(), ilearner, 1 + icons, rankings [ilearner] [icons]);
+		Table_setNumericValue (thee.get(), ilearner, 1 + numberOfConstraints + 1, scores [ilearner]);
+	}
+	return thee;
+}
+
+autoTable OTGrammar_PairDistribution_simulateLearners (OTGrammar me, PairDistribution thee, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews,
+	integer numberOfTestInputs)
+{
+	try {
+		Melder_require (numberOfTestInputs >= 1,
+			U"The number of test inputs should be at least 1.");
+		return OTGrammar_simulateLearners (me, numberOfLearners, U"fractionCorrect", [&] (OTGrammar learner) {
+			/*
+				As OTGrammar_PairDistribution_learn, but without the monitor or the EDCD stall warnings.
+			*/
+			double plasticity = initialPlasticity;
+			for (integer iplasticity = 1; iplasticity <= numberOfPlasticities; iplasticity ++) {
+				for (integer ireplication = 1; ireplication <= replicationsPerPlasticity; ireplication ++) {
+					conststring32 input, output;
+					PairDistribution_peekPair (thee, & input, & output);
+					for (integer ichew = 1; ichew <= numberOfChews; ichew ++)
+						OTGrammar_learnOne (learner, input, output,
+							evaluationNoise, updateRule, honourLocalRankings,
+							plasticity, relativePlasticityNoise, true, false, nullptr
+						);
+				}
+				plasticity *= plasticityDecrement;
+			}
+			return OTGrammar_PairDistribution_getFractionCorrect (learner, thee, evaluationNoise, numberOfTestInputs);
+		});
+	} catch (MelderError) {
+		Melder_throw (me, U" & ", thee, U": learners not simulated.");
+	}
+}
+
+autoTable OTGrammar_Strings_simulateLearnersFromPartialOutputs (OTGrammar me, Strings partialOutputs, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double plasticity, double relativePlasticityNoise, integer numberOfChews)
+{
+	try {
+		return OTGrammar_simulateLearners (me, numberOfLearners, U"fractionGrammatical", [&] (OTGrammar learner) {
+			autoOTHistory history;
+			OTGrammar_learnFromPartialOutputs (learner, partialOutputs,
+				evaluationNoise, updateRule, honourLocalRankings,
+				plasticity, relativePlasticityNoise, numberOfChews, 0, & history
+			);
+			/*
+				The score is the fraction of the partial outputs that are grammatical without evaluation noise.
+			*/
+			OTGrammar_newDisharmonies (learner, 0.0);
+			integer numberOfGrammatical = 0;
+			for (integer ioutput = 1; ioutput <= partialOutputs -> numberOfStrings; ioutput ++)
+				if (OTGrammar_isPartialOutputGrammatical (learner, partialOutputs -> strings [ioutput].get()))
+					numberOfGrammatical ++;
+			return partialOutputs -> numberOfStrings > 0 ? (double) numberOfGrammatical / partialOutputs -> numberOfStrings : undefined;
+		});
+	} catch (MelderError) {
+		Melder_throw (me, U" & ", partialOutputs, U": learners not simulated.");
+	}
+}
+
 void OTGrammar_removeConstraint (OTGrammar me, conststring32 constraintName) {
 	try {
 		integer removed = 0;
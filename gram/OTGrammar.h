@@ -120,6 +120,20 @@ integer OTGrammar_PairDistribution_getMinimumNumberCorrect (OTGrammar me, PairDi
 double OTGrammar_Distributions_getFractionCorrect (OTGrammar me, Distributions thee, integer columnNumber,
 	double evaluationNoise, integer numberOfInputs);
 
+/*
+	Runs a number of independent learners concurrently, each from a copy of `me` and with its own random stream.
+	The resulting Table has one row per learner, with the final rankings and a score.
+	`me` is not changed.
+*/
+autoTable OTGrammar_PairDistribution_simulateLearners (OTGrammar me, PairDistribution thee, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews,
+	integer numberOfTestInputs);
+autoTable OTGrammar_Strings_simulateLearnersFromPartialOutputs (OTGrammar me, Strings partialOutputs, integer numberOfLearners,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double plasticity, double relativePlasticityNoise, integer numberOfChews);
+
 void OTGrammar_checkIndex (OTGrammar me);
 
 autoOTGrammar OTGrammar_create_NoCoda_grammar ();
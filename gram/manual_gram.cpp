@@ -1316,6 +1316,26 @@ DEFINITION (U"After the command finishes, the harmony of every optimal (and corr
 	"will be at least this much greater than the harmony of any competitor in the same tableau.")
 MAN_END
 
+MAN_BEGIN (U"OTGrammar & PairDistribution: Simulate learners...", U"ppgb", 20261018)
+INTRO (U"A command that lets a number of virtual learners, each starting from a copy of the selected @OTGrammar, "
+	"learn from the language data in the selected @PairDistribution, and reports how well every learner did. "
+	"The selected OTGrammar itself does not change.")
+NORMAL (U"Every learner goes through the same schedule as with ##Learn...#: %%replications per plasticity% input/output pairs "
+	"are drawn from the PairDistribution for each of the %%number of plasticities%, starting with the %%initial plasticity% "
+	"and multiplying it by the %%plasticity decrement% each time. See @@OT learning 4. Learning an ordinal grammar@ "
+	"and @@OT learning 5. Learning a stochastic grammar@ for the other settings.")
+NORMAL (U"After learning, the fraction correct of every learner is measured on %%number of test inputs% inputs drawn from the PairDistribution, "
+	"as with ##Get fraction correct...#.")
+ENTRY (U"Output")
+NORMAL (U"A @Table with one row per learner. The columns are the number of the learner, "
+	"the final ranking value of every constraint, and the fraction correct.")
+ENTRY (U"Reproducibility")
+NORMAL (U"The learners run in parallel, but every learner draws from its own random stream, "
+	"whose seed is taken from Praat's random generator before the learners start. "
+	"Once the random generator has been given a fixed seed, the Table is therefore the same on every computer, "
+	"whatever the number of processors.")
+MAN_END
+
 MAN_BEGIN (U"OTGrammar & Strings: Inputs to outputs...", U"ppgb", 19981230)
 INTRO (U"An action that creates a @Strings object from a selected @OTGrammar and a selected @Strings.")
 NORMAL (U"The selected Strings object is considered as a list of inputs to the OTGrammar grammar.")
@@ -1326,6 +1346,19 @@ NORMAL (U"The resulting Strings object will contain the output string of the gra
 NORMAL (U"See @@OT learning 3.2. Data from another grammar@.")
 MAN_END
 
+MAN_BEGIN (U"OTGrammar & Strings: Simulate learners from partial outputs...", U"ppgb", 20261018)
+INTRO (U"A command that lets a number of virtual learners, each starting from a copy of the selected @OTGrammar, "
+	"learn from the partial outputs in the selected @Strings object, as with ##Learn from partial outputs...#, "
+	"and reports how well every learner did. The selected OTGrammar itself does not change.")
+NORMAL (U"For the settings, see @@OT learning 4. Learning an ordinal grammar@ and @@OT learning 5. Learning a stochastic grammar@.")
+ENTRY (U"Output")
+NORMAL (U"A @Table with one row per learner. The columns are the number of the learner, "
+	"the final ranking value of every constraint, and the fraction of the partial outputs that are grammatical "
+	"in the learner's final grammar, evaluated without noise.")
+NORMAL (U"As with @@OTGrammar & PairDistribution: Simulate learners...@, the learners run in parallel "
+	"but the Table does not depend on the number of processors.")
+MAN_END
+
 MAN_BEGIN (U"OTGrammar & 2 Strings: Learn...", U"ppgb", 20100331)
 INTRO (U"Causes the selected @OTGrammar object to process a number of input/output pairs "
 	"according to the Gradual Learning Algorithm by @@Boersma (1997)@ and @@Boersma & Hayes (2001)@ "
@@ -919,6 +919,26 @@ DO
 	MODIFY_FIRST_OF_ONE_WEAK_AND_ONE_WITH_HISTORY_END
 }
 
+FORM (CONVERT_ONE_AND_ONE_TO_ONE__OTGrammar_Strings_simulateLearnersFromPartialOutputs, U"OTGrammar & Strings: Simulate learners from partial outputs",
+	U"OTGrammar & Strings: Simulate learners from partial outputs...")
+{
+	NATURAL (numberOfLearners, U"Number of learners", U"100")
+	REAL (evaluationNoise, U"Evaluation noise", U"2.0")
+	OPTIONMENU_ENUM (kOTGrammar_rerankingStrategy, updateRule,
+			U"Update rule", kOTGrammar_rerankingStrategy::SYMMETRIC_ALL)
+	REAL (plasticity, U"Plasticity", U"0.1")
+	REAL (relativePlasticitySpreading, U"Rel. plasticity spreading", U"0.1")
+	BOOLEAN (honourLocalRankings, U"Honour local rankings", 1)
+	NATURAL (numberOfChews, U"Number of chews", U"1")
+	OK
+DO
+	CONVERT_ONE_AND_ONE_TO_ONE (OTGrammar, Strings)
+		autoTable result = OTGrammar_Strings_simulateLearnersFromPartialOutputs (me, you, numberOfLearners,
+				evaluationNoise, updateRule, honourLocalRankings,
+				plasticity, relativePlasticitySpreading, numberOfChews);
+	CONVERT_ONE_AND_ONE_TO_ONE_END (my name.get(), U"_learners")
+}
+
 DIRECT (CONVERT_ONE_AND_TWO_TO_ONE__OTGrammar_Stringses_tabulateAllCorrectRankings) {
 	CONVERT_ONE_AND_TWO_TO_ONE (OTGrammar, Strings)
 		autoTable result = OTGrammar_tabulateAllCorrectRankings (me, you, him);
@@ -1109,6 +1129,33 @@ DO
 	MODIFY_FIRST_OF_ONE_WEAK_AND_ONE_END
 }
 
+FORM (CONVERT_ONE_AND_ONE_TO_ONE__OTGrammar_PairDistribution_simulateLearners, U"OTGrammar & PairDistribution: Simulate learners",
+	U"OTGrammar & PairDistribution: Simulate learners...")
+{
+	NATURAL (numberOfLearners, U"Number of learners", U"100")
+	REAL (evaluationNoise, U"Evaluation noise", U"2.0")
+	OPTIONMENU_ENUM (kOTGrammar_rerankingStrategy, updateRule,
+			U"Update rule", kOTGrammar_rerankingStrategy::SYMMETRIC_ALL)
+	POSITIVE (initialPlasticity, U"Initial plasticity", U"1.0")
+	NATURAL (replicationsPerPlasticity, U"Replications per plasticity", U"100000")
+	REAL (plasticityDecrement, U"Plasticity decrement", U"0.1")
+	NATURAL (numberOfPlasticities, U"Number of plasticities", U"4")
+	REAL (relativePlasticitySpreading, U"Rel. plasticity spreading", U"0.1")
+	BOOLEAN (honourLocalRankings, U"Honour local rankings", true)
+	NATURAL (numberOfChews, U"Number of chews", U"1")
+	NATURAL (numberOfTestInputs, U"Number of test inputs", U"10000")
+	OK
+DO
+	CONVERT_ONE_AND_ONE_TO_ONE (OTGrammar, PairDistribution)
+		autoTable result = OTGrammar_PairDistribution_simulateLearners (me, you, numberOfLearners,
+			evaluationNoise, updateRule, honourLocalRankings,
+			initialPlasticity, replicationsPerPlasticity,
+			plasticityDecrement, numberOfPlasticities, relativePlasticitySpreading, numberOfChews,
+			numberOfTestInputs
+		);
+	CONVERT_ONE_AND_ONE_TO_ONE_END (my name.get(), U"_learners")
+}
+
 DIRECT (INFO_ONE_AND_ONE__OTGrammar_PairDistribution_listObligatoryRankings) {
 	INFO_ONE_AND_ONE (OTGrammar, PairDistribution)
 		OTGrammar_PairDistribution_listObligatoryRankings (me, you);
@@ -1884,6 +1931,8 @@ void praat_uvafon_gram_init () {
 			CONVERT_ONE_WEAK_AND_ONE_TO_ONE__OTGrammar_Strings_inputsToOutputs);
 	praat_addAction2 (classOTGrammar, 1, classStrings, 1, U"Learn from partial outputs...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_WEAK_AND_ONE_WITH_HISTORY__OTGrammar_Strings_learnFromPartialOutputs);
+	praat_addAction2 (classOTGrammar, 1, classStrings, 1, U"Simulate learners from partial outputs...", nullptr, 0,
+			CONVERT_ONE_AND_ONE_TO_ONE__OTGrammar_Strings_simulateLearnersFromPartialOutputs);
 	praat_addAction2 (classOTGrammar, 1, classStrings, 2, U"Learn...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_WEAK_AND_TWO__OTGrammar_Stringses_learn);
 	praat_addAction2 (classOTGrammar, 1, classStrings, 2, U"Tabulate all correct rankings", nullptr, 0,
@@ -1902,6 +1951,8 @@ void praat_uvafon_gram_init () {
 			INFO_ONE_AND_ONE__OTGrammar_Distributions_listObligatoryRankings);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Learn...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_WEAK_AND_ONE__OTGrammar_PairDistribution_learn);
+	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Simulate learners...", nullptr, 0,
+			CONVERT_ONE_AND_ONE_TO_ONE__OTGrammar_PairDistribution_simulateLearners);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Find positive weights...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_AND_ONE__OTGrammar_PairDistribution_findPositiveWeights);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Get fraction correct...", nullptr, 0,
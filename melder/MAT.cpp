@@ -48,6 +48,20 @@ void doubleCentre_MAT_inout (MATVU const& x) noexcept {
 void mtm_MAT_out (MATVU const& target, constMATVU const& x) noexcept {
 	Melder_assert (target.nrow == x.ncol);
 	Melder_assert (target.ncol == x.ncol);
+	if (double (x.nrow) * double (x.ncol) * double (x.ncol) >= 1e5) {
+		/*
+			Computing the whole of X'.X with the blocked kernel is faster than computing half of it with the loops below.
+			Counting the flops of the whole product, on one core with AVX2,
+			the speed is 4.93, 7.72, 11.0, 14.3, 13.5 Gflop/s
+			instead of   3.36, 4.44, 4.52, 4.58, 2.97 Gflop/s
+			for size =     50,  100,  200,  500, 1000.
+		*/
+		_mul_blocked_MAT_out (target, x.transpose(), x, 1.0, 0.0);
+		for (integer irow = 2; irow <= target.nrow; irow ++)
+			for (integer icol = 1; icol < irow; icol ++)
+				target [irow] [icol] = target [icol] [irow];   // exactly symmetric
+		return;
+	}
 	#if 0
 	for (integer irow = 1; irow <= target.nrow; irow ++) {
 		for (integer icol = irow; icol <= target.ncol; icol ++) {
@@ -83,6 +97,19 @@ void mtm_MAT_out (MATVU const& target, constMATVU const& x) noexcept {
 	#endif
 }
 
+void mtm_threaded_MAT_out (MATVU const& target, constMATVU const& x) {
+	Melder_assert (target.nrow == x.ncol);
+	Melder_assert (target.ncol == x.ncol);
+	if (double (x.nrow) * double (x.ncol) * double (x.ncol) < 3e7) {
+		mtm_MAT_out (target, x);
+		return;
+	}
+	_mul_blocked_threaded_MAT_out (target, x.transpose(), x, 1.0, 0.0, 0);
+	for (integer irow = 2; irow <= target.nrow; irow ++)
+		for (integer icol = 1; icol < irow; icol ++)
+			target [irow] [icol] = target [icol] [irow];   // exactly symmetric
+}
+
 void _mul_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y) noexcept {
 	/*
 		Precise matrix multiplication, using pairwise summation.
@@ -345,6 +372,237 @@ void _mul_allowAllocation_MAT_out (MATVU const& target, constMATVU x, constMATVU
 	}
 }
 
+/*
+	Blocked matrix multiplication, after Goto & Van de Geijn (2008):
+		target := alpha * x.y + beta * target
+
+	The innermost kernel keeps a block of kernel_MR x kernel_NR target cells in registers,
+	and reads a panel of kernel_MR rows of x and a panel of kernel_NR columns of y,
+	both of which have been packed so that the kernel can read them contiguously.
+	The packed part of x (blocked_MC x blocked_KC) is meant to stay in the level-2 cache,
+	the packed part of y (blocked_KC x blocked_NC) in the level-3 cache,
+	and a packed panel of y (blocked_KC x kernel_NR) in the level-1 cache.
+	Because of the packing, the strides of x, y and target do not matter.
+*/
+constexpr integer kernel_MR = 4, kernel_NR = 8;
+constexpr integer blocked_MC = 128, blocked_KC = 256, blocked_NC = 1024;
+
+using MATmul_kernel = void (*) (integer kc, const double *packedX, const double *packedY, double *block);
+
+static void MATmul_kernel_portable (integer kc, const double *packedX, const double *packedY, double *block) {
+	double sum [kernel_MR] [kernel_NR] = { };
+	for (integer p = 0; p < kc; p ++, packedX += kernel_MR, packedY += kernel_NR)
+		for (integer i = 0; i < kernel_MR; i ++) {
+			const double xcell = packedX [i];
+			for (integer j = 0; j < kernel_NR; j ++)
+				sum [i] [j] += xcell * packedY [j];
+		}
+	for (integer i = 0; i < kernel_MR; i ++)
+		for (integer j = 0; j < kernel_NR; j ++)
+			block [i * kernel_NR + j] = sum [i] [j];
+}
+
+#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+	/*
+		The same kernel with 256-bit fused multiply-add instructions, in twelve of the sixteen vector registers.
+		It is compiled for AVX2 whatever the compiler flags, but only called if the processor supports it.
+	*/
+	#include <immintrin.h>
+	__attribute__ ((target ("avx2,fma")))
+	static void MATmul_kernel_avx2 (integer kc, const double *packedX, const double *packedY, double *block) {
+		__m256d c00 = _mm256_setzero_pd (), c01 = _mm256_setzero_pd (), c10 = _mm256_setzero_pd (), c11 = _mm256_setzero_pd ();
+		__m256d c20 = _mm256_setzero_pd (), c21 = _mm256_setzero_pd (), c30 = _mm256_setzero_pd (), c31 = _mm256_setzero_pd ();
+		for (integer p = 0; p < kc; p ++, packedX += kernel_MR, packedY += kernel_NR) {
+			const __m256d y0 = _mm256_loadu_pd (packedY), y1 = _mm256_loadu_pd (packedY + 4);
+			__m256d xcell = _mm256_broadcast_sd (packedX);
+			c00 = _mm256_fmadd_pd (xcell, y0, c00);
+			c01 = _mm256_fmadd_pd (xcell, y1, c01);
+			xcell = _mm256_broadcast_sd (packedX + 1);
+			c10 = _mm256_fmadd_pd (xcell, y0, c10);
+			c11 = _mm256_fmadd_pd (xcell, y1, c11);
+			xcell = _mm256_broadcast_sd (packedX + 2);
+			c20 = _mm256_fmadd_pd (xcell, y0, c20);
+			c21 = _mm256_fmadd_pd (xcell, y1, c21);
+			xcell = _mm256_broadcast_sd (packedX + 3);
+			c30 = _mm256_fmadd_pd (xcell, y0, c30);
+			c31 = _mm256_fmadd_pd (xcell, y1, c31);
+		}
+		_mm256_storeu_pd (block, c00);
+		_mm256_storeu_pd (block + 4, c01);
+		_mm256_storeu_pd (block + 8, c10);
+		_mm256_storeu_pd (block + 12, c11);
+		_mm256_storeu_pd (block + 16, c20);
+		_mm256_storeu_pd (block + 20, c21);
+		_mm256_storeu_pd (block + 24, c30);
+		_mm256_storeu_pd (block + 28, c31);
+	}
+	static MATmul_kernel MATmul_chooseKernel () {
+		static const bool processorHasAvx2 = __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+		return processorHasAvx2 ? MATmul_kernel_avx2 : MATmul_kernel_portable;
+	}
+#else
+	static MATmul_kernel MATmul_chooseKernel () {
+		return MATmul_kernel_portable;
+	}
+#endif
+
+static integer MATmul_packedXsize (integer nrow, integer ncol) {
+	const integer numberOfPanels = (std::min (nrow, blocked_MC) + kernel_MR - 1) / kernel_MR;
+	return numberOfPanels * kernel_MR * std::min (ncol, blocked_KC);
+}
+static integer MATmul_packedYsize (integer nrow, integer ncol) {
+	const integer numberOfPanels = (std::min (ncol, blocked_NC) + kernel_NR - 1) / kernel_NR;
+	return numberOfPanels * kernel_NR * std::min (nrow, blocked_KC);
+}
+
+/*
+	Rows firstRow .. firstRow + mc - 1 and columns firstColumn .. firstColumn + kc - 1 of alpha * x,
+	as consecutive panels of kernel_MR rows, each stored column by column; missing rows are zero.
+*/
+static void MATmul_packX (constMATVU const& x, integer firstRow, integer mc, integer firstColumn, integer kc, double alpha, double *packed) {
+	for (integer ipanel = 0; ipanel < mc; ipanel += kernel_MR) {
+		const integer numberOfRows = std::min (kernel_MR, mc - ipanel);
+		const double *const firstCell = & x [firstRow + ipanel] [firstColumn];
+		for (integer p = 0; p < kc; p ++) {
+			const double *cell = firstCell + p * x.colStride;
+			integer i = 0;
+			for (; i < numberOfRows; i ++, cell += x.rowStride)
+				* packed ++ = alpha * *cell;
+			for (; i < kernel_MR; i ++)
+				* packed ++ = 0.0;
+		}
+	}
+}
+/*
+	Rows firstRow .. firstRow + kc - 1 and columns firstColumn .. firstColumn + nc - 1 of y,
+	as consecutive panels of kernel_NR columns, each stored row by row; missing columns are zero.
+*/
+static void MATmul_packY (constMATVU const& y, integer firstRow, integer kc, integer firstColumn, integer nc, double *packed) {
+	for (integer jpanel = 0; jpanel < nc; jpanel += kernel_NR) {
+		const integer numberOfColumns = std::min (kernel_NR, nc - jpanel);
+		const double *const firstCell = & y [firstRow] [firstColumn + jpanel];
+		for (integer p = 0; p < kc; p ++) {
+			const double *cell = firstCell + p * y.rowStride;
+			integer j = 0;
+			for (; j < numberOfColumns; j ++, cell += y.colStride)
+				* packed ++ = *cell;
+			for (; j < kernel_NR; j ++)
+				* packed ++ = 0.0;
+		}
+	}
+}
+
+static void MATmul_blocked_singleThread (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta, double *packedX, double *packedY) noexcept
+{
+	if (beta == 0.0)
+		target  <<=  0.0;   // not multiplied, so that NaNs in the target disappear
+	else if (beta != 1.0)
+		target  *=  beta;
+	if (alpha == 0.0)
+		return;
+	const MATmul_kernel kernel = MATmul_chooseKernel ();
+	double block [kernel_MR * kernel_NR];
+	for (integer jc = 1; jc <= target.ncol; jc += blocked_NC) {
+		const integer nc = std::min (blocked_NC, target.ncol - jc + 1);
+		for (integer pc = 1; pc <= x.ncol; pc += blocked_KC) {
+			const integer kc = std::min (blocked_KC, x.ncol - pc + 1);
+			MATmul_packY (y, pc, kc, jc, nc, packedY);
+			for (integer ic = 1; ic <= target.nrow; ic += blocked_MC) {
+				const integer mc = std::min (blocked_MC, target.nrow - ic + 1);
+				MATmul_packX (x, ic, mc, pc, kc, alpha, packedX);
+				for (integer jr = 0; jr < nc; jr += kernel_NR) {
+					const integer nr = std::min (kernel_NR, nc - jr);
+					for (integer ir = 0; ir < mc; ir += kernel_MR) {
+						const integer mr = std::min (kernel_MR, mc - ir);
+						kernel (kc, packedX + ir * kc, packedY + jr * kc, block);
+						for (integer i = 0; i < mr; i ++) {
+							double *cell = & target [ic + ir + i] [jc + jr];
+							for (integer j = 0; j < nr; j ++, cell += target.colStride)
+								*cell += block [i * kernel_NR + j];
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+	Used only if there is no memory for the packed blocks.
+*/
+static void MATmul_blocked_unpacked (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta) noexcept
+{
+	for (integer irow = 1; irow <= target.nrow; irow ++) {
+		for (integer icol = 1; icol <= target.ncol; icol ++) {
+			double sum = 0.0;
+			for (integer i = 1; i <= x.ncol; i ++)
+				sum += x [irow] [i] * y [i] [icol];
+			target [irow] [icol] = alpha * sum + ( beta == 0.0 ? 0.0 : beta * target [irow] [icol] );
+		}
+	}
+}
+
+void _mul_blocked_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta) noexcept
+{
+	if (target.nrow == 0 || target.ncol == 0)
+		return;
+	if (x.ncol == 0) {
+		MATmul_blocked_singleThread (target, x, y, 0.0, beta, nullptr, nullptr);
+		return;
+	}
+	std::unique_ptr <double []> packedX (new (std::nothrow) double [MATmul_packedXsize (target.nrow, x.ncol)]);
+	std::unique_ptr <double []> packedY (new (std::nothrow) double [MATmul_packedYsize (x.ncol, target.ncol)]);
+	if (! packedX || ! packedY) {
+		MATmul_blocked_unpacked (target, x, y, alpha, beta);
+		return;
+	}
+	MATmul_blocked_singleThread (target, x, y, alpha, beta, packedX.get(), packedY.get());
+}
+
+void _mul_blocked_threaded_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta, integer maximumNumberOfThreads)
+{
+	if (target.nrow == 0 || target.ncol == 0)
+		return;
+	/*
+		Each thread computes a band of the target, along its longer dimension;
+		below some 30 million multiply-add pairs per thread, threading does not pay.
+	*/
+	const bool splitRows = ( target.nrow >= target.ncol );
+	const integer length = ( splitRows ? target.nrow : target.ncol );
+	const double numberOfMultiplications = double (target.nrow) * double (target.ncol) * double (x.ncol);
+	integer numberOfThreads = std::min (MelderThread_getNumberOfProcessors (), Melder_ifloor (numberOfMultiplications / 3e7));
+	if (maximumNumberOfThreads > 0)
+		numberOfThreads = std::min (numberOfThreads, maximumNumberOfThreads);
+	Melder_clip (1_integer, & numberOfThreads, std::min (16_integer, (length + kernel_NR - 1) / kernel_NR));
+	if (numberOfThreads == 1) {
+		_mul_blocked_MAT_out (target, x, y, alpha, beta);
+		return;
+	}
+	const integer bandLength = (length + numberOfThreads - 1) / numberOfThreads;
+	const integer bandNrow = ( splitRows ? bandLength : target.nrow ), bandNcol = ( splitRows ? target.ncol : bandLength );
+	const integer packedXsize = MATmul_packedXsize (bandNrow, x.ncol), packedYsize = MATmul_packedYsize (x.ncol, bandNcol);
+	autoVEC packedX = raw_VEC (numberOfThreads * packedXsize);
+	autoVEC packedY = raw_VEC (numberOfThreads * packedYsize);
+	auto multiplyBand = [&] (integer ithread) {
+		const integer first = (ithread - 1) * bandLength + 1, last = std::min (ithread * bandLength, length);
+		if (first > last)
+			return;
+		double *const threadPackedX = & packedX [1] + (ithread - 1) * packedXsize;
+		double *const threadPackedY = & packedY [1] + (ithread - 1) * packedYsize;
+		if (splitRows)
+			MATmul_blocked_singleThread (target.part (first, last, 1, target.ncol), x.part (first, last, 1, x.ncol), y,
+					alpha, beta, threadPackedX, threadPackedY);
+		else
+			MATmul_blocked_singleThread (target.verticalBand (first, last), x, y.verticalBand (first, last),
+					alpha, beta, threadPackedX, threadPackedY);
+	};
+	MelderThread_run (numberOfThreads, multiplyBand);
+}
+
 static inline void MATmul_rough_naiveReferenceImplementation (MATVU const& target, constMATVU const& x, constMATVU const& y) noexcept {
 	/*
 		If x.colStride == size and y.colStride == 1,
@@ -361,6 +619,16 @@ static inline void MATmul_rough_naiveReferenceImplementation (MATVU const& targe
 void _mul_fast_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y) noexcept {
 	if ((false)) {
 		MATmul_rough_naiveReferenceImplementation (target, x, y);
+	} else if (double (target.nrow) * double (target.ncol) * double (x.ncol) >= 1e5) {
+		/*
+			Large matrices, whatever their strides.
+			For X.Y, where X and Y are packed row-major matrices, on one core,
+			the speed is 5.54, 9.72, 11.2, 16.9, 15.8, 16.9, 16.7 Gflop/s with AVX2
+			the speed is 1.97, 2.21, 2.34, 2.49, 2.55, 2.58, 2.67 Gflop/s with the portable kernel
+			for size =     50,  100,  200,  500, 1000, 2000, 3000,
+			whereas the loops below run at 2.43, 2.46, 2.33, 2.03, 2.02, 1.40, 1.22 Gflop/s on the same machine.
+		*/
+		_mul_blocked_MAT_out (target, x, y, 1.0, 0.0);
 	} else if (y.colStride == 1) {
 		/*
 			This case is appropriate for the multiplication of full matrices
@@ -467,6 +735,13 @@ void _mul_fast_MAT_out (MATVU const& target, constMATVU const& x, constMATVU con
 	}
 }
 
+void _mul_fast_threaded_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y) {
+	if (double (target.nrow) * double (target.ncol) * double (x.ncol) >= 3e7)
+		_mul_blocked_threaded_MAT_out (target, x, y, 1.0, 0.0, 0);
+	else
+		_mul_fast_MAT_out (target, x, y);
+}
+
 void MATmul_forceMetal_ (MATVU const& target, constMATVU const& x, constMATVU const& y) {
 #ifdef macintosh
 	if (@available (macOS 10.13, *)) {
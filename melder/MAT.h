@@ -355,6 +355,11 @@ inline autoMAT mtm_MAT (constMATVU const& x) {
 	mtm_MAT_out (result.get(), x);
 	return result;
 }
+/*
+	As mtm_MAT_out, but products of more than 3e7 multiplications are divided over threads.
+	Meant for top-level code: do not call this from a function that itself runs in a separate thread.
+*/
+extern void mtm_threaded_MAT_out (MATVU const& target, constMATVU const& x);
 
 /*
 	Precise matrix multiplication, using pairwise summation.
@@ -406,7 +411,8 @@ inline autoMAT mul_allowAllocation_MAT (constMATVU const& x, constMATVU const& y
 	return result;
 }
 /*
-	Rough matrix multiplication, using an in-cache inner loop if that is faster.
+	Rough matrix multiplication, using an in-cache inner loop if that is faster,
+	and _mul_blocked_MAT_out for large matrices.
 */
 extern void _mul_fast_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y) noexcept;
 inline void mul_fast_MAT_out  (MATVU const& target, constMATVU const& x, constMATVU const& y) {
@@ -420,6 +426,43 @@ inline autoMAT mul_fast_MAT (constMATVU const& x, constMATVU const& y) {
 	mul_fast_MAT_out (result.all(), x, y);
 	return result;
 }
+/*
+	As mul_fast_MAT_out, but products of more than 3e7 multiplications are divided over threads.
+	Meant for top-level code: do not call this from a function that itself runs in a separate thread.
+*/
+extern void _mul_fast_threaded_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y);
+inline void mul_fast_threaded_MAT_out  (MATVU const& target, constMATVU const& x, constMATVU const& y) {
+	Melder_assert (target.nrow == x.nrow);
+	Melder_assert (target.ncol == y.ncol);
+	Melder_assert (x.ncol == y.nrow);
+	_mul_fast_threaded_MAT_out (target, x, y);
+}
+inline autoMAT mul_fast_threaded_MAT (constMATVU const& x, constMATVU const& y) {
+	autoMAT result = raw_MAT (x.nrow, y.ncol);
+	mul_fast_threaded_MAT_out (result.all(), x, y);
+	return result;
+}
+/*
+	Rough matrix multiplication with packed blocks and a register-tiled kernel:
+		target := alpha * x.y + beta * target
+	Uses AVX2 if the processor has it. Runs on the calling thread only, so it can be used anywhere.
+	The target should not overlap with x or y.
+*/
+extern void _mul_blocked_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta) noexcept;
+inline void mul_blocked_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y) noexcept {
+	Melder_assert (target.nrow == x.nrow);
+	Melder_assert (target.ncol == y.ncol);
+	Melder_assert (x.ncol == y.nrow);
+	_mul_blocked_MAT_out (target, x, y, 1.0, 0.0);
+}
+/*
+	As _mul_blocked_MAT_out, but products of more than 3e7 multiplications are divided over
+	at most maximumNumberOfThreads threads (0 = as many as there are processors).
+	Meant for top-level code: do not call this from a function that itself runs in a separate thread.
+*/
+extern void _mul_blocked_threaded_MAT_out (MATVU const& target, constMATVU const& x, constMATVU const& y,
+	double alpha, double beta, integer maximumNumberOfThreads);
 void MATmul_forceMetal_ (MATVU const& target, constMATVU const& x, constMATVU const& y);
 void MATmul_forceOpenCL_ (MATVU const& target, constMATVU const& x, constMATVU const& y);
 
@@ -1,6 +1,6 @@
 /* MelderCat.cpp
  *
- * Copyright (C) 2006-2012,2014-2024 Paul Boersma
+ * Copyright (C) 2006-2012,2014-2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,7 +18,11 @@
 
 #include "melder.h"
 
-MelderString MelderCat::_buffers [MelderCat::_k_NUMBER_OF_BUFFERS] { };
-int MelderCat::_bufferNumber = 0;
+thread_local MelderCat::_Buffers MelderCat::_buffers;
+
+MelderCat::_Buffers :: ~ _Buffers () {
+	for (int ibuffer = 0; ibuffer < _k_NUMBER_OF_BUFFERS; ibuffer ++)
+		MelderString_free (& strings [ibuffer]);
+}
 
 /* End of file MelderCat.cpp */
@@ -2,7 +2,7 @@
 #define _melder_cat_h_
 /* melder_cat.h
  *
- * Copyright (C) 1992-2018,2020 Paul Boersma
+ * Copyright (C) 1992-2018,2020,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,18 +18,27 @@
  * along with this work. If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+	The buffers are per thread, because error messages can be composed in worker threads;
+	they are freed when their thread ends.
+*/
 namespace MelderCat {
 	constexpr int _k_NUMBER_OF_BUFFERS = 33;
-	extern MelderString _buffers [_k_NUMBER_OF_BUFFERS];
-	extern int _bufferNumber;
+	struct _Buffers {
+		MelderString strings [_k_NUMBER_OF_BUFFERS];
+		int number = 0;
+		~ _Buffers ();
+	};
+	extern thread_local _Buffers _buffers;
 }
 
 template <typename... Args>
 conststring32 Melder_cat (Args... args) {
-	if (++ MelderCat::_bufferNumber == MelderCat::_k_NUMBER_OF_BUFFERS)
-		MelderCat::_bufferNumber = 0;
-	MelderString_copy (& MelderCat::_buffers [MelderCat::_bufferNumber], args...);
-	return MelderCat::_buffers [MelderCat::_bufferNumber].string;
+	MelderCat::_Buffers& buffers = MelderCat::_buffers;
+	if (++ buffers. number == MelderCat::_k_NUMBER_OF_BUFFERS)
+		buffers. number = 0;
+	MelderString_copy (& buffers. strings [buffers. number], args...);
+	return buffers. strings [buffers. number].string;
 }
 
 /* End of file melder_cat.h */
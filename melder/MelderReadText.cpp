@@ -1,6 +1,6 @@
 /* MelderReadText.cpp
  *
- * Copyright (C) 2008,2010-2012,2014-2020,2022,2023,2025 Paul Boersma
+ * Copyright (C) 2008,2010-2012,2014-2020,2022,2023,2025,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -219,4 +219,38 @@ autoMelderReadText MelderReadText_createFromText (autostring32 text) {
 	return me;
 }
 
+integer MelderReadText_tell (MelderReadText me) {
+	return my string32 ? my readPointer32 - my string32.get() : my readPointer8 - my string8.get();
+}
+
+void MelderReadText_seek (MelderReadText me, integer position) {
+	Melder_assert (position >= 0);
+	if (my string32)
+		my readPointer32 = my string32.get() + position;
+	else
+		my readPointer8 = my string8.get() + position;
+	my previousPointerStep = 0;
+}
+
+integer MelderReadText_getEndPosition (MelderReadText me) {
+	return my string32 ? Melder_length (my string32.get()) : Melder8_length (my string8.get());
+}
+
+autoMelderReadText MelderReadText_createFromPart (MelderReadText me, integer fromPosition, integer toPosition) {
+	Melder_assert (fromPosition >= 0 && fromPosition <= toPosition);
+	const integer length = toPosition - fromPosition;
+	autoMelderReadText part = std::make_unique <structMelderReadText> ();
+	if (my string32) {
+		part -> string32 = autostring32 (length);
+		memcpy (part -> string32.get(), my string32.get() + fromPosition, (size_t) length * sizeof (char32));
+		part -> readPointer32 = part -> string32.get();
+	} else {
+		part -> string8 = autostring8 (length);
+		memcpy (part -> string8.get(), my string8.get() + fromPosition, (size_t) length);
+		part -> readPointer8 = part -> string8.get();
+		part -> input8Encoding = my input8Encoding;
+	}
+	return part;
+}
+
 /* End of file MelderReadText.cpp */
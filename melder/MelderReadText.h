@@ -2,7 +2,7 @@
 #define _melder_readtext_h_
 /* melder_readtext.h
  *
- * Copyright (C) 1992-2019,2023,2025 Paul Boersma
+ * Copyright (C) 1992-2019,2023,2025,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -81,5 +81,15 @@ mutablestring32 MelderReadText_readLine (MelderReadText me);
 int64 MelderReadText_getNumberOfLines (MelderReadText me);
 conststring32 MelderReadText_getLineNumber (MelderReadText me);
 
+/*
+	Positions in the stored text, counted in bytes (8-bit text) or in characters (UTF-32 text).
+	A part of the text between two positions can be copied into a new MelderReadText with the same encoding,
+	e.g. to read the parts of a text in parallel.
+*/
+integer MelderReadText_tell (MelderReadText me);
+void MelderReadText_seek (MelderReadText me, integer position);
+integer MelderReadText_getEndPosition (MelderReadText me);
+autoMelderReadText MelderReadText_createFromPart (MelderReadText me, integer fromPosition, integer toPosition);
+
 /* End of file melder_readText.h */
 #endif
@@ -165,6 +165,25 @@ static uint64 getTicksSinceBoot () {
 	//Melder_casual (U"ticks since boot: ", ticksSinceBoot);
 }
 
+/*
+	The state that the NUMrandom functions without a thread number draw from.
+	It is states [0], except within the scope of an autoNUMrandomStream on the same thread.
+*/
+static thread_local NUMrandom_State *theCurrentState = & states [0];
+
+autoNUMrandomStream :: autoNUMrandomStream (uint64 seed) :
+	_state (std::make_unique <NUMrandom_State> ()),
+	_previousState (theCurrentState)
+{
+	_state -> init_genrand64 (seed);
+	_state -> secondAvailable = false;
+	theCurrentState = _state.get();
+}
+
+autoNUMrandomStream :: ~ autoNUMrandomStream () {
+	theCurrentState = _previousState;
+}
+
 static bool theInited = false;
 void NUMrandom_initializeSafelyAndUnpredictably () {
 	const uint64 ticksSince1969 = getTicksSince1969 ();   // possibly microseconds
@@ -221,8 +240,7 @@ void NUMrandom_initializeWithSeedUnsafelyButPredictably (uint64 seed) {
 	#define ZERO_OR_MAGIC  mag01 [(int) (x & UINT64_C (1))]
 #endif
 
-double NUMrandomFraction () {
-	NUMrandom_State *me = & states [0];
+static inline uint64 NUMrandom_State_nextWord (NUMrandom_State *me) {
 	uint64 x;
 
 	if (my index >= NN) {   // generate NN words at a time
@@ -251,7 +269,15 @@ double NUMrandomFraction () {
 	x ^= (x << 37) & UINT64_C (0xFFF7EEE000000000);
 	x ^= (x >> 43);
 
-	return (x >> 11) * (1.0/9007199254740992.0);
+	return x;
+}
+
+double NUMrandomFraction () {
+	return (NUMrandom_State_nextWord (theCurrentState) >> 11) * (1.0/9007199254740992.0);
+}
+
+uint64 NUMrandomSeed () {
+	return NUMrandom_State_nextWord (theCurrentState);
 }
 
 double NUMrandomFraction_mt (int threadNumber) {
@@ -306,7 +332,7 @@ double NUMrandomBernoulli_real (double probability) {
 #define repeat  do
 #define until(cond)  while (! (cond))
 double NUMrandomGauss (double mean, double standardDeviation) {
-	NUMrandom_State *me = & states [0];
+	NUMrandom_State *me = theCurrentState;
 	/*
 		Knuth, p. 122.
 	*/
@@ -26,6 +26,24 @@ void NUMrandom_initializeWithSeedUnsafelyButPredictably (uint64 seed);
 double NUMrandomFraction ();
 double NUMrandomFraction_mt (int threadNumber);
 
+uint64 NUMrandomSeed ();   // 64 random bits, e.g. for seeding an autoNUMrandomStream
+
+/*
+	While an autoNUMrandomStream exists, the random functions below (and NUMrandomFraction),
+	when called from the thread that created it, draw from a private generator seeded with `seed`.
+	This lets independent simulations run concurrently, each with a reproducible sequence.
+*/
+class NUMrandom_State;
+class autoNUMrandomStream {
+	std::unique_ptr <NUMrandom_State> _state;
+	NUMrandom_State *_previousState;
+public:
+	explicit autoNUMrandomStream (uint64 seed);
+	~ autoNUMrandomStream ();
+	autoNUMrandomStream (const autoNUMrandomStream&) = delete;
+	autoNUMrandomStream& operator= (const autoNUMrandomStream&) = delete;
+};
+
 double NUMrandomUniform (double lowest, double highest);
 
 integer NUMrandomInteger (integer lowest, integer highest);
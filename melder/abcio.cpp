@@ -1,6 +1,6 @@
 /* abcio.cpp
  *
- * Copyright (C) 1992-2011,2015,2017-2020,2022,2024 Paul Boersma
+ * Copyright (C) 1992-2011,2015,2017-2020,2022,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -23,8 +23,278 @@
 
 /********** text I/O **********/
 
+/*
+	Fast paths for the text readers.
+
+	A MelderReadText holds the whole text in memory, either as 8-bit text (UTF-8, or another encoding
+	whose lower 128 codes are ASCII) or as UTF-32. Numbers, the labels in front of them, and most strings
+	consist of ASCII characters, so the readers below first try to find and convert the next item
+	by looking at the text in memory directly, instead of decoding it through MelderReadText_getChar ().
+
+	Whenever something turns up that the fast path does not handle (a non-ASCII character outside a string,
+	an error, the end of the text, a very long number), the fast path leaves the read pointer
+	at the start of the current word, i.e. at a place that directly follows white space.
+	The character-by-character reader, which starts afresh at every such place, then takes over
+	and produces exactly the same result (or error message) as it would have done by itself.
+*/
+
+static inline char32 fast_code (char kar) { return (char32) (char8) kar; }
+static inline char32 fast_code (char32 kar) { return kar; }
+
+/*
+	Skip white space, comments and labels up to the start of a number (a digit or a sign) or a string (a double quote).
+	Return a pointer to that start, or nullptr if the fast path gives up, with *out_wordStart at the last word start.
+*/
+template <typename T>
+static const T *fast_skipToItem (const T *p, bool lookingForString, const T **out_wordStart) {
+	for (;;) {
+		*out_wordStart = p;
+		char32 c = fast_code (*p);
+		if (c == U'\0' || c > 127 || c == U'<')
+			return nullptr;
+		if (c == U'\"')
+			return lookingForString ? p : nullptr;
+		if (c == U'-' || c == U'+' || Melder_isAsciiDecimalNumber (c))
+			return lookingForString ? nullptr : p;
+		if (c == U'!') {   // end-of-line comment
+			do {
+				c = fast_code (* ++ p);
+				if (c == U'\0')
+					return nullptr;
+			} while (c != U'\n' && c != U'\r');
+		} else {
+			while (! Melder_isAsciiHorizontalOrVerticalSpace (c)) {   // a label such as "xmin" or "="
+				c = fast_code (* ++ p);
+				if (c == U'\0' || c > 127)
+					return nullptr;
+			}
+		}
+		p ++;   // past the space
+	}
+}
+
+/*
+	Copy the number that starts at p into the buffer, which will be null-terminated,
+	and return its length, or 0 if the fast path gives up (the slow path will then handle the same number).
+*/
+template <typename T>
+static integer fast_copyNumber (const T *p, char buffer [41]) {
+	for (integer i = 0; i < 40; i ++) {
+		const char32 c = fast_code (p [i]);
+		if (c == U'\0' || c > 127)
+			return 0;
+		if (Melder_isAsciiHorizontalOrVerticalSpace (c)) {
+			buffer [i] = '\0';
+			return i;
+		}
+		buffer [i] = (char) c;
+	}
+	return 0;
+}
+
+template <typename T>
+static bool fast_getNumber (MelderReadText me, T **readPointer, bool allowMinus, bool skipLonePlusSigns, char buffer [41]) {
+	const T *p = *readPointer, *wordStart;
+	for (;;) {
+		p = fast_skipToItem (p, false, & wordStart);
+		if (! p || (! allowMinus && *p == '-'))
+			break;
+		const integer length = fast_copyNumber (p, buffer);
+		if (length == 0)
+			break;
+		p += length + 1;   // the number, and the space after it
+		if (skipLonePlusSigns && length == 1 && buffer [0] == '+')
+			continue;
+		*readPointer = const_cast <T *> (p);
+		my previousPointerStep = 1;
+		return true;
+	}
+	*readPointer = const_cast <T *> (wordStart);
+	my previousPointerStep = 0;
+	return false;
+}
+
+static bool fast_getNumber (MelderReadText me, bool allowMinus, bool skipLonePlusSigns, char buffer [41]) {
+	return my string32 ?
+		fast_getNumber (me, & my readPointer32, allowMinus, skipLonePlusSigns, buffer) :
+		fast_getNumber (me, & my readPointer8, allowMinus, skipLonePlusSigns, buffer);
+}
+
+/*
+	Convert a number of the form [+-]digits[.digits][(e|E)[+-]digits] with at most 19 significant digits
+	and a value that is an integer up to 2^53 times a power of ten between 1e-22 and 1e22.
+	Both factors are exact in double precision, so a single multiplication or division gives the correctly rounded result,
+	i.e. the same result as strtod () (Clinger 1990). Anything else is left to Melder_a8tof ().
+*/
+static bool fast_stringToReal (const char *p, double *out_value) {
+	static const double powersOfTen [23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+			1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const bool negative = ( *p == '-' );
+	if (*p == '-' || *p == '+')
+		p ++;
+	if (! Melder_isAsciiDecimalNumber (*p))
+		return false;
+	uint64 mantissa = 0;
+	integer numberOfSignificantDigits = 0, exponent = 0;
+	for (; Melder_isAsciiDecimalNumber (*p); p ++) {
+		if (mantissa == 0 && *p == '0')
+			continue;
+		if (++ numberOfSignificantDigits > 19)
+			return false;
+		mantissa = 10 * mantissa + (uint64) (*p - '0');
+	}
+	if (*p == '.') {
+		for (p ++; Melder_isAsciiDecimalNumber (*p); p ++) {
+			exponent --;
+			if (mantissa == 0 && *p == '0')
+				continue;
+			if (++ numberOfSignificantDigits > 19)
+				return false;
+			mantissa = 10 * mantissa + (uint64) (*p - '0');
+		}
+	}
+	if (*p == 'e' || *p == 'E') {
+		p ++;
+		const bool negativeExponent = ( *p == '-' );
+		if (*p == '-' || *p == '+')
+			p ++;
+		if (! Melder_isAsciiDecimalNumber (*p))
+			return false;
+		integer explicitExponent = 0;
+		for (; Melder_isAsciiDecimalNumber (*p); p ++) {
+			if (explicitExponent > 1000)
+				return false;
+			explicitExponent = 10 * explicitExponent + (*p - '0');
+		}
+		exponent += ( negativeExponent ? - explicitExponent : explicitExponent );
+	}
+	if (*p != '\0' || mantissa > (uint64_t (1) << 53))
+		return false;
+	double value = (double) mantissa;
+	if (mantissa != 0) {
+		if (exponent < -22 || exponent > 22)
+			return false;
+		value = ( exponent < 0 ? value / powersOfTen [- exponent] : value * powersOfTen [exponent] );
+	}
+	*out_value = ( negative ? - value : value );
+	return true;
+}
+
+/*
+	Read a string, including its closing double quote and a space after it, into the buffer.
+	Only the end of the text after the closing quote, or a space, is handled here;
+	the rest (errors, and strings in 8-bit encodings other than UTF-8 that contain non-ASCII characters) is left to the slow path.
+*/
+static bool fast_appendUtf8 (MelderString *buffer, const char *from, const char *to) {
+	const integer maximumLength = buffer -> length + (to - from);
+	if (maximumLength + 1 > buffer -> bufferSize)
+		_private_MelderString_expand (buffer, maximumLength + 1);
+	char32 *out = & buffer -> string [buffer -> length];
+	for (const char *p = from; p < to; ) {   // as in MelderReadText_getChar ()
+		const char32 kar1 = (char32) (char8) *p ++;
+		const integer numberOfContinuationBytes = ( kar1 <= 0x00'007F ? 0 : kar1 <= 0x00'00DF ? 1 : kar1 <= 0x00'00EF ? 2 : 3 );
+		if (p + numberOfContinuationBytes > to)
+			return false;   // a truncated sequence; let the slow path handle it
+		if (kar1 <= 0x00'007F) {
+			*out ++ = kar1;
+		} else if (kar1 <= 0x00'00DF) {
+			const char32 kar2 = (char32) (char8) *p ++;
+			*out ++ = ((kar1 & 0x00'001F) << 6) | (kar2 & 0x00'003F);
+		} else if (kar1 <= 0x00'00EF) {
+			const char32 kar2 = (char32) (char8) *p ++;
+			const char32 kar3 = (char32) (char8) *p ++;
+			*out ++ = ((kar1 & 0x00'000F) << 12) | ((kar2 & 0x00'003F) << 6) | (kar3 & 0x00'003F);
+		} else if (kar1 <= 0x00'00F4) {
+			const char32 kar2 = (char32) (char8) *p ++;
+			const char32 kar3 = (char32) (char8) *p ++;
+			const char32 kar4 = (char32) (char8) *p ++;
+			*out ++ = ((kar1 & 0x00'0007) << 18) | ((kar2 & 0x00'003F) << 12) | ((kar3 & 0x00'003F) << 6) | (kar4 & 0x00'003F);
+		} else {
+			return false;   // not UTF-8; the slow path will insert a replacement character
+		}
+	}
+	*out = U'\0';
+	buffer -> length = out - & buffer -> string [0];
+	return true;
+}
+
+static void fast_appendAscii (MelderString *buffer, const char *from, const char *to) {
+	const integer length = to - from;
+	if (buffer -> length + length + 1 > buffer -> bufferSize)
+		_private_MelderString_expand (buffer, buffer -> length + length + 1);
+	char32 *out = & buffer -> string [buffer -> length];
+	for (integer i = 0; i < length; i ++)
+		out [i] = (char32) (char8) from [i];
+	out [length] = U'\0';
+	buffer -> length += length;
+}
+
+static bool fast_isAscii (const char *from, const char *to) {
+	char8 bits = 0;
+	for (const char *p = from; p < to; p ++)   // without early exit, so that this can be vectorized
+		bits |= (char8) *p;
+	return bits < 128;
+}
+
+static const char *fast_findQuote (const char *p) {
+	return strchr (p, '\"');
+}
+
+static const char32 *fast_findQuote (const char32 *p) {
+	for (; *p != U'\0'; p ++)
+		if (*p == U'\"')
+			return p;
+	return nullptr;
+}
+
+template <typename T>
+static bool fast_peekString (MelderReadText me, T **readPointer, MelderString *buffer) {
+	const T *wordStart;
+	const T *openingQuote = fast_skipToItem (*readPointer, true, & wordStart);
+	if (openingQuote) {
+		for (const T *p = openingQuote + 1; ; ) {
+			const T *quote = fast_findQuote (p);
+			if (! quote)
+				break;
+			if constexpr (std::is_same_v <T, char>) {
+				if (fast_isAscii (p, quote))
+					fast_appendAscii (buffer, p, quote);
+				else if (my input8Encoding != kMelder_textInputEncoding::UTF8 || ! fast_appendUtf8 (buffer, p, quote))
+					break;
+			} else {
+				MelderString_nappend (buffer, p, quote - p);
+			}
+			const char32 next = fast_code (quote [1]);
+			if (next == U'\"') {   // a doubled quote
+				MelderString_appendCharacter (buffer, U'\"');
+				p = quote + 2;
+				continue;
+			}
+			if (next == U'\0' || (next <= 127 && Melder_isAsciiHorizontalOrVerticalSpace (next))) {
+				*readPointer = const_cast <T *> (next == U'\0' ? quote + 1 : quote + 2);
+				my previousPointerStep = ( next == U'\0' ? 0 : 1 );
+				return true;
+			}
+			break;
+		}
+		wordStart = openingQuote;
+		MelderString_empty (buffer);
+	}
+	*readPointer = const_cast <T *> (wordStart);
+	my previousPointerStep = 0;
+	return false;
+}
+
+static bool fast_peekString (MelderReadText me, MelderString *buffer) {
+	return my string32 ?
+		fast_peekString (me, & my readPointer32, buffer) :
+		fast_peekString (me, & my readPointer8, buffer);
+}
+
 static int64 getInteger (MelderReadText me) {
 	char buffer [41];
+	if (fast_getNumber (me, true, false, buffer))
+		return strtoll (buffer, nullptr, 10);
 	char32 c;
 	/*
 	 * Look for the first numeric character.
@@ -65,6 +335,8 @@ static int64 getInteger (MelderReadText me) {
 
 static uint64 getUnsigned (MelderReadText me) {
 	char buffer [41];
+	if (fast_getNumber (me, false, false, buffer))
+		return strtoull (buffer, nullptr, 10);
 	char32 c;
 	for (c = MelderReadText_getChar (me); ! Melder_isAsciiDecimalNumber (c) && c != U'+'; c = MelderReadText_getChar (me)) {
 		if (c == U'\0')
@@ -106,38 +378,43 @@ static double getReal (MelderReadText me) {
 	int i;
 	char buffer [41], *slash;
 	char32 c;
-	do {
-		for (c = MelderReadText_getChar (me); c != U'-' && ! Melder_isAsciiDecimalNumber (c) && c != U'+'; c = MelderReadText_getChar (me)) {
-			if (c == U'\0')
-				Melder_throw (U"Early end of text detected while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
-			if (c == U'!') {   // end-of-line comment?
-				while ((c = MelderReadText_getChar (me)) != U'\n' && c != U'\r') {
+	if (! fast_getNumber (me, true, true, buffer)) {
+		do {
+			for (c = MelderReadText_getChar (me); c != U'-' && ! Melder_isAsciiDecimalNumber (c) && c != U'+'; c = MelderReadText_getChar (me)) {
+				if (c == U'\0')
+					Melder_throw (U"Early end of text detected while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
+				if (c == U'!') {   // end-of-line comment?
+					while ((c = MelderReadText_getChar (me)) != U'\n' && c != U'\r') {
+						if (c == U'\0')
+							Melder_throw (U"Early end of text detected in comment while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
+					}
+				}
+				if (c == U'\"')
+					Melder_throw (U"Found a string while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
+				if (c == U'<')
+					Melder_throw (U"Found an enumerated value while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
+				while (! Melder_isHorizontalOrVerticalSpace (c)) {
 					if (c == U'\0')
 						Melder_throw (U"Early end of text detected in comment while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
+					c = MelderReadText_getChar (me);
 				}
 			}
-			if (c == U'\"')
-				Melder_throw (U"Found a string while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
-			if (c == U'<')
-				Melder_throw (U"Found an enumerated value while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
-			while (! Melder_isHorizontalOrVerticalSpace (c)) {
-				if (c == U'\0')
-					Melder_throw (U"Early end of text detected in comment while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
+			for (i = 0; i < 40; i ++) {
+				if (c > 127)
+					Melder_throw (U"Found strange text while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
+				buffer [i] = (char) (char8) c;   // guarded conversion down
 				c = MelderReadText_getChar (me);
+				if (c == U'\0') { break; }   // this may well be OK here
+				if (Melder_isHorizontalOrVerticalSpace (c)) break;
 			}
-		}
-		for (i = 0; i < 40; i ++) {
-			if (c > 127)
-				Melder_throw (U"Found strange text while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
-			buffer [i] = (char) (char8) c;   // guarded conversion down
-			c = MelderReadText_getChar (me);
-			if (c == U'\0') { break; }   // this may well be OK here
-			if (Melder_isHorizontalOrVerticalSpace (c)) break;
-		}
-		if (i >= 40)
-			Melder_throw (U"Found long text while searching for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
-	} while (i == 0 && buffer [0] == '+');   // guard against single '+' symbols, which occur in complex numbers
-	buffer [i + 1] = '\0';
+			if (i >= 40)
+				Melder_throw (U"Found long text while searching for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
+		} while (i == 0 && buffer [0] == '+');   // guard against single '+' symbols, which occur in complex numbers
+		buffer [i + 1] = '\0';
+	}
+	double value;
+	if (fast_stringToReal (buffer, & value))
+		return value;
 	slash = strchr (buffer, '/');
 	if (slash) {
 		*slash = '\0';
@@ -293,9 +570,21 @@ static int getEnum (MelderReadText me, int (*getValue) (conststring32)) {
 	return value;
 }
 
+/*
+	Each thread has its own buffer, because parts of a text (e.g. the tiers of a TextGrid) can be read in parallel.
+*/
+static thread_local struct PeekStringBuffer {
+	MelderString string;
+	~ PeekStringBuffer () {
+		MelderString_free (& string);
+	}
+} thePeekStringBuffer;
+
 static char32 * peekString (MelderReadText me) {
-	static MelderString buffer;
+	MelderString& buffer = thePeekStringBuffer.string;
 	MelderString_empty (& buffer);
+	if (fast_peekString (me, & buffer))
+		return buffer.string;
 	for (char32 c = MelderReadText_getChar (me); c != U'\"'; c = MelderReadText_getChar (me)) {
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while looking for a string (line ", MelderReadText_getLineNumber (me), U").");
@@ -433,6 +722,73 @@ bool texgetex (MelderReadText text) { return getEnum (text, (enum_generic_getVal
 autostring32 texgetw16 (MelderReadText text) { return Melder_dup (peekString (text)); }
 autostring32 texgetw32 (MelderReadText text) { return Melder_dup (peekString (text)); }
 
+template <typename T>
+static T *skipItems (T *p, integer numberOfItems) {
+	for (integer iitem = 1; iitem <= numberOfItems; iitem ++) {
+		/*
+			Skip white space, comments and labels.
+		*/
+		for (;;) {
+			char32 c = fast_code (*p);
+			if (c == U'\0')
+				return nullptr;
+			if (c == U'\"' || c == U'-' || c == U'+' || Melder_isAsciiDecimalNumber (c))
+				break;
+			if (c == U'!') {   // end-of-line comment
+				do {
+					c = fast_code (* ++ p);
+					if (c == U'\0')
+						return nullptr;
+				} while (c != U'\n' && c != U'\r');
+			} else {
+				while (! Melder_isAsciiHorizontalOrVerticalSpace (c)) {
+					c = fast_code (* ++ p);
+					if (c == U'\0')
+						return nullptr;
+				}
+			}
+			p ++;   // past the space
+		}
+		/*
+			Skip the item itself, and the character after it.
+		*/
+		if (*p == '\"') {
+			for (p ++; ; p += 2) {
+				p = const_cast <T *> (fast_findQuote (p));
+				if (! p)
+					return nullptr;
+				if (p [1] != '\"')
+					break;
+			}
+			p ++;   // past the closing quote
+		} else {
+			while (*p != '\0' && ! Melder_isAsciiHorizontalOrVerticalSpace (fast_code (*p)))
+				p ++;
+		}
+		if (*p != '\0') {
+			if (! Melder_isAsciiHorizontalOrVerticalSpace (fast_code (*p)))
+				return nullptr;   // not an item that the texget functions would accept
+			p ++;
+		}
+	}
+	return p;
+}
+
+void texskipitems (MelderReadText text, integer numberOfItems) {
+	if (text -> string32) {
+		char32 *p = skipItems (text -> readPointer32, numberOfItems);
+		if (! p)
+			Melder_throw (U"Cannot skip ", numberOfItems, U" items in text (line ", MelderReadText_getLineNumber (text), U").");
+		text -> readPointer32 = p;
+	} else {
+		char *p = skipItems (text -> readPointer8, numberOfItems);
+		if (! p)
+			Melder_throw (U"Cannot skip ", numberOfItems, U" items in text (line ", MelderReadText_getLineNumber (text), U").");
+		text -> readPointer8 = p;
+	}
+	text -> previousPointerStep = 0;
+}
+
 void texindent (MelderFile file) { file -> indent += 4; }
 void texexdent (MelderFile file) { file -> indent -= 4; }
 void texresetindent (MelderFile file) { file -> indent = 0; }
@@ -1444,6 +1800,40 @@ void binputu32LE (uint32 u, FILE *f) {
 	}
 }
 
+static void r32ToBigEndianBytes (double x, uint8 bytes [4]) {
+	int sign, exponent;
+	double fMantissa, fsMantissa;
+	uint32 mantissa;
+	if (x < 0.0) {
+		sign = 0x0100;
+		x *= -1.0;
+	} else
+		sign = 0;
+	if (x == 0.0) {
+		exponent = 0;
+		mantissa = 0;
+	} else {
+		fMantissa = frexp (x, & exponent);
+		if ((exponent > 128) || ! (fMantissa < 1.0))   // Infinity or Not-a-Number
+			{ exponent = sign | 0x00FF; mantissa = 0; }   // Infinity
+		else {   // finite
+			exponent += 126;   // add bias
+			if (exponent <= 0) {   // denormalized
+				fMantissa = ldexp (fMantissa, exponent - 1);
+				exponent = 0;
+			}
+			exponent |= sign;
+			fMantissa = ldexp (fMantissa, 24);          
+			fsMantissa = floor (fMantissa); 
+			mantissa = (uint32) fsMantissa & 0x007FFFFF;
+		}
+	}
+	bytes [0] = (uint8) (exponent >> 1);   // truncate: bits 2 through 9 (bit 9 is the sign bit)
+	bytes [1] = (uint8) ((exponent << 7) | (mantissa >> 16));   // truncate
+	bytes [2] = (uint8) (mantissa >> 8);   // truncate
+	bytes [3] = (uint8) mantissa;   // truncate
+}
+
 void binputr32 (double x, FILE *f) {
 	try {
 		if (binario_floatIEEE4msb && ! (Melder_debug == 18)) {
@@ -1452,37 +1842,7 @@ void binputr32 (double x, FILE *f) {
 				writeError (U"a 32-bit floating-point number.");
 		} else {
 			uint8 bytes [4];
-			int sign, exponent;
-			double fMantissa, fsMantissa;
-			uint32 mantissa;
-			if (x < 0.0) {
-				sign = 0x0100;
-				x *= -1.0;
-			} else
-				sign = 0;
-			if (x == 0.0) {
-				exponent = 0;
-				mantissa = 0;
-			} else {
-				fMantissa = frexp (x, & exponent);
-				if ((exponent > 128) || ! (fMantissa < 1.0))   // Infinity or Not-a-Number
-					{ exponent = sign | 0x00FF; mantissa = 0; }   // Infinity
-				else {   // finite
-					exponent += 126;   // add bias
-					if (exponent <= 0) {   // denormalized
-						fMantissa = ldexp (fMantissa, exponent - 1);
-						exponent = 0;
-					}
-					exponent |= sign;
-					fMantissa = ldexp (fMantissa, 24);          
-					fsMantissa = floor (fMantissa); 
-					mantissa = (uint32) fsMantissa & 0x007FFFFF;
-				}
-			}
-			bytes [0] = (uint8) (exponent >> 1);   // truncate: bits 2 through 9 (bit 9 is the sign bit)
-			bytes [1] = (uint8) ((exponent << 7) | (mantissa >> 16));   // truncate
-			bytes [2] = (uint8) (mantissa >> 8);   // truncate
-			bytes [3] = (uint8) mantissa;   // truncate
+			r32ToBigEndianBytes (x, bytes);
 			if (fwrite (bytes, sizeof (uint8), 4, f) != 4)
 				writeError (U"four bytes.");
 		}
@@ -1760,6 +2120,157 @@ void binputc128 (dcomplex z, FILE *f) {
 	}
 }
 
+/*
+	Bulk versions for vectors and matrices.
+	The values are read or written with a single fread or fwrite per block, instead of one per value,
+	and the bytes are reordered in a loop over the whole block, which the compiler can vectorize.
+	The results are identical to those of the one-value versions above:
+	on reading, infinities and NaNs become `undefined`;
+	on writing, NaNs become positive infinity and negative zero becomes positive zero.
+*/
+
+constexpr integer binario_BLOCK_SIZE = 4096;   // values per fread or fwrite when a buffer is needed
+
+static bool binario_isLittleEndian () {
+	const uint16 one = 1;
+	uint8 firstByte;
+	memcpy (& firstByte, & one, 1);
+	return firstByte == 1;
+}
+
+static inline uint64 binario_swap64 (uint64 x) {
+	return
+		(x >> 56) | ((x >> 40) & 0x0000'0000'0000'FF00) | ((x >> 24) & 0x0000'0000'00FF'0000) | ((x >> 8) & 0x0000'0000'FF00'0000) |
+		((x << 8) & 0x0000'00FF'0000'0000) | ((x << 24) & 0x0000'FF00'0000'0000) | ((x << 40) & 0x00FF'0000'0000'0000) | (x << 56);
+}
+
+static inline uint32 binario_swap32 (uint32 x) {
+	return (x >> 24) | ((x >> 8) & 0x0000'FF00) | ((x << 8) & 0x00FF'0000) | (x << 24);
+}
+
+void bingetr64 (FILE *f, double *out_values, integer n) {
+	if (n <= 0)
+		return;
+	if (Melder_debug == 18 || Melder_debug == 181) {   // keep the debugging options of the one-value version
+		for (integer i = 0; i < n; i ++)
+			out_values [i] = bingetr64 (f);
+		return;
+	}
+	try {
+		/*
+			Read the big-endian bit patterns straight into the target,
+			then convert them in place.
+		*/
+		if (fread (out_values, sizeof (double), integer_to_uinteger (n), f) != integer_to_uinteger (n))
+			readError (f, Melder_cat (n, U" 64-bit floating-point numbers."));
+		uint64 *const bits = reinterpret_cast <uint64 *> (out_values);
+		const bool swap = binario_isLittleEndian ();
+		bool hasNonfiniteValues = false;
+		for (integer i = 0; i < n; i ++) {
+			const uint64 word = ( swap ? binario_swap64 (bits [i]) : bits [i] );
+			bits [i] = word;
+			hasNonfiniteValues |= ( (word & 0x7FF0'0000'0000'0000) == 0x7FF0'0000'0000'0000 );
+		}
+		if (hasNonfiniteValues)
+			for (integer i = 0; i < n; i ++)
+				if ((bits [i] & 0x7FF0'0000'0000'0000) == 0x7FF0'0000'0000'0000)
+					out_values [i] = undefined;
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not read from binary file.");
+	}
+}
+
+void binputr64 (const double *values, integer n, FILE *f) {
+	if (n <= 0)
+		return;
+	if (Melder_debug == 18 || Melder_debug == 181) {
+		for (integer i = 0; i < n; i ++)
+			binputr64 (values [i], f);
+		return;
+	}
+	try {
+		const bool swap = binario_isLittleEndian ();
+		uint64 buffer [binario_BLOCK_SIZE];
+		for (integer offset = 0; offset < n; offset += binario_BLOCK_SIZE) {
+			const integer count = std::min (binario_BLOCK_SIZE, n - offset);
+			memcpy (buffer, values + offset, integer_to_uinteger (count) * sizeof (double));
+			for (integer i = 0; i < count; i ++) {
+				uint64 word = buffer [i];
+				if ((word & 0x7FFF'FFFF'FFFF'FFFF) == 0)
+					word = 0;   // negative zero
+				else if ((word & 0x7FF0'0000'0000'0000) == 0x7FF0'0000'0000'0000 && (word & 0x000F'FFFF'FFFF'FFFF) != 0)
+					word = 0x7FF0'0000'0000'0000;   // NaN
+				buffer [i] = ( swap ? binario_swap64 (word) : word );
+			}
+			if (fwrite (buffer, sizeof (uint64), integer_to_uinteger (count), f) != integer_to_uinteger (count))
+				writeError (Melder_cat (count, U" 64-bit floating-point numbers."));
+		}
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not written to binary file.");
+	}
+}
+
+void bingetr32 (FILE *f, double *out_values, integer n) {
+	if (n <= 0)
+		return;
+	if (Melder_debug == 18) {
+		for (integer i = 0; i < n; i ++)
+			out_values [i] = bingetr32 (f);
+		return;
+	}
+	try {
+		const bool swap = binario_isLittleEndian ();
+		uint32 buffer [binario_BLOCK_SIZE];
+		for (integer offset = 0; offset < n; offset += binario_BLOCK_SIZE) {
+			const integer count = std::min (binario_BLOCK_SIZE, n - offset);
+			if (fread (buffer, sizeof (uint32), integer_to_uinteger (count), f) != integer_to_uinteger (count))
+				readError (f, Melder_cat (count, U" 32-bit floating-point numbers."));
+			for (integer i = 0; i < count; i ++) {
+				const uint32 word = ( swap ? binario_swap32 (buffer [i]) : buffer [i] );
+				float x;
+				memcpy (& x, & word, sizeof (float));
+				out_values [offset + i] = ( (word & 0x7F80'0000) == 0x7F80'0000 ? undefined : (double) x );
+			}
+		}
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not read from binary file.");
+	}
+}
+
+void binputr32 (const double *values, integer n, FILE *f) {
+	if (n <= 0)
+		return;
+	if (binario_floatIEEE4msb || Melder_debug == 18) {
+		for (integer i = 0; i < n; i ++)
+			binputr32 (values [i], f);
+		return;
+	}
+	try {
+		/*
+			The one-value version rounds towards zero, which a cast to `float` does not;
+			we therefore keep its conversion, but write whole blocks.
+		*/
+		uint8 buffer [4 * binario_BLOCK_SIZE];
+		for (integer offset = 0; offset < n; offset += binario_BLOCK_SIZE) {
+			const integer count = std::min (binario_BLOCK_SIZE, n - offset);
+			for (integer i = 0; i < count; i ++)
+				r32ToBigEndianBytes (values [offset + i], & buffer [4 * i]);
+			if (fwrite (buffer, 4, integer_to_uinteger (count), f) != integer_to_uinteger (count))
+				writeError (Melder_cat (count, U" 32-bit floating-point numbers."));
+		}
+	} catch (MelderError) {
+		Melder_throw (U"Floating-point numbers not written to binary file.");
+	}
+}
+
+void bingetc128 (FILE *f, dcomplex *out_values, integer n) {
+	bingetr64 (f, reinterpret_cast <double *> (out_values), 2 * n);   // real and imaginary parts alternate, as in the file
+}
+
+void binputc128 (const dcomplex *values, integer n, FILE *f) {
+	binputr64 (reinterpret_cast <const double *> (values), 2 * n, f);
+}
+
 autostring8 bingets8 (FILE *f) {
 	try {
 		uint32 length = bingetu8 (f);
@@ -2,7 +2,7 @@
 #define _abcio_h_
 /* abcio.h
  *
- * Copyright (C) 1992-2011,2015,2017-2020,2022,2024 Paul Boersma
+ * Copyright (C) 1992-2011,2015,2017-2020,2022,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -41,6 +41,12 @@ bool texgeteq (MelderReadText text);
 bool texgetex (MelderReadText text);
 autostring32 texgetw16 (MelderReadText text);
 autostring32 texgetw32 (MelderReadText text);
+void texskipitems (MelderReadText text, integer numberOfItems);
+/*
+	Skips numbers and strings (together with the labels and comments in front of them) without converting them,
+	e.g. to find where the next object in a text file starts. Throws at an early end of the text,
+	or at an item that is not followed by white space; other errors are left to the readers that read the skipped part later.
+*/
 
 void texindent (MelderFile file);
 void texexdent (MelderFile file);
@@ -163,6 +169,15 @@ dcomplex bingetc128 (FILE *f);
 void binputc64 (dcomplex z, FILE *f);
 void binputc128 (dcomplex z, FILE *f);
 
+void bingetr32 (FILE *f, double *out_values, integer n);   void binputr32 (const double *values, integer n, FILE *f);
+void bingetr64 (FILE *f, double *out_values, integer n);   void binputr64 (const double *values, integer n, FILE *f);
+void bingetc128 (FILE *f, dcomplex *out_values, integer n);   void binputc128 (const dcomplex *values, integer n, FILE *f);
+/*
+	Read or write `n` consecutive numbers in a single pass, with the same result as `n` calls
+	to the one-value versions, but with one fread or fwrite per block instead of one per number.
+	These are used for vectors and matrices.
+*/
+
 autostring8 bingets8 (FILE *f);   void binputs8 (const char *s, FILE *f);   // 0..255 characters
 autostring8 bingets16 (FILE *f);   void binputs16 (const char *s, FILE *f);   // 0..65535 characters
 autostring8 bingets32 (FILE *f);   void binputs32 (const char *s, FILE *f);   // 0..4294967295 characters
@@ -98,6 +98,7 @@
 #include "melder_help.h"
 #include "melder_ftoi.h"
 #include "melder_time.h"   // stopwatch, sleep, clock
+#include "melder_thread.h"   // MelderThread_run (requires MelderError, Melder_dup_f)
 #include "melder_audio.h"
 #include "melder_audiofiles.h"
 
@@ -1,6 +1,6 @@
 /* melder_audiofiles.cpp
  *
- * Copyright (C) 1992-2008,2010-2019,2021,2023,2024 Paul Boersma & David Weenink, 2007 Erez Volk (for FLAC)
+ * Copyright (C) 1992-2008,2010-2019,2021,2023,2024,2026 Paul Boersma & David Weenink, 2007 Erez Volk (for FLAC)
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,6 +25,10 @@
 	#include "../external/flac/flac_share_windows_unicode_filenames.h"
 #endif
 #include "../external/mp3/mp3.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 /***** WRITING *****/
 
@@ -777,7 +781,8 @@ static void Melder_checkNistFile (FILE *f, integer *numberOfChannels, int *encod
 static void Melder_checkFlacFile (MelderFile file, integer *numberOfChannels_out, int *encoding_out,
 	double *sampleRate_out, integer *startOfData_out, integer *numberOfSamples_out)
 {
-	const conststring8 fileName_utf8 = MelderFile_peekPath8 (file);
+	char fileName_utf8 [kMelder_MAXPATH+1];   // on the stack, because sound files can be read in parallel
+	Melder_32to8_fileSystem_inplace (MelderFile_peekPath (file), fileName_utf8);
 	FLAC__StreamMetadata metadata;
 	if (! FLAC__metadata_get_streaminfo (fileName_utf8, & metadata))   // Unicode-savvy (test/fon/soundFiles.praat 2024-08-11)
 		Melder_throw (U"Invalid FLAC file");
@@ -998,9 +1003,9 @@ static void Melder_readMp3File (FILE *f, MAT buffer) {
 		Melder_throw (U"Error decoding MP3 file.");
 }
 
-static int bitsInReadBuffer = 0;
+static thread_local int bitsInReadBuffer = 0;   // thread-local, because sound files can be read in parallel
 static uint32 readOneBit (FILE *f) {
-	static uint8 readBuffer;
+	static thread_local uint8 readBuffer;
 	if (bitsInReadBuffer == 0) {
 		int externalValue = fgetc (f);
 		Melder_require (externalValue >= 0,
@@ -1681,6 +1686,126 @@ static void Melder_readPolyphoneFile (MelderFile file, MAT buffer) {
 		U"Expected ", buffer.ncol, U" samples but found ", numberOfSamplesRead, U".");
 }
 
+/*
+	Linear PCM and the other encodings with whole bytes per sample are decoded in blocks:
+	a block of interleaved sample frames is read into a small byte buffer,
+	after which each channel is converted into its own row of the output, stepping through the block one frame at a time.
+	Every sample becomes an int32 whose most significant bits are the sample's bits, scaled by 2^-31
+	(for 8- and 16-bit samples this is the same as scaling the sample itself by 1/128 or 1/32768).
+*/
+constexpr integer PCM_BLOCK_NUMBER_OF_BYTES = 65536;
+constexpr integer PCM_BLOCK_NUMBER_OF_EXTRA_BYTES = 32;   // so that vector instructions can load a little beyond the last frame
+
+using PcmDecoder = void (*) (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out);
+
+template <int numberOfBytesPerSample, bool bigEndian>
+static void decodeLinearPcm (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out) {
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+		uint32 unsignedValue = 0;
+		for (int ibyte = 0; ibyte < numberOfBytesPerSample; ibyte ++)   // from most significant to least significant
+			unsignedValue |= (uint32) bytes [bigEndian ? ibyte : numberOfBytesPerSample - 1 - ibyte] << (24 - 8 * ibyte);
+		out [isamp] = (int32) unsignedValue * (1.0 / 32768 / 65536);
+	}
+}
+
+static void decodeLinear8Unsigned (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out) {
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+		out [isamp] = *bytes * (1.0 / 128) - 1.0;
+}
+
+static void decodeMulaw (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out) {
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+		out [isamp] = ulaw2linear [*bytes] * (1.0 / 32768);
+}
+
+static void decodeAlaw (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out) {
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+		out [isamp] = alaw2linear [*bytes] * (1.0 / 32768);
+}
+
+#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+	/*
+		16-bit little-endian samples, mono or stereo, eight at a time.
+		For stereo, the 32-bit word at each frame has the sample of the channel at hand in its lower half,
+		for the second channel as well because `bytes` then starts two bytes into the frame;
+		the last load of a block may therefore read two bytes beyond the last frame.
+		It is compiled for AVX2 whatever the compiler flags, but only called if the processor supports it.
+	*/
+	#include <immintrin.h>
+	__attribute__ ((target ("avx2")))
+	static void decodeLinear16LittleEndian_avx2 (const uint8 *bytes, integer frameSize, integer numberOfSamples, double *out) {
+		Melder_assert (frameSize == 2 || frameSize == 4);
+		const __m256d scale = _mm256_set1_pd (1.0 / 32768);
+		integer isamp = 0;
+		for (; isamp + 8 <= numberOfSamples; isamp += 8) {
+			const __m256i values = ( frameSize == 2 ?
+				_mm256_cvtepi16_epi32 (_mm_loadu_si128 ((const __m128i *) (bytes + 2 * isamp))) :
+				_mm256_srai_epi32 (_mm256_slli_epi32 (_mm256_loadu_si256 ((const __m256i *) (bytes + 4 * isamp)), 16), 16)
+			);
+			_mm256_storeu_pd (out + isamp, _mm256_mul_pd (_mm256_cvtepi32_pd (_mm256_castsi256_si128 (values)), scale));
+			_mm256_storeu_pd (out + isamp + 4, _mm256_mul_pd (_mm256_cvtepi32_pd (_mm256_extracti128_si256 (values, 1)), scale));
+		}
+		decodeLinearPcm <2, false> (bytes + isamp * frameSize, frameSize, numberOfSamples - isamp, out + isamp);
+	}
+#endif
+
+static PcmDecoder chooseDecoder (int encoding, integer frameSize) {
+	switch (encoding) {
+		case Melder_LINEAR_8_SIGNED: return decodeLinearPcm <1, true>;
+		case Melder_LINEAR_8_UNSIGNED: return decodeLinear8Unsigned;
+		case Melder_LINEAR_16_BIG_ENDIAN: return decodeLinearPcm <2, true>;
+		case Melder_LINEAR_16_LITTLE_ENDIAN: {
+			#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+				static const bool processorHasAvx2 = __builtin_cpu_supports ("avx2");
+				if (processorHasAvx2 && (frameSize == 2 || frameSize == 4))
+					return decodeLinear16LittleEndian_avx2;
+			#else
+				(void) frameSize;
+			#endif
+			return decodeLinearPcm <2, false>;
+		}
+		case Melder_LINEAR_24_BIG_ENDIAN: return decodeLinearPcm <3, true>;
+		case Melder_LINEAR_24_LITTLE_ENDIAN: return decodeLinearPcm <3, false>;
+		case Melder_LINEAR_32_BIG_ENDIAN: return decodeLinearPcm <4, true>;
+		case Melder_LINEAR_32_LITTLE_ENDIAN: return decodeLinearPcm <4, false>;
+		case Melder_MULAW: return decodeMulaw;
+		case Melder_ALAW: return decodeAlaw;
+		default: Melder_fatal (U"chooseDecoder: unknown encoding ", encoding, U".");
+	}
+}
+
+/*
+	Returns false if the file turns out to be too small; the missing samples are then set to zero.
+*/
+static bool readBlocksOfBytes (FILE *f, int encoding, MAT const& buffer) {
+	const integer numberOfChannels = buffer.nrow, numberOfSamples = buffer.ncol;
+	const integer numberOfBytesPerSample = Melder_bytesPerSamplePoint (encoding);
+	const integer frameSize = numberOfChannels * numberOfBytesPerSample;
+	const integer numberOfFramesPerBlock = std::max (PCM_BLOCK_NUMBER_OF_BYTES / frameSize, 1_integer);
+	autovector <uint8> bytes = newvectorzero <uint8> (numberOfFramesPerBlock * frameSize + PCM_BLOCK_NUMBER_OF_EXTRA_BYTES);
+	const PcmDecoder decode = chooseDecoder (encoding, frameSize);
+	bool fileIsLargeEnough = true;
+	for (integer firstSample = 1; firstSample <= numberOfSamples; firstSample += numberOfFramesPerBlock) {
+		const integer numberOfFrames = std::min (numberOfFramesPerBlock, numberOfSamples - firstSample + 1);
+		const size_t numberOfBytesWanted = (size_t) (numberOfFrames * frameSize);
+		size_t numberOfBytesRead = ( fileIsLargeEnough ? fread (bytes.cells, 1, numberOfBytesWanted, f) : 0 );
+		if (numberOfBytesRead < numberOfBytesWanted) {
+			numberOfBytesRead -= numberOfBytesRead % (size_t) numberOfBytesPerSample;   // an incomplete sample counts as missing
+			memset (bytes.cells + numberOfBytesRead, 0, numberOfBytesWanted - numberOfBytesRead);
+			fileIsLargeEnough = false;
+		}
+		for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
+			decode (bytes.cells + (ichan - 1) * numberOfBytesPerSample, frameSize, numberOfFrames, & buffer [ichan] [firstSample]);
+		if (numberOfBytesRead < numberOfBytesWanted && numberOfBytesPerSample == 1)
+			/*
+				A zero byte does not stand for a zero sample in unsigned or μ-law or A-law encoding.
+			*/
+			for (integer ibyte = (integer) numberOfBytesRead; ibyte < (integer) numberOfBytesWanted; ibyte ++)
+				buffer [1 + ibyte % numberOfChannels] [firstSample + ibyte / numberOfChannels] = 0.0;
+	}
+	return fileIsLargeEnough;
+}
+
 static void warning_fileTooSmall (MelderFile file, integer numberOfChannels, const char32 *type) {
 	Melder_warning (U"File ", MelderFile_messageName (file), U" too small (",
 			numberOfChannels, U"-channel ", type, U").\nMissing samples were set to zero.");
@@ -1692,28 +1817,13 @@ void Melder_readAudioToFloat (MelderFile file, int encoding, MAT buffer) {
 		integer numberOfChannels = buffer.nrow;
 		integer numberOfSamples = buffer.ncol;
 		switch (encoding) {
-			case Melder_LINEAR_8_SIGNED: {
-				try {
-					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-						for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							int8 value;
-							if (fread (& value, 1, 1, f) < 1) throw MelderError ();
-							buffer [ichan] [isamp] = value * (1.0 / 128);
-						}
-				} catch (MelderError) {
-					Melder_clearError ();
+			case Melder_LINEAR_8_SIGNED:
+				if (! readBlocksOfBytes (f, encoding, buffer))
 					warning_fileTooSmall (file, numberOfChannels, U"8-bit signed");
-				}
-			} break;
+				break;
 			case Melder_LINEAR_8_UNSIGNED:
-				try {
-					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-						for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
-							buffer [ichan] [isamp] = bingetu8 (f) * (1.0 / 128) - 1.0;
-				} catch (MelderError) {
-					Melder_clearError ();
+				if (! readBlocksOfBytes (f, encoding, buffer))
 					warning_fileTooSmall (file, numberOfChannels, U"8-bit unsigned");
-				}
 				break;
 			case Melder_LINEAR_16_BIG_ENDIAN:
 			case Melder_LINEAR_16_LITTLE_ENDIAN:
@@ -1721,260 +1831,10 @@ void Melder_readAudioToFloat (MelderFile file, int encoding, MAT buffer) {
 			case Melder_LINEAR_24_LITTLE_ENDIAN:
 			case Melder_LINEAR_32_BIG_ENDIAN:
 			case Melder_LINEAR_32_LITTLE_ENDIAN:
-			{
-				const int numberOfBytesPerSamplePerChannel =
-					encoding == Melder_LINEAR_16_BIG_ENDIAN || encoding == Melder_LINEAR_16_LITTLE_ENDIAN ? 2 :
-					encoding == Melder_LINEAR_24_BIG_ENDIAN || encoding == Melder_LINEAR_24_LITTLE_ENDIAN ? 3 : 4;
-				const double numberOfBytes_f = (double) numberOfChannels * (double) numberOfSamples * (double) numberOfBytesPerSamplePerChannel;
-				if (isinf (numberOfBytes_f) || numberOfBytes_f > (double) (1LL << 53)) {
-					Melder_throw (U"Cannot read ", numberOfBytes_f, U" bytes, "
-						U"because that crosses the 9-petabyte limit.");
-				}
-				if (numberOfBytes_f > (double) SIZE_MAX) {
-					Melder_throw (U"Cannot read ", numberOfBytes_f, U" bytes. "
-						U"Perhaps try a 64-bit edition of Praat?");
-				}
-				Melder_assert (numberOfBytes_f >= 0.0);
-				const size_t numberOfBytes = (size_t) numberOfBytes_f;   // cast is safe because overflow and signedness have been checked
-				/* mutable read */ uint8 * /* mutable cycle */ bytes =
-						(uint8 *) & buffer [numberOfChannels] [numberOfSamples] + sizeof (double) - numberOfBytes;
-				/*
-					Read 16-bit data into the last quarter of the buffer,
-					or 24-bit data into the last three-eighths of the buffer,
-					or 32-bit data into the last half of the buffer.
-				*/
-				const size_t numberOfBytesRead = fread (bytes, 1, numberOfBytes, f);
-				if (numberOfChannels == 1) {
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++;
-								const int value = (int) (int16) (((uint16) byte1 << 8) | (uint16) byte2);   // extend sign
-								buffer [1] [isamp] = value * (1.0 / 32768);
-							}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++;
-								const int value = (int) (int16) (((uint16) byte2 << 8) | (uint16) byte1);   // extend sign
-								buffer [1] [isamp] = value * (1.0 / 32768);
-							}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-								const int32 value = (int32)
-									((uint32) ((uint32) byte1 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-											  ((uint32) byte3 << 8));
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-								const int32 value = (int32)
-									((uint32) ((uint32) byte3 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-											  ((uint32) byte1 << 8));
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-								const int32 value = (int32)
-									((uint32) ((uint32) byte1 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-									 (uint32) ((uint32) byte3 << 8) |
-											   (uint32) byte4);
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								const unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-								const int32 value = (int32)
-									((uint32) ((uint32) byte4 << 24) |
-									 (uint32) ((uint32) byte3 << 16) |
-									 (uint32) ((uint32) byte2 << 8) |
-											   (uint32) byte1);
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-					}
-				} else if (numberOfChannels <= (int) sizeof (double) / numberOfBytesPerSamplePerChannel) {
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									const int value = (int) (int16) (uint16) ((uint16) ((uint16) byte1 << 8) | (uint16) byte2);
-									buffer [ichan] [isamp] = value * (1.0 / 32768);
-								}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									const int value = (int) (int16) (uint16) ((uint16) ((uint16) byte2 << 8) | (uint16) byte1);
-									buffer [ichan] [isamp] = value * (1.0 / 32768);
-								}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									/* mutable sign */ uint32 unsignedValue =
-										(uint32) ((uint32) byte1 << 16) |
-										(uint32) ((uint32) byte2 << 8) |
-												  (uint32) byte3;
-									if ((byte1 & 128) != 0)
-										unsignedValue |= 0xFF000000;   // extend sign
-									buffer [ichan] [isamp] = (int32) unsignedValue * (1.0 / 8388608);
-								}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									/* mutable sign */ uint32 unsignedValue = ((uint32) byte3 << 16) | ((uint32) byte2 << 8) | (uint32) byte1;
-									if ((byte3 & 128) != 0)
-										unsignedValue |= 0xFF000000;
-									buffer [ichan] [isamp] = (int32) unsignedValue * (1.0 / 8388608);
-								}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									const int32 value = (int32)
-										((uint32) ((uint32) byte1 << 24) |
-										 (uint32) ((uint32) byte2 << 16) |
-										 (uint32) ((uint32) byte3 << 8) |
-												   (uint32) byte4);
-									buffer [ichan] [isamp] = value * (1.0 / 32768 / 65536);
-								}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									const int32 value = (int32)
-										((uint32) ((uint32) byte4 << 24) |
-										 (uint32) ((uint32) byte3 << 16) |
-										 (uint32) ((uint32) byte2 << 8) |
-												   (uint32) byte1);
-									buffer [ichan] [isamp] = value * (1.0 / 32768 / 65536);
-								}
-						} break;
-					}
-				} else {
-					Melder_assert (sizeof (double) == 8);
-					int32 *ints = (int32 *) & buffer [1] [1];
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									const int32 value = (int32)
-										((uint32) ((uint32) byte1 << 24) |
-										 (uint32) ((uint32) byte2 << 16));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									const int32 value = (int32)
-										(((uint32) byte2 << 24) |
-										 ((uint32) byte1 << 16));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									const int32 value = (int32)
-										(((uint32) byte1 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte3 << 8));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									const int32 value = (int32)
-										(((uint32) byte3 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte1 << 8));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									const int32 value = (int32)
-										(((uint32) byte1 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte3 << 8) |
-										  (uint32) byte4);
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-								for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									const uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									const int32 value = (int32)
-										(((uint32) byte4 << 24) |
-										 ((uint32) byte3 << 16) |
-										 ((uint32) byte2 << 8) |
-										  (uint32) byte1);
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-						}
-					}
-					double *doubles = & buffer [1] [1];
-					integer n = numberOfSamples * numberOfChannels;
-					for (integer i = 0; i < n; i ++) {
-						int32 *valuePosition = (int32 *) & doubles [i];
-						int32 *markerPosition = valuePosition + 1;
-						if (! *markerPosition) {
-							int32 value = *valuePosition;
-							integer ichan = i / numberOfSamples, isamp = i % numberOfSamples;
-							for (integer other = isamp * numberOfChannels + ichan; other != i; ) {
-								int32 *otherValuePosition = (int32 *) & doubles [other];
-								*valuePosition = *otherValuePosition;
-								*markerPosition = 1;
-								valuePosition = otherValuePosition;
-								markerPosition = valuePosition + 1;
-								ichan = other / numberOfSamples, isamp = other % numberOfSamples;
-								other = isamp * numberOfChannels + ichan;
-							}
-							*valuePosition = value;
-							*markerPosition = 1;
-						}
-					}
-					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-						for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
-							buffer [ichan] [isamp] = * (int32 *) & buffer [ichan] [isamp] * (1.0 / 32768 / 65536);
-				}
-				if (numberOfBytesRead < numberOfBytes)
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel ", numberOfBytesPerSamplePerChannel * 8, U"-bit).\n"
+				if (! readBlocksOfBytes (f, encoding, buffer))
+					Melder_warning (U"File too small (", numberOfChannels, U"-channel ", Melder_bytesPerSamplePoint (encoding) * 8, U"-bit).\n"
 							U"Missing samples were set to zero.");
-			} break;
+				break;
 			case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
 				try {
 					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
@@ -2016,24 +1876,12 @@ void Melder_readAudioToFloat (MelderFile file, int encoding, MAT buffer) {
 				}
 				break;
 			case Melder_MULAW:
-				try {
-					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-						for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
-							buffer [ichan] [isamp] = ulaw2linear [bingetu8 (f)] * (1.0 / 32768);
-				} catch (MelderError) {
-					Melder_clearError ();
+				if (! readBlocksOfBytes (f, encoding, buffer))
 					warning_fileTooSmall (file, numberOfChannels, U"8-bit μ-law");
-				}
 				break;
 			case Melder_ALAW:
-				try {
-					for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-						for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
-							buffer [ichan] [isamp] = alaw2linear [bingetu8 (f)] * (1.0 / 32768);
-				} catch (MelderError) {
-					Melder_clearError ();
+				if (! readBlocksOfBytes (f, encoding, buffer))
 					warning_fileTooSmall (file, numberOfChannels, U"8-bit A-law");
-				}
 				break;
 			case Melder_FLAC_COMPRESSION_16:
 			case Melder_FLAC_COMPRESSION_24:
@@ -2213,146 +2061,352 @@ void MelderFile_writeShortToAudio (MelderFile file, integer numberOfChannels, in
 	}
 }
 
+/*
+	Writing linear PCM is the mirror image of reading it:
+	each channel is converted into its own place in a block of interleaved sample frames,
+	and the whole block is then written with a single fwrite.
+	The samples are rounded and clipped exactly as if they were written one at a time;
+	each encoder returns the number of samples it had to clip.
+*/
+using PcmEncoder = integer (*) (const double *in, integer inStride, integer numberOfSamples, uint8 *bytes, integer frameSize);
+
+template <int numberOfBytesPerSample, bool bigEndian>
+static integer encodeLinearPcm (const double *in, integer inStride, integer numberOfSamples, uint8 *bytes, integer frameSize) {
+	constexpr double scale = (double) (int64 (1) << (8 * numberOfBytesPerSample - 1));   // 128, 32768, 8388608 or 2147483648
+	constexpr double minimum = - scale, maximum = scale - 1.0;
+	integer nclipped = 0;
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, in += inStride, bytes += frameSize) {
+		/* mutable clip */ double value = round (*in * scale);
+		if (value < minimum) { value = minimum; nclipped ++; }
+		if (value > maximum) { value = maximum; nclipped ++; }
+		const uint32 unsignedValue = (uint32) (int32) value;   // safe cast: rounding and range already handled
+		for (int ibyte = 0; ibyte < numberOfBytesPerSample; ibyte ++)   // from least significant to most significant
+			bytes [bigEndian ? numberOfBytesPerSample - 1 - ibyte : ibyte] = (uint8) (unsignedValue >> (8 * ibyte));
+	}
+	return nclipped;
+}
+
+static integer encodeLinear8Unsigned (const double *in, integer inStride, integer numberOfSamples, uint8 *bytes, integer frameSize) {
+	integer nclipped = 0;
+	for (integer isamp = 0; isamp < numberOfSamples; isamp ++, in += inStride, bytes += frameSize) {
+		/* mutable clip */ double value = floor ((*in + 1.0) * 128.0);
+		if (value < 0.0) { value = 0.0; nclipped ++; }
+		if (value > 255.0) { value = 255.0; nclipped ++; }
+		*bytes = (uint8) (int) value;
+	}
+	return nclipped;
+}
+
+#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+	/*
+		16-bit little-endian samples from a contiguous row, four at a time.
+		The rounding is that of round(): halfway cases away from zero
+		(the difference between a value and its truncation is exact, so it can be compared with 0.5).
+		The clipping leaves a NaN alone, so that it is written as zero, as by the scalar version.
+	*/
+	__attribute__ ((target ("avx2")))
+	static integer encodeLinear16LittleEndian_avx2 (const double *in, integer inStride, integer numberOfSamples, uint8 *bytes, integer frameSize) {
+		Melder_assert (inStride == 1);
+		const __m256d scale = _mm256_set1_pd (32768.0), minimum = _mm256_set1_pd (-32768.0), maximum = _mm256_set1_pd (32767.0);
+		const __m256d half = _mm256_set1_pd (0.5), one = _mm256_set1_pd (1.0), signBit = _mm256_set1_pd (-0.0);
+		integer nclipped = 0, isamp = 0;
+		for (; isamp + 4 <= numberOfSamples; isamp += 4) {
+			const __m256d scaled = _mm256_mul_pd (_mm256_loadu_pd (in + isamp), scale);
+			const __m256d truncated = _mm256_round_pd (scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+			const __m256d roundAwayFromZero = _mm256_cmp_pd (_mm256_andnot_pd (signBit, _mm256_sub_pd (scaled, truncated)), half, _CMP_GE_OQ);
+			const __m256d step = _mm256_and_pd (roundAwayFromZero, _mm256_or_pd (_mm256_and_pd (signBit, scaled), one));   // 0 or ±1
+			const __m256d rounded = _mm256_add_pd (truncated, step);
+			nclipped += __builtin_popcount ((unsigned) _mm256_movemask_pd (_mm256_cmp_pd (rounded, minimum, _CMP_LT_OQ)))
+					+ __builtin_popcount ((unsigned) _mm256_movemask_pd (_mm256_cmp_pd (rounded, maximum, _CMP_GT_OQ)));
+			const __m256d clipped = _mm256_min_pd (maximum, _mm256_max_pd (minimum, rounded));   // a NaN is the second operand, and survives
+			alignas (16) int32 values [4];
+			_mm_store_si128 ((__m128i *) values, _mm256_cvttpd_epi32 (clipped));
+			for (int i = 0; i < 4; i ++) {
+				uint8 *sample = bytes + (isamp + i) * frameSize;
+				sample [0] = (uint8) values [i];
+				sample [1] = (uint8) (values [i] >> 8);
+			}
+		}
+		return nclipped + encodeLinearPcm <2, false> (in + isamp, 1, numberOfSamples - isamp, bytes + isamp * frameSize, frameSize);
+	}
+#endif
+
+static PcmEncoder chooseEncoder (int encoding, integer inStride) {
+	switch (encoding) {
+		case Melder_LINEAR_8_SIGNED: return encodeLinearPcm <1, true>;
+		case Melder_LINEAR_8_UNSIGNED: return encodeLinear8Unsigned;
+		case Melder_LINEAR_16_BIG_ENDIAN: return encodeLinearPcm <2, true>;
+		case Melder_LINEAR_16_LITTLE_ENDIAN: {
+			#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+				static const bool processorHasAvx2 = __builtin_cpu_supports ("avx2");
+				if (processorHasAvx2 && inStride == 1)
+					return encodeLinear16LittleEndian_avx2;
+			#else
+				(void) inStride;
+			#endif
+			return encodeLinearPcm <2, false>;
+		}
+		case Melder_LINEAR_24_BIG_ENDIAN: return encodeLinearPcm <3, true>;
+		case Melder_LINEAR_24_LITTLE_ENDIAN: return encodeLinearPcm <3, false>;
+		case Melder_LINEAR_32_BIG_ENDIAN: return encodeLinearPcm <4, true>;
+		case Melder_LINEAR_32_LITTLE_ENDIAN: return encodeLinearPcm <4, false>;
+		default: Melder_fatal (U"chooseEncoder: unknown encoding ", encoding, U".");
+	}
+}
+
+static integer writeBlocksOfBytes (FILE *f, int encoding, constMATVU const& buffer) {
+	const integer numberOfChannels = buffer.nrow, numberOfSamples = buffer.ncol;
+	const integer numberOfBytesPerSample = Melder_bytesPerSamplePoint (encoding);
+	const integer frameSize = numberOfChannels * numberOfBytesPerSample;
+	const integer numberOfFramesPerBlock = std::max (PCM_BLOCK_NUMBER_OF_BYTES / frameSize, 1_integer);
+	autovector <uint8> bytes = newvectorraw <uint8> (std::min (numberOfFramesPerBlock, numberOfSamples) * frameSize);
+	const PcmEncoder encode = chooseEncoder (encoding, buffer.colStride);
+	integer nclipped = 0;
+	for (integer firstSample = 1; firstSample <= numberOfSamples; firstSample += numberOfFramesPerBlock) {
+		const integer numberOfFrames = std::min (numberOfFramesPerBlock, numberOfSamples - firstSample + 1);
+		for (integer ichan = 1; ichan <= numberOfChannels; ichan ++)
+			nclipped += encode (& buffer [ichan] [firstSample], buffer.colStride, numberOfFrames,
+					bytes.cells + (ichan - 1) * numberOfBytesPerSample, frameSize);
+		const size_t numberOfBytes = (size_t) (numberOfFrames * frameSize);
+		if (fwrite (bytes.cells, 1, numberOfBytes, f) != numberOfBytes)
+			Melder_throw (U"Error in file while trying to write ", numberOfFrames, U" sample frames.");
+	}
+	return nclipped;
+}
+
+static integer encodeFlac (FLAC__StreamEncoder *encoder, constMATVU const& buffer) {
+	const integer numberOfChannels = buffer.nrow, numberOfSamples = buffer.ncol;
+	const integer numberOfFramesPerBlock = std::max (PCM_BLOCK_NUMBER_OF_BYTES / (numberOfChannels * (integer) sizeof (FLAC__int32)), 1_integer);
+	autovector <FLAC__int32> samples = newvectorraw <FLAC__int32> (std::min (numberOfFramesPerBlock, numberOfSamples) * numberOfChannels);
+	integer nclipped = 0;
+	for (integer firstSample = 1; firstSample <= numberOfSamples; firstSample += numberOfFramesPerBlock) {
+		const integer numberOfFrames = std::min (numberOfFramesPerBlock, numberOfSamples - firstSample + 1);
+		for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+			constVECVU const channel = buffer.row (ichan).part (firstSample, firstSample + numberOfFrames - 1);
+			for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
+				/* mutable clip */ double value = round (channel [iframe] * 32768.0);
+				if (value < -32768.0) { value = -32768.0; nclipped ++; }
+				if (value > 32767.0) { value = 32767.0; nclipped ++; }
+				samples [(iframe - 1) * numberOfChannels + ichan] = (FLAC__int32) value;
+			}
+		}
+		if (! FLAC__stream_encoder_process_interleaved (encoder, samples.cells, (uint32) numberOfFrames))
+			Melder_throw (U"Error encoding FLAC stream.");
+	}
+	return nclipped;
+}
+
+/*
+	Returns the number of clipped samples.
+*/
+static integer writeFloatToAudio (MelderFile file, constMATVU const& buffer, int encoding) {
+	FILE *f = file -> filePointer;
+	if (! f)
+		Melder_throw (U"File ", MelderFile_messageName (file), U" is not open.");
+	const integer numberOfSamples = buffer.ncol, numberOfChannels = buffer.nrow;
+	switch (encoding) {
+		case Melder_LINEAR_8_SIGNED:
+		case Melder_LINEAR_8_UNSIGNED:
+		case Melder_LINEAR_16_BIG_ENDIAN:
+		case Melder_LINEAR_16_LITTLE_ENDIAN:
+		case Melder_LINEAR_24_BIG_ENDIAN:
+		case Melder_LINEAR_24_LITTLE_ENDIAN:
+		case Melder_LINEAR_32_BIG_ENDIAN:
+		case Melder_LINEAR_32_LITTLE_ENDIAN:
+			return writeBlocksOfBytes (f, encoding, buffer);
+		case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
+			for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
+				for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+					const double value = buffer [ichan] [isamp];
+					binputr32 (value, f);
+				}
+			break;
+		case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN:
+			for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
+				for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+					const double value = buffer [ichan] [isamp];
+					binputr32LE (value, f);
+				}
+			break;
+		case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
+			for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
+				for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+					const double value = buffer [ichan] [isamp];
+					binputr64 (value, f);
+				}
+			break;
+		case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN:
+			for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
+				for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
+					const double value = buffer [ichan] [isamp];
+					binputr64LE (value, f);
+				}
+			break;
+		case Melder_FLAC_COMPRESSION_16:
+		case Melder_FLAC_COMPRESSION_24:
+		case Melder_FLAC_COMPRESSION_32:
+			if (! file -> flacEncoder)
+				Melder_throw (U"FLAC encoder not initialized.");
+			return encodeFlac (file -> flacEncoder, buffer);
+		case Melder_MULAW:
+		case Melder_ALAW:
+		default:
+			Melder_throw (U"Unknown format.");
+	}
+	return 0;
+}
+
+static void warning_samplesClipped (MelderFile file, integer numberOfClippedSamples, integer numberOfSamples) {
+	Melder_warning (U"Writing samples to audio file ", MelderFile_messageName (file), U": ",
+		numberOfClippedSamples, U" out of ", numberOfSamples, U" samples have been clipped.\n"
+		U"Advice: you could scale the amplitudes or write to a binary file."
+	);
+}
+
 void MelderFile_writeFloatToAudio (MelderFile file, constMATVU const& buffer, int encoding, bool warnIfClipped) {
 	try {
-		FILE *f = file -> filePointer;
-		if (! f)
-			Melder_throw (U"File ", MelderFile_messageName (file), U" is not open.");
-		const integer numberOfSamples = buffer.ncol, numberOfChannels = buffer.nrow;
-		integer nclipped = 0;
-		switch (encoding) {
-			case Melder_LINEAR_8_SIGNED:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 128.0);
-						if (value < -128.0) { value = -128.0; nclipped ++; }
-						if (value > 127.0) { value = 127.0; nclipped ++; }
-						binputi8 ((int) value, f);
-					}
-				break;
-			case Melder_LINEAR_8_UNSIGNED:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = floor ((buffer [ichan] [isamp] + 1.0) * 128.0);
-						if (value < 0.0) { value = 0.0; nclipped ++; }
-						if (value > 255.0) { value = 255.0; nclipped ++; }
-						binputu8 ((int) value, f);
-					}
-				break;
-			case Melder_LINEAR_16_BIG_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 32768.0);
-						if (value < -32768.0) { value = -32768.0; nclipped ++; }
-						if (value > 32767.0) { value = 32767.0; nclipped ++; }
-						binputi16 ((int16) value, f);
-					}
-				break;
-			case Melder_LINEAR_16_LITTLE_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 32768.0);
-						if (value < -32768.0) { value = -32768.0; nclipped ++; }
-						if (value > 32767.0) { value = 32767.0; nclipped ++; }
-						binputi16LE ((int16) value, f);
-					}
-				break;
-			case Melder_LINEAR_24_BIG_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 8388608.0);
-						if (value < -8388608.0) { value = -8388608.0; nclipped ++; }
-						if (value > 8388607.0) { value = 8388607.0; nclipped ++; }
-						binputi24 ((int32) value, f);
-					}
-				break;
-			case Melder_LINEAR_24_LITTLE_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 8388608.0);
-						if (value < -8388608.0) { value = -8388608.0; nclipped ++; }
-						if (value > 8388607.0) { value = 8388607.0; nclipped ++; }
-						binputi24LE ((int32) value, f);
-					}
-				break;
-			case Melder_LINEAR_32_BIG_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 2147483648.0);
-						if (value < -2147483648.0) { value = -2147483648.0; nclipped ++; }
-						if (value > 2147483647.0) { value = 2147483647.0; nclipped ++; }
-						binputi32 ((int32) value, f);   // safe cast: rounding and range already handled
-					}
-				break;
-			case Melder_LINEAR_32_LITTLE_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 2147483648.0);
-						if (value < -2147483648.0) { value = -2147483648.0; nclipped ++; }
-						if (value > 2147483647.0) { value = 2147483647.0; nclipped ++; }
-						binputi32LE ((int32) value, f);
-					}
-				break;
-			case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						const double value = buffer [ichan] [isamp];
-						binputr32 (value, f);
-					}
-				break;
-			case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						const double value = buffer [ichan] [isamp];
-						binputr32LE (value, f);
-					}
-				break;
-			case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						const double value = buffer [ichan] [isamp];
-						binputr64 (value, f);
-					}
-				break;
-			case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN:
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++)
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						const double value = buffer [ichan] [isamp];
-						binputr64LE (value, f);
-					}
-				break;
-			case Melder_FLAC_COMPRESSION_16:
-			case Melder_FLAC_COMPRESSION_24:
-			case Melder_FLAC_COMPRESSION_32:
-				if (! file -> flacEncoder)
-					Melder_throw (U"FLAC encoder not initialized.");
-				for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
-					FLAC__int32 samples [FLAC__MAX_CHANNELS];
-					for (integer ichan = 1; ichan <= numberOfChannels; ichan ++) {
-						/* mutable clip */ double value = round (buffer [ichan] [isamp] * 32768.0);
-						if (value < -32768.0) { value = -32768.0; nclipped ++; }
-						if (value > 32767.0) { value = 32767.0; nclipped ++; }
-						samples [ichan - 1] = (FLAC__int32) value;
-					}
-					if (! FLAC__stream_encoder_process_interleaved (file -> flacEncoder, samples, 1))
-						Melder_throw (U"Error encoding FLAC stream.");
-				}
-				break;
-			case Melder_MULAW:
-			case Melder_ALAW:
-			default:
-				Melder_throw (U"Unknown format.");
-		}
+		const integer nclipped = writeFloatToAudio (file, buffer, encoding);
 		if (nclipped > 0 && warnIfClipped)
-			Melder_warning (U"Writing samples to audio file ", MelderFile_messageName (file), U": ",
-				nclipped, U" out of ", numberOfSamples, U" samples have been clipped.\n"
-				U"Advice: you could scale the amplitudes or write to a binary file."
-			);
+			warning_samplesClipped (file, nclipped, buffer.ncol);
 	} catch (MelderError) {
 		Melder_throw (U"Samples not written to audio file.");
 	}
 }
 
+#pragma mark - STREAMING AUDIO FILE WRITER
+
+constexpr size_t MelderAudioFileWriter_MAXIMUM_NUMBER_OF_WAITING_BLOCKS = 4;
+constexpr integer MelderAudioFileWriter_MAXIMUM_NUMBER_OF_FRAMES_PER_BLOCK = 65536;
+
+struct structMelderAudioFileWriter {
+	MelderFile file;
+	autoMelderFile mfile;
+	int audioFileType = 0, numberOfBitsPerSamplePoint = 0, encoding = 0;
+	integer sampleRate = 0, numberOfSamples = 0, numberOfChannels = 0;
+	integer numberOfSamplesReceived = 0;   // only accessed by the calling thread
+	std::thread thread;
+	/*
+		Shared between the calling thread and the background thread.
+	*/
+	std::mutex mutex;
+	std::condition_variable queueHasChanged;
+	std::deque <autoMAT> waitingBlocks;
+	bool noMoreBlocks = false, failed = false;
+	autostring32 errorMessage;
+	integer numberOfClippedSamples = 0;
+
+	structMelderAudioFileWriter (MelderFile fileToCreate) : file (fileToCreate), mfile (MelderFile_create (fileToCreate)) { }
+	void writeWaitingBlocks () {
+		for (;;) {
+			autoMAT block;
+			{// scope
+				std::unique_lock <std::mutex> lock (our mutex);
+				our queueHasChanged.wait (lock, [this] { return ! our waitingBlocks.empty () || our noMoreBlocks; });
+				if (our waitingBlocks.empty ())
+					return;
+				block = std::move (our waitingBlocks.front ());
+				our waitingBlocks.pop_front ();
+			}
+			our queueHasChanged.notify_all ();   // there is room for another block
+			try {
+				const integer nclipped = writeFloatToAudio (our file, block.get(), our encoding);
+				std::lock_guard <std::mutex> lock (our mutex);
+				our numberOfClippedSamples += nclipped;
+			} catch (MelderError) {
+				{// scope
+					std::lock_guard <std::mutex> lock (our mutex);
+					our errorMessage = Melder_dup (Melder_getError ());
+					our failed = true;
+				}
+				Melder_clearError ();
+				our queueHasChanged.notify_all ();   // a waiting caller should not wait forever
+				return;
+			}
+		}
+	}
+	void stop () {
+		if (! our thread.joinable ())
+			return;
+		{// scope
+			std::lock_guard <std::mutex> lock (our mutex);
+			our noMoreBlocks = true;
+		}
+		our queueHasChanged.notify_all ();
+		our thread.join ();
+	}
+	void throwIfFailed () {
+		std::lock_guard <std::mutex> lock (our mutex);
+		if (our failed)
+			Melder_throw (our errorMessage.get());
+	}
+	~structMelderAudioFileWriter () {
+		{// scope
+			std::lock_guard <std::mutex> lock (our mutex);
+			our waitingBlocks.clear ();
+		}
+		our stop ();
+	}
+};
+
+autoMelderAudioFileWriter :: autoMelderAudioFileWriter (MelderFile file, int audioFileType, integer sampleRate, integer numberOfSamples,
+	integer numberOfChannels, int numberOfBitsPerSamplePoint)
+{
+	_writer = std::make_unique <structMelderAudioFileWriter> (file);
+	_writer -> audioFileType = audioFileType;
+	_writer -> numberOfBitsPerSamplePoint = numberOfBitsPerSamplePoint;
+	_writer -> encoding = Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint);
+	_writer -> sampleRate = sampleRate;
+	_writer -> numberOfSamples = numberOfSamples;
+	_writer -> numberOfChannels = numberOfChannels;
+	MelderFile_writeAudioFileHeader (file, audioFileType, sampleRate, numberOfSamples, numberOfChannels, numberOfBitsPerSamplePoint);
+	structMelderAudioFileWriter *writer = _writer.get();
+	_writer -> thread = std::thread ([writer] { writer -> writeWaitingBlocks (); });
+}
+
+autoMelderAudioFileWriter :: ~ autoMelderAudioFileWriter () = default;   // stops the background thread; the file is then closed without a trailer
+
+void autoMelderAudioFileWriter :: write (constMATVU const& block) {
+	structMelderAudioFileWriter *me = _writer.get();
+	Melder_assert (me);
+	Melder_require (block.nrow == my numberOfChannels,
+		U"The block should have ", my numberOfChannels, U" channels, not ", block.nrow, U".");
+	Melder_require (my numberOfSamplesReceived + block.ncol <= my numberOfSamples,
+		U"Cannot write more than the announced ", my numberOfSamples, U" samples to audio file ", MelderFile_messageName (my file), U".");
+	/*
+		A large block is queued in parts, so that the copies stay small.
+	*/
+	for (integer firstSample = 1; firstSample <= block.ncol; firstSample += MelderAudioFileWriter_MAXIMUM_NUMBER_OF_FRAMES_PER_BLOCK) {
+		const integer lastSample = std::min (firstSample + MelderAudioFileWriter_MAXIMUM_NUMBER_OF_FRAMES_PER_BLOCK - 1, block.ncol);
+		autoMAT copy = copy_MAT (block.part (1, block.nrow, firstSample, lastSample));   // the caller can reuse its block immediately
+		{// scope
+			std::unique_lock <std::mutex> lock (my mutex);
+			my queueHasChanged.wait (lock, [me] {
+				return my waitingBlocks.size () < MelderAudioFileWriter_MAXIMUM_NUMBER_OF_WAITING_BLOCKS || my failed;
+			});
+			if (! my failed)
+				my waitingBlocks.push_back (std::move (copy));
+		}
+		my throwIfFailed ();
+		my numberOfSamplesReceived += lastSample - firstSample + 1;
+		my queueHasChanged.notify_all ();
+	}
+}
+
+void autoMelderAudioFileWriter :: close () {
+	structMelderAudioFileWriter *me = _writer.get();
+	Melder_assert (me);
+	my stop ();
+	my throwIfFailed ();
+	Melder_require (my numberOfSamplesReceived == my numberOfSamples,
+		U"Only ", my numberOfSamplesReceived, U" of the announced ", my numberOfSamples,
+		U" samples have been written to audio file ", MelderFile_messageName (my file), U".");
+	MelderFile_writeAudioFileTrailer (my file, my audioFileType, my sampleRate, my numberOfSamples, my numberOfChannels, my numberOfBitsPerSamplePoint);
+	my mfile.close ();
+	if (my numberOfClippedSamples > 0)
+		warning_samplesClipped (my file, my numberOfClippedSamples, my numberOfSamples);
+	_writer.reset ();
+}
+
 void Melder_audiofiles_init () {
 	#ifdef _WIN32
 		flac_set_utf8_filenames (true);
@@ -2,7 +2,7 @@
 #define _melder_audiofiles_h_
 /* melder_audiofiles.h
  *
- * Copyright (C) 1992-2019,2024 Paul Boersma
+ * Copyright (C) 1992-2019,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -75,6 +75,33 @@ void Melder_readAudioToShort (MelderFile file, integer numberOfChannels, int enc
 void MelderFile_writeFloatToAudio (MelderFile file, constMATVU const& buffer, int encoding, bool warnIfClipped);
 void MelderFile_writeShortToAudio (MelderFile file, integer numberOfChannels, int encoding, const short *buffer, integer numberOfSamples);
 
+/*
+	Writing a long sound to an audio file block by block, e.g. while the sound is being computed.
+	The constructor creates the file and writes the header, so the total number of samples has to be known in advance.
+	`write` copies a block (one row per channel; a large block in parts) into a queue, from which a background thread
+	converts, clips (or FLAC-encodes) and writes it; if the queue already contains a few blocks,
+	`write` waits, so that memory use does not grow with the length of the sound.
+	An error on the background thread is thrown by the next `write` or by `close`.
+	`close` waits for the background thread, writes the trailer, closes the file,
+	and warns (on the calling thread) if any samples have been clipped.
+	Destroying the writer without calling `close` (e.g. after an exception) closes the file without a trailer.
+*/
+struct structMelderAudioFileWriter;
+class autoMelderAudioFileWriter {
+	std::unique_ptr <structMelderAudioFileWriter> _writer;
+public:
+	autoMelderAudioFileWriter (MelderFile file, int audioFileType, integer sampleRate, integer numberOfSamples,
+		integer numberOfChannels, int numberOfBitsPerSamplePoint);
+	~autoMelderAudioFileWriter ();
+	void write (constMATVU const& block);
+	void close ();
+	/*
+		Disable copying.
+	*/
+	autoMelderAudioFileWriter (const autoMelderAudioFileWriter&) = delete;   // disable copy constructor
+	autoMelderAudioFileWriter& operator= (const autoMelderAudioFileWriter&) = delete;   // disable copy assignment
+};
+
 void Melder_audiofiles_init ();
 
 /* End of file melder_audiofiles.h */
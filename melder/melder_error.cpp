@@ -1,6 +1,6 @@
 /* melder_error.cpp
  *
- * Copyright (C) 1992-2024 Paul Boersma
+ * Copyright (C) 1992-2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -40,7 +40,7 @@ void Melder_setCrashProc (void (*p_crashProc) (conststring32)) {
 }
 
 constexpr integer BUFFER_LENGTH = 2000;
-static char32 theErrorBuffer [BUFFER_LENGTH];   // safe in low-memory situations
+static thread_local char32 theErrorBuffer [BUFFER_LENGTH];   // safe in low-memory situations; every thread has its own error message
 
 void MelderError::_append (conststring32 message) {
 	if (! message)
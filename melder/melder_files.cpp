@@ -1,6 +1,6 @@
 /* melder_files.cpp
  *
- * Copyright (C) 1992-2008,2010-2025 Paul Boersma, 2013 Tom Naughton
+ * Copyright (C) 1992-2008,2010-2026 Paul Boersma, 2013 Tom Naughton
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -633,7 +633,12 @@ FILE * Melder_fopen (MelderFile file, const char *type) {
 	} else {
 		//TRACE
 		#if defined (_WIN32) && ! defined (__CYGWIN__)
-			f = _wfopen (MelderFile_peekPathW (file), Melder_peek32toW (Melder_peek8to32 (type)));
+			wchar_t typeW [10];   // not Melder_peek32toW, whose static buffers are not thread-safe
+			integer ikar = 0;
+			for (; type [ikar] != '\0' && ikar < 9; ikar ++)
+				typeW [ikar] = (wchar_t) type [ikar];   // the type is ASCII
+			typeW [ikar] = L'\0';
+			f = _wfopen (MelderFile_peekPathW (file), typeW);
 		#else
 			struct stat statbuf;
 			int status = stat ((char *) utf8path, & statbuf);
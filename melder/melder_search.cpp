@@ -1,6 +1,6 @@
 /* melder_search.cpp
  *
- * Copyright (C) 1992-2018,2020-2022 Paul Boersma
+ * Copyright (C) 1992-2018,2020-2022,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -63,6 +63,124 @@ inline static char32 * str32str_word_optionallyCaseSensitive (conststring32 stri
 	return nullptr;   // can never occur
 }
 
+/*
+	A query over all the intervals of a large tier calls Melder_stringMatchesCriterion ()
+	with the same regular expression many times in a row. Compiled regular expressions are therefore kept
+	for reuse, together with a literal text that every match has to contain (e.g. "ing" for "^[a-z]+ing$"):
+	a value that does not contain that literal text cannot match, and finding that out
+	is much faster than running the matcher.
+*/
+
+static autostring32 getRequiredLiteral (conststring32 pattern) {
+	/*
+		The longest run of ordinary characters outside parentheses and brackets,
+		without a quantifier after its last character.
+		Anything that we are not sure about gives an empty result.
+	*/
+	conststring32 longestRunStart = pattern;
+	integer longestRunLength = 0;
+	conststring32 runStart = nullptr;
+	integer depth = 0;
+	auto endRun = [&] (conststring32 runEnd) {
+		if (runStart && runEnd - runStart > longestRunLength) {
+			longestRunStart = runStart;
+			longestRunLength = runEnd - runStart;
+		}
+		runStart = nullptr;
+	};
+	for (const char32 *p = pattern; *p != U'\0'; ) {
+		const char32 kar = *p;
+		if (kar == U'\\') {
+			endRun (p);
+			const char32 escaped = p [1];
+			if (escaped == U'\0' || Melder_isAsciiDecimalNumber (escaped) || escaped == U'x' || escaped == U'X' || escaped == U'u' || escaped == U'U')
+				return Melder_dup (U"");   // numeric escapes and back references can be longer than two characters
+			p += 2;
+		} else if (kar == U'[') {
+			endRun (p);
+			p ++;
+			if (*p == U'^')
+				p ++;
+			if (*p == U']')
+				p ++;   // a literal ']'
+			while (*p != U']') {
+				if (*p == U'\0')
+					return Melder_dup (U"");
+				if (*p == U'\\' && p [1] != U'\0')
+					p ++;
+				p ++;
+			}
+			p ++;
+		} else if (kar == U'*' || kar == U'+' || kar == U'?') {
+			endRun (p - ( runStart ? 1 : 0 ));   // the quantified character is optional or repeated
+			p ++;
+		} else if (kar == U'{') {   // a counting quantifier, such as {2,3}
+			endRun (p - ( runStart ? 1 : 0 ));
+			while (*p != U'}') {
+				if (*p == U'\0')
+					return Melder_dup (U"");
+				p ++;
+			}
+			p ++;
+		} else if (kar == U'(') {
+			endRun (p);
+			depth ++;
+			p ++;
+		} else if (kar == U')') {
+			endRun (p);
+			depth --;
+			p ++;
+		} else if (kar == U'|') {
+			if (depth == 0)
+				return Melder_dup (U"");   // top-level alternatives
+			p ++;
+		} else if (kar == U'.' || kar == U'^' || kar == U'$' || kar == U'<' || kar == U'>') {
+			endRun (p);
+			p ++;
+		} else {
+			if (depth == 0 && ! runStart)
+				runStart = p;
+			p ++;
+		}
+	}
+	endRun (pattern + Melder_length (pattern));
+	autostring32 result (longestRunLength);
+	str32ncpy (result.get(), longestRunStart, longestRunLength);
+	result [longestRunLength] = U'\0';
+	return result;
+}
+
+struct CachedRegularExpression {
+	autostring32 pattern;
+	regexp *compiledPattern = nullptr;
+	autostring32 requiredLiteral;
+	~ CachedRegularExpression () {
+		if (compiledPattern)
+			free (compiledPattern);
+	}
+};
+constexpr integer theNumberOfCachedRegularExpressions = 8;
+static thread_local CachedRegularExpression theCachedRegularExpressions [theNumberOfCachedRegularExpressions];
+static thread_local integer theOldestCachedRegularExpression = 0;   // the next one to be replaced
+
+static CachedRegularExpression *getCompiledRegularExpression (conststring32 pattern) {
+	for (integer i = 0; i < theNumberOfCachedRegularExpressions; i ++) {
+		CachedRegularExpression *cached = & theCachedRegularExpressions [i];
+		if (cached -> compiledPattern && str32equ (cached -> pattern.get(), pattern))
+			return cached;
+	}
+	regexp *compiledPattern = CompileRE_throwable (pattern, ! REDFLT_CASE_INSENSITIVE);
+	autostring32 patternCopy = Melder_dup (pattern), requiredLiteral = getRequiredLiteral (pattern);
+	CachedRegularExpression *cached = & theCachedRegularExpressions [theOldestCachedRegularExpression];
+	theOldestCachedRegularExpression = (theOldestCachedRegularExpression + 1) % theNumberOfCachedRegularExpressions;
+	if (cached -> compiledPattern)
+		free (cached -> compiledPattern);
+	cached -> compiledPattern = compiledPattern;
+	cached -> pattern = patternCopy.move();
+	cached -> requiredLiteral = requiredLiteral.move();
+	return cached;
+}
+
 bool Melder_stringMatchesCriterion (conststring32 value, kMelder_string which, conststring32 criterion, bool caseSensitive) {
 	if (! value)
 		value = U"";   // regard null strings as empty strings, as is usual in Praat
@@ -138,12 +256,11 @@ bool Melder_stringMatchesCriterion (conststring32 value, kMelder_string which, c
 		}
 		case kMelder_string::MATCH_REGEXP:
 		{
-			char32 *place = nullptr;
-			regexp *compiled_regexp = CompileRE_throwable (criterion, ! REDFLT_CASE_INSENSITIVE);
-			if (ExecRE (compiled_regexp, nullptr, value, nullptr, 0, U'\0', U'\0', nullptr, nullptr))
-				place = compiled_regexp -> startp [0];
-			free (compiled_regexp);
-			return !! place;
+			CachedRegularExpression *cached = getCompiledRegularExpression (criterion);
+			if (cached -> requiredLiteral [0] != U'\0' && ! str32str (value, cached -> requiredLiteral.get()))
+				return false;
+			return ExecRE (cached -> compiledPattern, nullptr, value, nullptr, 0, U'\0', U'\0', nullptr, nullptr) &&
+					cached -> compiledPattern -> startp [0];
 		}
 	}
 	//return false;   // should not occur
@@ -20,7 +20,7 @@
 
 /*** Typed I/O functions for vectors and matrices. ***/
 
-#define FUNCTION(T,storage)  \
+#define TEXT_FUNCTIONS(T,storage)  \
 	void vector_writeText_##storage (const constvector<T>& vec, MelderFile file, conststring32 name) { \
 		texputintro (file, name, U" []: ", vec.size >= 1 ? nullptr : U"(empty)", 0,0,0); \
 		for (integer i = 1; i <= vec.size; i ++) \
@@ -28,11 +28,6 @@
 		texexdent (file); \
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
-	void vector_writeBinary_##storage (const constvector<T>& vec, FILE *f) { \
-		for (integer i = 1; i <= vec.size; i ++) \
-			binput##storage (vec [i], f); \
-		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
-	} \
 	autovector<T> vector_readText_##storage (integer size, MelderReadText text, const char *name) { \
 		autovector<T> result = newvectorzero<T> (size); \
 		for (integer i = 1; i <= size; i ++) { \
@@ -44,13 +39,6 @@
 		} \
 		return result; \
 	} \
-	autovector<T> vector_readBinary_##storage (integer size, FILE *f) { \
-		autovector<T> result = newvectorzero<T> (size); \
-		for (integer i = 1; i <= size; i ++) { \
-			result [i] = binget##storage (f); \
-		} \
-		return result; \
-	} \
 	void matrix_writeText_##storage (const constmatrix<T>& mat, MelderFile file, conststring32 name) { \
 		texputintro (file, name, U" [] []: ", mat.nrow >= 1 ? nullptr : U"(empty)", 0,0,0); \
 		for (integer irow = 1; irow <= mat.nrow; irow ++) { \
@@ -63,13 +51,6 @@
 		texexdent (file); \
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
-	void matrix_writeBinary_##storage (const constmatrix<T>& mat, FILE *f) { \
-		for (integer irow = 1; irow <= mat.nrow; irow ++) { \
-			for (integer icol = 1; icol <= mat.ncol; icol ++) \
-				binput##storage (mat [irow] [icol], f); \
-		} \
-		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
-	} \
 	automatrix<T> matrix_readText_##storage (integer nrow, integer ncol, MelderReadText text, const char *name) { \
 		automatrix<T> result = newmatrixzero<T> (nrow, ncol); \
 		for (integer irow = 1; irow <= nrow; irow ++) for (integer icol = 1; icol <= ncol; icol ++) { \
@@ -81,12 +62,6 @@
 		} \
 		return result; \
 	} \
-	automatrix<T> matrix_readBinary_##storage (integer nrow, integer ncol, FILE *f) { \
-		automatrix<T> result = newmatrixzero<T> (nrow, ncol); \
-		for (integer irow = 1; irow <= nrow; irow ++) for (integer icol = 1; icol <= ncol; icol ++) \
-			result [irow] [icol] = binget##storage (f); \
-		return result; \
-	} \
 	void tensor3_writeText_##storage (const consttensor3<T>& ten3, MelderFile file, conststring32 name) { \
 		texputintro (file, name, U" [] [] []: ", ten3.ndim1 >= 1 && ten3.ndim2 >= 1 && ten3.ndim3 >= 1 ? nullptr : U"(empty)", 0,0,0); \
 		for (integer idim1 = 1; idim1 <= ten3.ndim1; idim1 ++) { \
@@ -102,16 +77,6 @@
 		texexdent (file); \
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
-	void tensor3_writeBinary_##storage (const consttensor3<T>& ten3, FILE *f) { \
-		for (integer idim1 = 1; idim1 <= ten3.ndim1; idim1 ++) { \
-			for (integer idim2 = 1; idim2 <= ten3.ndim2; idim2 ++) { \
-				for (integer idim3 = 1; idim3 <= ten3.ndim3; idim3 ++) { \
-					binput##storage (ten3 [idim1] [idim2] [idim3], f); \
-				} \
-			} \
-		} \
-		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
-	} \
 	autotensor3<T> tensor3_readText_##storage (integer ndim1, integer ndim2, integer ndim3, MelderReadText text, const char *name) { \
 		autotensor3<T> result = newtensor3zero<T> (ndim1, ndim2, ndim3); \
 		for (integer idim1 = 1; idim1 <= result.ndim1; idim1 ++) { \
@@ -126,6 +91,43 @@
 			} \
 		} \
 		return result; \
+	}
+
+#define ONE_BY_ONE_BINARY_FUNCTIONS(T,storage)  \
+	void vector_writeBinary_##storage (const constvector<T>& vec, FILE *f) { \
+		for (integer i = 1; i <= vec.size; i ++) \
+			binput##storage (vec [i], f); \
+		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
+	} \
+	autovector<T> vector_readBinary_##storage (integer size, FILE *f) { \
+		autovector<T> result = newvectorzero<T> (size); \
+		for (integer i = 1; i <= size; i ++) { \
+			result [i] = binget##storage (f); \
+		} \
+		return result; \
+	} \
+	void matrix_writeBinary_##storage (const constmatrix<T>& mat, FILE *f) { \
+		for (integer irow = 1; irow <= mat.nrow; irow ++) { \
+			for (integer icol = 1; icol <= mat.ncol; icol ++) \
+				binput##storage (mat [irow] [icol], f); \
+		} \
+		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
+	} \
+	automatrix<T> matrix_readBinary_##storage (integer nrow, integer ncol, FILE *f) { \
+		automatrix<T> result = newmatrixzero<T> (nrow, ncol); \
+		for (integer irow = 1; irow <= nrow; irow ++) for (integer icol = 1; icol <= ncol; icol ++) \
+			result [irow] [icol] = binget##storage (f); \
+		return result; \
+	} \
+	void tensor3_writeBinary_##storage (const consttensor3<T>& ten3, FILE *f) { \
+		for (integer idim1 = 1; idim1 <= ten3.ndim1; idim1 ++) { \
+			for (integer idim2 = 1; idim2 <= ten3.ndim2; idim2 ++) { \
+				for (integer idim3 = 1; idim3 <= ten3.ndim3; idim3 ++) { \
+					binput##storage (ten3 [idim1] [idim2] [idim3], f); \
+				} \
+			} \
+		} \
+		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
 	} \
 	autotensor3<T> tensor3_readBinary_##storage (integer ndim1, integer ndim2, integer ndim3, FILE *f) { \
 		autotensor3<T> result = newtensor3zero<T> (ndim1, ndim2, ndim3); \
@@ -139,6 +141,99 @@
 		return result; \
 	}
 
+/*
+	The storage formats that abcio can read and write in bulk,
+	which is much faster for large vectors and matrices.
+	Vectors, matrices and tensors are contiguous in memory, with the last index running fastest,
+	which is also the order in the file.
+*/
+/*
+	In native mode (see autoMelderNativeBinaryTensors in melder_tensorio.h),
+	the cells of a real or complex tensor are written as they are in memory,
+	starting at a file position that is a multiple of MelderTensor_NATIVE_ALIGNMENT,
+	so that they can be read back without conversion, or mapped into memory.
+*/
+static thread_local bool theNativeBinaryTensors = false;
+
+autoMelderNativeBinaryTensors :: autoMelderNativeBinaryTensors () : _wasOn (theNativeBinaryTensors) {
+	theNativeBinaryTensors = true;
+}
+
+autoMelderNativeBinaryTensors :: ~ autoMelderNativeBinaryTensors () {
+	theNativeBinaryTensors = _wasOn;
+}
+
+static integer numberOfBytesToAlignment (FILE *f) {
+	const off_t position = ftello (f);
+	if (position < 0)
+		Melder_throw (U"Cannot determine the position in the file.");
+	return (MelderTensor_NATIVE_ALIGNMENT - (integer) (position % MelderTensor_NATIVE_ALIGNMENT)) % MelderTensor_NATIVE_ALIGNMENT;
+}
+
+static void writeNative (const void *cells, integer numberOfBytes, FILE *f) {
+	static const char zeroes [MelderTensor_NATIVE_ALIGNMENT] = { 0 };
+	const integer numberOfPaddingBytes = numberOfBytesToAlignment (f);
+	if (numberOfPaddingBytes > 0)
+		fwrite (zeroes, 1, (size_t) numberOfPaddingBytes, f);
+	if (numberOfBytes > 0)
+		fwrite (cells, 1, (size_t) numberOfBytes, f);
+}
+
+static void readNative (FILE *f, void *cells, integer numberOfBytes) {
+	const integer numberOfPaddingBytes = numberOfBytesToAlignment (f);
+	if (numberOfPaddingBytes > 0)
+		fseeko (f, numberOfPaddingBytes, SEEK_CUR);
+	if (numberOfBytes > 0)
+		fread (cells, 1, (size_t) numberOfBytes, f);   // a short read shows up as feof() in Data_readBinary
+}
+
+#define BULK_BINARY_FUNCTIONS(T,storage)  \
+	static void write_##storage (const T *cells, integer n, FILE *f) { \
+		if (theNativeBinaryTensors) \
+			writeNative (cells, n * (integer) sizeof (T), f); \
+		else \
+			binput##storage (cells, n, f); \
+	} \
+	static void read_##storage (FILE *f, T *cells, integer n) { \
+		if (theNativeBinaryTensors) \
+			readNative (f, cells, n * (integer) sizeof (T)); \
+		else \
+			binget##storage (f, cells, n); \
+	} \
+	void vector_writeBinary_##storage (const constvector<T>& vec, FILE *f) { \
+		write_##storage (vec.cells, vec.size, f); \
+	} \
+	autovector<T> vector_readBinary_##storage (integer size, FILE *f) { \
+		autovector<T> result = newvectorraw<T> (size); \
+		read_##storage (f, result.cells, size); \
+		return result; \
+	} \
+	void matrix_writeBinary_##storage (const constmatrix<T>& mat, FILE *f) { \
+		write_##storage (mat.cells, mat.nrow * mat.ncol, f); \
+	} \
+	automatrix<T> matrix_readBinary_##storage (integer nrow, integer ncol, FILE *f) { \
+		automatrix<T> result = newmatrixraw<T> (nrow, ncol); \
+		read_##storage (f, result.cells, nrow * ncol); \
+		return result; \
+	} \
+	void tensor3_writeBinary_##storage (const consttensor3<T>& ten3, FILE *f) { \
+		Melder_assert (ten3.stride3 == 1 && ten3.stride2 == ten3.ndim3 && ten3.stride1 == ten3.ndim2 * ten3.ndim3); \
+		write_##storage (ten3.cells, ten3.ndim1 * ten3.ndim2 * ten3.ndim3, f); \
+	} \
+	autotensor3<T> tensor3_readBinary_##storage (integer ndim1, integer ndim2, integer ndim3, FILE *f) { \
+		autotensor3<T> result = newtensor3raw<T> (ndim1, ndim2, ndim3); \
+		read_##storage (f, result.cells, ndim1 * ndim2 * ndim3); \
+		return result; \
+	}
+
+#define FUNCTION(T,storage)  \
+	TEXT_FUNCTIONS (T, storage) \
+	ONE_BY_ONE_BINARY_FUNCTIONS (T, storage)
+
+#define BULK_FUNCTION(T,storage)  \
+	TEXT_FUNCTIONS (T, storage) \
+	BULK_BINARY_FUNCTIONS (T, storage)
+
 FUNCTION (signed char, i8)
 FUNCTION (int, i16)
 FUNCTION (long, i32)
@@ -147,11 +242,12 @@ FUNCTION (integer, integer16BE)
 FUNCTION (unsigned char, u8)
 FUNCTION (unsigned int, u16)
 FUNCTION (unsigned long, u32)
-FUNCTION (double, r32)
-FUNCTION (double, r64)
+BULK_FUNCTION (double, r32)
+BULK_FUNCTION (double, r64)
 FUNCTION (dcomplex, c64)
-FUNCTION (dcomplex, c128)
+BULK_FUNCTION (dcomplex, c128)
 FUNCTION (bool, eb)
 #undef FUNCTION
+#undef BULK_FUNCTION
 
 /* End of file melder_tensorio.cpp */
@@ -2,7 +2,7 @@
 #define _melder_tensorio_h_
 /* melder_tensorio.h
  *
- * Copyright (C) 1992-2020 Paul Boersma
+ * Copyright (C) 1992-2020,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -77,5 +77,23 @@ automatrix <double> matrix_readBinary_r64 (integer nrow, integer ncol, FILE *f);
 	Throw an error message if anything went wrong.
 */
 
+/*
+	Native binary tensors, for the "ooFastBinaryFile" format (see Data_writeToFastBinaryFile).
+	While an autoMelderNativeBinaryTensors object exists, the binary writers and readers of r32, r64 and c128
+	vectors, matrices and tensor3s in the current thread use the native byte order and the in-memory layout
+	(doubles or complex doubles), with the first cell at a file position that is a multiple of MelderTensor_NATIVE_ALIGNMENT;
+	all other binary writers and readers are unaffected.
+*/
+constexpr integer MelderTensor_NATIVE_ALIGNMENT = 64;
+
+class autoMelderNativeBinaryTensors {
+	bool _wasOn;
+public:
+	autoMelderNativeBinaryTensors ();
+	~ autoMelderNativeBinaryTensors ();
+	autoMelderNativeBinaryTensors (const autoMelderNativeBinaryTensors&) = delete;
+	autoMelderNativeBinaryTensors& operator= (const autoMelderNativeBinaryTensors&) = delete;
+};
+
 /* End of file melder_tensorio.h */
 #endif
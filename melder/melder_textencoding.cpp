@@ -1,6 +1,6 @@
 /* melder_textencoding.cpp
  *
- * Copyright (C) 2007-2025 Paul Boersma
+ * Copyright (C) 2007-2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -591,9 +591,28 @@ autostringW Melder_32toW (conststring32 text) {
 	return result;
 }
 conststringW Melder_peek32toW_fileSystem (conststring32 string) {
-	static wchar_t buffer [1 + kMelder_MAXPATH];
-	NormalizeString (NormalizationC, Melder_peek32toW (string), -1, buffer, 1 + kMelder_MAXPATH);
-	//FoldStringW (MAP_PRECOMPOSED, Melder_peek32toW (string), -1, buffer, 1 + kMelder_MAXPATH);   // this works even on Windows XP
+	/*
+		Thread-local and without Melder_peek32toW, because files can be opened from several threads at a time
+		(e.g. in SoundSet_readFromSoundFiles).
+	*/
+	static thread_local wchar_t stringW [1 + 2 * kMelder_MAXPATH];   // room for a surrogate pair per character
+	static thread_local wchar_t buffer [1 + kMelder_MAXPATH];
+	integer n_utf16 = 0;
+	for (const char32 *p = string; *p != U'\0' && n_utf16 < 2 * kMelder_MAXPATH - 1; p ++) {
+		char32 kar = *p;
+		if (kar <= 0x00'FFFF) {
+			stringW [n_utf16 ++] = (wchar_t) kar;   // guarded truncation
+		} else if (kar <= 0x10'FFFF) {
+			kar -= 0x01'0000;
+			stringW [n_utf16 ++] = (wchar_t) (0x00'D800 | (kar >> 10));
+			stringW [n_utf16 ++] = (wchar_t) (0x00'DC00 | (kar & 0x00'03FF));
+		} else {
+			stringW [n_utf16 ++] = UNICODE_REPLACEMENT_CHARACTER;
+		}
+	}
+	stringW [n_utf16] = L'\0';
+	NormalizeString (NormalizationC, stringW, -1, buffer, 1 + kMelder_MAXPATH);
+	//FoldStringW (MAP_PRECOMPOSED, stringW, -1, buffer, 1 + kMelder_MAXPATH);   // this works even on Windows XP
 	return buffer;
 }
 autostringW Melder_32toW_fileSystem (conststring32 text) {
@@ -641,7 +660,7 @@ void Melder_32to8_fileSystem_inplace (conststring32 string, char *utf8) {
 	#endif
 }
 conststring8 Melder_peek32to8_fileSystem (conststring32 string) {
-	static char buffer [1 + kMelder_MAXPATH];
+	static thread_local char buffer [1 + kMelder_MAXPATH];   // thread-local, because files can be opened from several threads at a time
 	Melder_32to8_fileSystem_inplace (string, buffer);
 	return buffer;
 }
@@ -0,0 +1,93 @@
+#ifndef _melder_thread_h_
+#define _melder_thread_h_
+/* melder_thread.h
+ *
+ * Copyright (C) 2014-2018,2020,2026 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <mutex>
+#include <exception>
+#include <thread>
+
+inline integer MelderThread_getNumberOfProcessors () {
+	return uinteger_to_integer (std::thread::hardware_concurrency ());
+}
+
+/*
+	Calls `func (ithread)` for ithread = 1 .. numberOfThreads, each on its own thread;
+	the last one runs on the calling thread.
+	If a thread cannot be created, its part is done on the calling thread instead.
+	All threads have been joined when this function returns, also if any part failed.
+	If any part throws a MelderError (or runs out of memory), the message of the first failing part is rethrown on the calling thread;
+	if the first failing part throws anything else, that exception itself is rethrown on the calling thread
+	(an exception that escapes from a std::thread would terminate the program).
+	A `func` that itself calls MelderThread_run should be given only its share of the processors,
+	otherwise the processors will be oversubscribed.
+*/
+template <typename Func> void MelderThread_run (integer numberOfThreads, Func const& func) {
+	if (numberOfThreads <= 1) {
+		func (1_integer);
+		return;
+	}
+	std::mutex errorMutex;
+	bool anyPartFailed = false;
+	autostring32 firstError;
+	std::exception_ptr firstOtherException;
+	auto runPart = [&] (integer ithread) {
+		try {
+			func (ithread);
+		} catch (MelderError) {
+			std::lock_guard <std::mutex> lock (errorMutex);
+			if (! anyPartFailed)
+				firstError = Melder_dup_f (Melder_getError ());
+			anyPartFailed = true;
+			Melder_clearError ();
+		} catch (std::bad_alloc&) {
+			std::lock_guard <std::mutex> lock (errorMutex);
+			anyPartFailed = true;
+		} catch (...) {
+			std::lock_guard <std::mutex> lock (errorMutex);
+			if (! anyPartFailed)
+				firstOtherException = std::current_exception ();
+			anyPartFailed = true;
+		}
+	};
+	std::vector <std::thread> threads;
+	integer numberOfStartedThreads = 0;
+	try {
+		threads. reserve (integer_to_uinteger (numberOfThreads - 1));
+		for (integer ithread = 1; ithread < numberOfThreads; ithread ++) {
+			threads. emplace_back (runPart, ithread);
+			numberOfStartedThreads = ithread;
+		}
+	} catch (...) {
+		// too many threads or too little memory: do the remaining parts here
+	}
+	for (integer ithread = numberOfStartedThreads + 1; ithread <= numberOfThreads; ithread ++)
+		runPart (ithread);
+	for (std::thread& thread : threads)
+		thread. join ();
+	if (anyPartFailed) {
+		if (firstOtherException)
+			std::rethrow_exception (firstOtherException);
+		Melder_appendError_noLine (firstError ? firstError.get() : U"Out of memory.");
+		throw MelderError ();
+	}
+}
+
+/* End of file melder_thread.h */
+#endif
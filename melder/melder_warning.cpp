@@ -1,6 +1,6 @@
 /* melder_warning.cpp
  *
- * Copyright (C) 1992-2012,2014-2016,2018,2020 Paul Boersma
+ * Copyright (C) 1992-2012,2014-2016,2018,2020,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -30,6 +30,8 @@ MelderWarning::Proc MelderWarning::_p_currentProc = & MelderWarning::_defaultPro
 
 MelderString MelderWarning::_buffer;
 
+thread_local MelderString *MelderWarning::_p_threadCollector = nullptr;
+
 void Melder_warningOff () { MelderWarning::_depth --; }
 void Melder_warningOn () { MelderWarning::_depth ++; }
 
@@ -2,7 +2,7 @@
 #define _melder_warning_h_
 /* melder_warning.h
  *
- * Copyright (C) 1992-2018 Paul Boersma
+ * Copyright (C) 1992-2018,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,11 +25,17 @@
 
 		Gives a warning to stderr (batch) or to a "Warning" dialog.
 		Use sparingly, because it interrupts the user's workflow.
+
+	autoMelderWarningCollector collector (& warnings);
+		Appends the warnings of the current thread to `warnings` (one line each) instead of showing them,
+		for as long as `collector` exists. Worker threads cannot show warnings,
+		but they can report them to the main thread this way.
 */
 
 namespace MelderWarning {
 	extern int _depth;
 	extern MelderString _buffer;
+	extern thread_local MelderString *_p_threadCollector;
 	using Proc = void (*) (conststring32 message);
 	void _defaultProc (conststring32 message);
 	extern Proc _p_currentProc;
@@ -40,6 +46,12 @@ void Melder_warning (const MelderArg& first, Args... rest);
 
 template <typename... Args>
 void Melder_warning (const MelderArg& first, Args... rest) {
+	if (MelderWarning::_p_threadCollector) {
+		if (MelderWarning::_p_threadCollector -> length > 0)
+			MelderString_appendCharacter (MelderWarning::_p_threadCollector, U'\n');
+		MelderString_append (MelderWarning::_p_threadCollector, first, rest...);
+		return;
+	}
 	if (MelderWarning::_depth < 0)
 		return;
 	MelderString_copy (& MelderWarning::_buffer, first, rest...);
@@ -55,6 +67,15 @@ public:
 	~autoMelderWarningOff () { Melder_warningOn (); }
 };
 
+class autoMelderWarningCollector {
+	MelderString *_p_previousCollector;
+public:
+	autoMelderWarningCollector (MelderString *collector) : _p_previousCollector (MelderWarning::_p_threadCollector) {
+		MelderWarning::_p_threadCollector = collector;
+	}
+	~autoMelderWarningCollector () { MelderWarning::_p_threadCollector = _p_previousCollector; }
+};
+
 void Melder_setWarningProc (MelderWarning::Proc p_proc);
 
 /* End of file melder_warning.h */
@@ -1,6 +1,6 @@
 /* Data.cpp
  *
- * Copyright (C) 1992-2018,2021,2022,2024 Paul Boersma
+ * Copyright (C) 1992-2018,2021,2022,2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -227,6 +227,10 @@ autoDaata Data_readFromBinaryFile (MelderFile file) {
 		*/
 		if (strstr (line, "ooBinary2File"))
 			Melder_throw (U"This Praat version cannot read this Praat file. Please download a newer version of Praat.");
+		if (n >= 16 && strnequ (line, "ooFastBinaryFile", 16)) {
+			f.close (file);
+			return Data_readFromFastBinaryFile (file);
+		}
 		char *end = strstr (line, "ooBinaryFile");
 		autoDaata me;
 		int formatVersion;
@@ -255,6 +259,204 @@ autoDaata Data_readFromBinaryFile (MelderFile file) {
 	}
 }
 
+/*
+	Fast binary files, version 1.
+	The header, the positions and sizes in the table of contents, and the real and complex tensors
+	are in the native byte order; the rest is as in ooBinary files.
+		header (48 bytes): "ooFastBinaryFile" (16 bytes, without a null byte), the byte order mark,
+			the version, whether the object is a Collection, the number of entries,
+			and the position of the table of contents
+		the entries, each as written by Data_writeBinary in native-tensor mode
+		the table of contents: for each entry its position, its size, its class name and its name
+*/
+static const char theFastBinaryFileType [] = "ooFastBinaryFile";
+static_assert (sizeof (theFastBinaryFileType) == 16 + 1);
+constexpr uint32 FAST_BINARY_BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32 FAST_BINARY_VERSION = 1;
+
+struct FastBinaryHeader {
+	char fileType [16];
+	uint32 byteOrderMark;
+	uint32 version;
+	int64 isCollection;
+	int64 numberOfEntries;
+	int64 tableOfContentsPosition;
+};
+static_assert (sizeof (FastBinaryHeader) == 48);
+
+static void writeNativeInt64 (int64 value, FILE *f) {
+	if (fwrite (& value, sizeof (int64), 1, f) != 1)
+		Melder_throw (U"Cannot write table of contents.");
+}
+
+static int64 readNativeInt64 (FILE *f) {
+	int64 value = 0;
+	if (fread (& value, sizeof (int64), 1, f) != 1)
+		Melder_throw (U"Early end of file.");
+	return value;
+}
+
+void Data_writeToFastBinaryFile (Daata me, MelderFile file) {
+	try {
+		const bool isCollection = ( my classInfo == classCollection );
+		Collection collection = ( isCollection ? static_cast <Collection> (me) : nullptr );
+		const integer numberOfEntries = ( isCollection ? collection -> size : 1 );
+		auto entry = [&] (integer ientry) -> Daata {
+			return isCollection ? (Daata) collection -> at [ientry] : me;
+		};
+		for (integer ientry = 1; ientry <= numberOfEntries; ientry ++) {
+			Daata thing = entry (ientry);
+			Melder_require (Thing_isa (thing, classDaata) && Data_canWriteBinary (thing),
+				U"Objects of class ", thing -> classInfo -> className, U" cannot be written to a fast binary file.");
+		}
+		autoMelderFile mfile = MelderFile_create (file);
+		FILE *f = file -> filePointer;
+		FastBinaryHeader header { };
+		memcpy (header.fileType, theFastBinaryFileType, sizeof (header.fileType));
+		header.byteOrderMark = FAST_BINARY_BYTE_ORDER_MARK;
+		header.version = FAST_BINARY_VERSION;
+		header.isCollection = isCollection;
+		header.numberOfEntries = numberOfEntries;
+		if (fwrite (& header, sizeof (FastBinaryHeader), 1, f) != 1)
+			Melder_throw (U"Cannot write header.");
+		autoINTVEC positions = raw_INTVEC (numberOfEntries), sizes = raw_INTVEC (numberOfEntries);
+		{// scope
+			autoMelderNativeBinaryTensors nativeTensors;
+			for (integer ientry = 1; ientry <= numberOfEntries; ientry ++) {
+				positions [ientry] = ftello (f);
+				Data_writeBinary (entry (ientry), f);
+				sizes [ientry] = ftello (f) - positions [ientry];
+			}
+		}
+		header.tableOfContentsPosition = ftello (f);
+		for (integer ientry = 1; ientry <= numberOfEntries; ientry ++) {
+			Daata thing = entry (ientry);
+			ClassInfo classInfo = thing -> classInfo;
+			writeNativeInt64 (positions [ientry], f);
+			writeNativeInt64 (sizes [ientry], f);
+			binputw8 (classInfo -> version > 0 ?
+				Melder_cat (classInfo -> className, U" ", classInfo -> version) : classInfo -> className, f);
+			binputw16 (thing -> name.get(), f);
+		}
+		fseeko (f, 0, SEEK_SET);
+		if (fwrite (& header, sizeof (FastBinaryHeader), 1, f) != 1)
+			Melder_throw (U"Cannot write header.");
+		mfile.close ();
+	} catch (MelderError) {
+		Melder_throw (me, U": not written to fast binary file ", file, U".");
+	}
+}
+
+static FastBinaryHeader readFastBinaryHeader (FILE *f) {
+	FastBinaryHeader header;
+	if (fread (& header, sizeof (FastBinaryHeader), 1, f) != 1 ||
+		memcmp (header.fileType, theFastBinaryFileType, sizeof (header.fileType)) != 0)
+		Melder_throw (U"Not a fast binary file.");
+	if (header.byteOrderMark != FAST_BINARY_BYTE_ORDER_MARK)
+		Melder_throw (U"This fast binary file was written on a computer with a different byte order. "
+			"Please save your objects as binary files instead.");
+	if (header.version > FAST_BINARY_VERSION)
+		Melder_throw (U"This Praat version cannot read this Praat file. Please download a newer version of Praat.");
+	Melder_require (header.numberOfEntries >= 1 && header.tableOfContentsPosition >= (int64) sizeof (FastBinaryHeader),
+		U"The header is damaged.");
+	return header;
+}
+
+/*
+	Reads the entry in the table of contents at the current position and leaves the file after that entry.
+*/
+static void readFastBinaryEntry (FILE *f, int64 *out_position, int64 *out_size, autostring8 *out_className, autostring32 *out_name) {
+	*out_position = readNativeInt64 (f);
+	*out_size = readNativeInt64 (f);
+	*out_className = bingets8 (f);
+	*out_name = bingetw16 (f);
+	if (feof (f) || ferror (f))
+		Melder_throw (U"The table of contents is damaged.");
+}
+
+static autoDaata readFastBinaryObject (FILE *f, int64 position, int64 size, conststring8 className) {
+	int formatVersion;
+	autoDaata thing = Thing_newFromClassName (Melder_peek8to32 (className), & formatVersion).static_cast_move <structDaata>();
+	Melder_require (Data_canReadBinary (thing.get()),
+		U"Objects of class ", Thing_className (thing.get()), U" cannot be read.");
+	fseeko (f, position, SEEK_SET);
+	{// scope
+		autoMelderNativeBinaryTensors nativeTensors;
+		Data_readBinary (thing.get(), f, formatVersion);
+	}
+	Melder_require (ftello (f) == position + size,
+		U"The object of class ", Thing_className (thing.get()), U" has a different size than stated in the table of contents.");
+	return thing;
+}
+
+autoDaata Data_readFromFastBinaryFile (MelderFile file) {
+	try {
+		autofile f = Melder_fopen (file, "rb");
+		const FastBinaryHeader header = readFastBinaryHeader (f);
+		MelderFile_getParentFolder (file, & Data_directoryBeingRead);
+		int64 entryPosition = header.tableOfContentsPosition;
+		autoDaata result;
+		autoCollection collection;
+		if (header.isCollection)
+			collection = Collection_create ();
+		for (integer ientry = 1; ientry <= header.numberOfEntries; ientry ++) {
+			int64 position, size;
+			autostring8 className;
+			autostring32 name;
+			fseeko (f, entryPosition, SEEK_SET);
+			readFastBinaryEntry (f, & position, & size, & className, & name);
+			entryPosition = ftello (f);
+			autoDaata thing = readFastBinaryObject (f, position, size, className.get());
+			if (header.isCollection) {
+				Thing_setName (thing.get(), name.get());
+				collection -> addItem_move (thing.move());
+			} else {
+				result = thing.move();
+			}
+		}
+		if (header.isCollection)
+			result = collection.move();
+		file -> format = structMelderFile :: Format :: binary;
+		f.close (file);
+		return result;
+	} catch (MelderError) {
+		Melder_throw (U"Data not read from fast binary file ", file, U".");
+	}
+}
+
+integer Data_getNumberOfItemsInFastBinaryFile (MelderFile file) {
+	try {
+		autofile f = Melder_fopen (file, "rb");
+		const FastBinaryHeader header = readFastBinaryHeader (f);
+		f.close (file);
+		return header.numberOfEntries;
+	} catch (MelderError) {
+		Melder_throw (U"Fast binary file ", file, U" not inspected.");
+	}
+}
+
+autoDaata Data_readItemFromFastBinaryFile (MelderFile file, integer itemNumber) {
+	try {
+		autofile f = Melder_fopen (file, "rb");
+		const FastBinaryHeader header = readFastBinaryHeader (f);
+		Melder_require (itemNumber >= 1 && itemNumber <= header.numberOfEntries,
+			U"The item number (", itemNumber, U") should be between 1 and ", header.numberOfEntries, U".");
+		MelderFile_getParentFolder (file, & Data_directoryBeingRead);
+		fseeko (f, header.tableOfContentsPosition, SEEK_SET);
+		int64 position, size;
+		autostring8 className;
+		autostring32 name;
+		for (integer ientry = 1; ientry <= itemNumber; ientry ++)
+			readFastBinaryEntry (f, & position, & size, & className, & name);
+		autoDaata thing = readFastBinaryObject (f, position, size, className.get());
+		Thing_setName (thing.get(), name.get());
+		f.close (file);
+		return thing;
+	} catch (MelderError) {
+		Melder_throw (U"Item ", itemNumber, U" not read from fast binary file ", file, U".");
+	}
+}
+
 static int defaultPublish (autoDaata /* me */) {
 	return 0;   // nothing published
 }
@@ -2,7 +2,7 @@
 #define _Data_h_
 /* Data.h
  *
- * Copyright (C) 1992-2009,2011,2012,2014-2019,2021-2024 Paul Boersma
+ * Copyright (C) 1992-2009,2011,2012,2014-2019,2021-2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -261,6 +261,46 @@ autoDaata Data_readFromBinaryFile (MelderFile file);
 		(plus those from Data_readBinary)
 */
 
+void Data_writeToFastBinaryFile (Daata me, MelderFile file);
+/*
+	Message:
+		"try to write yourself as fast binary data to a file".
+	Description:
+		The file starts with "ooFastBinaryFile", followed by a header in the native byte order
+		and a table of contents at the end of the file. If you are a Collection, each of your items
+		gets its own entry in the table of contents (class name, object name, position and size),
+		so that it can be read later without reading the other items; otherwise, you are the only entry.
+		Each entry is written as in Data_writeBinary, except that the real and complex vectors and matrices
+		are written in the native byte order and memory layout, aligned in the file (see autoMelderNativeBinaryTensors),
+		so that reading them needs no conversion.
+		The file can be read back only on computers with the same byte order.
+*/
+
+autoDaata Data_readFromFastBinaryFile (MelderFile file);
+/*
+	Message:
+		"try to read a Data from a file written by Data_writeToFastBinaryFile".
+	Return value:
+		the new object; a Collection if a Collection was written.
+	Description:
+		The whole object is read into memory; the tensors are not mapped from the file.
+*/
+
+integer Data_getNumberOfItemsInFastBinaryFile (MelderFile file);
+/*
+	Return value:
+		the number of entries in the table of contents:
+		the number of items if a Collection was written, otherwise 1.
+*/
+
+autoDaata Data_readItemFromFastBinaryFile (MelderFile file, integer itemNumber);
+/*
+	Message:
+		"read only the object at entry 'itemNumber' of the table of contents, with its name".
+	Description:
+		The other entries are not read, so this is fast even if the file contains thousands of objects.
+*/
+
 using Data_FileTypeRecognizer = autoDaata (*) (integer numberOfBytesRead, const char *header, MelderFile file);
 
 void Data_recognizeFileType (Data_FileTypeRecognizer recognizer);
@@ -7071,7 +7071,7 @@ static void do_mul_fast_MAT () {
 			U"In the function “mul_fast##”, the number of columns of the first matrix and the number of rows of the second matrix should be equal, "
 			U"not ", xNcol, U" and ", yNrow, U"."
 		);
-		autoMAT result = mul_fast_MAT (x->numericMatrix, y->numericMatrix);
+		autoMAT result = mul_fast_threaded_MAT (x->numericMatrix, y->numericMatrix);
 		pushNumericMatrix (result.move());
 	} else {
 		Melder_throw (U"The function “mul_fast##” requires two matrices, not ", x->whichText(), U" and ", y->whichText(), U".");
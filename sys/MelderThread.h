@@ -2,7 +2,7 @@
 #define _MelderThread_h_
 /* MelderThread.h
  *
- * Copyright (C) 2014-2018,2020 Paul Boersma
+ * Copyright (C) 2014-2018,2020,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,10 +22,6 @@
 #include "Thing.h"
 #include <thread>
 
-inline integer MelderThread_getNumberOfProcessors () {
-	return uinteger_to_integer (std::thread::hardware_concurrency ());
-}
-
 template <class T> void MelderThread_run (void (*func) (T *), autoSomeThing <T> *args, integer numberOfThreads) {
 	uinteger unsignedNumberOfThreads = integer_to_uinteger (numberOfThreads);
 	if (unsignedNumberOfThreads == 1) {
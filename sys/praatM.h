@@ -1141,6 +1141,12 @@
 	TO_MULTIPLE__ \
 	CONVERT_END__
 
+#define CONVERT_ONE_AND_ALL_TO_MULTIPLE(klas1,klas2)  \
+	FIND_ONE_AND_ALL (klas1, klas2)
+#define CONVERT_ONE_AND_ALL_TO_MULTIPLE_END  \
+	TO_MULTIPLE__ \
+	CONVERT_END__
+
 #define CONVERT_ONE_WEAK_AND_ONE_TO_ONE(klas1,klas2)  \
 	FIND_ONE_AND_ONE (klas1, klas2) \
 	FIRST_WEAK_BEGIN
@@ -1,6 +1,6 @@
 /* praat_objectMenus.cpp
  *
- * Copyright (C) 1992-2024 Paul Boersma
+ * Copyright (C) 1992-2024,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -582,6 +582,32 @@ FORM_SAVE (SAVE_Data_writeToBinaryFile, U"Save Object(s) as one binary file", nu
 	END_NO_NEW_DATA
 }
 
+FORM_SAVE (SAVE_Data_writeToFastBinaryFile, U"Save Object(s) as one fast binary file", nullptr, nullptr) {
+	if (theCurrentPraatObjects -> totalSelection == 1) {
+		LOOP {
+			iam_LOOP (Daata);
+			Data_writeToFastBinaryFile (me, file);
+		}
+	} else {
+		autoCollection set = praat_getSelectedObjects ();
+		Data_writeToFastBinaryFile (set.get(), file);
+	}
+	END_NO_NEW_DATA
+}
+
+FORM (READ1_Data_readItemFromFastBinaryFile, U"Read one object from fast binary file", nullptr) {
+	INFILE (filePath, U"File path", U"")
+	NATURAL (objectNumber, U"Object number", U"1")
+	OK
+DO
+	CREATE_ONE
+		structMelderFile file { };
+		Melder_relativePathToFile (filePath, & file);
+		autoDaata result = Data_readItemFromFastBinaryFile (& file, objectNumber);
+		autostring32 name = Melder_dup (result -> name && result -> name [0] ? result -> name.get() : MelderFile_name (& file));
+	CREATE_ONE_END (name.get())
+}
+
 FORM (PRAAT_ManPages_saveToHtmlFolder, U"Save all pages as HTML files", nullptr) {
 	FOLDER (folder, U"Folder", U"")
 OK
@@ -884,6 +910,7 @@ void praat_addMenus (GuiWindow window) {
 			nullptr, 0, INFO_praat_library_createC);
 
 	praat_addMenuCommand (U"Objects", U"Open", U"Read from file...", nullptr, GuiMenu_ATTRACTIVE | 'O', READMANY_Data_readFromFile);
+	praat_addMenuCommand (U"Objects", U"Open", U"Read one object from fast binary file...", nullptr, GuiMenu_HIDDEN, READ1_Data_readItemFromFastBinaryFile);
 
 	praat_addAction1 (classDaata, 0, U"Save as text file... || Write to text file...",
 			nullptr, 0, SAVE_Data_writeToTextFile);   // alternative GuiMenu_DEPRECATED_2011
@@ -891,6 +918,8 @@ void praat_addMenus (GuiWindow window) {
 			nullptr, 0, SAVE_Data_writeToShortTextFile);   // alternative GuiMenu_DEPRECATED_2011
 	praat_addAction1 (classDaata, 0, U"Save as binary file... || Write to binary file...",
 			nullptr, 0, SAVE_Data_writeToBinaryFile);   // alternative GuiMenu_DEPRECATED_2011
+	praat_addAction1 (classDaata, 0, U"Save as fast binary file...",
+			nullptr, 0, SAVE_Data_writeToFastBinaryFile);
 
 	praat_addAction1 (classManPages, 1, U"Save to HTML folder... || Save to HTML directory...",
 			nullptr, 0, PRAAT_ManPages_saveToHtmlFolder);   // alternative GuiMenu_DEPRECATED_2020